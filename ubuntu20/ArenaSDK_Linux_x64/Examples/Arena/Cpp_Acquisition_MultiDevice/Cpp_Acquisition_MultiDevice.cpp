@@ -214,13 +214,8 @@ int main()
 			std::cout << "\nThis example is recommended to run with more than one device to demonstrate the multithreading clearly\n";
 		}
 
-		// create all dicovered devices and add them to a vector
-		std::vector<Arena::IDevice*> vDevices = std::vector<Arena::IDevice*>();
-		for (auto& deviceInfo : deviceInfos)
-		{
-			Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfo);
-			vDevices.push_back(pDevice);
-		}
+		// create all discovered devices concurrently
+		std::vector<Arena::IDevice*> vDevices = Arena::DeviceFactory::CreateDevices(pSystem, deviceInfos);
 
 		// run example
 		std::cout << "Commence example\n\n";
@@ -228,10 +223,7 @@ int main()
 		std::cout << "\nExample complete\n";
 
 		// clean up example
-		for (auto& pDevice : vDevices)
-		{
-			pSystem->DestroyDevice(pDevice);
-		}
+		Arena::DeviceFactory::DestroyDevices(pSystem, vDevices);
 
 		Arena::CloseSystem(pSystem);
 	}
@@ -236,19 +236,26 @@ void AcquireImagesRapidly(Arena::IDevice* pDevice)
 
 	pDevice->StopStream();
 
-	// return nodes to their initial values
+	// Return nodes to their initial values
+	//    Restore the initial values as a single transaction. The transaction
+	//    orders the writes so that features come after those they depend on
+	//    (for example, exposure time after exposure auto), and restores the
+	//    current values if any write fails.
+	Arena::NodeMapTransaction transaction(pDevice->GetNodeMap());
+	transaction.Begin();
 	if (exposureAutoInitial == "Off")
 	{
-		Arena::SetNodeValue<double>(pDevice->GetNodeMap(), "ExposureTime", exposureTimeInitial);
+		transaction.Set("ExposureTime", exposureTimeInitial);
 	}
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "ExposureAuto", exposureAutoInitial);
+	transaction.Set("ExposureAuto", exposureAutoInitial);
 	if (MAX_PACKET_SIZE)
 	{
-		Arena::SetNodeValue<int64_t>(pDevice->GetNodeMap(), "DeviceStreamChannelPacketSize", deviceStreamChannelPacketSizeInitial);
+		transaction.Set("DeviceStreamChannelPacketSize", deviceStreamChannelPacketSizeInitial);
 	}
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", pixelFormatInitial);
-	Arena::SetNodeValue<int64_t>(pDevice->GetNodeMap(), "Width", widthInitial);
-	Arena::SetNodeValue<int64_t>(pDevice->GetNodeMap(), "Height", heightInitial);
+	transaction.Set("PixelFormat", pixelFormatInitial);
+	transaction.Set("Width", widthInitial);
+	transaction.Set("Height", heightInitial);
+	transaction.Commit();
 }
 
 // =-=-=-=-=-=-=-=-=-
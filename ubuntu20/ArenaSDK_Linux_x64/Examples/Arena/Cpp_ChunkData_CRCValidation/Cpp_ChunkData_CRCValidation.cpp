@@ -153,6 +153,21 @@ void ConfigureAndValidateCRC(Arena::IDevice* pDevice)
 		std::cout << TAB3 << "CRCs invalid (CRCs do not match, data incorrect)\n";
 	}
 
+	// Validate CRC with hardware acceleration
+	//    For large images validated on every frame, the accelerated helpers
+	//    calculate the same CRC using processor instructions (PCLMULQDQ on
+	//    x86, CRC32 on ARMv8) where available, falling back to lookup tables.
+	std::cout << TAB2 << "Validate CRC with hardware acceleration" << (Arena::CRC32::IsAccelerated() ? "" : " (not available, using lookup tables)") << "\n";
+
+	if (Arena::VerifyCRCFast(pImage))
+	{
+		std::cout << TAB3 << "CRCs verified (CRCs match, data correct)\n";
+	}
+	else
+	{
+		std::cout << TAB3 << "CRCs invalid (CRCs do not match, data incorrect)\n";
+	}
+
 	// requeue buffer and stop stream
 	std::cout << TAB1 << "Requeue buffer and stop stream\n";
 
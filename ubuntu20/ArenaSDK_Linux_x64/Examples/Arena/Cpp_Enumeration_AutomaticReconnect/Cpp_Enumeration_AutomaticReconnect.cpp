@@ -0,0 +1,199 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+
+#include <atomic> // for std::atomic
+#include <thread> // for std::this_thread::sleep_for
+#include <chrono> // for std::chrono::seconds
+
+#define TAB1 "  "
+#define TAB2 "    "
+#define TAB3 "      "
+
+// Enumeration: Automatic Reconnect
+//    This example demonstrates the reconnect manager, which keeps a device
+//    acquiring through disconnections. When the device is lost, the manager
+//    finds it again by serial number, recreates it, reapplies its features,
+//    and restarts its stream, while image callbacks keep receiving images.
+//    Compare with Cpp_Enumeration_HandlingDisconnections, which does the same
+//    by hand.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// time to acquire, during which the device may be disconnected
+#define ACQUISITION_TIME 60
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// counts images received
+class ImageCallback : public Arena::IImageCallback
+{
+public:
+	ImageCallback() :
+		m_count(0)
+	{
+	}
+
+	void OnImage(Arena::IImage* /*pImage*/)
+	{
+		m_count++;
+	}
+
+	uint64_t GetCount()
+	{
+		return m_count;
+	}
+
+private:
+	std::atomic<uint64_t> m_count;
+};
+
+// prints disconnections and reconnections
+class ReconnectCallback : public Arena::IReconnectCallback
+{
+public:
+	void OnDisconnected()
+	{
+		std::cout << TAB2 << "Device disconnected, searching...\n";
+	}
+
+	void OnReconnected(Arena::IDevice* /*pDevice*/, const Arena::ReconnectStatistics& statistics)
+	{
+		std::cout << TAB2 << "Device reconnected after " << statistics.lastDowntime << " ms (about " << statistics.lastLostFrames << " frames lost)\n";
+	}
+};
+
+// demonstrates automatic reconnection
+// (1) prepares stream settings
+// (2) hands device to reconnect manager
+// (3) registers callbacks
+// (4) starts stream through manager
+// (5) acquires, reconnecting as needed
+// (6) stops stream and reports statistics
+void AcquireThroughDisconnections(Arena::ISystem* pSystem, Arena::IDevice* pDevice)
+{
+	// prepare stream settings
+	std::cout << TAB1 << "Prepare stream settings\n";
+
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+	// Hand device to reconnect manager
+	//    The manager takes ownership of the device, destroying it when the
+	//    manager goes out of scope. Features set before starting the stream
+	//    are saved and reapplied on reconnection.
+	std::cout << TAB1 << "Hand device to reconnect manager\n";
+
+	Arena::ReconnectManager manager(pSystem, pDevice);
+
+	// Register callbacks
+	//    Image callbacks registered through the manager survive reconnections;
+	//    reconnect callbacks are notified when the device is lost and restored.
+	std::cout << TAB1 << "Register callbacks\n";
+
+	ImageCallback imageCallback;
+	ReconnectCallback reconnectCallback;
+	manager.RegisterImageCallback(&imageCallback);
+	manager.RegisterReconnectCallback(&reconnectCallback);
+
+	// start stream
+	std::cout << TAB1 << "Start stream and acquire for " << ACQUISITION_TIME << " seconds (disconnect and reconnect device)\n";
+
+	manager.StartStream();
+
+	std::this_thread::sleep_for(std::chrono::seconds(ACQUISITION_TIME));
+
+	// Stop stream and report statistics
+	//    Downtime runs from the disconnection until the stream is restarted.
+	//    Lost frames are estimated from the frame rate over that time.
+	std::cout << TAB1 << "Stop stream\n";
+
+	manager.StopStream();
+	manager.DeregisterImageCallback(&imageCallback);
+	manager.DeregisterReconnectCallback(&reconnectCallback);
+
+	Arena::ReconnectStatistics statistics = manager.GetStatistics();
+
+	std::cout << TAB2 << "Images received: " << imageCallback.GetCount() << "\n";
+	std::cout << TAB2 << "Disconnections: " << statistics.disconnections << "\n";
+	std::cout << TAB2 << "Reconnections: " << statistics.reconnections << "\n";
+	std::cout << TAB3 << "Total downtime: " << statistics.totalDowntime << " ms\n";
+	std::cout << TAB3 << "Total lost frames: " << statistics.totalLostFrames << "\n";
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Enumeration_AutomaticReconnect\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(100);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		//    The device is destroyed by the reconnect manager.
+		std::cout << "Commence example\n\n";
+		AcquireThroughDisconnections(pSystem, pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
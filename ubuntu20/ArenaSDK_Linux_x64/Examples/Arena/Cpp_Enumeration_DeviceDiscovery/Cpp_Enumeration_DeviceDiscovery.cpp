@@ -0,0 +1,161 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+
+#include <thread> // for std::this_thread::sleep_for
+#include <chrono> // for std::chrono::seconds
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Enumeration: Device Discovery
+//    This example introduces the device discovery service. Instead of calling
+//    UpdateDevices in a loop, the service keeps the device list up to date in
+//    the background, listening for network changes and sweeping periodically.
+//    Applications retrieve devices without waiting on the network and are
+//    notified when devices come and go.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// time between sweeps of all interfaces
+#define SWEEP_INTERVAL 2000
+
+// time to watch for changes
+#define WATCH_TIME 30
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// prints devices added to and removed from the device table
+class DiscoveryCallback : public Arena::IDeviceDiscoveryCallback
+{
+public:
+	void OnDeviceAdded(Arena::DeviceInfo deviceInfo)
+	{
+		std::cout << TAB2 << "Added " << deviceInfo.ModelName() << " (" << deviceInfo.SerialNumber() << ", " << deviceInfo.IpAddressStr() << ")\n";
+	}
+
+	void OnDeviceRemoved(Arena::DeviceInfo deviceInfo)
+	{
+		std::cout << TAB2 << "Removed " << deviceInfo.ModelName() << " (" << deviceInfo.SerialNumber() << ")\n";
+	}
+};
+
+// demonstrates device discovery
+// (1) starts discovery service
+// (2) retrieves devices from table
+// (3) registers callback
+// (4) watches for changes
+// (5) deregisters callback and stops service
+void DiscoverDevices(Arena::ISystem* pSystem)
+{
+	// Start discovery service
+	//    Starting the service populates the device table with a discovery on all
+	//    interfaces before returning.
+	std::cout << TAB1 << "Start discovery service\n";
+
+	Arena::DeviceDiscovery discovery(pSystem, DISCOVERY_TIMEOUT, SWEEP_INTERVAL);
+	discovery.Start();
+
+	// Retrieve devices from table
+	//    Retrieving devices returns the table immediately, without sending
+	//    discovery.
+	std::vector<Arena::DeviceInfo> deviceInfos = discovery.GetDevices();
+
+	std::cout << TAB1 << "Retrieve devices (" << deviceInfos.size() << " found)\n";
+
+	for (size_t i = 0; i < deviceInfos.size(); i++)
+	{
+		std::cout << TAB2 << deviceInfos[i].ModelName() << " (" << deviceInfos[i].SerialNumber() << ", " << deviceInfos[i].IpAddressStr() << ")\n";
+	}
+
+	// register callback
+	std::cout << TAB1 << "Register callback\n";
+
+	DiscoveryCallback callback;
+	discovery.RegisterCallback(&callback);
+
+	// Watch for changes
+	//    Connect, disconnect or power cycle devices while the example waits.
+	//    Changes on the host's network interfaces trigger a discovery on the
+	//    affected interface; devices behind a switch are found by the next
+	//    sweep.
+	std::cout << TAB1 << "Watch for changes for " << WATCH_TIME << " seconds\n";
+
+	std::this_thread::sleep_for(std::chrono::seconds(WATCH_TIME));
+
+	// deregister callback and stop service
+	std::cout << TAB1 << "Deregister callback and stop service\n";
+
+	discovery.DeregisterCallback(&callback);
+	discovery.Stop();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Enumeration_DeviceDiscovery\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+
+		// run example
+		std::cout << "Commence example\n\n";
+		DiscoverDevices(pSystem);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
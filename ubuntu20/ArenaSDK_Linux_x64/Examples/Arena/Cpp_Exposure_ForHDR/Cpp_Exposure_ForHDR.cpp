@@ -61,19 +61,16 @@ public:
 
 // Trigger software once armed
 //    Continually check until trigger is armed. Once the trigger is armed, it is
-//    ready to be executed.
-void TriggerSoftwareOnceArmed(Arena::IDevice* pDevice)
+//    ready to be executed. The features are resolved once beforehand, so that
+//    polling does not look up the node by name on every check.
+void TriggerSoftwareOnceArmed(Arena::Feature<bool>& triggerArmed, Arena::Feature<Arena::Command>& triggerSoftware)
 {
 	// wait until trigger armed is true
-	bool triggerArmed = false;
-	do
-	{
-		triggerArmed = Arena::GetNodeValue<bool>(pDevice->GetNodeMap(), "TriggerArmed");
-	} while (triggerArmed == false);
+	while (!triggerArmed.Get())
+		;
 
-	// retrieve and execute software trigger node
-	GenApi::CCommandPtr pTriggerSoftware = pDevice->GetNodeMap()->GetNode("TriggerSoftware");
-	pTriggerSoftware->Execute();
+	// execute software trigger
+	triggerSoftware.Execute();
 }
 
 // demonstrates exposure configuration and acquisition for HDR imaging
@@ -133,28 +130,24 @@ void AcquireHDRImages(Arena::IDevice* pDevice)
 
 	// Get exposure time and software trigger nodes
 	//    The exposure time and software trigger nodes are retrieved beforehand
-	//    in order to check for existance, readability, and writability only once
-	//    before the stream.
+	//    as feature handles (Arena::Feature), which check for existence and
+	//    type only once, before the stream; setting values through them skips
+	//    the lookup by name for every image.
 	std::cout << TAB1 << "Get exposure time and trigger software nodes\n";
 
-	GenApi::CFloatPtr pExposureTime = pDevice->GetNodeMap()->GetNode("ExposureTime");
-	GenApi::CCommandPtr pTriggerSoftware = pDevice->GetNodeMap()->GetNode("TriggerSoftware");
-
-	if (!pExposureTime || !pTriggerSoftware)
-	{
-		throw GenICam::GenericException("ExposureTime or TriggerSoftware node not found", __FILE__, __LINE__);
-	}
+	Arena::Feature<double> exposureTime(pDevice->GetNodeMap(), "ExposureTime");
+	Arena::Feature<bool> triggerArmed(pDevice->GetNodeMap(), "TriggerArmed");
+	Arena::Feature<Arena::Command> triggerSoftware(pDevice->GetNodeMap(), "TriggerSoftware");
 
-	if (!GenApi::IsWritable(pExposureTime) || !GenApi::IsWritable(pTriggerSoftware))
+	if (!exposureTime.IsWritable() || !triggerSoftware.IsWritable())
 	{
 		throw GenICam::GenericException("ExposureTime or TriggerSoftware node not writable", __FILE__, __LINE__);
 	}
 
 	// get max and min exposure time to ensure set of exposure times are within
 	// this range
-	GenApi::CFloatPtr pFloat = pDevice->GetNodeMap()->GetNode("ExposureTime");
-	double exposureTimeMax = pFloat->GetMax();
-	double exposureTimeMin = pFloat->GetMin();
+	double exposureTimeMax = exposureTime.GetMax();
+	double exposureTimeMin = exposureTime.GetMin();
 
 	// if largest exposure times is not within the exposure time range, set
 	// largest exposure time to max value and set the remaining exposure times to
@@ -192,28 +185,28 @@ void AcquireHDRImages(Arena::IDevice* pDevice)
 		std::cout << TAB2 << "Get HDR image " << i << "\n";
 
 		// high exposure image
-		pExposureTime->SetValue(EXPOSURE_HIGH);
-		TriggerSoftwareOnceArmed(pDevice);
+		exposureTime.Set(EXPOSURE_HIGH);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImagePreHigh = pDevice->GetImage(TIMEOUT);
-		TriggerSoftwareOnceArmed(pDevice);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImageHigh = pDevice->GetImage(TIMEOUT);
 
 		std::cout << TAB3 << "High image (timestamp " << pImageHigh->GetTimestampNs() << ", exposure " << EXPOSURE_HIGH << ")\n";
 
 		// medium exposure image
-		pExposureTime->SetValue(EXPOSURE_MID);
-		TriggerSoftwareOnceArmed(pDevice);
+		exposureTime.Set(EXPOSURE_MID);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImagePreMid = pDevice->GetImage(TIMEOUT);
-		TriggerSoftwareOnceArmed(pDevice);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImageMid = pDevice->GetImage(TIMEOUT);
 
 		std::cout << TAB3 << "Mid image (timestamp " << pImageMid->GetTimestampNs() << ", exposure " << EXPOSURE_MID << ")\n";
 
 		// low exposure image
-		pExposureTime->SetValue(EXPOSURE_LOW);
-		TriggerSoftwareOnceArmed(pDevice);
+		exposureTime.Set(EXPOSURE_LOW);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImagePreLow = pDevice->GetImage(TIMEOUT);
-		TriggerSoftwareOnceArmed(pDevice);
+		TriggerSoftwareOnceArmed(triggerArmed, triggerSoftware);
 		Arena::IImage* pImageLow = pDevice->GetImage(TIMEOUT);
 
 		std::cout << TAB3 << "Low image (timestamp " << pImageLow->GetTimestampNs() << ", exposure " << EXPOSURE_LOW << ")\n";
@@ -0,0 +1,497 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+
+#include <fstream>	 // for std::ofstream
+#include <sstream>	 // for std::ostringstream
+#include <vector>	 // for std::vector
+#include <map>		 // for std::map
+#include <set>		 // for std::set
+#include <algorithm> // for std::sort
+#include <cstdlib>	 // for strtoll
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Generate Feature Header
+//    This tool generates a C++ header of strongly typed features from a
+//    device's GenICam XML. Each feature becomes a pre-resolved handle
+//    (Arena::Feature) and each enumeration a C++ enum, so that misspelled
+//    feature and entry names fail to compile. Features whose value lives in a
+//    register at a fixed address, without formulas (SwissKnife, Converter) or
+//    selector indexing in between, also get a direct register write that
+//    bypasses GenApi entirely.
+//
+//    Usage:
+//       Cpp_GenerateFeatureHeader
+//          generates from the first device found
+//       Cpp_GenerateFeatureHeader <xml or zip file> [header] [namespace]
+//          generates from a downloaded XML (Arena::IDevice::DownloadXml)
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// update timeout
+#define UPDATE_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// direct access to the register behind a feature
+struct DirectRegister
+{
+	std::string port;
+	int64_t address;
+	int64_t length;
+	bool bigEndian;
+	bool masked;
+	int shift;
+	int width;
+	bool floating;
+};
+
+// gets a property of a node, returning an empty string if absent
+std::string GetProperty(GenApi::INode* pNode, const char* name)
+{
+	GenICam::gcstring value;
+	GenICam::gcstring attribute;
+	if (!pNode->GetProperty(name, value, attribute))
+		return "";
+	return value.c_str();
+}
+
+// Find register behind feature
+//    A feature can be written directly if it is a register, or a plain
+//    Integer, Float, Boolean or Enumeration node pointing to a register
+//    through a single value (pValue), and the register:
+//    (1) has a fixed address, not computed (pAddress, SwissKnife) or indexed
+//        by a selector (pIndex, pValueIndexed),
+//    (2) is an integer, masked integer or float register,
+//    (3) is writable.
+bool FindDirectRegister(GenApi::INodeMap* pNodeMap, GenApi::INode* pFeature, DirectRegister& reg)
+{
+	GenApi::INode* pRegister = pFeature;
+	if (GetProperty(pFeature, "Address").empty())
+	{
+		// converters and SwissKnifes also have a pValue, but apply a formula
+		// on top of it
+		std::string featureType = GetProperty(pFeature, "NodeType");
+		if (featureType != "Integer" && featureType != "Float" && featureType != "Boolean" && featureType != "Enumeration")
+			return false;
+
+		std::string value = GetProperty(pFeature, "pValue");
+		if (value.empty() || value.find('\t') != std::string::npos || !GetProperty(pFeature, "pValueIndexed").empty())
+			return false;
+
+		pRegister = pNodeMap->GetNode(value.c_str());
+		if (!pRegister)
+			return false;
+	}
+
+	std::string nodeType = GetProperty(pRegister, "NodeType");
+	if (nodeType != "IntReg" && nodeType != "MaskedIntReg" && nodeType != "FloatReg")
+		return false;
+	if (GetProperty(pRegister, "Address").empty() || !GetProperty(pRegister, "pAddress").empty() || !GetProperty(pRegister, "pIndex").empty())
+		return false;
+	if (!GetProperty(pRegister, "pLength").empty() || GetProperty(pRegister, "AccessMode") == "RO")
+		return false;
+
+	// float features must be backed by float registers, integer features by
+	// integer registers, as no conversion is generated
+	reg.floating = nodeType == "FloatReg";
+	if (reg.floating != (pFeature->GetPrincipalInterfaceType() == GenApi::intfIFloat))
+		return false;
+
+	GenApi::IRegister* pIRegister = dynamic_cast<GenApi::IRegister*>(pRegister);
+	if (!pIRegister)
+		return false;
+
+	try
+	{
+		reg.address = pIRegister->GetAddress();
+		reg.length = pIRegister->GetLength();
+	}
+	catch (GenICam::GenericException&)
+	{
+		return false;
+	}
+	if (reg.length < 1 || reg.length > 8 || (reg.floating && reg.length != 4 && reg.length != 8))
+		return false;
+
+	reg.port = GetProperty(pRegister, "pPort");
+	reg.bigEndian = GetProperty(pRegister, "Endianess") == "BigEndian";
+	reg.masked = nodeType == "MaskedIntReg";
+	reg.shift = 0;
+	reg.width = static_cast<int>(reg.length * 8);
+	if (reg.port.empty())
+		return false;
+
+	if (reg.masked)
+	{
+		// big endian registers number bits from the most significant bit
+		std::string bit = GetProperty(pRegister, "Bit");
+		int lsb = static_cast<int>(strtoll((bit.empty() ? GetProperty(pRegister, "LSB") : bit).c_str(), NULL, 0));
+		int msb = static_cast<int>(strtoll((bit.empty() ? GetProperty(pRegister, "MSB") : bit).c_str(), NULL, 0));
+		int bits = static_cast<int>(reg.length * 8);
+		reg.shift = reg.bigEndian ? bits - 1 - lsb : lsb;
+		reg.width = (reg.bigEndian ? lsb - msb : msb - lsb) + 1;
+		if (reg.shift < 0 || reg.width < 1 || reg.shift + reg.width > bits)
+			return false;
+	}
+	return true;
+}
+
+// makes a name usable as a C++ identifier
+std::string ToIdentifier(const std::string& name)
+{
+	static const char* keywords[] = { "and", "auto", "bool", "break", "case", "char", "class", "const", "default", "delete", "do", "double", "else", "enum", "false", "float", "for", "if", "int", "long", "new", "not", "or", "private", "public", "return", "short", "signed", "static", "switch", "this", "true", "union", "unsigned", "void", "while", "xor" };
+
+	std::string identifier;
+	for (size_t i = 0; i < name.size(); i++)
+		identifier += isalnum(static_cast<unsigned char>(name[i])) ? name[i] : '_';
+	if (identifier.empty() || isdigit(static_cast<unsigned char>(identifier[0])))
+		identifier = "Value" + identifier;
+	for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+	{
+		if (identifier == keywords[i])
+			identifier += "_";
+	}
+	return identifier;
+}
+
+// Generate header
+//    Walk all features of the node map in name order, emitting:
+//    (1) an enum per enumeration, with the integer values of its entries,
+//    (2) a handle per feature, resolved when the class is constructed,
+//    (3) a register write per feature with a direct register,
+//    (4) helpers to encode register values in the device's byte order.
+void GenerateHeader(GenApi::INodeMap* pNodeMap, const std::string& source, const std::string& ns, std::ostream& os)
+{
+	GenApi::NodeList_t nodes;
+	pNodeMap->GetNodes(nodes);
+
+	// member names are reserved, so that features cannot collide with them
+	std::map<std::string, GenApi::INode*> features;
+	std::map<std::string, std::string> identifiers;
+	std::set<std::string> used;
+	used.insert("Features");
+	used.insert("InvalidateNodes");
+	used.insert("Write");
+	used.insert("WriteMasked");
+	used.insert("WriteFloat");
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		if (!nodes[i]->IsFeature())
+			continue;
+
+		switch (nodes[i]->GetPrincipalInterfaceType())
+		{
+		case GenApi::intfIInteger:
+		case GenApi::intfIFloat:
+		case GenApi::intfIBoolean:
+		case GenApi::intfIString:
+		case GenApi::intfIEnumeration:
+		case GenApi::intfICommand:
+			features[nodes[i]->GetName().c_str()] = nodes[i];
+			break;
+		default:
+			break;
+		}
+	}
+	for (std::map<std::string, GenApi::INode*>::iterator it = features.begin(); it != features.end();)
+	{
+		std::string identifier = ToIdentifier(it->first);
+		if (!used.insert(identifier).second || !used.insert(identifier + "Enum").second || !used.insert("Write" + identifier + "Register").second)
+		{
+			std::cout << TAB2 << "Skip feature " << it->first << ", identifier " << identifier << " already in use\n";
+			features.erase(it++);
+			continue;
+		}
+		identifiers[it->first] = identifier;
+		++it;
+	}
+
+	std::map<std::string, DirectRegister> registers;
+	std::set<std::string> ports;
+	for (std::map<std::string, GenApi::INode*>::iterator it = features.begin(); it != features.end(); ++it)
+	{
+		DirectRegister reg;
+		GenApi::EInterfaceType type = it->second->GetPrincipalInterfaceType();
+		if (type == GenApi::intfIString || type == GenApi::intfICommand)
+			continue;
+		if (!FindDirectRegister(pNodeMap, it->second, reg))
+			continue;
+
+		registers[it->first] = reg;
+		ports.insert(reg.port);
+	}
+
+	os << "// Generated by Cpp_GenerateFeatureHeader from " << source << "\n";
+	os << "// Do not edit; regenerate when the device's XML changes.\n\n";
+	os << "#pragma once\n\n";
+	os << "#include \"ArenaApi.h\"\n\n";
+	os << "#include <cstring>\n\n";
+	os << "namespace " << ns << "\n{\n";
+
+	// enums
+	for (std::map<std::string, GenApi::INode*>::iterator it = features.begin(); it != features.end(); ++it)
+	{
+		if (it->second->GetPrincipalInterfaceType() != GenApi::intfIEnumeration)
+			continue;
+
+		GenApi::NodeList_t entries;
+		dynamic_cast<GenApi::IEnumeration*>(it->second)->GetEntries(entries);
+
+		os << "\tenum class " << identifiers[it->first] << "Enum : int64_t\n\t{\n";
+		std::set<std::string> names;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			GenApi::IEnumEntry* pEntry = dynamic_cast<GenApi::IEnumEntry*>(entries[i]);
+			std::string name = ToIdentifier(pEntry->GetSymbolic().c_str());
+			if (!names.insert(name).second)
+			{
+				std::cout << TAB2 << "Drop entry " << pEntry->GetSymbolic() << " of " << it->first << ", identifier " << name << " already in use\n";
+				continue;
+			}
+			os << "\t\t" << name << " = " << pEntry->GetValue() << "LL,\n";
+		}
+		os << "\t};\n\n";
+	}
+
+	// features
+	os << "\tclass Features\n\t{\n\tpublic:\n";
+	os << "\t\tFeatures(GenApi::INodeMap* pNodeMap) :\n";
+	for (std::map<std::string, GenApi::INode*>::iterator it = features.begin(); it != features.end(); ++it)
+		os << "\t\t\t" << identifiers[it->first] << "(pNodeMap, \"" << it->first << "\"),\n";
+	os << "\t\t\tm_pNodeMap(pNodeMap)";
+	for (std::set<std::string>::iterator it = ports.begin(); it != ports.end(); ++it)
+		os << ",\n\t\t\tm_pPort" << ToIdentifier(*it) << "(dynamic_cast<GenApi::IPort*>(pNodeMap->GetNode(\"" << *it << "\")))";
+	os << "\n\t\t{\n";
+	for (std::set<std::string>::iterator it = ports.begin(); it != ports.end(); ++it)
+	{
+		os << "\t\t\tif (!m_pPort" << ToIdentifier(*it) << ")\n";
+		os << "\t\t\t\tthrow GenICam::GenericException(\"Port not found: " << *it << "\", __FILE__, __LINE__);\n";
+	}
+	os << "\t\t}\n\n";
+
+	for (std::map<std::string, GenApi::INode*>::iterator it = features.begin(); it != features.end(); ++it)
+	{
+		os << "\t\t";
+		switch (it->second->GetPrincipalInterfaceType())
+		{
+		case GenApi::intfIInteger:
+			os << "Arena::Feature<int64_t> ";
+			break;
+		case GenApi::intfIFloat:
+			os << "Arena::Feature<double> ";
+			break;
+		case GenApi::intfIBoolean:
+			os << "Arena::Feature<bool> ";
+			break;
+		case GenApi::intfIString:
+			os << "Arena::Feature<GenICam::gcstring> ";
+			break;
+		case GenApi::intfIEnumeration:
+			os << "Arena::EnumFeature<" << identifiers[it->first] << "Enum> ";
+			break;
+		default:
+			os << "Arena::Feature<Arena::Command> ";
+			break;
+		}
+		os << identifiers[it->first] << ";\n";
+	}
+
+	// direct register writes
+	if (!registers.empty())
+	{
+		os << "\n\t\t// Direct register writes\n";
+		os << "\t\t//    These write the feature's register without any GenApi evaluation:\n";
+		os << "\t\t//    no access mode, range or dependency checks, and no invalidation.\n";
+		os << "\t\t//    Call InvalidateNodes() before reading the features through GenApi\n";
+		os << "\t\t//    again.\n";
+	}
+	for (std::map<std::string, DirectRegister>::iterator it = registers.begin(); it != registers.end(); ++it)
+	{
+		const DirectRegister& reg = it->second;
+		GenApi::INode* pFeature = features[it->first];
+		GenApi::EInterfaceType type = pFeature->GetPrincipalInterfaceType();
+		std::string port = "m_pPort" + ToIdentifier(reg.port);
+
+		std::ostringstream address;
+		address << "0x" << std::hex << reg.address;
+
+		os << "\t\tvoid Write" << identifiers[it->first] << "Register(";
+		if (type == GenApi::intfIFloat)
+			os << "double value";
+		else if (type == GenApi::intfIBoolean)
+			os << "bool value";
+		else if (type == GenApi::intfIEnumeration)
+			os << identifiers[it->first] << "Enum value";
+		else
+			os << "int64_t value";
+		os << ")\n\t\t{\n";
+
+		std::string value = "static_cast<uint64_t>(value)";
+		if (type == GenApi::intfIBoolean)
+		{
+			std::string on = GetProperty(pFeature, "OnValue");
+			std::string off = GetProperty(pFeature, "OffValue");
+			value = "static_cast<uint64_t>(value ? " + (on.empty() ? std::string("1") : on) + "LL : " + (off.empty() ? std::string("0") : off) + "LL)";
+		}
+
+		if (reg.floating)
+			os << "\t\t\tWriteFloat(" << port << ", " << address.str() << ", " << reg.length << ", " << (reg.bigEndian ? "true" : "false") << ", value);\n";
+		else if (reg.masked)
+			os << "\t\t\tWriteMasked(" << port << ", " << address.str() << ", " << reg.length << ", " << (reg.bigEndian ? "true" : "false") << ", " << reg.shift << ", " << reg.width << ", " << value << ");\n";
+		else
+			os << "\t\t\tWrite(" << port << ", " << address.str() << ", " << reg.length << ", " << (reg.bigEndian ? "true" : "false") << ", " << value << ");\n";
+		os << "\t\t}\n\n";
+	}
+
+	os << "\t\tvoid InvalidateNodes()\n\t\t{\n\t\t\tm_pNodeMap->InvalidateNodes();\n\t\t}\n\n";
+
+	os << "\tprivate:\n";
+	if (!registers.empty())
+	{
+		os << "\t\tstatic void Write(GenApi::IPort* pPort, int64_t address, int64_t length, bool bigEndian, uint64_t value)\n";
+		os << "\t\t{\n";
+		os << "\t\t\tuint8_t buffer[8];\n";
+		os << "\t\t\tfor (int64_t i = 0; i < length; i++)\n";
+		os << "\t\t\t\tbuffer[bigEndian ? length - 1 - i : i] = static_cast<uint8_t>(value >> (8 * i));\n";
+		os << "\t\t\tpPort->Write(buffer, address, length);\n";
+		os << "\t\t}\n\n";
+		os << "\t\tstatic void WriteMasked(GenApi::IPort* pPort, int64_t address, int64_t length, bool bigEndian, int shift, int width, uint64_t value)\n";
+		os << "\t\t{\n";
+		os << "\t\t\tuint8_t buffer[8];\n";
+		os << "\t\t\tpPort->Read(buffer, address, length);\n";
+		os << "\t\t\tuint64_t current = 0;\n";
+		os << "\t\t\tfor (int64_t i = 0; i < length; i++)\n";
+		os << "\t\t\t\tcurrent |= static_cast<uint64_t>(buffer[bigEndian ? length - 1 - i : i]) << (8 * i);\n";
+		os << "\t\t\tuint64_t mask = (width == 64 ? ~0ULL : ((1ULL << width) - 1)) << shift;\n";
+		os << "\t\t\tWrite(pPort, address, length, bigEndian, (current & ~mask) | ((value << shift) & mask));\n";
+		os << "\t\t}\n\n";
+		os << "\t\tstatic void WriteFloat(GenApi::IPort* pPort, int64_t address, int64_t length, bool bigEndian, double value)\n";
+		os << "\t\t{\n";
+		os << "\t\t\tuint64_t bits = 0;\n";
+		os << "\t\t\tif (length == 4)\n";
+		os << "\t\t\t{\n";
+		os << "\t\t\t\tfloat single = static_cast<float>(value);\n";
+		os << "\t\t\t\tuint32_t singleBits;\n";
+		os << "\t\t\t\tmemcpy(&singleBits, &single, sizeof(singleBits));\n";
+		os << "\t\t\t\tbits = singleBits;\n";
+		os << "\t\t\t}\n";
+		os << "\t\t\telse\n";
+		os << "\t\t\t{\n";
+		os << "\t\t\t\tmemcpy(&bits, &value, sizeof(bits));\n";
+		os << "\t\t\t}\n";
+		os << "\t\t\tWrite(pPort, address, length, bigEndian, bits);\n";
+		os << "\t\t}\n\n";
+	}
+	os << "\t\tGenApi::INodeMap* m_pNodeMap;\n";
+	for (std::set<std::string>::iterator it = ports.begin(); it != ports.end(); ++it)
+		os << "\t\tGenApi::IPort* m_pPort" << ToIdentifier(*it) << ";\n";
+	os << "\t};\n";
+	os << "} // namespace " << ns << "\n";
+
+	std::cout << TAB2 << features.size() << " features, " << registers.size() << " with direct register writes\n";
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main(int argc, char** argv)
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_GenerateFeatureHeader\n";
+
+	try
+	{
+		std::string header = argc > 2 ? argv[2] : "";
+		std::string ns = argc > 3 ? argv[3] : "";
+
+		if (argc > 1)
+		{
+			// load XML from file
+			std::string xml = argv[1];
+			std::cout << TAB1 << "Load " << xml << "\n";
+
+			GenApi::CNodeMapRef nodeMap;
+			if (xml.size() > 4 && xml.substr(xml.size() - 4) == ".zip")
+				nodeMap._LoadXMLFromZIPFile(xml.c_str());
+			else
+				nodeMap._LoadXMLFromFile(xml.c_str());
+
+			if (ns.empty())
+				ns = ToIdentifier(nodeMap._GetDeviceName().c_str());
+			if (header.empty())
+				header = ns + ".h";
+
+			std::cout << TAB1 << "Generate " << header << "\n";
+			std::ofstream os(header.c_str());
+			GenerateHeader(nodeMap._Ptr, xml, ns, os);
+		}
+		else
+		{
+			// load XML from first device
+			Arena::ISystem* pSystem = Arena::OpenSystem();
+			pSystem->UpdateDevices(UPDATE_TIMEOUT);
+			std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+			if (deviceInfos.size() == 0)
+			{
+				std::cout << "\nNo camera connected\nPress enter to complete\n";
+				std::getchar();
+				return 0;
+			}
+			Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+			ns = ToIdentifier(deviceInfos[0].ModelName().c_str());
+			header = ns + ".h";
+
+			std::cout << TAB1 << "Generate " << header << " from " << deviceInfos[0].ModelName() << " (" << deviceInfos[0].DeviceVersion() << ")\n";
+			std::ofstream os(header.c_str());
+			GenerateHeader(pDevice->GetNodeMap(), std::string(deviceInfos[0].ModelName().c_str()) + " " + deviceInfos[0].DeviceVersion().c_str(), ns, os);
+
+			pSystem->DestroyDevice(pDevice);
+			Arena::CloseSystem(pSystem);
+		}
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
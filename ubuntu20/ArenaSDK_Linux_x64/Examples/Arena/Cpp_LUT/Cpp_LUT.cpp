@@ -71,32 +71,27 @@ void InvertIntensity(Arena::IDevice* pDevice)
 	// Invert values
 	std::cout << TAB1 << "Invert values\n";
 
-	// get nodes for LUT index and value
+	// get number of entries in the lookup table
 	GenApi::CIntegerPtr pLUTIndex = pDevice->GetNodeMap()->GetNode("LUTIndex");
-	GenApi::CIntegerPtr pLUTValue = pDevice->GetNodeMap()->GetNode("LUTValue");
-	if (!pLUTIndex || !pLUTValue)
+	if (!pLUTIndex)
 	{
-		throw GenICam::GenericException("Requisite node(s) LUTIndex and/or LUTValue do(es) not exist", __FILE__, __LINE__);
+		throw GenICam::GenericException("Requisite node LUTIndex does not exist", __FILE__, __LINE__);
 	}
 
+	// calculate substitution values
+	std::vector<uint16_t> table(static_cast<size_t>(pLUTIndex->GetMax() + 1));
 	for (int64_t i = 0; i <= pLUTIndex->GetMax(); i++)
 	{
-		// select pixel value
-		pLUTIndex->SetValue(i);
-
-		// set substitution value
-		int64_t value = (SLOPE * i) + pLUTIndex->GetMax();
-		pLUTValue->SetValue(value);
-
-		if (i % 1024 == 0)
-			std::cout << TAB2;
+		table[static_cast<size_t>(i)] = static_cast<uint16_t>((SLOPE * i) + pLUTIndex->GetMax());
+	}
 
-		if (i % 256 == 255)
-			std::cout << '.';
+	// Upload lookup table
+	//    Rather than selecting each index and setting its value one register
+	//    at a time, upload the whole table at once. The table is written as a
+	//    single block if the device provides one, otherwise as stacked writes.
+	std::cout << TAB2 << "Upload " << table.size() << " entries\n";
 
-		if (i % 1024 == 1023)
-			std::cout << '\n';
-	}
+	Arena::SetLUT(pDevice->GetNodeMap(), &table[0], table.size());
 
 	// enable stream auto negotiate packet size
 	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
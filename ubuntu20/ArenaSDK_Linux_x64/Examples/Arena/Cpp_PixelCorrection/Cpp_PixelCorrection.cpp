@@ -113,42 +113,29 @@ void CorrectPixels(Arena::IDevice* pDevice, int64_t pixelX, int64_t pixelY)
 		pDevice->GetNodeMap(),
 		"DefectCorrectionSave");
 
-	// Remove all pixels set through this example by decrementing through the index
-	//    The index is updated so that there are no empty indices after removal,
-	//    regardless of position
+	// Find and remove pixel from correction list
+	//    Read the whole correction list at once, remove the pixel set through
+	//    this example and write the list back. The positions are written as a
+	//    single batch, and entries after the removed pixel move up so that
+	//    there are no empty indices.
 	std::cout << TAB1 << "Find and remove pixel from correction list\n";
 
-	for (int64_t pixelCorrectionIndex = pixelCorrectionUpdatedIndex; pixelCorrectionIndex >= pixelCorrectionCountInitial; pixelCorrectionIndex--)
-	{
-		// select pixel
-		Arena::SetNodeValue<int64_t>(
-			pDevice->GetNodeMap(),
-			"DefectCorrectionIndex",
-			pixelCorrectionIndex);
-
-		std::cout << TAB2 << "Pixel index: " << std::setw(2) << pixelCorrectionIndex << " ";
-
-		// check position
-		int64_t x = Arena::GetNodeValue<int64_t>(
-			pDevice->GetNodeMap(),
-			"DefectCorrectionPositionX");
+	std::vector<Arena::DefectPixel> pixels = Arena::GetDefectPixels(pDevice->GetNodeMap());
 
-		std::cout << "(x: " << std::setw(4) << x;
-
-		int64_t y = Arena::GetNodeValue<int64_t>(
-			pDevice->GetNodeMap(),
-			"DefectCorrectionPositionY");
+	for (size_t pixelCorrectionIndex = pixels.size(); pixelCorrectionIndex > static_cast<size_t>(pixelCorrectionCountInitial); pixelCorrectionIndex--)
+	{
+		const Arena::DefectPixel& pixel = pixels[pixelCorrectionIndex - 1];
 
-		std::cout << ", y: " << std::setw(4) << y << ")";
+		std::cout << TAB2 << "Pixel index: " << std::setw(2) << pixelCorrectionIndex - 1 << " ";
+		std::cout << "(x: " << std::setw(4) << pixel.x << ", y: " << std::setw(4) << pixel.y << ")";
 
-		if (x == pixelX && y == pixelY)
+		if (pixel.x == pixelX && pixel.y == pixelY)
 		{
 			std::cout << " matches\n" TAB2 "Remove pixel\n";
 
 			// Delete pixel from correction list
-			Arena::ExecuteNode(
-				pDevice->GetNodeMap(),
-				"DefectCorrectionRemove");
+			pixels.erase(pixels.begin() + (pixelCorrectionIndex - 1));
+			Arena::SetDefectPixels(pDevice->GetNodeMap(), pixels);
 			break;
 		}
 		else
@@ -186,19 +173,15 @@ int main()
 			return 0;
 		}
 		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
-		int64_t pixelCorrectionCount = Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "DefectCorrectionCount");
 		// ensure arbitrary pixel selections are not already corrected
-		if (pixelCorrectionCount > 0)
+		std::vector<Arena::DefectPixel> pixels = Arena::GetDefectPixels(pDevice->GetNodeMap());
+		for (size_t i = 0; i < pixels.size(); i++)
 		{
-			for (int64_t i = 0; i < pixelCorrectionCount; i++)
+			if (pixels[i].x == PIXEL_X && pixels[i].y == PIXEL_Y)
 			{
-				Arena::SetNodeValue<int64_t>(pDevice->GetNodeMap(), "DefectCorrectionIndex", i);
-				if (Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "DefectCorrectionPositionX") == PIXEL_X && Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "DefectCorrectionPositionY") == PIXEL_Y)
-				{
-					std::cout << "\nPixels already corrected\nPress enter to complete\n";
-					std::getchar();
-					return -1;
-				}
+				std::cout << "\nPixels already corrected\nPress enter to complete\n";
+				std::getchar();
+				return -1;
 			}
 		}
 
@@ -0,0 +1,223 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <iomanip> // for std::setw
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Pixel Correction: Find Defects
+//    This example builds a defect pixel correction list on the host. It takes
+//    a dark image (lens covered) to find hot pixels and a flat image (evenly
+//    lit, unsaturated surface) to find dead and stuck pixels, then adds the
+//    pixels found to the device's correction list in one bulk write. Images
+//    are taken at the current region of interest; positions are only correct
+//    for the full sensor without offsets or binning.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Hot pixel threshold
+//    Number of standard deviations above the mean of the dark image from
+//    which a pixel is considered hot.
+#define HOT_THRESHOLD 6.0
+
+// Flat tolerance
+//    Relative deviation from the median of its neighbours beyond which a
+//    pixel of the flat image is considered dead or stuck.
+#define FLAT_TOLERANCE 0.3
+
+// number of pixels found to print
+#define NUM_PIXELS_TO_PRINT 10
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// 16-bit format to convert packed images to; bayer images stay bayer, so
+// that the defect search compares pixels of the same colour
+PfncFormat GetUnpackedFormat(Arena::IImage* pImage)
+{
+	std::string name = GetPixelFormatName(static_cast<PfncFormat>(pImage->GetPixelFormat()));
+	if (name.compare(0, 7, "BayerRG") == 0)
+		return BayerRG16;
+	if (name.compare(0, 7, "BayerGR") == 0)
+		return BayerGR16;
+	if (name.compare(0, 7, "BayerGB") == 0)
+		return BayerGB16;
+	if (name.compare(0, 7, "BayerBG") == 0)
+		return BayerBG16;
+	return Mono16;
+}
+
+// waits for the user to prepare the scene and grabs an image that the defect
+// search can read (8 or 16 bits per pixel); the stream only runs for the
+// grab, so that the image cannot be one buffered before the scene was ready
+Arena::IImage* GrabImage(Arena::IDevice* pDevice, const char* instructions)
+{
+	std::cout << TAB1 << instructions << ", then press enter\n";
+	std::getchar();
+
+	pDevice->StartStream();
+	Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+	Arena::IImage* pCopy = NULL;
+	if (pImage->GetBitsPerPixel() == 8 || pImage->GetBitsPerPixel() == 16)
+		pCopy = Arena::ImageFactory::Copy(pImage);
+	else
+		pCopy = Arena::ImageFactory::Convert(pImage, GetUnpackedFormat(pImage));
+
+	pDevice->RequeueBuffer(pImage);
+	pDevice->StopStream();
+	return pCopy;
+}
+
+// demonstrates building a defect list on the host
+// (1) grabs dark and flat images
+// (2) finds defective pixels
+// (3) adds them to the correction list
+void FindAndCorrectDefects(Arena::IDevice* pDevice)
+{
+	// enable stream auto negotiate packet size
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+
+	// enable stream packet resend
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+	// Grab dark and flat images
+	//    Grab one image with the lens covered and one of an evenly lit
+	//    surface. Packed pixel formats are converted to 16 bits, keeping
+	//    bayer patterns, so that each pixel can be read on its own.
+	std::cout << TAB1 << "Grab dark and flat images\n";
+
+	Arena::IImage* pDark = GrabImage(pDevice, "Cover the lens");
+	Arena::IImage* pFlat = GrabImage(pDevice, "Point the camera at an evenly lit surface");
+
+	// Find defective pixels
+	//    Hot pixels stand out from the dark image; dead and stuck pixels
+	//    stand out from their neighbours of the same colour in the flat
+	//    image.
+	std::cout << TAB1 << "Find defective pixels";
+
+	std::vector<Arena::DefectPixel> found = Arena::FindDefectPixels(pDark, pFlat, HOT_THRESHOLD, FLAT_TOLERANCE);
+
+	std::cout << " (" << found.size() << " found)\n";
+
+	for (size_t i = 0; i < found.size() && i < NUM_PIXELS_TO_PRINT; i++)
+	{
+		std::cout << TAB2 << "(x: " << std::setw(4) << found[i].x << ", y: " << std::setw(4) << found[i].y << ")\n";
+	}
+
+	Arena::ImageFactory::Destroy(pDark);
+	Arena::ImageFactory::Destroy(pFlat);
+
+	// Add pixels to correction list
+	//    Read the current list at once, add the pixels that are not already
+	//    in it and write the whole list back in a single batch. The list is
+	//    applied but not saved, so power-cycling the camera restores it.
+	std::vector<Arena::DefectPixel> pixels = Arena::GetDefectPixels(pDevice->GetNodeMap());
+	size_t countInitial = pixels.size();
+
+	for (size_t i = 0; i < found.size(); i++)
+	{
+		bool listed = false;
+		for (size_t j = 0; j < countInitial && !listed; j++)
+		{
+			listed = pixels[j].x == found[i].x && pixels[j].y == found[i].y;
+		}
+		if (!listed)
+		{
+			pixels.push_back(found[i]);
+		}
+	}
+
+	std::cout << TAB1 << "Add " << pixels.size() - countInitial << " pixels to correction list of " << countInitial << "\n";
+
+	Arena::SetDefectPixels(pDevice->GetNodeMap(), pixels);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_PixelCorrection_FindDefects\n";
+	std::cout << "Example may change device settings -- proceed? ('y' to continue) ";
+	char continueExample = 'a';
+	std::cin >> continueExample;
+
+	// clear input
+	while (std::cin.get() != '\n')
+		continue;
+
+	if (continueExample == 'y')
+	{
+		try
+		{
+			// prepare example
+			Arena::ISystem* pSystem = Arena::OpenSystem();
+			pSystem->UpdateDevices(100);
+			std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+			if (deviceInfos.size() == 0)
+			{
+				std::cout << "\nNo camera connected\nPress enter to complete\n";
+				std::getchar();
+				return 0;
+			}
+			Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+			// run example
+			std::cout << "Commence example\n\n";
+			FindAndCorrectDefects(pDevice);
+			std::cout << "\nExample complete\n";
+
+			// clean up example
+			pSystem->DestroyDevice(pDevice);
+			Arena::CloseSystem(pSystem);
+		}
+		catch (GenICam::GenericException& ge)
+		{
+			std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+			exceptionThrown = true;
+		}
+		catch (std::exception& ex)
+		{
+			std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+			exceptionThrown = true;
+		}
+		catch (...)
+		{
+			std::cout << "\nUnexpected exception thrown\n";
+			exceptionThrown = true;
+		}
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,213 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <iostream>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Record: Asynchronous
+//    This example records a video while images are being acquired, without
+//    converting them to BGR8 first. An asynchronous video recorder copies
+//    each image into a bounded queue and returns; conversion from the
+//    camera's pixel format (Mono8, YUV 4:2:2 or 8-bit Bayer) and H264
+//    encoding then run on their own threads. The recording is cut into
+//    files of a few seconds each, without a gap between them.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format used if the camera's is not accepted by the recorder
+#define FALLBACK_PIXEL_FORMAT "Mono8"
+
+// frames per second of the video
+#define FRAMES_PER_SECOND 25.0
+
+// number of images to record
+#define NUM_IMAGES 250
+
+// number of images that may wait for encoding
+#define MAX_QUEUED 8
+
+// length of each video file, in seconds
+#define SEGMENT_SECONDS 4.0
+
+// file name
+//    '<count>' numbers the video files
+#define FILE_NAME "Images/Cpp_Record_Async/video<count>.mp4"
+
+// image timeout
+#define TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates recording a video while acquiring
+// (1) chooses a pixel format the recorder accepts
+// (2) prepares asynchronous video recorder
+// (3) sets length of video files
+// (4) opens video for the pixel format
+// (5) starts stream and appends images as they arrive
+// (6) closes video
+void RecordVideoAsync(Arena::IDevice* pDevice)
+{
+	// choose pixel format
+	//    Frames in Mono8, YUV 4:2:2 or 8-bit Bayer are converted by the
+	//    recorder; other formats fall back to Mono8.
+	GenICam::gcstring pixelFormatInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat");
+	uint64_t pixelFormat = GetPixelFormatInteger(pixelFormatInitial.c_str());
+
+	if (!Save::AsyncVideoRecorder::IsSupported(pixelFormat))
+	{
+		Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", FALLBACK_PIXEL_FORMAT);
+		pixelFormat = GetPixelFormatInteger(FALLBACK_PIXEL_FORMAT);
+	}
+
+	int64_t width = Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Width");
+	int64_t height = Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Height");
+
+	std::cout << TAB1 << "Record " << width << "x" << height << " " << GetPixelFormatName(static_cast<PfncFormat>(pixelFormat)) << " images\n";
+
+	// prepare asynchronous video recorder
+	//    The codec and container are set as on a video recorder.
+	std::cout << TAB1 << "Prepare video recorder for video " << FILE_NAME << "\n";
+
+	Save::AsyncVideoRecorder recorder(
+		Save::VideoParams(static_cast<size_t>(width), static_cast<size_t>(height), FRAMES_PER_SECOND),
+		FILE_NAME,
+		MAX_QUEUED);
+
+	recorder.SetH264Mp4BGR8();
+
+	// set length of video files
+	//    Once a file holds the given time of video, the next frame starts a
+	//    new file. The next file is opened ahead of time and the previous one
+	//    closed in the background, so no frame waits on the cut.
+	std::cout << TAB1 << "Cut video every " << SEGMENT_SECONDS << " seconds\n";
+
+	recorder.SetSegmentDuration(SEGMENT_SECONDS);
+
+	// open video
+	std::cout << TAB1 << "Open video\n";
+
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+	recorder.Open(pixelFormat);
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+
+	// append images
+	//    Each image is copied into the queue, so its buffer can be requeued
+	//    right away. If encoding falls behind, AppendImage waits for room in
+	//    the queue.
+	std::cout << TAB1 << "Start stream and append " << NUM_IMAGES << " images\n";
+
+	pDevice->StartStream();
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(TIMEOUT);
+
+		if (!pImage->IsIncomplete())
+			recorder.AppendImage(pImage->GetData());
+
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	pDevice->StopStream();
+
+	// close video
+	//    Closing waits for the queued images to be encoded.
+	std::cout << TAB1 << "Close video (peak queue depth " << recorder.GetPeakQueueDepth() << " of " << MAX_QUEUED << ")\n";
+
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+	recorder.Close();
+	std::cout << "\nFFMPEG OUTPUT---------------\n";
+
+	std::cout << TAB2 << recorder.GetNumEncoded() << " images encoded\n";
+
+	for (size_t i = 0; i < recorder.GetNumSegments(); i++)
+		std::cout << TAB2 << "Saved " << recorder.GetSegmentFileName(i) << "\n";
+
+	// return nodes to their initial values
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", pixelFormatInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Record_Async\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(100);
+		std::vector<Arena::DeviceInfo> devices = pSystem->GetDevices();
+		if (devices.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(devices[0]);
+
+		// enable stream auto negotiate packet size
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+
+		// enable stream packet resend
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+		std::cout << "Commence example\n\n";
+		RecordVideoAsync(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,239 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <iostream>
+#include <cstdlib>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Record: Pre-Trigger
+//    This example records video only around events instead of streaming
+//    everything to disk. Images are appended to an asynchronous video
+//    recorder set up for event capture, which keeps the last seconds of
+//    video in memory. When an event is detected, here a sudden change of
+//    brightness, a trigger writes the video held in memory to a new file,
+//    followed by the video recorded for a few seconds after it.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format used if the camera's is not accepted by the recorder
+#define FALLBACK_PIXEL_FORMAT "Mono8"
+
+// frames per second of the video
+#define FRAMES_PER_SECOND 25.0
+
+// number of images to watch
+#define NUM_IMAGES 750
+
+// video kept before and recorded after an event, in seconds
+#define PRE_TRIGGER_SECONDS 2.0
+#define POST_TRIGGER_SECONDS 2.0
+
+// change of mean brightness, in gray levels, that counts as an event
+#define BRIGHTNESS_CHANGE 20
+
+// file name
+//    '<count>' numbers the events
+#define FILE_NAME "Images/Cpp_Record_PreTrigger/event<count>.mp4"
+
+// image timeout
+#define TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// estimates mean brightness from a sample of the image's bytes
+int GetBrightness(const uint8_t* pData, size_t size)
+{
+	const size_t step = 64;
+	uint64_t sum = 0;
+	size_t count = 0;
+
+	for (size_t i = 0; i < size; i += step, count++)
+		sum += pData[i];
+
+	return count > 0 ? static_cast<int>(sum / count) : 0;
+}
+
+// demonstrates recording video around events
+// (1) chooses a pixel format the recorder accepts
+// (2) prepares asynchronous video recorder
+// (3) sets up event capture
+// (4) opens recorder for the pixel format
+// (5) starts stream, appends images and triggers on events
+// (6) closes recorder
+void RecordVideoAroundEvents(Arena::IDevice* pDevice)
+{
+	// choose pixel format
+	//    Frames in Mono8, YUV 4:2:2 or 8-bit Bayer are converted by the
+	//    recorder; other formats fall back to Mono8.
+	GenICam::gcstring pixelFormatInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat");
+	uint64_t pixelFormat = GetPixelFormatInteger(pixelFormatInitial.c_str());
+
+	if (!Save::AsyncVideoRecorder::IsSupported(pixelFormat))
+	{
+		Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", FALLBACK_PIXEL_FORMAT);
+		pixelFormat = GetPixelFormatInteger(FALLBACK_PIXEL_FORMAT);
+	}
+
+	int64_t width = Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Width");
+	int64_t height = Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Height");
+
+	std::cout << TAB1 << "Watch " << width << "x" << height << " " << GetPixelFormatName(static_cast<PfncFormat>(pixelFormat)) << " images\n";
+
+	// prepare asynchronous video recorder
+	std::cout << TAB1 << "Prepare video recorder for videos " << FILE_NAME << "\n";
+
+	Save::AsyncVideoRecorder recorder(
+		Save::VideoParams(static_cast<size_t>(width), static_cast<size_t>(height), FRAMES_PER_SECOND),
+		FILE_NAME);
+
+	recorder.SetH264Mp4BGR8();
+
+	// set up event capture
+	//    Appended images are kept in a memory ring holding the last seconds
+	//    of video, compressed losslessly where the pixel format allows. Only
+	//    a trigger sends them on to be encoded.
+	std::cout << TAB1 << "Keep " << PRE_TRIGGER_SECONDS << " seconds before and record " << POST_TRIGGER_SECONDS << " seconds after each event\n";
+
+	recorder.SetPreTrigger(PRE_TRIGGER_SECONDS, POST_TRIGGER_SECONDS);
+
+	// open recorder
+	std::cout << TAB1 << "Open recorder\n";
+
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+	recorder.Open(pixelFormat);
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+
+	// append images and trigger on events
+	//    The trigger takes effect after the images appended before it, so
+	//    the image that showed the event is the last one kept before it.
+	//    Events during the post-trigger time extend the same video.
+	std::cout << TAB1 << "Start stream and watch " << NUM_IMAGES << " images\n";
+
+	pDevice->StartStream();
+
+	int lastBrightness = -1;
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(TIMEOUT);
+
+		if (!pImage->IsIncomplete())
+		{
+			int brightness = GetBrightness(pImage->GetData(), pImage->GetSizeFilled());
+			recorder.AppendImage(pImage->GetData());
+
+			if (lastBrightness >= 0 && std::abs(brightness - lastBrightness) >= BRIGHTNESS_CHANGE)
+			{
+				std::cout << TAB2 << "Event at image " << i << " (brightness " << lastBrightness << " to " << brightness << ")\n";
+				recorder.Trigger();
+			}
+			lastBrightness = brightness;
+		}
+
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	pDevice->StopStream();
+
+	// close recorder
+	//    Closing finishes the video of the last event; images still held in
+	//    memory are discarded.
+	std::cout << TAB1 << "Close recorder\n";
+
+	std::cout << "\nFFMPEG OUTPUT---------------\n\n";
+	recorder.Close();
+	std::cout << "\nFFMPEG OUTPUT---------------\n";
+
+	std::cout << TAB2 << recorder.GetNumSegments() << " events recorded\n";
+
+	for (size_t i = 0; i < recorder.GetNumSegments(); i++)
+		std::cout << TAB2 << "Saved " << recorder.GetSegmentFileName(i) << "\n";
+
+	// return nodes to their initial values
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", pixelFormatInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Record_PreTrigger\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(100);
+		std::vector<Arena::DeviceInfo> devices = pSystem->GetDevices();
+		if (devices.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(devices[0]);
+
+		// enable stream auto negotiate packet size
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+
+		// enable stream packet resend
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+		std::cout << "Commence example\n\n";
+		RecordVideoAroundEvents(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
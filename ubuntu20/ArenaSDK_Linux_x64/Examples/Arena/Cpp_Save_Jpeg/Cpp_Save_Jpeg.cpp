@@ -15,13 +15,16 @@
 #include "stdafx.h"
 #include "ArenaApi.h"
 #include "SaveApi.h"
+#include "JpegEncoder.h"
 
 #define TAB1 "  "
 
 // Save: Jpeg
 //    This example introduces saving JPEG image data in the saving library. It
 //    shows the construction of an image parameters object and an image writer,
-//    sets writer to JPEG and saves a single JPEG image.
+//    sets writer to JPEG and saves a single JPEG image. It then saves the
+//    unconverted image with the multithreaded JPEG encoder, which takes Mono8,
+//    YCbCr 4:2:2 and Bayer data directly.
 
 // =-=-=-=-=-=-=-=-=-
 // =-=- SETTINGS =-=-
@@ -33,6 +36,12 @@
 // file name
 #define FILE_NAME "Images/Cpp_Save/image.jpg"
 
+// file name for the multithreaded encoder
+#define FILE_NAME_PARALLEL "Images/Cpp_Save/image_parallel.jpg"
+
+// number of encoder threads (0 for one per hardware thread)
+#define NUM_THREADS 0
+
 // =-=-=-=-=-=-=-=-=-
 // =-=- EXAMPLE -=-=-
 // =-=-=-=-=-=-=-=-=-
@@ -44,6 +53,7 @@
 // (4) sets image writer to JPEG
 // (5) saves image
 // (6) destroys converted image
+// (7) saves unconverted image with the multithreaded encoder
 void SaveImage(Arena::IImage* pImage, const char* filename)
 {
 	// convert image
@@ -86,6 +96,27 @@ void SaveImage(Arena::IImage* pImage, const char* filename)
 
 	// destroy converted image
 	Arena::ImageFactory::Destroy(pConverted);
+
+	// Save with the multithreaded encoder
+	//   The JPEG encoder converts Mono8, YCbCr 4:2:2 and Bayer images to
+	//   YCbCr as it compresses them, so no converted copy of the image is
+	//   needed. The image is split into slices compressed on separate
+	//   threads and joined with restart markers into a single JPEG.
+	if (!Save::JpegEncoder::IsSupported(pImage->GetPixelFormat()))
+	{
+		std::cout << TAB1 << "Skip multithreaded encoder (" << GetPixelFormatName(static_cast<PfncFormat>(pImage->GetPixelFormat())) << " not supported)\n";
+		return;
+	}
+
+	std::cout << TAB1 << "Save " << GetPixelFormatName(static_cast<PfncFormat>(pImage->GetPixelFormat())) << " image with multithreaded encoder\n";
+
+	Save::JpegEncoder encoder(75, NUM_THREADS);
+	encoder.Save(
+		FILE_NAME_PARALLEL,
+		pImage->GetData(),
+		pImage->GetWidth(),
+		pImage->GetHeight(),
+		pImage->GetPixelFormat());
 }
 
 // =-=-=-=-=-=-=-=-=-
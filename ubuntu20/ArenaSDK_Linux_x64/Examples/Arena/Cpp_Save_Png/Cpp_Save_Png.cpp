@@ -15,13 +15,16 @@
 #include "stdafx.h"
 #include "ArenaApi.h"
 #include "SaveApi.h"
+#include "PngEncoder.h"
 
 #define TAB1 "  "
 
 // Save: Png
 //    This example introduces saving PNG image data in the saving library. It
 //    shows the construction of an image parameters object and an image writer,
-//    sets writer to PNG and saves a single PNG image.
+//    sets writer to PNG and saves a single PNG image. It then saves the same
+//    image with the parallel PNG encoder, which spreads compression across
+//    all cores.
 
 // =-=-=-=-=-=-=-=-=-
 // =-=- SETTINGS =-=-
@@ -33,6 +36,12 @@
 // file name
 #define FILE_NAME "Images/Cpp_Save/image.png"
 
+// file name for the parallel encoder
+#define FILE_NAME_PARALLEL "Images/Cpp_Save/image_parallel.png"
+
+// use fast mode of the parallel encoder
+#define FAST_MODE false
+
 // =-=-=-=-=-=-=-=-=-
 // =-=- EXAMPLE -=-=-
 // =-=-=-=-=-=-=-=-=-
@@ -43,7 +52,8 @@
 // (3) prepares image writer
 // (4) sets image writer to PNG
 // (5) saves image
-// (6) destroys converted image
+// (6) saves image with the parallel encoder
+// (7) destroys converted image
 void SaveImage(Arena::IImage* pImage, const char* filename)
 {
 	// convert image
@@ -84,6 +94,22 @@ void SaveImage(Arena::IImage* pImage, const char* filename)
 
 	writer << pConverted->GetData();
 
+	// Save image with the parallel encoder
+	//   The parallel encoder splits the image into bands that are filtered
+	//   and compressed on separate threads, then joined into a single PNG.
+	//   Fast mode trades file size for speed.
+	std::cout << TAB1 << "Save image with parallel encoder\n";
+
+	Save::PngEncoder encoder(6);
+	encoder.SetFast(FAST_MODE);
+
+	encoder.Save(
+		FILE_NAME_PARALLEL,
+		pConverted->GetData(),
+		pConverted->GetWidth(),
+		pConverted->GetHeight(),
+		pConverted->GetBitsPerPixel());
+
 	// destroy converted image
 	Arena::ImageFactory::Destroy(pConverted);
 }
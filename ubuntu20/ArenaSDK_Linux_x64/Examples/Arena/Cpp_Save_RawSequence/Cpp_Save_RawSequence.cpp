@@ -0,0 +1,201 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Save: Raw Sequence
+//    This example records a stream of raw images into a sequence instead of
+//    one file per image. A sequence writer appends frames, each with a header
+//    holding its pixel format, dimensions, timestamp and frame ID, into a few
+//    large segment files. A sequence reader then maps the segments back into
+//    memory for random access. Frames can be compressed losslessly on the
+//    way in, which roughly halves the size of packed 10 and 12-bit data.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// base name of the segment files
+#define BASE_NAME "Images/Cpp_Save_RawSequence/sequence"
+
+// number of images to record
+#define NUM_IMAGES 100
+
+// segment size in bytes
+#define SEGMENT_SIZE (1ULL << 30)
+
+// write with direct I/O, bypassing the page cache
+#define DIRECT_IO true
+
+// compress Mono and Bayer frames losslessly
+#define COMPRESS true
+
+// image timeout
+#define TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates recording and reading a raw sequence
+// (1) prepares sequence writer
+// (2) starts stream and appends images with chunk data
+// (3) closes writer to write segment indexes
+// (4) opens sequence reader
+// (5) reads frames back by position
+void RecordRawSequence(Arena::IDevice* pDevice)
+{
+	// prepare sequence writer
+	//    Segment files are preallocated and frames are written in large
+	//    aligned blocks. A new segment is started once the current one
+	//    reaches the segment size.
+	std::cout << TAB1 << "Prepare sequence writer\n";
+
+	Save::SequenceWriter writer(BASE_NAME, SEGMENT_SIZE, DIRECT_IO);
+	writer.SetCompression(COMPRESS);
+
+	// start stream and append images
+	//    Any chunk data sent after the image is stored alongside it.
+	std::cout << TAB1 << "Start stream and record " << NUM_IMAGES << " images\n";
+
+	pDevice->StartStream();
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(TIMEOUT);
+
+		if (!pImage->IsIncomplete())
+		{
+			size_t imageSize = pImage->GetWidth() * pImage->GetHeight() * pImage->GetBitsPerPixel() / 8;
+			size_t chunkSize = pImage->GetSizeFilled() > imageSize ? pImage->GetSizeFilled() - imageSize : 0;
+
+			writer.Append(
+				pImage->GetData(),
+				imageSize,
+				pImage->GetPixelFormat(),
+				pImage->GetWidth(),
+				pImage->GetHeight(),
+				pImage->GetBitsPerPixel(),
+				pImage->GetTimestampNs(),
+				pImage->GetFrameId(),
+				chunkSize > 0 ? pImage->GetData() + imageSize : NULL,
+				chunkSize);
+		}
+
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	pDevice->StopStream();
+
+	// close writer
+	//    Closing flushes the last frames and writes each segment's index.
+	std::cout << TAB1 << "Close writer (" << writer.GetNumFrames() << " frames in " << writer.GetNumSegments() << " segments)\n";
+
+	writer.Close();
+
+	// open sequence reader
+	std::cout << TAB1 << "Open sequence reader\n";
+
+	Save::SequenceReader reader(BASE_NAME);
+
+	// read frames back
+	//    Frames are returned as pointers into the mapped segments, so no
+	//    data is copied. Compressed frames are restored with ReadImage.
+	std::cout << TAB1 << "Read " << reader.GetNumFrames() << " frames\n";
+
+	std::vector<uint8_t> image;
+
+	for (uint64_t i = 0; i < reader.GetNumFrames(); i += NUM_IMAGES / 10)
+	{
+		Save::SequenceFrame frame = reader.GetFrame(i);
+		reader.ReadImage(i, image);
+
+		std::cout << TAB2 << "Frame " << frame.pHeader->frameId
+				  << " (" << frame.pHeader->width << "x" << frame.pHeader->height
+				  << ", " << GetPixelFormatName(static_cast<PfncFormat>(frame.pHeader->pixelFormat))
+				  << ", timestamp " << frame.pHeader->timestamp
+				  << ", " << frame.pHeader->dataSize << " of " << image.size() << " bytes stored"
+				  << ", " << frame.pHeader->chunkSize << " bytes chunk data)\n";
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Save_RawSequence\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(100);
+		std::vector<Arena::DeviceInfo> devices = pSystem->GetDevices();
+		if (devices.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(devices[0]);
+
+		// enable stream auto negotiate packet size
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+
+		// enable stream packet resend
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+		std::cout << "Commence example\n\n";
+		RecordRawSequence(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,189 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include "TiffWriter.h"
+#include "TiffReader.h"
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Save: Tiff Stack
+//    This example streams a series of 16-bit images into a single multi-page
+//    BigTIFF file. Each image is appended as a new page without rewriting the
+//    pages before it, with strips compressed in parallel. A TIFF reader then
+//    opens the stack and decodes pages by position.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format
+#define PIXEL_FORMAT Mono16
+
+// file name
+#define FILE_NAME "Images/Cpp_Save_TiffStack/stack.tif"
+
+// number of images to record
+#define NUM_IMAGES 25
+
+// compression of each page
+#define COMPRESSION Save::TiffCodecDeflate
+
+// image timeout
+#define TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates streaming images into a multi-page TIFF
+// (1) prepares TIFF writer
+// (2) starts stream, converts images and appends them as pages
+// (3) closes writer to write the page index
+// (4) opens TIFF reader
+// (5) reads pages back by position
+void RecordTiffStack(Arena::IDevice* pDevice)
+{
+	// prepare TIFF writer
+	//    BigTIFF removes the 4 GB limit of classic TIFF. Strips are
+	//    compressed with horizontal differencing, which suits 16-bit data.
+	std::cout << TAB1 << "Prepare TIFF writer\n";
+
+	Save::TiffWriter writer(FILE_NAME);
+	writer.SetCompression(COMPRESSION);
+
+	// start stream and append images
+	//    Each page is complete once appended, so the file stays readable
+	//    while the capture runs.
+	std::cout << TAB1 << "Start stream and append " << NUM_IMAGES << " images as " << GetPixelFormatName(PIXEL_FORMAT) << "\n";
+
+	pDevice->StartStream();
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(TIMEOUT);
+
+		if (!pImage->IsIncomplete())
+		{
+			Arena::IImage* pConverted = Arena::ImageFactory::Convert(pImage, PIXEL_FORMAT);
+
+			writer.AppendPage(
+				pConverted->GetData(),
+				pConverted->GetWidth(),
+				pConverted->GetHeight(),
+				pConverted->GetBitsPerPixel());
+
+			Arena::ImageFactory::Destroy(pConverted);
+		}
+
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	pDevice->StopStream();
+
+	// close writer
+	//    Closing stores a table of page offsets, so readers can reach any
+	//    page without walking the directory chain.
+	std::cout << TAB1 << "Close writer (" << writer.GetNumPages() << " pages)\n";
+
+	writer.Close();
+
+	// open TIFF reader
+	std::cout << TAB1 << "Open TIFF reader\n";
+
+	Save::TiffReader reader(FILE_NAME);
+
+	// read pages back
+	std::cout << TAB1 << "Read " << reader.GetNumPages() << " pages" << (reader.IsIndexed() ? " through the page index" : "") << "\n";
+
+	for (size_t i = 0; i < reader.GetNumPages(); i += 5)
+	{
+		Save::TiffPageInfo info = reader.GetPageInfo(i);
+		std::vector<uint8_t> page = reader.ReadPage(i);
+
+		std::cout << TAB2 << "Page " << i
+				  << " (" << info.width << "x" << info.height
+				  << ", " << info.bitsPerSample * info.samplesPerPixel << " bpp"
+				  << ", " << info.blockOffsets.size() << " strips"
+				  << ", " << page.size() << " bytes)\n";
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Save_TiffStack\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(100);
+		std::vector<Arena::DeviceInfo> devices = pSystem->GetDevices();
+		if (devices.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(devices[0]);
+
+		// enable stream auto negotiate packet size
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+
+		// enable stream packet resend
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+		std::cout << "Commence example\n\n";
+		RecordTiffStack(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -62,65 +62,6 @@ double EXPOSURE_TIME_2 = 100000.0;
 // =-=- EXAMPLE -=-=-
 // =-=-=-=-=-=-=-=-=-
 
-// set sequencer set to desired values
-void SetSequencerSet(GenApi::INodeMap* nodeMap, int64_t setNumber, double exposureTime, int64_t pathNextSet, GenICam::gcstring triggerSource)
-{
-	// set Sequencer Set Selector to sequence number
-	Arena::SetNodeValue<int64_t>(
-		nodeMap,
-		"SequencerSetSelector",
-		setNumber);
-
-	std::cout << TAB2 << "Updating set " << setNumber << ":\n";
-
-	Arena::SetNodeValue<GenICam::gcstring>(
-		nodeMap,
-		"SequencerFeatureSelector",
-		"ExposureTime");
-
-	// set exposure time to the value we want it to save
-	Arena::SetNodeValue<double>(
-		nodeMap,
-		"ExposureTime",
-		exposureTime);
-
-	std::cout << TAB3 << "Exposure time = " << exposureTime << "\n";
-
-	// select the path we want it to follow from this set to next set, there can
-	// be multiple paths so the first path will always be set to 0
-	Arena::SetNodeValue<int64_t>(
-		nodeMap,
-		"SequencerPathSelector",
-		0);
-
-	std::cout << TAB3 << "Path[0] = ";
-
-	// set next state in the sequence, ensure it does not exceed the maximum
-	Arena::SetNodeValue<int64_t>(
-		nodeMap,
-		"SequencerSetNext",
-		pathNextSet);
-
-	std::cout << pathNextSet << "\n";
-
-	// set Sequencer Trigger Source to Frame Start
-	Arena::SetNodeValue<GenICam::gcstring>(
-		nodeMap,
-		"SequencerTriggerSource",
-		triggerSource);
-
-	std::cout << TAB3 << "Trigger source = " + triggerSource + "\n";
-
-	// Save current state
-	//    Once all appropriate settings have been configured, make sure to save
-	//    the state to the sequence. Notice that these settings will be lost when
-	//    the camera is power-cycled.
-	std::cout << TAB3 << "Save sequence set\n";
-
-	GenApi::CCommandPtr pSequencerSetSave = nodeMap->GetNode("SequencerSetSave");
-	pSequencerSetSave->Execute();
-}
-
 // start streaming, acquire and save images
 void AcquireAndSaveImages(Arena::IDevice* pDevice)
 {
@@ -243,47 +184,37 @@ void AcquireImagesUsingSequencer(Arena::IDevice* pDevice)
 		"GainAuto",
 		"Off");
 
-	// if sequencer mode is on, turn it off
-	if (Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "SequencerMode") == "On")
-	{
-		std::cout << TAB1 << "Turn sequencer mode off\n";
-
-		Arena::SetNodeValue<GenICam::gcstring>(
-			pDevice->GetNodeMap(),
-			"SequencerMode",
-			"Off");
-	}
-
-	// Put sequencer in configuration mode
-	//    Sequencer configuration mode must be on while making changes to the
-	//    sequencer sets.
-	std::cout << TAB1 << "Turn sequencer configuration mode on\n";
+	// Describe sequencer program
+	//    Describe each set of the sequencer in a program: the exposure time of
+	//    the set and the path to the next set. There can be multiple paths per
+	//    set, so the first path is always path 0. Set 0 goes to set 1, set 1 to
+	//    set 2 and set 2 back to set 0, all triggered on Frame Start.
+	std::cout << TAB1 << "Describe sequencer program\n";
 
-	Arena::SetNodeValue<GenICam::gcstring>(
-		pDevice->GetNodeMap(),
-		"SequencerConfigurationMode",
-		"On");
+	Arena::SequencerProgram program;
+	double exposureTimes[NUM_SETS] = { EXPOSURE_TIME_0, EXPOSURE_TIME_1, EXPOSURE_TIME_2 };
+	for (int64_t set = 0; set < NUM_SETS; set++)
+	{
+		int64_t nextSet = (set + 1) % NUM_SETS;
 
-	// set up sequencer sets
-	std::cout << TAB1 << "Set up sequencer sets\n";
+		program.SetFeature(set, "ExposureTime", exposureTimes[set]);
+		program.SetPath(set, 0, nextSet, "FrameStart");
 
-	SetSequencerSet(pDevice->GetNodeMap(), 0, EXPOSURE_TIME_0, 1, "FrameStart");
-	SetSequencerSet(pDevice->GetNodeMap(), 1, EXPOSURE_TIME_1, 2, "FrameStart");
-	SetSequencerSet(pDevice->GetNodeMap(), 2, EXPOSURE_TIME_2, 0, "FrameStart");
+		std::cout << TAB2 << "Set " << set << ": exposure time = " << exposureTimes[set] << ", path[0] = " << nextSet << " on FrameStart\n";
+	}
 
 	// sets the sequencer starting set to be set 0
-	Arena::SetNodeValue<int64_t>(
-		pDevice->GetNodeMap(),
-		"SequencerSetStart",
-		0);
+	program.SetStartSet(0);
 
-	// turn off configuration mode
-	std::cout << TAB1 << "Turn sequencer configuration mode off\n";
+	// Upload sequencer program
+	//    The program is validated against the device before anything is
+	//    written. Each set is then written in one batch and saved in
+	//    configuration mode, and the program is read back to verify it.
+	//    Notice that these settings will be lost when the camera is
+	//    power-cycled.
+	std::cout << TAB1 << "Upload and verify sequencer program\n";
 
-	Arena::SetNodeValue<GenICam::gcstring>(
-		pDevice->GetNodeMap(),
-		"SequencerConfigurationMode",
-		"Off");
+	program.Upload(pDevice->GetNodeMap());
 
 	// Turn on sequencer
 	//    When sequencer mode is on and the device is streaming it will follow
@@ -21,7 +21,9 @@
 //    This example introduces streamables, which uses files to pass settings
 //    around between devices. This example writes all streamable features from a
 //    source device to a file, and then writes them from the file to all other
-//    connected devices.
+//    connected devices. Finally, it uses in-memory snapshots taken before
+//    loading to return the other devices to their initial settings,
+//    restoring only the features the file changed.
 
 // =-=-=-=-=-=-=-=-=-
 // =-=- SETTINGS =-=-
@@ -39,6 +41,8 @@
 // (2) writes features to file
 // (3) reads features from file
 // (4) writes features to destination devices
+// (5) compares destination devices with source device
+// (6) restores destination devices from snapshots at the end
 void WriteAndReadStreamables(Arena::IDevice* pSrcDevice, std::vector<Arena::IDevice*> dstDevices)
 {
 	// Write features to file
@@ -55,13 +59,49 @@ void WriteAndReadStreamables(Arena::IDevice* pSrcDevice, std::vector<Arena::IDev
 	//    Again, each node map requires a separate feature stream object. When
 	//    reading from a file, all features saved to the file will be loaded to
 	//    the device. If a device does not have a feature, it is skipped.
+	std::vector<Arena::FeatureSnapshot> initialFeatures;
+
 	for (size_t i = 0; i < dstDevices.size(); i++)
 	{
 		std::cout << TAB1 << "Load features from " << FILE_NAME << " to device " << Arena::GetNodeValue<GenICam::gcstring>(dstDevices[i]->GetTLDeviceNodeMap(), "DeviceSerialNumber") << "\n";
 
+		// Snapshot features before loading
+		//    Keep the streamable features of the device in memory before they
+		//    are overwritten, to return the device to them at the end of the
+		//    example.
+		initialFeatures.push_back(Arena::FeatureSnapshot(dstDevices.at(i)->GetNodeMap()));
+
 		Arena::FeatureStream featureStreamDst(dstDevices.at(i)->GetNodeMap());
 		featureStreamDst.Read("allStreamableFeatures.txt");
 	}
+
+	// Compare devices with source
+	//    A diff from a device's features to the source device's holds the
+	//    writes that would still make them equal. Features the device does
+	//    not have, or cannot write in its current state, remain.
+	Arena::FeatureSnapshot srcFeatures(pSrcDevice->GetNodeMap());
+
+	for (size_t i = 0; i < dstDevices.size(); i++)
+	{
+		Arena::FeatureSnapshot loaded(dstDevices.at(i)->GetNodeMap());
+
+		std::cout << TAB1 << "Device " << Arena::GetNodeValue<GenICam::gcstring>(dstDevices[i]->GetTLDeviceNodeMap(), "DeviceSerialNumber") << " differs from source in " << loaded.Diff(srcFeatures).GetSize() << " feature writes\n";
+	}
+
+	// Restore changed features
+	//    At the end of the example, compare the loaded features of each
+	//    device with its snapshot. The diff holds only the writes that
+	//    differ, along with the selectors they depend on, and applies them
+	//    as a single batch.
+	for (size_t i = 0; i < dstDevices.size(); i++)
+	{
+		Arena::FeatureSnapshot loaded(dstDevices.at(i)->GetNodeMap());
+		Arena::FeatureSnapshot diff = loaded.Diff(initialFeatures[i]);
+
+		std::cout << TAB1 << "Restore " << diff.GetSize() << " of " << initialFeatures[i].GetSize() << " feature writes on device " << Arena::GetNodeValue<GenICam::gcstring>(dstDevices[i]->GetTLDeviceNodeMap(), "DeviceSerialNumber") << "\n";
+
+		diff.Apply(dstDevices.at(i)->GetNodeMap());
+	}
 }
 
 // =-=-=-=-=-=-=-=-=-
@@ -59,11 +59,15 @@
 // (7) stops stream
 void ConfigureTriggerAndAcquireImage(Arena::IDevice* pDevice)
 {
-	// get node values that will be changed in order to return their values at
-	// the end of the example
+	// Get node values that will be changed
+	//    Collect the initial values in a feature batch in order to return them
+	//    at the end of the example. The batch writes them back together,
+	//    stacking the register writes instead of waiting on each one.
+	Arena::FeatureBatch initialValues(pDevice->GetNodeMap());
 	GenICam::gcstring triggerSelectorInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSelector");
-	GenICam::gcstring triggerModeInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerMode");
-	GenICam::gcstring triggerSourceInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSource");
+	initialValues.AddCurrentValue("TriggerSource");
+	initialValues.AddCurrentValue("TriggerMode");
+	initialValues.Add("TriggerSelector", triggerSelectorInitial);
 
 	// Set trigger selector
 	//    Set the trigger selector to FrameStart. When triggered, the device will
@@ -161,9 +165,16 @@ void ConfigureTriggerAndAcquireImage(Arena::IDevice* pDevice)
 	pDevice->StopStream();
 
 	// return nodes to their initial values
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSource", triggerSourceInitial);
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerMode", triggerModeInitial);
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSelector", triggerSelectorInitial);
+	//    Values that could not be written are reported with their reasons.
+	if (!initialValues.Write())
+	{
+		const std::vector<Arena::FeatureBatchResult>& results = initialValues.GetResults();
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			if (!results[i].written)
+				std::cout << TAB1 << "Could not restore " << results[i].name << " to " << results[i].value << " (" << results[i].error << ")\n";
+		}
+	}
 }
 
 // =-=-=-=-=-=-=-=-=-
@@ -66,18 +66,13 @@
 
 // demonstrates basic trigger configuration and use
 // (1) sets trigger mode, source, and selector
-// (2) sets acquisition mode, event selector, and turns on event notifications
+// (2) sets acquisition mode and creates an event queue for exposure end events
 // (3) starts stream
 // (4) waits on trigger armed, executes trigger, and waits on exposureEnd event for all images
 // (5) grabs each image and requeues image buffer for all images
 // (6) stops stream
 void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 {
-	// Initialize events
-	//    Events nodes aren't available until the events engine has been
-	//    initialized.
-	pDevice->InitializeEvents();
-
 	// get node values that will be changed in order to return their values at
 	// the end of the example
 	GenICam::gcstring triggerSelectorInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSelector");
@@ -85,8 +80,6 @@ void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 	GenICam::gcstring triggerSourceInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSource");
 	GenICam::gcstring triggerOverlapInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerOverlap");
 	GenICam::gcstring acquisitionModeInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "AcquisitionMode");
-	GenICam::gcstring eventSelectorInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "EventSelector");
-	GenICam::gcstring eventNotificationInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "EventNotification");
 	GenICam::gcstring exposureAutoInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "ExposureAuto");
 
 	// Set trigger selector
@@ -148,27 +141,18 @@ void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 		"AcquisitionMode",
 		"Continuous");
 
-	// Set event selector
+	// Create event queue
 	//    We want to trigger and wait to be notified as soon as a certain event
 	//    occurs while making the image. Here we choose to be notified at the end
-	//    of the exposure of an image.
-	std::cout << TAB1 << "Set event selector to: \"ExposureEnd\"\n";
-
-	Arena::SetNodeValue<GenICam::gcstring>(
-		pDevice->GetNodeMap(),
-		"EventSelector",
-		"ExposureEnd");
+	//    of the exposure of an image. The event queue initializes the events
+	//    engine, turns on the notification for the event, and receives events
+	//    on its own thread, handing back the timestamp of each one. Events are
+	//    deinitialized and the notification restored when it goes out of scope.
+	std::cout << TAB1 << "Create event queue for \"ExposureEnd\"\n";
 
-	// Set event notification
-	//    After choosing which event to be notified about, enabling the
-	//    EventNotification node will turn on the notification for the event
-	//    selected in the EventSelector node.
-	std::cout << TAB1 << "Enable event notifications for \"ExposureEnd\"\n";
-
-	Arena::SetNodeValue<GenICam::gcstring>(
-		pDevice->GetNodeMap(),
-		"EventNotification",
-		"On");
+	std::vector<GenICam::gcstring> events;
+	events.push_back("ExposureEnd");
+	Arena::EventQueue eventQueue(pDevice, events);
 
 	// Retrieve exposure time
 	//    The exposure time is similar to the time between triggering images.
@@ -201,7 +185,7 @@ void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 
 	// start stream
 	const size_t numberOfImages = NUM_IMAGES;
-	const int64_t waitOnEventTimeout = EVENT_TIMEOUT;
+	const uint64_t waitOnEventTimeout = EVENT_TIMEOUT;
 	std::cout << TAB1 << "Start stream with " << numberOfImages << " buffers\n";
 
 	pDevice->StartStream(numberOfImages);
@@ -227,10 +211,14 @@ void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 		pTriggerSoftwareNode->Execute();
 
 		// Wait on event
-		//    Wait on event to process before continuing. The data is created
+		//    Wait on event to be queued before continuing. The data is created
 		//    from the event generation, not from waiting on it.
-		pDevice->WaitOnEvent(waitOnEventTimeout);
-		std::cout << " and ExposureEnd Event notification arrived";
+		Arena::EventRecord record;
+		if (eventQueue.Wait(&record, 1, waitOnEventTimeout) == 0)
+		{
+			throw GenICam::GenericException("ExposureEnd event timed out", __FILE__, __LINE__);
+		}
+		std::cout << " and ExposureEnd Event notification arrived (" << record.timestamp << ")";
 	}
 
 	std::cout << "\n"
@@ -267,16 +255,8 @@ void OverlapTriggerOnExposureEndEvent(Arena::IDevice* pDevice)
 
 	pDevice->StopStream();
 
-	// Deinitialize events
-	//    Deinitialize the events engine in order to deallocate memory and stop
-	//    processing events. Failing to deinitialize events results in a memory
-	//    leak.
-	pDevice->DeinitializeEvents();
-
 	// return nodes to their initial values
 	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "ExposureAuto", exposureAutoInitial);
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "EventNotification", eventNotificationInitial);
-	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "EventSelector", eventSelectorInitial);
 	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "AcquisitionMode", acquisitionModeInitial);
 	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerOverlap", triggerOverlapInitial);
 	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "TriggerSource", triggerSourceInitial);
@@ -70,7 +70,7 @@ FFMPEGLIBS = -lavcodec \
              -lavutil \
              -lswresample
 
-LIBS= -larena -lsave -lgentl $(GENICAMLIBS) $(FFMPEGLIBS) -lpthread -llucidlog $(OPENCV_LIBS)
+LIBS= -larena -lsave -lgentl $(GENICAMLIBS) $(FFMPEGLIBS) -lpthread -llucidlog $(OPENCV_LIBS) $(ENCODER_LIBS)
 RM = rm -f
 
 SRCS = $(wildcard *.cpp)
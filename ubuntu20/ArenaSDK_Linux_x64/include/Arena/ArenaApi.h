@@ -37,7 +37,16 @@
 
 #include "Arena.h"
 #include "ArenaDefs.h"
+#include "AsyncNodeMap.h"
+#include "CRC32.h"
+#include "DefectMap.h"
+#include "DeviceDiscovery.h"
+#include "DeviceFactory.h"
 #include "DeviceInfo.h"
+#include "EventQueue.h"
+#include "Feature.h"
+#include "FeatureBatch.h"
+#include "FeatureSnapshot.h"
 #include "FeatureStream.h"
 #include "GenApiCustom.h"
 #include "IBuffer.h"
@@ -46,5 +55,10 @@
 #include "IImage.h"
 #include "ImageFactory.h"
 #include "ISystem.h"
+#include "LUT.h"
+#include "NodeMapCache.h"
+#include "NodeMapTransaction.h"
 #include "PFNC.h"
 #include "PFNCCustom.h"
+#include "ReconnectManager.h"
+#include "SequencerProgram.h"
@@ -0,0 +1,335 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file AsyncNodeMap.h
+ * This file defines asynchronous access to the features of a node map.
+ */
+
+#pragma once
+
+#include "FeatureBatch.h"
+#include "GenApiCustom.h"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Arena
+{
+	/**
+	 * @class AsyncNodeMap
+	 *
+	 * An <B> AsyncNodeMap </B> queues reads, writes and commands to the
+	 * features of a node map (GenApi::INodeMap) and carries them out on a
+	 * worker thread, returning a future (std::future) for each of them.
+	 *
+	 * \code{.cpp}
+	 * 	// queuing writes without waiting for each acknowledgement
+	 * 	{
+	 * 		Arena::AsyncNodeMap asyncNodeMap(pNodeMap);
+	 * 		std::future<void> width = asyncNodeMap.SetNodeValueAsync<int64_t>("Width", 1024);
+	 * 		std::future<void> height = asyncNodeMap.SetNodeValueAsync<int64_t>("Height", 768);
+	 * 		std::future<double> exposure = asyncNodeMap.GetNodeValueAsync<double>("ExposureTime");
+	 * 		// ... other work ...
+	 * 		width.get();
+	 * 		height.get();
+	 * 		std::cout << exposure.get();
+	 * 	}
+	 * \endcode
+	 *
+	 * Requests are carried out in the order they are queued. Writes that
+	 * are queued one after another while the worker is busy are sent
+	 * together as a feature batch (Arena::FeatureBatch), so that the device
+	 * receives them as a stacked write rather than waiting for an
+	 * acknowledgement per feature. The more requests are in flight, the
+	 * fewer round trips are needed.
+	 *
+	 * A failed request stores its exception in its future, to be rethrown
+	 * by std::future::get.
+	 *
+	 * @warning
+	 *  - Requests still queued when the object is destroyed are carried out
+	 *    before the destructor returns
+	 *  - Other threads may still access the node map directly; requests
+	 *    lock the node map only while carried out
+	 *
+	 * @see
+	 *  - Arena::FeatureBatch
+	 */
+	class AsyncNodeMap
+	{
+	public:
+		/**
+		 * @fn AsyncNodeMap(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to access
+		 *
+		 * A constructor, starting the worker thread.
+		 */
+		AsyncNodeMap(GenApi::INodeMap* pNodeMap) :
+			m_pNodeMap(pNodeMap),
+			m_running(true)
+		{
+			m_thread = std::thread(&AsyncNodeMap::Run, this);
+		}
+
+		/**
+		 * @fn ~AsyncNodeMap()
+		 *
+		 * A destructor, carrying out the remaining requests and stopping
+		 * the worker thread.
+		 */
+		~AsyncNodeMap()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+			}
+			m_queued.notify_all();
+			m_thread.join();
+		}
+
+		/**
+		 * @fn template<typename T> std::future<void> SetNodeValueAsync(const GenICam::gcstring& name, T value)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @param value
+		 *  - Type: T
+		 *  - Value to write
+		 *  - GenICam::gcstring (or const char*), int64_t, double or bool
+		 *  - Enumeration nodes use the name of the entry
+		 *
+		 * @return
+		 *  - Type: std::future<void>
+		 *  - Ready once the value is written
+		 *
+		 * <B> SetNodeValueAsync </B> queues a write.
+		 *
+		 * @see
+		 *  - Arena::SetNodeValue
+		 */
+		template<typename T>
+		std::future<void> SetNodeValueAsync(const GenICam::gcstring& name, T value)
+		{
+			Request request;
+			request.write = true;
+			request.add = [name, value](FeatureBatch& batch) { batch.Add(name, value); };
+			std::future<void> future = request.written->get_future();
+			Queue(request);
+			return future;
+		}
+
+		std::future<void> SetNodeValueAsync(const GenICam::gcstring& name, const char* value)
+		{
+			return SetNodeValueAsync<GenICam::gcstring>(name, value);
+		}
+
+		/**
+		 * @fn template<typename T> std::future<T> GetNodeValueAsync(const GenICam::gcstring& name)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @return
+		 *  - Type: std::future<T>
+		 *  - Ready with the value once it is read
+		 *  - GenICam::gcstring, int64_t, double or bool
+		 *
+		 * <B> GetNodeValueAsync </B> queues a read. The read is carried out
+		 * after all requests queued before it.
+		 *
+		 * @see
+		 *  - Arena::GetNodeValue
+		 */
+		template<typename T>
+		std::future<T> GetNodeValueAsync(const GenICam::gcstring& name)
+		{
+			std::shared_ptr<std::promise<T> > pPromise = std::make_shared<std::promise<T> >();
+			GenApi::INodeMap* pNodeMap = m_pNodeMap;
+
+			Request request;
+			request.write = false;
+			request.task = [pPromise, pNodeMap, name]() {
+				try
+				{
+					pPromise->set_value(GetNodeValue<T>(pNodeMap, name));
+				}
+				catch (...)
+				{
+					pPromise->set_exception(std::current_exception());
+				}
+			};
+			Queue(request);
+			return pPromise->get_future();
+		}
+
+		/**
+		 * @fn std::future<void> ExecuteNodeAsync(const GenICam::gcstring& name)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the command
+		 *
+		 * @return
+		 *  - Type: std::future<void>
+		 *  - Ready once the command is executed
+		 *
+		 * <B> ExecuteNodeAsync </B> queues the execution of a command. The
+		 * command is executed after all requests queued before it.
+		 *
+		 * @see
+		 *  - Arena::ExecuteNode
+		 */
+		std::future<void> ExecuteNodeAsync(const GenICam::gcstring& name)
+		{
+			std::shared_ptr<std::promise<void> > pPromise = std::make_shared<std::promise<void> >();
+			GenApi::INodeMap* pNodeMap = m_pNodeMap;
+
+			Request request;
+			request.write = false;
+			request.task = [pPromise, pNodeMap, name]() {
+				try
+				{
+					ExecuteNode(pNodeMap, name);
+					pPromise->set_value();
+				}
+				catch (...)
+				{
+					pPromise->set_exception(std::current_exception());
+				}
+			};
+			Queue(request);
+			return pPromise->get_future();
+		}
+
+		/**
+		 * @fn size_t GetQueueSize()
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of requests waiting to be carried out
+		 */
+		size_t GetQueueSize()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_requests.size();
+		}
+
+	private:
+		struct Request
+		{
+			bool write;
+			std::function<void(FeatureBatch&)> add;
+			std::shared_ptr<std::promise<void> > written;
+			std::function<void()> task;
+
+			Request() :
+				write(false),
+				written(std::make_shared<std::promise<void> >())
+			{
+			}
+		};
+
+		GenApi::INodeMap* m_pNodeMap;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queued;
+		std::deque<Request> m_requests;
+		bool m_running;
+		std::thread m_thread;
+
+		void Queue(const Request& request)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_requests.push_back(request);
+			}
+			m_queued.notify_one();
+		}
+
+		void Run()
+		{
+			while (true)
+			{
+				std::deque<Request> requests;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_queued.wait(lock, [this]() { return !m_requests.empty() || !m_running; });
+					if (m_requests.empty())
+						return;
+					requests.swap(m_requests);
+				}
+
+				GenApi::AutoLock lock(m_pNodeMap->GetLock());
+
+				std::vector<Request> writes;
+				for (size_t i = 0; i < requests.size(); i++)
+				{
+					if (requests[i].write)
+					{
+						writes.push_back(requests[i]);
+						continue;
+					}
+					Flush(writes);
+					requests[i].task();
+				}
+				Flush(writes);
+			}
+		}
+
+		// writes consecutive requests as one batch
+		void Flush(std::vector<Request>& writes)
+		{
+			if (writes.empty())
+				return;
+
+			FeatureBatch batch(m_pNodeMap);
+			for (size_t i = 0; i < writes.size(); i++)
+				writes[i].add(batch);
+
+			// if the stacked write fails, the writes are made once in the
+			// order they were queued
+			batch.Write(false);
+
+			const std::vector<FeatureBatchResult>& results = batch.GetResults();
+			for (size_t i = 0; i < writes.size(); i++)
+			{
+				if (results[i].written)
+				{
+					writes[i].written->set_value();
+				}
+				else
+				{
+					GenICam::gcstring error = "Unable to set " + results[i].name + " to " + results[i].value + ": " + results[i].error;
+					writes[i].written->set_exception(std::make_exception_ptr(GenICam::GenericException(error.c_str(), __FILE__, __LINE__)));
+				}
+			}
+			writes.clear();
+		}
+
+		AsyncNodeMap(const AsyncNodeMap&);
+		AsyncNodeMap& operator=(const AsyncNodeMap&);
+	};
+} // namespace Arena
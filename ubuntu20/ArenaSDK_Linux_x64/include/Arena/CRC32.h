@@ -0,0 +1,526 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file CRC32.h
+ * This file defines an accelerated, incremental CRC32 used to validate chunk
+ * CRCs on large payloads.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "IImage.h"
+#include "IChunkData.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARENA_CRC32_X86_CLMUL 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#define ARENA_CRC32_ARM_CRC 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace Arena
+{
+	namespace Internal
+	{
+		// reflected IEEE 802.3 polynomial
+		static const uint32_t kCRC32Polynomial = 0xEDB88320;
+
+		// lookup tables for slice-by-16; table[0] is the classic bytewise table
+		struct CRC32Tables
+		{
+			uint32_t table[16][256];
+
+			CRC32Tables()
+			{
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					uint32_t crc = i;
+					for (int bit = 0; bit < 8; bit++)
+						crc = (crc & 1) ? (crc >> 1) ^ kCRC32Polynomial : crc >> 1;
+					table[0][i] = crc;
+				}
+				for (uint32_t i = 0; i < 256; i++)
+				{
+					for (int slice = 1; slice < 16; slice++)
+						table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+				}
+			}
+		};
+
+		inline const CRC32Tables& GetCRC32Tables()
+		{
+			static const CRC32Tables tables;
+			return tables;
+		}
+
+		// portable path, 16 bytes per iteration
+		inline uint32_t UpdateCRC32SliceBy16(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			const uint32_t (*t)[256] = GetCRC32Tables().table;
+
+			while (nBytes >= 16)
+			{
+				uint32_t w0, w1, w2, w3;
+				memcpy(&w0, pData, 4);
+				memcpy(&w1, pData + 4, 4);
+				memcpy(&w2, pData + 8, 4);
+				memcpy(&w3, pData + 12, 4);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+				w0 = __builtin_bswap32(w0);
+				w1 = __builtin_bswap32(w1);
+				w2 = __builtin_bswap32(w2);
+				w3 = __builtin_bswap32(w3);
+#endif
+				w0 ^= crc;
+				crc = t[15][w0 & 0xFF] ^ t[14][(w0 >> 8) & 0xFF] ^ t[13][(w0 >> 16) & 0xFF] ^ t[12][w0 >> 24] ^
+					  t[11][w1 & 0xFF] ^ t[10][(w1 >> 8) & 0xFF] ^ t[9][(w1 >> 16) & 0xFF] ^ t[8][w1 >> 24] ^
+					  t[7][w2 & 0xFF] ^ t[6][(w2 >> 8) & 0xFF] ^ t[5][(w2 >> 16) & 0xFF] ^ t[4][w2 >> 24] ^
+					  t[3][w3 & 0xFF] ^ t[2][(w3 >> 8) & 0xFF] ^ t[1][(w3 >> 16) & 0xFF] ^ t[0][w3 >> 24];
+				pData += 16;
+				nBytes -= 16;
+			}
+
+			while (nBytes--)
+				crc = (crc >> 8) ^ t[0][(crc ^ *pData++) & 0xFF];
+
+			return crc;
+		}
+
+#if defined(ARENA_CRC32_X86_CLMUL)
+		// carry-less multiplication folding (Intel white paper "Fast CRC
+		// Computation for Generic Polynomials Using PCLMULQDQ Instruction"),
+		// constants for the reflected IEEE 802.3 polynomial
+		__attribute__((target("pclmul,sse4.1"))) inline uint32_t UpdateCRC32Clmul(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			if (nBytes < 64)
+				return UpdateCRC32SliceBy16(crc, pData, nBytes);
+
+			const __m128i k1k2 = _mm_set_epi64x(0x1c6e41596LL, 0x154442bd4LL);
+			const __m128i k3k4 = _mm_set_epi64x(0x0ccaa009eLL, 0x1751997d0LL);
+			const __m128i k5 = _mm_set_epi64x(0, 0x163cd6124LL);
+			const __m128i poly = _mm_set_epi64x(0x1f7011641LL, 0x1db710641LL);
+			const __m128i mask32 = _mm_set_epi32(0, 0, 0, -1);
+
+			__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+			__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 16));
+			__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 32));
+			__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 48));
+			x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+			pData += 64;
+			nBytes -= 64;
+
+			// fold 64 bytes at a time
+			while (nBytes >= 64)
+			{
+				__m128i h1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+				__m128i h2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+				__m128i h3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+				__m128i h4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+				x1 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+				x2 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+				x3 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+				x4 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, h1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData)));
+				x2 = _mm_xor_si128(_mm_xor_si128(x2, h2), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 16)));
+				x3 = _mm_xor_si128(_mm_xor_si128(x3, h3), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 32)));
+				x4 = _mm_xor_si128(_mm_xor_si128(x4, h4), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + 48)));
+				pData += 64;
+				nBytes -= 64;
+			}
+
+			// fold the four lanes into one
+			__m128i h = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x00), h), x2);
+			h = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x00), h), x3);
+			h = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x00), h), x4);
+
+			// fold 16 bytes at a time
+			while (nBytes >= 16)
+			{
+				h = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x00), h), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData)));
+				pData += 16;
+				nBytes -= 16;
+			}
+
+			// reduce 128 bits to 64 bits
+			__m128i t = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+			x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+
+			// reduce 64 bits to 32 bits
+			t = _mm_srli_si128(x1, 4);
+			x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5, 0x00);
+			x1 = _mm_xor_si128(x1, t);
+
+			// Barrett reduction
+			t = x1;
+			x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+			x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x00);
+			x1 = _mm_xor_si128(x1, t);
+			crc = static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+
+			return UpdateCRC32SliceBy16(crc, pData, nBytes);
+		}
+
+		inline bool HasCRC32Acceleration()
+		{
+			static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+			return supported;
+		}
+
+		inline uint32_t UpdateCRC32Accelerated(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			return UpdateCRC32Clmul(crc, pData, nBytes);
+		}
+#elif defined(ARENA_CRC32_ARM_CRC)
+		// ARMv8 CRC32 instructions implement the same reflected polynomial
+		__attribute__((target("+crc"))) inline uint32_t UpdateCRC32Arm(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			while (nBytes && (reinterpret_cast<uintptr_t>(pData) & 7))
+			{
+				crc = __crc32b(crc, *pData++);
+				nBytes--;
+			}
+			while (nBytes >= 32)
+			{
+				uint64_t w[4];
+				memcpy(w, pData, sizeof(w));
+				crc = __crc32d(crc, w[0]);
+				crc = __crc32d(crc, w[1]);
+				crc = __crc32d(crc, w[2]);
+				crc = __crc32d(crc, w[3]);
+				pData += 32;
+				nBytes -= 32;
+			}
+			while (nBytes >= 8)
+			{
+				uint64_t w;
+				memcpy(&w, pData, sizeof(w));
+				crc = __crc32d(crc, w);
+				pData += 8;
+				nBytes -= 8;
+			}
+			while (nBytes--)
+				crc = __crc32b(crc, *pData++);
+
+			return crc;
+		}
+
+		inline bool HasCRC32Acceleration()
+		{
+			static const bool supported = (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+			return supported;
+		}
+
+		inline uint32_t UpdateCRC32Accelerated(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			return UpdateCRC32Arm(crc, pData, nBytes);
+		}
+#else
+		inline bool HasCRC32Acceleration()
+		{
+			return false;
+		}
+
+		inline uint32_t UpdateCRC32Accelerated(uint32_t crc, const uint8_t* pData, size_t nBytes)
+		{
+			return UpdateCRC32SliceBy16(crc, pData, nBytes);
+		}
+#endif
+
+		// multiplies two polynomials modulo the CRC polynomial
+		inline uint32_t MultiplyCRC32(uint32_t a, uint32_t b)
+		{
+			uint32_t m = 1u << 31;
+			uint32_t p = 0;
+			for (;;)
+			{
+				if (a & m)
+				{
+					p ^= b;
+					if ((a & (m - 1)) == 0)
+						break;
+				}
+				m >>= 1;
+				b = (b & 1) ? (b >> 1) ^ kCRC32Polynomial : b >> 1;
+			}
+			return p;
+		}
+
+		// x^(n * 2^k) modulo the CRC polynomial
+		inline uint32_t PowerOfXCRC32(uint64_t n, unsigned k)
+		{
+			uint32_t x2n[64];
+			x2n[0] = 1u << 30;
+			for (unsigned i = 1; i < 64; i++)
+				x2n[i] = MultiplyCRC32(x2n[i - 1], x2n[i - 1]);
+
+			uint32_t p = 1u << 31;
+			while (n)
+			{
+				if (n & 1)
+					p = MultiplyCRC32(x2n[k & 63], p);
+				n >>= 1;
+				k++;
+			}
+			return p;
+		}
+	} // namespace Internal
+
+	/**
+	 * @class CRC32
+	 *
+	 * <B> CRC32 </B> calculates the same CRC (cyclical redundancy check) as the
+	 * global helper (Arena::CalculateCRC32), but incrementally and with
+	 * hardware acceleration. On startup, the fastest implementation available
+	 * to the processor is chosen:
+	 *  - x86/x64 with PCLMULQDQ: carry-less multiplication folding
+	 *  - ARMv8 with the CRC extension: CRC32 instructions
+	 *  - otherwise: slice-by-16 lookup tables
+	 *
+	 * Data can be fed as it becomes available (Arena::CRC32::Update), so that
+	 * the CRC of a payload is complete the moment its last piece lands.
+	 * Pieces calculated separately, for example on different threads, can be
+	 * joined afterwards (Arena::CRC32::Combine).
+	 *
+	 * \code{.cpp}
+	 * 	// calculating a CRC over two halves of an image
+	 * 	{
+	 * 		Arena::CRC32 crc;
+	 * 		crc.Update(pData, half);
+	 * 		crc.Update(pData + half, size - half);
+	 * 		bool valid = crc.GetValue() == chunkCrc;
+	 * 	}
+	 * \endcode
+	 *
+	 * @see
+	 *  - Arena::CalculateCRC32
+	 *  - Arena::CalculateCRC32Fast
+	 *  - Arena::VerifyCRCFast
+	 */
+	class CRC32
+	{
+	public:
+		/**
+		 * @fn CRC32()
+		 *
+		 * A constructor, starting an empty calculation.
+		 */
+		CRC32() :
+			m_state(0xFFFFFFFF),
+			m_length(0)
+		{
+		}
+
+		/**
+		 * @fn void Update(const uint8_t* pData, size_t nBytes)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - The next piece of data
+		 *
+		 * @param nBytes
+		 *  - Type: size_t
+		 *  - The size of the piece
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Update </B> adds the next consecutive piece of data to the
+		 * calculation.
+		 */
+		void Update(const uint8_t* pData, size_t nBytes)
+		{
+			if (Internal::HasCRC32Acceleration())
+				m_state = Internal::UpdateCRC32Accelerated(m_state, pData, nBytes);
+			else
+				m_state = Internal::UpdateCRC32SliceBy16(m_state, pData, nBytes);
+			m_length += nBytes;
+		}
+
+		/**
+		 * @fn uint32_t GetValue() const
+		 *
+		 * @return
+		 *  - Type: uint32_t
+		 *  - The CRC of all data added so far
+		 *
+		 * <B> GetValue </B> retrieves the CRC of the data added so far. More
+		 * data may still be added afterwards.
+		 */
+		uint32_t GetValue() const
+		{
+			return ~m_state;
+		}
+
+		/**
+		 * @fn uint64_t GetLength() const
+		 *
+		 * @return
+		 *  - Type: uint64_t
+		 *  - Unit: bytes
+		 *  - Amount of data added so far
+		 *
+		 * <B> GetLength </B> retrieves the amount of data added so far.
+		 */
+		uint64_t GetLength() const
+		{
+			return m_length;
+		}
+
+		/**
+		 * @fn void Reset()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Reset </B> restarts the calculation, discarding all data added.
+		 */
+		void Reset()
+		{
+			m_state = 0xFFFFFFFF;
+			m_length = 0;
+		}
+
+		/**
+		 * @fn static uint32_t Combine(uint32_t crc1, uint32_t crc2, uint64_t length2)
+		 *
+		 * @param crc1
+		 *  - Type: uint32_t
+		 *  - CRC of the first piece of data
+		 *
+		 * @param crc2
+		 *  - Type: uint32_t
+		 *  - CRC of the second piece of data
+		 *
+		 * @param length2
+		 *  - Type: uint64_t
+		 *  - Unit: bytes
+		 *  - Size of the second piece of data
+		 *
+		 * @return
+		 *  - Type: uint32_t
+		 *  - CRC of both pieces, one after the other
+		 *
+		 * <B> Combine </B> calculates the CRC of two consecutive pieces of data
+		 * from their separate CRCs, without touching the data again.
+		 */
+		static uint32_t Combine(uint32_t crc1, uint32_t crc2, uint64_t length2)
+		{
+			return Internal::MultiplyCRC32(Internal::PowerOfXCRC32(length2, 3), crc1) ^ crc2;
+		}
+
+		/**
+		 * @fn static bool IsAccelerated()
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if a hardware accelerated implementation is in use
+		 *  - Otherwise, false
+		 *
+		 * <B> IsAccelerated </B> reports whether the processor provides
+		 * instructions to accelerate the calculation.
+		 */
+		static bool IsAccelerated()
+		{
+			return Internal::HasCRC32Acceleration();
+		}
+
+	private:
+		uint32_t m_state;
+		uint64_t m_length;
+	};
+
+	/**
+	 * @fn int64_t CalculateCRC32Fast(const uint8_t* pData, size_t nBytes)
+	 *
+	 * @param pData
+	 *  - Type: const uint8_t*
+	 *  - A pointer to the data to use to calculate the CRC
+	 *
+	 * @param nBytes
+	 *  - Type: size_t
+	 *  - The size of the data
+	 *
+	 * @return
+	 *  - Type: int64_t
+	 *  - The calculated CRC value
+	 *
+	 * <B> CalculateCRC32Fast </B> is a drop-in replacement for the global
+	 * helper (Arena::CalculateCRC32), using the fastest implementation
+	 * available to the processor (Arena::CRC32).
+	 *
+	 * @see
+	 *  - Arena::CalculateCRC32
+	 *  - Arena::CRC32
+	 */
+	inline int64_t CalculateCRC32Fast(const uint8_t* pData, size_t nBytes)
+	{
+		CRC32 crc;
+		crc.Update(pData, nBytes);
+		return static_cast<int64_t>(crc.GetValue());
+	}
+
+	/**
+	 * @fn bool VerifyCRCFast(IImage* pImage)
+	 *
+	 * @param pImage
+	 *  - Type: Arena::IImage*
+	 *  - An image with the CRC chunk enabled
+	 *
+	 * @return
+	 *  - Type: bool
+	 *  - True if the calculated CRC value equals the one sent from the device
+	 *  - Otherwise, false
+	 *
+	 * <B> VerifyCRCFast </B> calculates the CRC of an image's data and
+	 * verifies it against the CRC chunk sent from the device, like
+	 * Arena::IImage::VerifyCRC, but using the fastest implementation available
+	 * to the processor (Arena::CRC32).
+	 *
+	 * @warning
+	 *  - Throws if chunk data disabled or not present, or CRC chunk disabled
+	 *  - Incomplete images never verify
+	 *
+	 * @see
+	 *  - Arena::IImage::VerifyCRC
+	 *  - Arena::CRC32
+	 */
+	inline bool VerifyCRCFast(IImage* pImage)
+	{
+		if (!pImage || !pImage->HasChunkData())
+			throw GenICam::GenericException("Chunk data not present", __FILE__, __LINE__);
+
+		GenApi::CIntegerPtr pChunkCRC = pImage->AsChunkData()->GetChunk("ChunkCRC");
+		if (!pChunkCRC || !GenApi::IsReadable(pChunkCRC))
+			throw GenICam::GenericException("CRC chunk not enabled", __FILE__, __LINE__);
+
+		if (pImage->IsIncomplete())
+			return false;
+
+		size_t imageDataSize = pImage->GetWidth() * pImage->GetHeight() * pImage->GetBitsPerPixel() / 8;
+
+		return CalculateCRC32Fast(pImage->GetData(), imageDataSize) == pChunkCRC->GetValue();
+	}
+} // namespace Arena
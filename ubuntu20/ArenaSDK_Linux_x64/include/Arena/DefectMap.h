@@ -0,0 +1,362 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file DefectMap.h
+ * This file defines bulk access to the defect pixel correction list.
+ */
+
+#pragma once
+
+#include "FeatureBatch.h"
+#include "GenApiCustom.h"
+#include "IImage.h"
+#include "PFNC.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Arena
+{
+	/**
+	 * @struct DefectPixel
+	 *
+	 * The position of a pixel in the defect correction list.
+	 *
+	 * @see
+	 *  - Arena::GetDefectPixels
+	 *  - Arena::SetDefectPixels
+	 *  - Arena::FindDefectPixels
+	 */
+	struct DefectPixel
+	{
+		/** horizontal position ('DefectCorrectionPositionX') */
+		int64_t x;
+		/** vertical position ('DefectCorrectionPositionY') */
+		int64_t y;
+	};
+
+	/**
+	 * @fn inline std::vector<DefectPixel> GetDefectPixels(GenApi::INodeMap* pNodeMap)
+	 *
+	 * @param pNodeMap
+	 *  - Type: GenApi::INodeMap*
+	 *  - Node map of the device
+	 *
+	 * @return
+	 *  - Type: std::vector<Arena::DefectPixel>
+	 *  - Pixels in the defect correction list, in the order of their index
+	 *
+	 * <B> GetDefectPixels </B> reads the whole defect correction list while
+	 * holding the node map lock, and leaves 'DefectCorrectionIndex' where it
+	 * was.
+	 *
+	 * @warning
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *
+	 * @see
+	 *  - Arena::SetDefectPixels
+	 */
+	inline std::vector<DefectPixel> GetDefectPixels(GenApi::INodeMap* pNodeMap)
+	{
+		GenApi::CIntegerPtr pIndex = pNodeMap->GetNode("DefectCorrectionIndex");
+		GenApi::CIntegerPtr pX = pNodeMap->GetNode("DefectCorrectionPositionX");
+		GenApi::CIntegerPtr pY = pNodeMap->GetNode("DefectCorrectionPositionY");
+		if (!pIndex || !pX || !pY)
+			throw GenICam::GenericException("Requisite node(s) DefectCorrectionIndex, DefectCorrectionPositionX and/or DefectCorrectionPositionY do(es) not exist", __FILE__, __LINE__);
+
+		GenApi::AutoLock lock(pNodeMap->GetLock());
+
+		int64_t count = GetNodeValue<int64_t>(pNodeMap, "DefectCorrectionCount");
+		std::vector<DefectPixel> pixels(static_cast<size_t>(count));
+		if (count == 0)
+			return pixels;
+
+		int64_t indexInitial = pIndex->GetValue();
+		try
+		{
+			for (int64_t i = 0; i < count; i++)
+			{
+				pIndex->SetValue(i);
+				pixels[static_cast<size_t>(i)].x = pX->GetValue();
+				pixels[static_cast<size_t>(i)].y = pY->GetValue();
+			}
+		}
+		catch (...)
+		{
+			try
+			{
+				pIndex->SetValue(indexInitial);
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+			throw;
+		}
+		pIndex->SetValue(indexInitial);
+		return pixels;
+	}
+
+	/**
+	 * @fn inline void SetDefectPixels(GenApi::INodeMap* pNodeMap, const std::vector<DefectPixel>& pixels, bool apply = true)
+	 *
+	 * @param pNodeMap
+	 *  - Type: GenApi::INodeMap*
+	 *  - Node map of the device
+	 *
+	 * @param pixels
+	 *  - Type: const std::vector<Arena::DefectPixel>&
+	 *  - Pixels to correct
+	 *
+	 * @param apply
+	 *  - Type: bool
+	 *  - Default: true
+	 *  - If true, applies the list ('DefectCorrectionApply') once written
+	 *
+	 * @return
+	 *  - none
+	 *
+	 * <B> SetDefectPixels </B> replaces the defect correction list with the
+	 * given pixels. Surplus entries are removed from the end of the list and
+	 * missing ones are added ('DefectCorrectionGetNewDefect'); then the
+	 * positions of all entries are written as one feature batch
+	 * (Arena::FeatureBatch), so that the device receives them as stacked
+	 * writes instead of three register writes per pixel.
+	 *
+	 * \code{.cpp}
+	 * 	// adding a pixel to the list
+	 * 	{
+	 * 		std::vector<Arena::DefectPixel> pixels = Arena::GetDefectPixels(pNodeMap);
+	 * 		Arena::DefectPixel pixel = { 256, 128 };
+	 * 		pixels.push_back(pixel);
+	 * 		Arena::SetDefectPixels(pNodeMap, pixels);
+	 * 	}
+	 * \endcode
+	 *
+	 * @warning
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *  - The list is lost when the device is power-cycled unless it is saved
+	 *    ('DefectCorrectionSave')
+	 *
+	 * @see
+	 *  - Arena::GetDefectPixels
+	 *  - Arena::FindDefectPixels
+	 */
+	inline void SetDefectPixels(GenApi::INodeMap* pNodeMap, const std::vector<DefectPixel>& pixels, bool apply = true)
+	{
+		if (!pNodeMap->GetNode("DefectCorrectionIndex") || !pNodeMap->GetNode("DefectCorrectionPositionX") || !pNodeMap->GetNode("DefectCorrectionPositionY"))
+			throw GenICam::GenericException("Requisite node(s) DefectCorrectionIndex, DefectCorrectionPositionX and/or DefectCorrectionPositionY do(es) not exist", __FILE__, __LINE__);
+
+		GenApi::AutoLock lock(pNodeMap->GetLock());
+
+		int64_t count = GetNodeValue<int64_t>(pNodeMap, "DefectCorrectionCount");
+		int64_t target = static_cast<int64_t>(pixels.size());
+
+		// removing from the end keeps the remaining indices in place
+		for (; count > target; count--)
+		{
+			SetNodeValue<int64_t>(pNodeMap, "DefectCorrectionIndex", count - 1);
+			ExecuteNode(pNodeMap, "DefectCorrectionRemove");
+		}
+		for (; count < target; count++)
+			ExecuteNode(pNodeMap, "DefectCorrectionGetNewDefect");
+
+		FeatureBatch batch(pNodeMap);
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			batch.Add("DefectCorrectionIndex", static_cast<int64_t>(i));
+			batch.Add("DefectCorrectionPositionX", pixels[i].x);
+			batch.Add("DefectCorrectionPositionY", pixels[i].y);
+		}
+		// written in order without retries if the stacked write fails, so
+		// that positions never land under another index
+		if (!batch.Write(false))
+		{
+			const std::vector<FeatureBatchResult>& results = batch.GetResults();
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				if (!results[i].written)
+					throw GenICam::GenericException(("Unable to set " + results[i].name + " to " + results[i].value + ": " + results[i].error).c_str(), __FILE__, __LINE__);
+			}
+		}
+
+		if (apply)
+			ExecuteNode(pNodeMap, "DefectCorrectionApply");
+	}
+
+	namespace Internal
+	{
+		inline double GetPixel(const uint8_t* pData, size_t bytesPerPixel, size_t index)
+		{
+			if (bytesPerPixel == 1)
+				return pData[index];
+
+			uint16_t value;
+			memcpy(&value, pData + index * 2, 2);
+			return value;
+		}
+	} // namespace Internal
+
+	/**
+	 * @fn inline std::vector<DefectPixel> FindDefectPixels(IImage* pDark, IImage* pFlat, double hotThreshold = 6.0, double flatTolerance = 0.3)
+	 *
+	 * @param pDark
+	 *  - Type: Arena::IImage*
+	 *  - Image taken without light (for example, with the lens capped)
+	 *  - NULL to skip the search for hot pixels
+	 *
+	 * @param pFlat
+	 *  - Type: Arena::IImage*
+	 *  - Image of an evenly lit, unsaturated surface
+	 *  - NULL to skip the search for dead and stuck pixels
+	 *
+	 * @param hotThreshold
+	 *  - Type: double
+	 *  - Default: 6.0
+	 *  - Number of standard deviations above the mean of the dark image
+	 *    from which a pixel is hot
+	 *
+	 * @param flatTolerance
+	 *  - Type: double
+	 *  - Default: 0.3
+	 *  - Relative deviation from the median of its neighbours beyond which
+	 *    a pixel of the flat image is defective
+	 *
+	 * @return
+	 *  - Type: std::vector<Arena::DefectPixel>
+	 *  - Defective pixels, ordered by row then column, without duplicates
+	 *
+	 * <B> FindDefectPixels </B> builds a defect correction list on the host
+	 * from a dark image and a flat image, to be written to the device with
+	 * Arena::SetDefectPixels.
+	 *
+	 * In the dark image, pixels brighter than the mean by more than the
+	 * given number of standard deviations are hot. In the flat image, each
+	 * pixel is compared with the median of its 8 nearest neighbours of the
+	 * same colour (2 pixels apart for bayer formats); pixels deviating by
+	 * more than the given fraction are dead or stuck. Positions are relative
+	 * to the image, so images should be taken at full resolution without
+	 * offsets or binning.
+	 *
+	 * @warning
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *  - Images must be 8 or 16 bits per pixel, mono or bayer; convert packed
+	 *    formats first (Arena::ImageFactory::Convert)
+	 *  - Bayer images must stay in a bayer format (e.g. BayerRG12p to
+	 *    BayerRG16, not Mono16), as the pixel format tells the search to
+	 *    compare pixels of the same colour
+	 *
+	 * @see
+	 *  - Arena::SetDefectPixels
+	 */
+	inline std::vector<DefectPixel> FindDefectPixels(IImage* pDark, IImage* pFlat, double hotThreshold = 6.0, double flatTolerance = 0.3)
+	{
+		std::vector<DefectPixel> pixels;
+		IImage* images[] = { pDark, pFlat };
+		for (size_t i = 0; i < 2; i++)
+		{
+			IImage* pImage = images[i];
+			if (!pImage)
+				continue;
+
+			size_t bpp = pImage->GetBitsPerPixel();
+			if (bpp != 8 && bpp != 16)
+				throw GenICam::GenericException("Image must be 8 or 16 bits per pixel", __FILE__, __LINE__);
+
+			size_t bytesPerPixel = bpp / 8;
+			size_t width = pImage->GetWidth();
+			size_t height = pImage->GetHeight();
+			size_t count = width * height;
+			const uint8_t* pData = pImage->GetData();
+
+			if (pImage == pDark)
+			{
+				double sum = 0.0;
+				double sumSquares = 0.0;
+				for (size_t p = 0; p < count; p++)
+				{
+					double value = Internal::GetPixel(pData, bytesPerPixel, p);
+					sum += value;
+					sumSquares += value * value;
+				}
+				double mean = count ? sum / count : 0.0;
+				double deviation = count ? std::sqrt(std::max(0.0, sumSquares / count - mean * mean)) : 0.0;
+				double limit = mean + hotThreshold * std::max(deviation, 1.0);
+
+				for (size_t p = 0; p < count; p++)
+				{
+					if (Internal::GetPixel(pData, bytesPerPixel, p) > limit)
+					{
+						DefectPixel pixel = { static_cast<int64_t>(p % width), static_cast<int64_t>(p / width) };
+						pixels.push_back(pixel);
+					}
+				}
+			}
+			else
+			{
+				const char* pName = GetPixelFormatName(static_cast<PfncFormat>(pImage->GetPixelFormat()));
+				int step = (pName && strncmp(pName, "Bayer", 5) == 0) ? 2 : 1;
+
+				std::vector<double> neighbours;
+				for (size_t y = 0; y < height; y++)
+				{
+					for (size_t x = 0; x < width; x++)
+					{
+						neighbours.clear();
+						for (int dy = -step; dy <= step; dy += step)
+						{
+							for (int dx = -step; dx <= step; dx += step)
+							{
+								int64_t nx = static_cast<int64_t>(x) + dx;
+								int64_t ny = static_cast<int64_t>(y) + dy;
+								if ((dx || dy) && nx >= 0 && ny >= 0 && nx < static_cast<int64_t>(width) && ny < static_cast<int64_t>(height))
+									neighbours.push_back(Internal::GetPixel(pData, bytesPerPixel, static_cast<size_t>(ny) * width + static_cast<size_t>(nx)));
+							}
+						}
+						if (neighbours.empty())
+							continue;
+
+						std::nth_element(neighbours.begin(), neighbours.begin() + neighbours.size() / 2, neighbours.end());
+						double median = neighbours[neighbours.size() / 2];
+						double value = Internal::GetPixel(pData, bytesPerPixel, y * width + x);
+						if (std::fabs(value - median) > flatTolerance * std::max(median, 1.0))
+						{
+							DefectPixel pixel = { static_cast<int64_t>(x), static_cast<int64_t>(y) };
+							pixels.push_back(pixel);
+						}
+					}
+				}
+			}
+		}
+
+		struct Before
+		{
+			bool operator()(const DefectPixel& a, const DefectPixel& b) const
+			{
+				return a.y != b.y ? a.y < b.y : a.x < b.x;
+			}
+		};
+		struct Same
+		{
+			bool operator()(const DefectPixel& a, const DefectPixel& b) const
+			{
+				return a.x == b.x && a.y == b.y;
+			}
+		};
+		std::sort(pixels.begin(), pixels.end(), Before());
+		pixels.erase(std::unique(pixels.begin(), pixels.end(), Same()), pixels.end());
+		return pixels;
+	}
+} // namespace Arena
@@ -0,0 +1,664 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file DeviceDiscovery.h
+ * This file defines a background device discovery service.
+ */
+
+#pragma once
+
+#include "ISystem.h"
+
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+
+#if defined __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+namespace Arena
+{
+	/**
+	 * @class IDeviceDiscoveryCallback
+	 *
+	 * An interface to receive changes to the device list maintained by the
+	 * discovery service (Arena::DeviceDiscovery).
+	 *
+	 * @warning
+	 *  - Called from the discovery thread
+	 *
+	 * @see
+	 *  - Arena::DeviceDiscovery
+	 */
+	class IDeviceDiscoveryCallback
+	{
+	public:
+		virtual ~IDeviceDiscoveryCallback(){};
+
+		virtual void OnDeviceAdded(DeviceInfo deviceInfo) = 0;
+
+		virtual void OnDeviceRemoved(DeviceInfo deviceInfo) = 0;
+
+	protected:
+		IDeviceDiscoveryCallback(){};
+	};
+
+	/**
+	 * @class DeviceDiscovery
+	 *
+	 * <B> DeviceDiscovery </B> keeps the device list up to date in the
+	 * background, so that applications no longer need to call
+	 * Arena::ISystem::UpdateDevices in loops. Once started, the service:
+	 *  - listens to link and address changes of the host's network interfaces
+	 *    (netlink on Linux),
+	 *  - sends discovery only on the interfaces that changed,
+	 *  - sweeps all interfaces periodically to find devices that appear
+	 *    behind a switch without any change on the host,
+	 *  - maintains a device table, notifying registered callbacks
+	 *    (Arena::IDeviceDiscoveryCallback) of added and removed devices.
+	 *
+	 * Devices are retrieved from the table without waiting on the network
+	 * (Arena::DeviceDiscovery::GetDevices).
+	 *
+	 * \code{.cpp}
+	 * 	// retrieving devices from the discovery service
+	 * 	{
+	 * 		Arena::DeviceDiscovery discovery(pSystem);
+	 * 		discovery.Start();
+	 * 		std::vector<Arena::DeviceInfo> deviceInfos = discovery.GetDevices();
+	 * 		// ...
+	 * 		Arena::IDevice* pDevice = discovery.CreateDevice(deviceInfos[0]);
+	 * 		// ...
+	 * 		discovery.DestroyDevice(pDevice);
+	 * 		discovery.Stop();
+	 * 	}
+	 * \endcode
+	 *
+	 * @warning
+	 *  - While running, the service updates the system's device list; create
+	 *    and destroy devices through the service so these calls are
+	 *    serialized with discovery
+	 *  - Must be stopped before the system is closed
+	 *
+	 * @see
+	 *  - Arena::ISystem::UpdateDevices
+	 *  - Arena::IDeviceDiscoveryCallback
+	 */
+	class DeviceDiscovery
+	{
+	public:
+		/**
+		 * @fn DeviceDiscovery(ISystem* pSystem, uint64_t timeout = 100, uint64_t sweepInterval = 5000)
+		 *
+		 * @param pSystem
+		 *  - Type: Arena::ISystem*
+		 *  - The system object
+		 *
+		 * @param timeout
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Default: 100
+		 *  - Time to wait for devices to respond to each discovery
+		 *
+		 * @param sweepInterval
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Default: 5000
+		 *  - Time between discoveries on all interfaces
+		 *  - 0 disables periodic sweeps
+		 *
+		 * A constructor. The service does not run until started.
+		 */
+		DeviceDiscovery(ISystem* pSystem, uint64_t timeout = 100, uint64_t sweepInterval = 5000) :
+			m_pSystem(pSystem),
+			m_timeout(timeout),
+			m_sweepInterval(sweepInterval),
+			m_running(false),
+			m_sweepRequested(false)
+		{
+			m_wakePipe[0] = -1;
+			m_wakePipe[1] = -1;
+		}
+
+		/**
+		 * @fn virtual ~DeviceDiscovery()
+		 *
+		 * A destructor, stopping the service.
+		 */
+		virtual ~DeviceDiscovery()
+		{
+			Stop();
+		}
+
+		/**
+		 * @fn void Start()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Start </B> populates the device table with a discovery on all
+		 * interfaces, then starts the background thread. The device table is
+		 * ready when <B> Start </B> returns.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Start()
+		{
+			if (m_running)
+				return;
+
+			Sweep(NULL);
+
+#if defined __linux__
+			if (pipe(m_wakePipe) != 0)
+			{
+				m_wakePipe[0] = -1;
+				m_wakePipe[1] = -1;
+			}
+#endif
+			m_running = true;
+			m_thread = std::thread(&DeviceDiscovery::Run, this);
+		}
+
+		/**
+		 * @fn void Stop()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Stop </B> stops the background thread. The device table keeps
+		 * its last contents.
+		 */
+		void Stop()
+		{
+			if (!m_running)
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(m_wakeMutex);
+				m_running = false;
+			}
+			m_wake.notify_all();
+#if defined __linux__
+			if (m_wakePipe[1] >= 0)
+			{
+				char c = 0;
+				ssize_t written = write(m_wakePipe[1], &c, 1);
+				(void)written;
+			}
+#endif
+			if (m_thread.joinable())
+				m_thread.join();
+#if defined __linux__
+			for (int i = 0; i < 2; i++)
+			{
+				if (m_wakePipe[i] >= 0)
+					close(m_wakePipe[i]);
+				m_wakePipe[i] = -1;
+			}
+#endif
+		}
+
+		/**
+		 * @fn std::vector<DeviceInfo> GetDevices()
+		 *
+		 * @return
+		 *  - Type: std::vector<Arena::DeviceInfo>
+		 *  - Devices currently in the table
+		 *
+		 * <B> GetDevices </B> retrieves the device table immediately, without
+		 * sending discovery.
+		 */
+		std::vector<DeviceInfo> GetDevices()
+		{
+			std::lock_guard<std::mutex> lock(m_tableMutex);
+			std::vector<DeviceInfo> deviceInfos;
+			for (std::map<uint64_t, DeviceInfo>::iterator it = m_table.begin(); it != m_table.end(); ++it)
+				deviceInfos.push_back(it->second);
+			return deviceInfos;
+		}
+
+		/**
+		 * @fn void Refresh()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Refresh </B> requests a discovery on all interfaces from the
+		 * background thread without waiting for it.
+		 */
+		void Refresh()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_wakeMutex);
+				m_sweepRequested = true;
+			}
+			m_wake.notify_all();
+#if defined __linux__
+			if (m_wakePipe[1] >= 0)
+			{
+				char c = 1;
+				ssize_t written = write(m_wakePipe[1], &c, 1);
+				(void)written;
+			}
+#endif
+		}
+
+		/**
+		 * @fn IDevice* CreateDevice(DeviceInfo deviceInfo)
+		 *
+		 * @param deviceInfo
+		 *  - Type: Arena::DeviceInfo
+		 *  - Device information object of the device to create
+		 *
+		 * @return
+		 *  - Type: Arena::IDevice*
+		 *  - The device object
+		 *
+		 * <B> CreateDevice </B> creates a device (Arena::ISystem::CreateDevice)
+		 * while no discovery is in progress.
+		 */
+		IDevice* CreateDevice(DeviceInfo deviceInfo)
+		{
+			std::lock_guard<std::mutex> lock(m_systemMutex);
+			return m_pSystem->CreateDevice(deviceInfo);
+		}
+
+		/**
+		 * @fn void DestroyDevice(IDevice* pDevice)
+		 *
+		 * @param pDevice
+		 *  - Type: Arena::IDevice*
+		 *  - The device to destroy
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> DestroyDevice </B> destroys a device
+		 * (Arena::ISystem::DestroyDevice) while no discovery is in progress.
+		 */
+		void DestroyDevice(IDevice* pDevice)
+		{
+			std::lock_guard<std::mutex> lock(m_systemMutex);
+			m_pSystem->DestroyDevice(pDevice);
+		}
+
+		/**
+		 * @fn void RegisterCallback(IDeviceDiscoveryCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IDeviceDiscoveryCallback*
+		 *  - Callback to notify of changes to the device table
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> RegisterCallback </B> registers a callback to be notified of
+		 * devices added to and removed from the table.
+		 */
+		void RegisterCallback(IDeviceDiscoveryCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_callbackMutex);
+			m_callbacks.insert(pCallback);
+		}
+
+		/**
+		 * @fn void DeregisterCallback(IDeviceDiscoveryCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IDeviceDiscoveryCallback*
+		 *  - Callback to deregister
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> DeregisterCallback </B> deregisters a callback. Callbacks may
+		 * deregister themselves.
+		 *
+		 * @warning
+		 *  - A notification already in progress on the background thread may
+		 *    still reach the callback after it is deregistered
+		 */
+		void DeregisterCallback(IDeviceDiscoveryCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_callbackMutex);
+			m_callbacks.erase(pCallback);
+		}
+
+	private:
+		// discovers devices on the given interfaces, or all interfaces if NULL,
+		// then reconciles the table with the system's device list; after a
+		// partial discovery, only devices on the subnets of the refreshed
+		// interfaces can be removed
+		void Sweep(const std::vector<uint32_t>* pInterfaceIps)
+		{
+			std::vector<DeviceInfo> deviceInfos;
+			std::vector<std::pair<uint32_t, uint32_t> > refreshed;
+			{
+				std::lock_guard<std::mutex> lock(m_systemMutex);
+
+				bool updated = false;
+				if (pInterfaceIps)
+				{
+					std::vector<InterfaceInfo> interfaces = m_pSystem->GetInterfaces();
+					std::vector<uint32_t> remaining = *pInterfaceIps;
+					for (size_t i = 0; i < interfaces.size(); i++)
+					{
+						std::vector<uint32_t>::iterator it = std::find(remaining.begin(), remaining.end(), interfaces[i].IpAddress());
+						if (it == remaining.end())
+							continue;
+
+						m_pSystem->UpdateDevices(interfaces[i], m_timeout);
+						refreshed.push_back(std::make_pair(interfaces[i].IpAddress(), interfaces[i].SubnetMask()));
+						remaining.erase(it);
+						updated = true;
+					}
+
+					// an address the system does not know yet belongs to a new
+					// or reconfigured interface, which only a full discovery
+					// picks up
+					if (!remaining.empty())
+						updated = false;
+				}
+				if (!updated)
+				{
+					m_pSystem->UpdateDevices(m_timeout);
+					refreshed.clear();
+				}
+
+				deviceInfos = m_pSystem->GetDevices();
+			}
+
+			std::vector<DeviceInfo> added;
+			std::vector<DeviceInfo> removed;
+			{
+				std::lock_guard<std::mutex> lock(m_tableMutex);
+
+				std::map<uint64_t, DeviceInfo> table;
+				for (size_t i = 0; i < deviceInfos.size(); i++)
+				{
+					uint64_t mac = deviceInfos[i].MacAddress();
+					table.insert(std::make_pair(mac, deviceInfos[i]));
+					if (m_table.find(mac) == m_table.end())
+						added.push_back(deviceInfos[i]);
+				}
+				for (std::map<uint64_t, DeviceInfo>::iterator it = m_table.begin(); it != m_table.end(); ++it)
+				{
+					if (table.find(it->first) != table.end())
+						continue;
+
+					bool searched = refreshed.empty();
+					for (size_t i = 0; i < refreshed.size() && !searched; i++)
+						searched = (it->second.IpAddress() & refreshed[i].second) == (refreshed[i].first & refreshed[i].second);
+
+					if (searched)
+						removed.push_back(it->second);
+					else
+						table.insert(*it);
+				}
+				m_table.swap(table);
+			}
+
+			if (added.empty() && removed.empty())
+				return;
+
+			// callbacks are called outside the lock, so that they may
+			// register or deregister callbacks
+			std::set<IDeviceDiscoveryCallback*> callbacks;
+			{
+				std::lock_guard<std::mutex> lock(m_callbackMutex);
+				callbacks = m_callbacks;
+			}
+			for (std::set<IDeviceDiscoveryCallback*>::iterator it = callbacks.begin(); it != callbacks.end(); ++it)
+			{
+				for (size_t i = 0; i < removed.size(); i++)
+					(*it)->OnDeviceRemoved(removed[i]);
+				for (size_t i = 0; i < added.size(); i++)
+					(*it)->OnDeviceAdded(added[i]);
+			}
+		}
+
+#if defined __linux__
+		static int OpenNetlink()
+		{
+			int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+			if (fd < 0)
+				return -1;
+
+			sockaddr_nl address;
+			memset(&address, 0, sizeof(address));
+			address.nl_family = AF_NETLINK;
+			address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+			if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+			{
+				close(fd);
+				return -1;
+			}
+			return fd;
+		}
+
+		// IPv4 addresses currently assigned to a link
+		static void GetLinkAddresses(int linkIndex, std::vector<uint32_t>& ips)
+		{
+			ifaddrs* pAddresses = NULL;
+			if (getifaddrs(&pAddresses) != 0)
+				return;
+
+			for (ifaddrs* pAddress = pAddresses; pAddress; pAddress = pAddress->ifa_next)
+			{
+				if (!pAddress->ifa_addr || pAddress->ifa_addr->sa_family != AF_INET)
+					continue;
+				if (static_cast<int>(if_nametoindex(pAddress->ifa_name)) != linkIndex)
+					continue;
+				ips.push_back(ntohl(reinterpret_cast<sockaddr_in*>(pAddress->ifa_addr)->sin_addr.s_addr));
+			}
+			freeifaddrs(pAddresses);
+		}
+
+		// collects the addresses of interfaces affected by pending messages;
+		// returns false if a change could not be attributed to an address
+		static bool ReadNetlink(int fd, std::vector<uint32_t>& ips)
+		{
+			bool attributed = true;
+			char buffer[8192];
+			for (;;)
+			{
+				ssize_t length = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+				if (length <= 0)
+					break;
+
+				for (nlmsghdr* pHeader = reinterpret_cast<nlmsghdr*>(buffer); NLMSG_OK(pHeader, static_cast<unsigned int>(length)); pHeader = NLMSG_NEXT(pHeader, length))
+				{
+					if (pHeader->nlmsg_type == RTM_NEWADDR || pHeader->nlmsg_type == RTM_DELADDR)
+					{
+						ifaddrmsg* pMessage = static_cast<ifaddrmsg*>(NLMSG_DATA(pHeader));
+						if (pMessage->ifa_family != AF_INET)
+							continue;
+
+						bool found = false;
+						int attributeLength = IFA_PAYLOAD(pHeader);
+						for (rtattr* pAttribute = IFA_RTA(pMessage); RTA_OK(pAttribute, attributeLength); pAttribute = RTA_NEXT(pAttribute, attributeLength))
+						{
+							if (pAttribute->rta_type != IFA_LOCAL && pAttribute->rta_type != IFA_ADDRESS)
+								continue;
+							uint32_t ip = ntohl(*static_cast<uint32_t*>(RTA_DATA(pAttribute)));
+							if (std::find(ips.begin(), ips.end(), ip) == ips.end())
+								ips.push_back(ip);
+							found = true;
+						}
+						attributed = attributed && found && pHeader->nlmsg_type == RTM_NEWADDR;
+					}
+					else if (pHeader->nlmsg_type == RTM_NEWLINK || pHeader->nlmsg_type == RTM_DELLINK)
+					{
+						ifinfomsg* pMessage = static_cast<ifinfomsg*>(NLMSG_DATA(pHeader));
+						size_t before = ips.size();
+						GetLinkAddresses(pMessage->ifi_index, ips);
+
+						// a link going down takes its devices with it
+						if (ips.size() == before || !(pMessage->ifi_flags & IFF_RUNNING))
+							attributed = false;
+					}
+				}
+			}
+			return attributed;
+		}
+#endif
+
+		void Run()
+		{
+			typedef std::chrono::steady_clock clock;
+			clock::time_point nextSweep = clock::now() + std::chrono::milliseconds(m_sweepInterval);
+#if defined __linux__
+			int netlink = OpenNetlink();
+#endif
+
+			while (m_running)
+			{
+				bool sweep = false;
+				bool targeted = false;
+				std::vector<uint32_t> ips;
+
+				int waitMs = 1000;
+				if (m_sweepInterval)
+				{
+					clock::duration remaining = nextSweep - clock::now();
+					waitMs = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count()));
+				}
+
+#if defined __linux__
+				pollfd fds[2];
+				int numFds = 0;
+				if (m_wakePipe[0] >= 0)
+				{
+					fds[numFds].fd = m_wakePipe[0];
+					fds[numFds].events = POLLIN;
+					numFds++;
+				}
+				if (netlink >= 0)
+				{
+					fds[numFds].fd = netlink;
+					fds[numFds].events = POLLIN;
+					numFds++;
+				}
+				if (numFds > 0)
+				{
+					if (poll(fds, numFds, waitMs) > 0)
+					{
+						for (int i = 0; i < numFds; i++)
+						{
+							if (!(fds[i].revents & POLLIN))
+								continue;
+							if (fds[i].fd == netlink)
+							{
+								// let addresses settle (DHCP, LLA) before
+								// discovering
+								std::this_thread::sleep_for(std::chrono::milliseconds(200));
+								if (ReadNetlink(netlink, ips))
+									targeted = !ips.empty();
+								else
+									sweep = true;
+							}
+							else
+							{
+								char drain[16];
+								ssize_t drained = read(m_wakePipe[0], drain, sizeof(drain));
+								(void)drained;
+							}
+						}
+					}
+				}
+				else
+#endif
+				{
+					std::unique_lock<std::mutex> lock(m_wakeMutex);
+					m_wake.wait_for(lock, std::chrono::milliseconds(waitMs));
+				}
+
+				if (!m_running)
+					break;
+
+				{
+					std::lock_guard<std::mutex> lock(m_wakeMutex);
+					sweep = sweep || m_sweepRequested;
+					m_sweepRequested = false;
+				}
+				if (m_sweepInterval && clock::now() >= nextSweep)
+					sweep = true;
+
+				try
+				{
+					if (sweep)
+					{
+						Sweep(NULL);
+						nextSweep = clock::now() + std::chrono::milliseconds(m_sweepInterval);
+					}
+					else if (targeted)
+					{
+						Sweep(&ips);
+					}
+				}
+				catch (GenICam::GenericException&)
+				{
+					// interfaces may disappear mid-discovery; the next event
+					// or sweep retries
+				}
+			}
+
+#if defined __linux__
+			if (netlink >= 0)
+				close(netlink);
+#endif
+		}
+
+		ISystem* m_pSystem;
+		uint64_t m_timeout;
+		uint64_t m_sweepInterval;
+
+		std::thread m_thread;
+		std::atomic<bool> m_running;
+		bool m_sweepRequested;
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wake;
+		int m_wakePipe[2];
+
+		std::mutex m_systemMutex;
+		std::mutex m_tableMutex;
+		std::map<uint64_t, DeviceInfo> m_table;
+
+		std::mutex m_callbackMutex;
+		std::set<IDeviceDiscoveryCallback*> m_callbacks;
+
+		DeviceDiscovery(const DeviceDiscovery&);
+		DeviceDiscovery& operator=(const DeviceDiscovery&);
+	};
+} // namespace Arena
@@ -0,0 +1,286 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file DeviceFactory.h
+ * This file defines the creation and destruction of multiple devices.
+ */
+
+#pragma once
+
+#include "ISystem.h"
+#include "NodeMapCache.h"
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace Arena
+{
+	/**
+	 * @class DeviceFactory
+	 *
+	 * <B> DeviceFactory </B> is a static class responsible for the creation
+	 * and destruction of multiple devices (Arena::IDevice) at once.
+	 *
+	 * Creating a device (Arena::ISystem::CreateDevice) opens its control
+	 * channel, downloads its XML and builds its node maps, most of which is
+	 * spent waiting on the device. Creating devices one after another therefore
+	 * grows linearly with the number of devices. The device factory creates
+	 * them concurrently, so that bringing up many devices takes about as long
+	 * as the slowest one.
+	 *
+	 * Each device owns its node maps, bound to its own port; node maps cannot
+	 * be shared between devices. What can be shared is the parsing of the XML:
+	 * with the node map cache enabled (Arena::EnableNodeMapCache), the
+	 * factory creates one device of each model and version first, and the
+	 * remaining devices of the same model and version load the preprocessed
+	 * XML from the cache.
+	 *
+	 * \code{.cpp}
+	 * 	// creating all devices at once
+	 * 	{
+	 * 		pSystem->UpdateDevices(100);
+	 * 		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+	 * 		std::vector<Arena::IDevice*> devices = Arena::DeviceFactory::CreateDevices(pSystem, deviceInfos);
+	 * 		// ...
+	 * 		Arena::DeviceFactory::DestroyDevices(pSystem, devices);
+	 * 	}
+	 * \endcode
+	 *
+	 * @warning 
+	 *  - Devices must be destroyed
+	 *
+	 * @see 
+	 *  - Arena::ISystem::CreateDevice
+	 *  - Arena::ISystem::DestroyDevice
+	 */
+	class DeviceFactory
+	{
+	public:
+		/**
+		 * @fn static std::vector<IDevice*> CreateDevices(ISystem* pSystem, std::vector<DeviceInfo> deviceInfos, size_t maxThreads = 0)
+		 *
+		 * @param pSystem
+		 *  - Type: Arena::ISystem*
+		 *  - The system object
+		 *
+		 * @param deviceInfos
+		 *  - Type: std::vector<Arena::DeviceInfo>
+		 *  - Device information objects of the devices to create
+		 *
+		 * @param maxThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Maximum number of devices to create at the same time
+		 *  - 0 creates all devices at the same time
+		 *
+		 * @return 
+		 *  - Type: std::vector<Arena::IDevice*>
+		 *  - Devices, in the order of their device information objects
+		 *
+		 * <B> CreateDevices </B> creates and initializes multiple devices
+		 * concurrently (Arena::ISystem::CreateDevice). It must be called after
+		 * devices have been retrieved (Arena::ISystem::GetDevices).
+		 *
+		 * If any device fails to be created, the devices that were created are
+		 * destroyed and the first exception is rethrown, so that either all
+		 * devices are returned or none.
+		 *
+		 * @warning 
+		 *  - Devices must be destroyed
+		 *  - May throw GenICam::GenericException or other derived exception
+		 *
+		 * @see 
+		 *  - Arena::ISystem::CreateDevice
+		 *  - Arena::DeviceFactory::DestroyDevices
+		 */
+		static std::vector<IDevice*> CreateDevices(ISystem* pSystem, std::vector<DeviceInfo> deviceInfos, size_t maxThreads = 0)
+		{
+			std::vector<IDevice*> devices(deviceInfos.size(), NULL);
+			if (deviceInfos.empty())
+				return devices;
+
+			CreateState state;
+			state.pSystem = pSystem;
+			state.pDeviceInfos = &deviceInfos;
+			state.pDevices = &devices;
+
+			// with the cache enabled, hold back all but the first device of
+			// each model and version until the first has populated the cache
+			bool cached = IsNodeMapCacheEnabled();
+			std::map<GenICam::gcstring, size_t> groups;
+			for (size_t i = 0; i < deviceInfos.size(); i++)
+			{
+				if (!cached)
+				{
+					state.pending.push_back(i);
+					continue;
+				}
+
+				GenICam::gcstring key = deviceInfos[i].ModelName() + "/" + deviceInfos[i].DeviceVersion();
+				std::map<GenICam::gcstring, size_t>::iterator it = groups.find(key);
+				if (it == groups.end())
+				{
+					groups.insert(std::make_pair(key, i));
+					state.pending.push_back(i);
+				}
+				else
+				{
+					state.waiting.insert(std::make_pair(it->second, i));
+				}
+			}
+			state.outstanding = deviceInfos.size();
+
+			size_t numThreads = maxThreads == 0 || maxThreads > deviceInfos.size() ? deviceInfos.size() : maxThreads;
+			std::vector<std::thread> threads;
+			for (size_t i = 0; i < numThreads; i++)
+				threads.push_back(std::thread(&DeviceFactory::CreateWorker, &state));
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+
+			if (state.error)
+			{
+				for (size_t i = 0; i < devices.size(); i++)
+				{
+					if (devices[i])
+						pSystem->DestroyDevice(devices[i]);
+				}
+				std::rethrow_exception(state.error);
+			}
+
+			return devices;
+		}
+
+		/**
+		 * @fn static void DestroyDevices(ISystem* pSystem, std::vector<IDevice*> devices)
+		 *
+		 * @param pSystem
+		 *  - Type: Arena::ISystem*
+		 *  - The system object
+		 *
+		 * @param devices
+		 *  - Type: std::vector<Arena::IDevice*>
+		 *  - Devices to destroy
+		 *
+		 * @return 
+		 *  - none
+		 *
+		 * <B> DestroyDevices </B> destroys multiple devices concurrently
+		 * (Arena::ISystem::DestroyDevice). All devices are destroyed even if
+		 * one fails; the first exception is then rethrown.
+		 *
+		 * @warning 
+		 *  - May throw GenICam::GenericException or other derived exception
+		 *
+		 * @see 
+		 *  - Arena::ISystem::DestroyDevice
+		 *  - Arena::DeviceFactory::CreateDevices
+		 */
+		static void DestroyDevices(ISystem* pSystem, std::vector<IDevice*> devices)
+		{
+			std::mutex errorMutex;
+			std::exception_ptr error;
+			std::vector<std::thread> threads;
+			for (size_t i = 0; i < devices.size(); i++)
+			{
+				if (!devices[i])
+					continue;
+
+				threads.push_back(std::thread([pSystem, &devices, i, &errorMutex, &error]() {
+					try
+					{
+						pSystem->DestroyDevice(devices[i]);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if (!error)
+							error = std::current_exception();
+					}
+				}));
+			}
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+	private:
+		struct CreateState
+		{
+			ISystem* pSystem;
+			std::vector<DeviceInfo>* pDeviceInfos;
+			std::vector<IDevice*>* pDevices;
+
+			std::mutex mutex;
+			std::condition_variable changed;
+			std::deque<size_t> pending;
+			std::multimap<size_t, size_t> waiting;
+			size_t outstanding;
+			std::exception_ptr error;
+		};
+
+		static void CreateWorker(CreateState* pState)
+		{
+			std::unique_lock<std::mutex> lock(pState->mutex);
+			for (;;)
+			{
+				while (pState->pending.empty() && pState->outstanding > 0)
+					pState->changed.wait(lock);
+				if (pState->pending.empty())
+					return;
+
+				size_t index = pState->pending.front();
+				pState->pending.pop_front();
+
+				IDevice* pDevice = NULL;
+				std::exception_ptr error;
+				if (!pState->error)
+				{
+					DeviceInfo deviceInfo = (*pState->pDeviceInfos)[index];
+					lock.unlock();
+					try
+					{
+						pDevice = pState->pSystem->CreateDevice(deviceInfo);
+					}
+					catch (...)
+					{
+						error = std::current_exception();
+					}
+					lock.lock();
+				}
+
+				(*pState->pDevices)[index] = pDevice;
+				if (error && !pState->error)
+					pState->error = error;
+
+				// release devices of the same model and version; they are
+				// skipped once an error is recorded
+				std::pair<std::multimap<size_t, size_t>::iterator, std::multimap<size_t, size_t>::iterator> range = pState->waiting.equal_range(index);
+				for (std::multimap<size_t, size_t>::iterator it = range.first; it != range.second; ++it)
+					pState->pending.push_back(it->second);
+				pState->waiting.erase(range.first, range.second);
+
+				pState->outstanding--;
+				pState->changed.notify_all();
+			}
+		}
+	};
+} // namespace Arena
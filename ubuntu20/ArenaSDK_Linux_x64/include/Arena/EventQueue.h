@@ -0,0 +1,487 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file EventQueue.h
+ * This file defines queued delivery of device events.
+ */
+
+#pragma once
+
+#include "IDevice.h"
+#include "GenApiCustom.h"
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Arena
+{
+	/**
+	 * @struct EventRecord
+	 *
+	 * A device event, as queued by an event queue (Arena::EventQueue).
+	 *
+	 * @see
+	 *  - Arena::EventQueue
+	 */
+	struct EventRecord
+	{
+		/** index of the event in the list given to the queue */
+		uint32_t index;
+		/** event ID ('Event<Name>'), or 0 if the event has none */
+		uint64_t eventId;
+		/** device timestamp ('Event<Name>Timestamp'), or 0 if the event has none */
+		uint64_t timestamp;
+		/** frame ID ('Event<Name>FrameID'), or 0 if the event has none */
+		uint64_t data;
+	};
+
+	/**
+	 * @class EventQueue
+	 *
+	 * An <B> EventQueue </B> receives events from a device on a worker thread
+	 * and queues them as plain records (Arena::EventRecord), to be taken in
+	 * batches (Arena::EventQueue::Poll, Arena::EventQueue::Wait).
+	 *
+	 * \code{.cpp}
+	 * 	// taking exposure end events in batches
+	 * 	{
+	 * 		std::vector<GenICam::gcstring> events;
+	 * 		events.push_back("ExposureEnd");
+	 * 		Arena::EventQueue eventQueue(pDevice, events);
+	 * 		Arena::EventRecord records[64];
+	 * 		size_t count = eventQueue.Wait(records, 64, 1000);
+	 * 		for (size_t i = 0; i < count; i++)
+	 * 			std::cout << records[i].timestamp << "\n";
+	 * 	}
+	 * \endcode
+	 *
+	 * Waiting on events (Arena::IDevice::WaitOnEvent) processes one event per
+	 * call on the calling thread, and its data is read through the event
+	 * nodes. The queue instead keeps waiting on its own thread, processes
+	 * the events that have arrived, up to a queue's worth or a millisecond
+	 * of them, before waking consumers once, and copies the ID, timestamp
+	 * and frame ID of each event through node handles resolved when the
+	 * queue is created. Consumers take as many records as are queued in a
+	 * single call.
+	 *
+	 * The queue also provides a file descriptor
+	 * (Arena::EventQueue::GetFileDescriptor) that is readable while records
+	 * are queued, so that events can be waited on with poll/select alongside
+	 * other sources.
+	 *
+	 * @warning
+	 *  - The queue initializes and deinitializes events on the device; do not
+	 *    call Arena::IDevice::WaitOnEvent while it exists
+	 *  - If the queue is full, the oldest records are dropped
+	 *    (Arena::EventQueue::GetDropped)
+	 *
+	 * @see
+	 *  - Arena::EventRecord
+	 *  - Arena::IDevice::WaitOnEvent
+	 */
+	class EventQueue
+	{
+	public:
+		/**
+		 * @fn EventQueue(IDevice* pDevice, const std::vector<GenICam::gcstring>& events, size_t capacity = 4096, uint64_t timeout = 100)
+		 *
+		 * @param pDevice
+		 *  - Type: Arena::IDevice*
+		 *  - Device to receive events from
+		 *
+		 * @param events
+		 *  - Type: const std::vector<GenICam::gcstring>&
+		 *  - Events to receive, as entries of 'EventSelector' (for example,
+		 *    "ExposureEnd")
+		 *
+		 * @param capacity
+		 *  - Type: size_t
+		 *  - Default: 4096
+		 *  - Maximum number of records queued
+		 *
+		 * @param timeout
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Default: 100
+		 *  - Time the worker waits on events before checking whether to stop
+		 *
+		 * A constructor, initializing events on the device and turning on
+		 * notification ('EventNotification') for each event.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		EventQueue(IDevice* pDevice, const std::vector<GenICam::gcstring>& events, size_t capacity = 4096, uint64_t timeout = 100) :
+			m_pDevice(pDevice),
+			m_timeout(timeout),
+			m_running(true),
+			m_records(capacity > 0 ? capacity : 1),
+			m_first(0),
+			m_count(0),
+			m_dropped(0)
+		{
+			if (pipe(m_wakePipe) != 0)
+				throw GenICam::GenericException("Unable to create event queue pipe", __FILE__, __LINE__);
+			fcntl(m_wakePipe[0], F_SETFL, O_NONBLOCK);
+			fcntl(m_wakePipe[1], F_SETFL, O_NONBLOCK);
+
+			GenApi::INodeMap* pNodeMap = NULL;
+			try
+			{
+				pNodeMap = m_pDevice->GetNodeMap();
+				m_pDevice->InitializeEvents();
+			}
+			catch (...)
+			{
+				close(m_wakePipe[0]);
+				close(m_wakePipe[1]);
+				throw;
+			}
+
+			try
+			{
+				m_eventSelectorInitial = GetNodeValue<GenICam::gcstring>(pNodeMap, "EventSelector");
+				for (size_t i = 0; i < events.size(); i++)
+				{
+					std::unique_ptr<Source> pSource(new Source(this, static_cast<uint32_t>(i)));
+					pSource->name = events[i];
+					pSource->pId = pNodeMap->GetNode("Event" + events[i]);
+					pSource->pTimestamp = pNodeMap->GetNode("Event" + events[i] + "Timestamp");
+					pSource->pData = pNodeMap->GetNode("Event" + events[i] + "FrameID");
+
+					// the timestamp changes with every event; the ID may not
+					GenApi::INode* pNode = pSource->pTimestamp ? pSource->pTimestamp->GetNode() : (pSource->pId ? pSource->pId->GetNode() : NULL);
+					if (!pNode)
+						throw GenICam::GenericException(("Event nodes not found: " + events[i]).c_str(), __FILE__, __LINE__);
+
+					SetNodeValue<GenICam::gcstring>(pNodeMap, "EventSelector", events[i]);
+					pSource->notificationInitial = GetNodeValue<GenICam::gcstring>(pNodeMap, "EventNotification");
+					SetNodeValue<GenICam::gcstring>(pNodeMap, "EventNotification", "On");
+
+					pSource->hCallback = GenApi::Register(pNode, *pSource, &Source::OnEvent);
+					m_sources.push_back(std::move(pSource));
+				}
+			}
+			catch (...)
+			{
+				Release();
+				throw;
+			}
+
+			m_thread = std::thread(&EventQueue::Run, this);
+		}
+
+		/**
+		 * @fn ~EventQueue()
+		 *
+		 * A destructor, stopping the worker, restoring the notification of
+		 * each event and deinitializing events on the device.
+		 */
+		~EventQueue()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+			}
+			m_thread.join();
+			Release();
+		}
+
+		/**
+		 * @fn size_t Poll(EventRecord* pRecords, size_t maxRecords)
+		 *
+		 * @param pRecords
+		 *  - Type: Arena::EventRecord*
+		 *  - Buffer to receive the records
+		 *
+		 * @param maxRecords
+		 *  - Type: size_t
+		 *  - Size of the buffer, in records
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of records taken, in the order the events arrived
+		 *
+		 * <B> Poll </B> takes the queued records without waiting.
+		 */
+		size_t Poll(EventRecord* pRecords, size_t maxRecords)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return Take(pRecords, maxRecords);
+		}
+
+		/**
+		 * @fn size_t Wait(EventRecord* pRecords, size_t maxRecords, uint64_t timeout)
+		 *
+		 * @param pRecords
+		 *  - Type: Arena::EventRecord*
+		 *  - Buffer to receive the records
+		 *
+		 * @param maxRecords
+		 *  - Type: size_t
+		 *  - Size of the buffer, in records
+		 *
+		 * @param timeout
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Maximum time to wait for a record
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of records taken; 0 if the timeout expired
+		 *
+		 * <B> Wait </B> waits until at least one record is queued, then takes
+		 * all queued records that fit in the buffer.
+		 */
+		size_t Wait(EventRecord* pRecords, size_t maxRecords, uint64_t timeout)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queued.wait_for(lock, std::chrono::milliseconds(timeout), [this]() { return m_count > 0; });
+			return Take(pRecords, maxRecords);
+		}
+
+		/**
+		 * @fn int GetFileDescriptor()
+		 *
+		 * @return
+		 *  - Type: int
+		 *  - File descriptor that is readable while records are queued
+		 *
+		 * <B> GetFileDescriptor </B> gets a descriptor to wait on with
+		 * poll/select. It stays readable until the queue is emptied by
+		 * Arena::EventQueue::Poll or Arena::EventQueue::Wait; it must not be
+		 * read from directly.
+		 */
+		int GetFileDescriptor() const
+		{
+			return m_wakePipe[0];
+		}
+
+		/**
+		 * @fn GenICam::gcstring GetEventName(uint32_t index)
+		 *
+		 * @param index
+		 *  - Type: uint32_t
+		 *  - Index of a record (Arena::EventRecord::index)
+		 *
+		 * @return
+		 *  - Type: GenICam::gcstring
+		 *  - Name of the event
+		 */
+		GenICam::gcstring GetEventName(uint32_t index) const
+		{
+			return index < m_sources.size() ? m_sources[index]->name : GenICam::gcstring();
+		}
+
+		/**
+		 * @fn uint64_t GetDropped()
+		 *
+		 * @return
+		 *  - Type: uint64_t
+		 *  - Number of records dropped because the queue was full
+		 */
+		uint64_t GetDropped()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_dropped;
+		}
+
+	private:
+		struct Source
+		{
+			EventQueue* pQueue;
+			uint32_t index;
+			GenICam::gcstring name;
+			GenApi::CIntegerPtr pId;
+			GenApi::CIntegerPtr pTimestamp;
+			GenApi::CIntegerPtr pData;
+			GenICam::gcstring notificationInitial;
+			GenApi::CallbackHandleType hCallback;
+
+			Source(EventQueue* pEventQueue, uint32_t eventIndex) :
+				pQueue(pEventQueue),
+				index(eventIndex),
+				hCallback(0)
+			{
+			}
+
+			void OnEvent(GenApi::INode*)
+			{
+				EventRecord record;
+				record.index = index;
+				record.eventId = Read(pId);
+				record.timestamp = Read(pTimestamp);
+				record.data = Read(pData);
+				pQueue->Push(record);
+			}
+
+			static uint64_t Read(GenApi::CIntegerPtr& pValue)
+			{
+				if (!pValue || !GenApi::IsReadable(pValue))
+					return 0;
+				return static_cast<uint64_t>(pValue->GetValue());
+			}
+		};
+
+		IDevice* m_pDevice;
+		uint64_t m_timeout;
+		bool m_running;
+		std::thread m_thread;
+		int m_wakePipe[2];
+
+		std::vector<std::unique_ptr<Source> > m_sources;
+		GenICam::gcstring m_eventSelectorInitial;
+
+		std::mutex m_mutex;
+		std::condition_variable m_queued;
+		std::vector<EventRecord> m_records;
+		size_t m_first;
+		size_t m_count;
+		uint64_t m_dropped;
+
+		// pending records are published to consumers after each pass
+		std::vector<EventRecord> m_pending;
+
+		void Push(const EventRecord& record)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending.push_back(record);
+		}
+
+		void Publish()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_pending.empty())
+					return;
+
+				bool wasEmpty = m_count == 0;
+				for (size_t i = 0; i < m_pending.size(); i++)
+				{
+					if (m_count == m_records.size())
+					{
+						m_first = (m_first + 1) % m_records.size();
+						m_count--;
+						m_dropped++;
+					}
+					m_records[(m_first + m_count) % m_records.size()] = m_pending[i];
+					m_count++;
+				}
+				if (wasEmpty)
+				{
+					char byte = 0;
+					ssize_t written = write(m_wakePipe[1], &byte, 1);
+					(void)written;
+				}
+				m_pending.clear();
+			}
+			m_queued.notify_all();
+		}
+
+		size_t Take(EventRecord* pRecords, size_t maxRecords)
+		{
+			size_t count = 0;
+			for (; count < maxRecords && m_count > 0; count++)
+			{
+				pRecords[count] = m_records[m_first];
+				m_first = (m_first + 1) % m_records.size();
+				m_count--;
+			}
+			if (m_count == 0)
+			{
+				char buffer[64];
+				while (read(m_wakePipe[0], buffer, sizeof(buffer)) > 0)
+					continue;
+			}
+			return count;
+		}
+
+		void Run()
+		{
+			while (true)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (!m_running)
+						break;
+				}
+
+				// wait for the first event, then process those that have
+				// already arrived before waking consumers; a pass ends after
+				// a queue's worth of events or a millisecond, so that
+				// consumers keep up with a steady stream of events
+				try
+				{
+					m_pDevice->WaitOnEvent(m_timeout);
+					std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+					for (size_t count = 1; count < m_records.size() && std::chrono::steady_clock::now() < end; count++)
+						m_pDevice->WaitOnEvent(0);
+				}
+				catch (GenICam::TimeoutException&)
+				{
+				}
+				catch (GenICam::GenericException&)
+				{
+					// device lost or events stopped; back off before retrying
+					Publish();
+					std::this_thread::sleep_for(std::chrono::milliseconds(m_timeout));
+					continue;
+				}
+				Publish();
+			}
+		}
+
+		void Release()
+		{
+			GenApi::INodeMap* pNodeMap = m_pDevice->GetNodeMap();
+			for (size_t i = 0; i < m_sources.size(); i++)
+			{
+				GenApi::Deregister(m_sources[i]->hCallback);
+				try
+				{
+					SetNodeValue<GenICam::gcstring>(pNodeMap, "EventSelector", m_sources[i]->name);
+					SetNodeValue<GenICam::gcstring>(pNodeMap, "EventNotification", m_sources[i]->notificationInitial);
+				}
+				catch (GenICam::GenericException&)
+				{
+				}
+			}
+			m_sources.clear();
+
+			try
+			{
+				if (!m_eventSelectorInitial.empty())
+					SetNodeValue<GenICam::gcstring>(pNodeMap, "EventSelector", m_eventSelectorInitial);
+				m_pDevice->DeinitializeEvents();
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+
+			close(m_wakePipe[0]);
+			close(m_wakePipe[1]);
+		}
+
+		EventQueue(const EventQueue&);
+		EventQueue& operator=(const EventQueue&);
+	};
+} // namespace Arena
@@ -0,0 +1,829 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file Feature.h
+ * This file defines pre-resolved, typed handles to features.
+ */
+
+#pragma once
+
+#include <GenICam.h>
+
+namespace Arena
+{
+	/**
+	 * @struct Command
+	 *
+	 * Tag type selecting the command node handle (Arena::Feature<Command>).
+	 */
+	struct Command
+	{
+	};
+
+	namespace Internal
+	{
+		// resolves a node once, checking its interface type
+		template<typename I>
+		inline I* ResolveFeature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name, GenApi::EInterfaceType interfaceType)
+		{
+			if (!pNodeMap)
+				throw GenICam::GenericException("Node map is NULL", __FILE__, __LINE__);
+
+			GenApi::INode* pNode = pNodeMap->GetNode(name);
+			if (!pNode)
+				throw GenICam::GenericException(("Node not found: " + name).c_str(), __FILE__, __LINE__);
+			if (pNode->GetPrincipalInterfaceType() != interfaceType)
+				throw GenICam::GenericException(("Node has a different type: " + name).c_str(), __FILE__, __LINE__);
+
+			return dynamic_cast<I*>(pNode);
+		}
+	} // namespace Internal
+
+	/**
+	 * @class FeatureBase
+	 *
+	 * The common part of all feature handles (Arena::Feature), holding the
+	 * resolved node.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<typename I>
+	class FeatureBase
+	{
+	public:
+		/**
+		 * @fn GenApi::INode* GetNode()
+		 *
+		 * @return
+		 *  - Type: GenApi::INode*
+		 *  - The resolved node
+		 */
+		GenApi::INode* GetNode() const
+		{
+			return m_pNode;
+		}
+
+		/**
+		 * @fn bool IsAvailable()
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the feature is currently available
+		 */
+		bool IsAvailable() const
+		{
+			return GenApi::IsAvailable(m_pNode);
+		}
+
+		/**
+		 * @fn bool IsReadable()
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the feature is currently readable
+		 */
+		bool IsReadable() const
+		{
+			return GenApi::IsReadable(m_pNode);
+		}
+
+		/**
+		 * @fn bool IsWritable()
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the feature is currently writable
+		 */
+		bool IsWritable() const
+		{
+			return GenApi::IsWritable(m_pNode);
+		}
+
+	protected:
+		FeatureBase(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name, GenApi::EInterfaceType interfaceType) :
+			m_pValue(Internal::ResolveFeature<I>(pNodeMap, name, interfaceType)),
+			m_pNode(pNodeMap->GetNode(name))
+		{
+		}
+
+		I* m_pValue;
+		GenApi::INode* m_pNode;
+	};
+
+	/**
+	 * @class Feature
+	 *
+	 * A <B> Feature </B> is a handle to a single feature of a node map
+	 * (GenApi::INodeMap), resolved by name and checked for type once, when it
+	 * is constructed. Reading and writing through the handle then goes
+	 * straight to the node, without the name lookup, string allocation and
+	 * cast that Arena::GetNodeValue and Arena::SetNodeValue repeat on every
+	 * call.
+	 *
+	 * The template type selects the kind of node:
+	 *  - Feature<int64_t>: integer nodes, or enumeration nodes by integer value
+	 *  - Feature<double>: float nodes
+	 *  - Feature<bool>: boolean nodes
+	 *  - Feature<GenICam::gcstring>: string nodes, or enumeration nodes by
+	 *    entry name
+	 *  - Feature<Arena::Command>: command nodes
+	 *
+	 * \code{.cpp}
+	 * 	// resolving features once, outside the acquisition loop
+	 * 	{
+	 * 		Arena::Feature<double> exposureTime(pNodeMap, "ExposureTime");
+	 * 		Arena::Feature<bool> triggerArmed(pNodeMap, "TriggerArmed");
+	 * 		Arena::Feature<Arena::Command> triggerSoftware(pNodeMap, "TriggerSoftware");
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			exposureTime.Set(exposureTimes[i]);
+	 * 			while (!triggerArmed.Get())
+	 * 				;
+	 * 			triggerSoftware.Execute();
+	 * 			// ...
+	 * 		}
+	 * 	}
+	 * \endcode
+	 *
+	 * Writes are verified by default, checking access mode and range before
+	 * writing. Writes that are known to be safe, such as a value already
+	 * checked against the range in a tight loop, may skip verification
+	 * (SetUnchecked). Writing a value still invalidates the nodes that depend
+	 * on it, as GenApi requires to keep their values consistent.
+	 *
+	 * @warning
+	 *  - The handle is valid as long as its node map; recreate handles after
+	 *    recreating a device
+	 *  - Construction may throw GenICam::GenericException if the node does
+	 *    not exist or is of another type
+	 *
+	 * @see
+	 *  - Arena::GetNodeValue
+	 *  - Arena::SetNodeValue
+	 */
+	template<typename T>
+	class Feature;
+
+	/**
+	 * @class Feature<int64_t>
+	 *
+	 * A handle to an integer node, or to an enumeration node by integer value.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<>
+	class Feature<int64_t> : public FeatureBase<GenApi::INode>
+	{
+	public:
+		/**
+		 * @fn Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			FeatureBase<GenApi::INode>(pNodeMap, name, ResolveType(pNodeMap, name)),
+			m_pInteger(dynamic_cast<GenApi::IInteger*>(m_pNode)),
+			m_pEnumeration(dynamic_cast<GenApi::IEnumeration*>(m_pNode))
+		{
+		}
+
+		/**
+		 * @fn int64_t Get(bool ignoreCache = false) const
+		 *
+		 * @param ignoreCache
+		 *  - Type: bool
+		 *  - Default: false
+		 *  - Reads from the device even if the value is cached
+		 *
+		 * @return
+		 *  - Type: int64_t
+		 *
+		 * <B> Get </B> gets the value of the node, from the node map's cache unless
+		 * ignored.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		int64_t Get(bool ignoreCache = false) const
+		{
+			return m_pInteger ? m_pInteger->GetValue(false, ignoreCache) : m_pEnumeration->GetIntValue(false, ignoreCache);
+		}
+
+		/**
+		 * @fn void Set(int64_t value)
+		 *
+		 * @param value
+		 *  - Type: int64_t
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> sets the value of the node, verifying access mode and
+		 * range.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Set(int64_t value)
+		{
+			if (m_pInteger)
+				m_pInteger->SetValue(value, true);
+			else
+				m_pEnumeration->SetIntValue(value, true);
+		}
+
+		/**
+		 * @fn void SetUnchecked(int64_t value)
+		 *
+		 * @param value
+		 *  - Type: int64_t
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetUnchecked </B> sets the value of the node without verifying
+		 * access mode and range; for values known to be valid.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void SetUnchecked(int64_t value)
+		{
+			if (m_pInteger)
+				m_pInteger->SetValue(value, false);
+			else
+				m_pEnumeration->SetIntValue(value, false);
+		}
+
+		/**
+		 * @fn int64_t GetMin() const
+		 *
+		 * @return
+		 *  - Type: int64_t
+		 *
+		 * <B> GetMin </B> gets the minimum of the node.
+		 */
+		int64_t GetMin() const
+		{
+			return m_pInteger ? m_pInteger->GetMin() : 0;
+		}
+
+		/**
+		 * @fn int64_t GetMax() const
+		 *
+		 * @return
+		 *  - Type: int64_t
+		 *
+		 * <B> GetMax </B> gets the maximum of the node.
+		 */
+		int64_t GetMax() const
+		{
+			return m_pInteger ? m_pInteger->GetMax() : 0;
+		}
+
+		/**
+		 * @fn int64_t GetInc() const
+		 *
+		 * @return
+		 *  - Type: int64_t
+		 *
+		 * <B> GetInc </B> gets the increment of the node.
+		 */
+		int64_t GetInc() const
+		{
+			return m_pInteger && m_pInteger->GetIncMode() == GenApi::fixedIncrement ? m_pInteger->GetInc() : 1;
+		}
+
+	private:
+		static GenApi::EInterfaceType ResolveType(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		{
+			GenApi::INode* pNode = pNodeMap ? pNodeMap->GetNode(name) : NULL;
+			return pNode && pNode->GetPrincipalInterfaceType() == GenApi::intfIEnumeration ? GenApi::intfIEnumeration : GenApi::intfIInteger;
+		}
+
+		GenApi::IInteger* m_pInteger;
+		GenApi::IEnumeration* m_pEnumeration;
+	};
+
+	/**
+	 * @class Feature<double>
+	 *
+	 * A handle to a float node.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<>
+	class Feature<double> : public FeatureBase<GenApi::IFloat>
+	{
+	public:
+		/**
+		 * @fn Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node as a float node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			FeatureBase<GenApi::IFloat>(pNodeMap, name, GenApi::intfIFloat)
+		{
+		}
+
+		/**
+		 * @fn double Get(bool ignoreCache = false) const
+		 *
+		 * @param ignoreCache
+		 *  - Type: bool
+		 *  - Default: false
+		 *  - Reads from the device even if the value is cached
+		 *
+		 * @return
+		 *  - Type: double
+		 *
+		 * <B> Get </B> gets the value of the node, from the node map's cache unless
+		 * ignored.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		double Get(bool ignoreCache = false) const
+		{
+			return m_pValue->GetValue(false, ignoreCache);
+		}
+
+		/**
+		 * @fn void Set(double value)
+		 *
+		 * @param value
+		 *  - Type: double
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> sets the value of the node, verifying access mode and
+		 * range.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Set(double value)
+		{
+			m_pValue->SetValue(value, true);
+		}
+
+		/**
+		 * @fn void SetUnchecked(double value)
+		 *
+		 * @param value
+		 *  - Type: double
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetUnchecked </B> sets the value of the node without verifying
+		 * access mode and range; for values known to be valid.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void SetUnchecked(double value)
+		{
+			m_pValue->SetValue(value, false);
+		}
+
+		/**
+		 * @fn double GetMin() const
+		 *
+		 * @return
+		 *  - Type: double
+		 *
+		 * <B> GetMin </B> gets the minimum of the node.
+		 */
+		double GetMin() const
+		{
+			return m_pValue->GetMin();
+		}
+
+		/**
+		 * @fn double GetMax() const
+		 *
+		 * @return
+		 *  - Type: double
+		 *
+		 * <B> GetMax </B> gets the maximum of the node.
+		 */
+		double GetMax() const
+		{
+			return m_pValue->GetMax();
+		}
+	};
+
+	/**
+	 * @class Feature<bool>
+	 *
+	 * A handle to a boolean node.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<>
+	class Feature<bool> : public FeatureBase<GenApi::IBoolean>
+	{
+	public:
+		/**
+		 * @fn Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node as a boolean node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			FeatureBase<GenApi::IBoolean>(pNodeMap, name, GenApi::intfIBoolean)
+		{
+		}
+
+		/**
+		 * @fn bool Get(bool ignoreCache = false) const
+		 *
+		 * @param ignoreCache
+		 *  - Type: bool
+		 *  - Default: false
+		 *  - Reads from the device even if the value is cached
+		 *
+		 * @return
+		 *  - Type: bool
+		 *
+		 * <B> Get </B> gets the value of the node, from the node map's cache unless
+		 * ignored.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		bool Get(bool ignoreCache = false) const
+		{
+			return m_pValue->GetValue(false, ignoreCache);
+		}
+
+		/**
+		 * @fn void Set(bool value)
+		 *
+		 * @param value
+		 *  - Type: bool
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> sets the value of the node, verifying access mode and
+		 * range.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Set(bool value)
+		{
+			m_pValue->SetValue(value, true);
+		}
+
+		/**
+		 * @fn void SetUnchecked(bool value)
+		 *
+		 * @param value
+		 *  - Type: bool
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetUnchecked </B> sets the value of the node without verifying
+		 * access mode and range; for values known to be valid.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void SetUnchecked(bool value)
+		{
+			m_pValue->SetValue(value, false);
+		}
+	};
+
+	/**
+	 * @class Feature<GenICam::gcstring>
+	 *
+	 * A handle to a string node, or to an enumeration node by entry name.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<>
+	class Feature<GenICam::gcstring> : public FeatureBase<GenApi::INode>
+	{
+	public:
+		/**
+		 * @fn Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node as a string or enumeration node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			FeatureBase<GenApi::INode>(pNodeMap, name, ResolveType(pNodeMap, name)),
+			m_pString(dynamic_cast<GenApi::IString*>(m_pNode)),
+			m_pEnumeration(dynamic_cast<GenApi::IEnumeration*>(m_pNode))
+		{
+		}
+
+		/**
+		 * @fn GenICam::gcstring Get(bool ignoreCache = false) const
+		 *
+		 * @param ignoreCache
+		 *  - Type: bool
+		 *  - Default: false
+		 *  - Reads from the device even if the value is cached
+		 *
+		 * @return
+		 *  - Type: GenICam::gcstring
+		 *
+		 * <B> Get </B> gets the value of the node, from the node map's cache unless
+		 * ignored.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		GenICam::gcstring Get(bool ignoreCache = false) const
+		{
+			if (m_pString)
+				return m_pString->GetValue(false, ignoreCache);
+
+			GenApi::IEnumEntry* pEntry = m_pEnumeration->GetCurrentEntry(false, ignoreCache);
+			return pEntry ? pEntry->GetSymbolic() : GenICam::gcstring();
+		}
+
+		/**
+		 * @fn void Set(const GenICam::gcstring& value)
+		 *
+		 * @param value
+		 *  - Type: const GenICam::gcstring&
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> sets the value of the node, verifying access mode and
+		 * range.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Set(const GenICam::gcstring& value)
+		{
+			if (m_pString)
+				m_pString->SetValue(value, true);
+			else
+				m_pEnumeration->FromString(value, true);
+		}
+
+		/**
+		 * @fn void SetUnchecked(const GenICam::gcstring& value)
+		 *
+		 * @param value
+		 *  - Type: const GenICam::gcstring&
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetUnchecked </B> sets the value of the node without verifying
+		 * access mode and range; for values known to be valid.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void SetUnchecked(const GenICam::gcstring& value)
+		{
+			if (m_pString)
+			{
+				m_pString->SetValue(value, false);
+				return;
+			}
+
+			GenApi::IEnumEntry* pEntry = m_pEnumeration->GetEntryByName(value);
+			if (!pEntry)
+				throw GenICam::GenericException(("Enumeration entry not found: " + value).c_str(), __FILE__, __LINE__);
+			m_pEnumeration->SetIntValue(pEntry->GetValue(), false);
+		}
+
+	private:
+		static GenApi::EInterfaceType ResolveType(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		{
+			GenApi::INode* pNode = pNodeMap ? pNodeMap->GetNode(name) : NULL;
+			return pNode && pNode->GetPrincipalInterfaceType() == GenApi::intfIEnumeration ? GenApi::intfIEnumeration : GenApi::intfIString;
+		}
+
+		GenApi::IString* m_pString;
+		GenApi::IEnumeration* m_pEnumeration;
+	};
+
+	/**
+	 * @class Feature<Command>
+	 *
+	 * A handle to a command node.
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<>
+	class Feature<Command> : public FeatureBase<GenApi::ICommand>
+	{
+	public:
+		/**
+		 * @fn Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node as a command node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		Feature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			FeatureBase<GenApi::ICommand>(pNodeMap, name, GenApi::intfICommand)
+		{
+		}
+
+		/**
+		 * @fn void Execute()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Execute </B> executes the command, verifying access mode.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Execute()
+		{
+			m_pValue->Execute(true);
+		}
+
+		/**
+		 * @fn void ExecuteUnchecked()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> ExecuteUnchecked </B> executes the command without verifying access
+		 * mode.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void ExecuteUnchecked()
+		{
+			m_pValue->Execute(false);
+		}
+
+		/**
+		 * @fn bool IsDone() const
+		 *
+		 * @return
+		 *  - Type: bool
+		 *
+		 * <B> IsDone </B> checks whether the command has completed.
+		 */
+		bool IsDone() const
+		{
+			return m_pValue->IsDone(false);
+		}
+	};
+
+	/**
+	 * @class EnumFeature
+	 *
+	 * An <B> EnumFeature </B> is a handle to an enumeration node
+	 * (Arena::Feature), reading and writing its value as a C++ enum whose
+	 * enumerators hold the integer values of the entries. Such enums are
+	 * generated from a device's XML (Cpp_GenerateFeatureHeader), so that
+	 * misspelled entries fail to compile.
+	 *
+	 * \code{.cpp}
+	 * 	// setting an enumeration through a generated enum
+	 * 	{
+	 * 		Arena::EnumFeature<PixelFormatEnum> pixelFormat(pNodeMap, "PixelFormat");
+	 * 		pixelFormat.Set(PixelFormatEnum::Mono8);
+	 * 	}
+	 * \endcode
+	 *
+	 * @see
+	 *  - Arena::Feature
+	 */
+	template<typename E>
+	class EnumFeature : public Feature<int64_t>
+	{
+	public:
+		/**
+		 * @fn EnumFeature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor, resolving the node as an enumeration node.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 *  - Throws GenICam::InvalidArgumentException if the node is not an
+		 *    enumeration
+		 */
+		EnumFeature(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name) :
+			Feature<int64_t>(pNodeMap, name)
+		{
+			// the integer handle also accepts integer nodes
+			if (!dynamic_cast<GenApi::IEnumeration*>(m_pNode))
+				throw GenICam::InvalidArgumentException(("Node is not an enumeration: " + name).c_str(), __FILE__, __LINE__);
+		}
+
+		E Get(bool ignoreCache = false) const
+		{
+			return static_cast<E>(Feature<int64_t>::Get(ignoreCache));
+		}
+
+		void Set(E value)
+		{
+			Feature<int64_t>::Set(static_cast<int64_t>(value));
+		}
+
+		void SetUnchecked(E value)
+		{
+			Feature<int64_t>::SetUnchecked(static_cast<int64_t>(value));
+		}
+	};
+} // namespace Arena
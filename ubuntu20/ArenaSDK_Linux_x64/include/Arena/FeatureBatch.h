@@ -0,0 +1,532 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file FeatureBatch.h
+ * This file defines batched writes of features.
+ */
+
+#pragma once
+
+#include <GenICam.h>
+
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+namespace Arena
+{
+	/**
+	 * @struct FeatureBatchResult
+	 *
+	 * The result of a single write of a feature batch (Arena::FeatureBatch).
+	 *
+	 * @see
+	 *  - Arena::FeatureBatch::GetResults
+	 */
+	struct FeatureBatchResult
+	{
+		/** name of the feature */
+		GenICam::gcstring name;
+		/** value written, as a string */
+		GenICam::gcstring value;
+		/** true if the value was written */
+		bool written;
+		/** reason the value was not written */
+		GenICam::gcstring error;
+	};
+
+	/**
+	 * @class FeatureBatch
+	 *
+	 * A <B> FeatureBatch </B> collects writes to the features of a node map
+	 * (GenApi::INodeMap) and applies them together
+	 * (Arena::FeatureBatch::Write).
+	 *
+	 * Writing features one at a time sends a register write to the device
+	 * for each of them, waiting for each acknowledgement in turn. A batch
+	 * instead hands all writes to GenApi at once
+	 * (GenApi::INodeMap::ConcatenatedWrite), which collects the resulting
+	 * register accesses and sends them to the transport layer as a stacked
+	 * write, so that the device receives many registers per packet.
+	 *
+	 * \code{.cpp}
+	 * 	// saving values to restore them later in a single batch
+	 * 	{
+	 * 		Arena::FeatureBatch restore(pNodeMap);
+	 * 		restore.AddCurrentValue("TriggerMode");
+	 * 		restore.AddCurrentValue("ExposureAuto");
+	 * 		restore.AddCurrentValue("ExposureTime");
+	 * 		// ...
+	 * 		restore.Write();
+	 * 	}
+	 * \endcode
+	 *
+	 * Writes are applied in the order they are added, as in a feature stream
+	 * (Arena::FeatureStream): selectors must be added before the features
+	 * they select, and may be added more than once to write a feature for
+	 * several selector values. If the stacked write fails, the batch applies
+	 * the writes one by one, in order. Writes that fail are then retried in
+	 * passes while any succeeds, each preceded by the writes of its
+	 * selectors that came before it in the batch, so that it lands under the
+	 * selector values it was added with; this resolves writes that depend on
+	 * each other, such as an offset limited by a width written later in the
+	 * batch. The last values of the selectors are written again afterwards.
+	 * Each write then reports its own result
+	 * (Arena::FeatureBatch::GetResults).
+	 *
+	 * @warning
+	 *  - Commands cannot be batched
+	 *
+	 * @see
+	 *  - Arena::FeatureBatchResult
+	 *  - Arena::FeatureStream
+	 */
+	class FeatureBatch
+	{
+	public:
+		/**
+		 * @fn FeatureBatch(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to write to
+		 *
+		 * A constructor.
+		 */
+		FeatureBatch(GenApi::INodeMap* pNodeMap) :
+			m_pNodeMap(pNodeMap)
+		{
+		}
+
+		/**
+		 * @fn void Add(const GenICam::gcstring& name, const GenICam::gcstring& value)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @param value
+		 *  - Type: const GenICam::gcstring&
+		 *  - Value to write, as a string
+		 *  - Enumeration nodes use the name of the entry
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Add </B> adds a write to the batch. Overloads take integer,
+		 * float and boolean values.
+		 */
+		void Add(const GenICam::gcstring& name, const GenICam::gcstring& value)
+		{
+			Item item;
+			item.name = name;
+			item.type = String;
+			item.stringValue = value;
+			m_items.push_back(item);
+		}
+
+		void Add(const GenICam::gcstring& name, const char* value)
+		{
+			Add(name, GenICam::gcstring(value));
+		}
+
+		void Add(const GenICam::gcstring& name, int64_t value)
+		{
+			Item item;
+			item.name = name;
+			item.type = Integer;
+			item.integerValue = value;
+			m_items.push_back(item);
+		}
+
+		void Add(const GenICam::gcstring& name, int value)
+		{
+			Add(name, static_cast<int64_t>(value));
+		}
+
+		void Add(const GenICam::gcstring& name, double value)
+		{
+			Item item;
+			item.name = name;
+			item.type = Float;
+			item.floatValue = value;
+			m_items.push_back(item);
+		}
+
+		void Add(const GenICam::gcstring& name, bool value)
+		{
+			Item item;
+			item.name = name;
+			item.type = Boolean;
+			item.booleanValue = value;
+			m_items.push_back(item);
+		}
+
+		/**
+		 * @fn void AddCurrentValue(const GenICam::gcstring& name)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> AddCurrentValue </B> reads the current value of a feature and
+		 * adds a write of that value to the batch, so that it can be restored
+		 * later.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void AddCurrentValue(const GenICam::gcstring& name)
+		{
+			GenApi::CValuePtr pValue = m_pNodeMap->GetNode(name);
+			if (!pValue)
+				throw GenICam::GenericException(("Node not found: " + name).c_str(), __FILE__, __LINE__);
+
+			Add(name, pValue->ToString());
+		}
+
+		/**
+		 * @fn size_t GetSize()
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of writes in the batch
+		 */
+		size_t GetSize() const
+		{
+			return m_items.size();
+		}
+
+		/**
+		 * @fn void Clear()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Clear </B> removes all writes and results from the batch.
+		 */
+		void Clear()
+		{
+			m_items.clear();
+			m_results.clear();
+		}
+
+		/**
+		 * @fn bool Write(bool retry = true)
+		 *
+		 * @param retry
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, single writes that fail are retried under their
+		 *    selector values while others succeed
+		 *  - Otherwise, single writes are made once, in order, as needed
+		 *    for index and value pairs that must not be separated
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if all writes succeeded
+		 *  - Otherwise, false
+		 *
+		 * <B> Write </B> applies all writes of the batch as a stacked write,
+		 * falling back to single writes for those that fail. The writes are
+		 * kept in the batch so that it can be written again.
+		 *
+		 * Failed writes do not throw; their reasons are reported in the
+		 * results (Arena::FeatureBatch::GetResults).
+		 */
+		bool Write(bool retry = true)
+		{
+			m_results.clear();
+			m_results.resize(m_items.size());
+
+			GenApi::AutoLock lock(m_pNodeMap->GetLock());
+
+			// features that do not exist are reported without being sent
+			std::vector<size_t> pending;
+			for (size_t i = 0; i < m_items.size(); i++)
+			{
+				m_results[i].name = m_items[i].name;
+				m_results[i].value = m_items[i].ToString();
+				m_results[i].written = false;
+
+				if (!m_pNodeMap->GetNode(m_items[i].name))
+					m_results[i].error = "Node not found";
+				else
+					pending.push_back(i);
+			}
+			if (pending.empty())
+				return m_items.empty();
+
+			// stacked write
+			try
+			{
+				GenApi::CNodeWriteConcatenator* pConcatenator = m_pNodeMap->NewNodeWriteConcatenator();
+				GenApi::CNodeWriteConcatenatorRef concatenator(pConcatenator);
+				for (size_t i = 0; i < pending.size(); i++)
+					m_items[pending[i]].AddTo(concatenator);
+
+				GenICam::gcstring_vector errors;
+				if (m_pNodeMap->ConcatenatedWrite(pConcatenator, true, &errors))
+				{
+					for (size_t i = 0; i < pending.size(); i++)
+						m_results[pending[i]].written = true;
+					return pending.size() == m_items.size();
+				}
+			}
+			catch (GenICam::GenericException&)
+			{
+				// fall through to single writes
+			}
+
+			// single writes, in order; a stacked write that failed part way
+			// is written over from the start
+			std::vector<size_t> failed;
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				FeatureBatchResult& result = m_results[pending[i]];
+				try
+				{
+					m_items[pending[i]].WriteTo(m_pNodeMap);
+					result.written = true;
+				}
+				catch (GenICam::GenericException& ge)
+				{
+					result.error = ge.GetDescription();
+					failed.push_back(pending[i]);
+				}
+			}
+
+			// retries, repeated while any succeeds, each under the selector
+			// values the write was added with
+			std::vector<size_t> reselected;
+			bool progress = retry && !failed.empty();
+			while (progress && !failed.empty())
+			{
+				progress = false;
+				std::vector<size_t> stillFailed;
+				for (size_t i = 0; i < failed.size(); i++)
+				{
+					FeatureBatchResult& result = m_results[failed[i]];
+					std::vector<size_t> selectors;
+					AddSelectorWrites(failed[i], selectors);
+					std::sort(selectors.begin(), selectors.end());
+					selectors.erase(std::unique(selectors.begin(), selectors.end()), selectors.end());
+					reselected.insert(reselected.end(), selectors.begin(), selectors.end());
+					try
+					{
+						for (size_t j = 0; j < selectors.size(); j++)
+							m_items[selectors[j]].WriteTo(m_pNodeMap);
+						m_items[failed[i]].WriteTo(m_pNodeMap);
+						result.written = true;
+						result.error = "";
+						progress = true;
+					}
+					catch (GenICam::GenericException& ge)
+					{
+						result.error = ge.GetDescription();
+						stillFailed.push_back(failed[i]);
+					}
+				}
+				failed.swap(stillFailed);
+			}
+
+			// selectors written again by retries are set back to their last
+			// values in the batch
+			std::vector<size_t> last;
+			for (size_t i = 0; i < reselected.size(); i++)
+			{
+				for (size_t j = m_items.size(); j-- > 0;)
+				{
+					if (m_items[j].name == m_items[reselected[i]].name && m_results[j].written)
+					{
+						last.push_back(j);
+						break;
+					}
+				}
+			}
+			std::sort(last.begin(), last.end());
+			last.erase(std::unique(last.begin(), last.end()), last.end());
+			for (size_t i = 0; i < last.size(); i++)
+			{
+				try
+				{
+					m_items[last[i]].WriteTo(m_pNodeMap);
+				}
+				catch (GenICam::GenericException& ge)
+				{
+					m_results[last[i]].written = false;
+					m_results[last[i]].error = ge.GetDescription();
+				}
+			}
+
+			for (size_t i = 0; i < m_results.size(); i++)
+			{
+				if (!m_results[i].written)
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * @fn const std::vector<FeatureBatchResult>& GetResults()
+		 *
+		 * @return
+		 *  - Type: const std::vector<Arena::FeatureBatchResult>&
+		 *  - Results of the last write, in the order the writes were added
+		 */
+		const std::vector<FeatureBatchResult>& GetResults() const
+		{
+			return m_results;
+		}
+
+	private:
+		// adds the latest writes before an item of the selectors of its
+		// feature, and of their selectors
+		void AddSelectorWrites(size_t index, std::vector<size_t>& writes) const
+		{
+			GenApi::CSelectorPtr pSelected = m_pNodeMap->GetNode(m_items[index].name);
+			if (!pSelected)
+				return;
+
+			GenApi::FeatureList_t selectors;
+			pSelected->GetSelectingFeatures(selectors);
+			for (size_t i = 0; i < selectors.size(); i++)
+			{
+				GenICam::gcstring name = selectors[i]->GetNode()->GetName();
+				for (size_t j = index; j-- > 0;)
+				{
+					if (m_items[j].name == name && m_results[j].written)
+					{
+						if (std::find(writes.begin(), writes.end(), j) == writes.end())
+						{
+							writes.push_back(j);
+							AddSelectorWrites(j, writes);
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		enum Type
+		{
+			String,
+			Integer,
+			Float,
+			Boolean
+		};
+
+		struct Item
+		{
+			GenICam::gcstring name;
+			Type type;
+			GenICam::gcstring stringValue;
+			int64_t integerValue;
+			double floatValue;
+			bool booleanValue;
+
+			GenICam::gcstring ToString() const
+			{
+				std::ostringstream value;
+				value.precision(17);
+				switch (type)
+				{
+				case Integer:
+					value << integerValue;
+					break;
+				case Float:
+					value << floatValue;
+					break;
+				case Boolean:
+					value << (booleanValue ? "1" : "0");
+					break;
+				default:
+					return stringValue;
+				}
+				return value.str().c_str();
+			}
+
+			void AddTo(GenApi::CNodeWriteConcatenatorRef& concatenator) const
+			{
+				switch (type)
+				{
+				case Integer:
+					concatenator._Add(name, integerValue);
+					break;
+				case Float:
+					concatenator._Add(name, floatValue);
+					break;
+				case Boolean:
+					concatenator._Add(name, booleanValue);
+					break;
+				default:
+					concatenator._Add(name, stringValue);
+					break;
+				}
+			}
+
+			void WriteTo(GenApi::INodeMap* pNodeMap) const
+			{
+				GenApi::INode* pNode = pNodeMap->GetNode(name);
+				switch (type)
+				{
+				case Integer:
+				{
+					GenApi::CIntegerPtr pInteger = pNode;
+					GenApi::CEnumerationPtr pEnumeration = pNode;
+					if (pInteger)
+						pInteger->SetValue(integerValue);
+					else if (pEnumeration)
+						pEnumeration->SetIntValue(integerValue);
+					else
+						throw GenICam::GenericException("Node is not an integer", __FILE__, __LINE__);
+					break;
+				}
+				case Float:
+				{
+					GenApi::CFloatPtr pFloat = pNode;
+					if (!pFloat)
+						throw GenICam::GenericException("Node is not a float", __FILE__, __LINE__);
+					pFloat->SetValue(floatValue);
+					break;
+				}
+				case Boolean:
+				{
+					GenApi::CBooleanPtr pBoolean = pNode;
+					if (!pBoolean)
+						throw GenICam::GenericException("Node is not a boolean", __FILE__, __LINE__);
+					pBoolean->SetValue(booleanValue);
+					break;
+				}
+				default:
+				{
+					GenApi::CValuePtr pValue = pNode;
+					if (!pValue)
+						throw GenICam::GenericException("Node has no value", __FILE__, __LINE__);
+					pValue->FromString(stringValue);
+					break;
+				}
+				}
+			}
+		};
+
+		GenApi::INodeMap* m_pNodeMap;
+		std::vector<Item> m_items;
+		std::vector<FeatureBatchResult> m_results;
+	};
+} // namespace Arena
@@ -0,0 +1,477 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file FeatureSnapshot.h
+ * This file defines in-memory snapshots of streamable features.
+ */
+
+#pragma once
+
+#include "FeatureBatch.h"
+
+#include <algorithm>
+#include <map>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+namespace Arena
+{
+	/**
+	 * @class FeatureSnapshot
+	 *
+	 * A <B> FeatureSnapshot </B> holds the values of the streamable features
+	 * of a node map (GenApi::INodeMap) in memory. It holds the same writes as
+	 * a feature stream (Arena::FeatureStream) would save to a file, in the
+	 * same order: selectors are written before the features they select, and
+	 * are replayed for each of their values.
+	 *
+	 * Two snapshots can be compared (Arena::FeatureSnapshot::Diff) to get
+	 * only the writes that turn one into the other. Applying a snapshot
+	 * (Arena::FeatureSnapshot::Apply) writes it as a feature batch
+	 * (Arena::FeatureBatch), so that the device receives stacked writes.
+	 *
+	 * \code{.cpp}
+	 * 	// switching from one recipe to another, writing only what changed
+	 * 	{
+	 * 		Arena::FeatureSnapshot current(pNodeMap);
+	 * 		Arena::FeatureSnapshot diff = current.Diff(recipe);
+	 * 		diff.Apply(pNodeMap);
+	 * 	}
+	 * \endcode
+	 *
+	 * Snapshots can be kept in a compact binary form
+	 * (Arena::FeatureSnapshot::Save, Arena::FeatureSnapshot::Load), for
+	 * example to store recipes.
+	 *
+	 * @warning
+	 *  - Not all features are streamable
+	 *  - Capturing a snapshot changes selectors while it replays them
+	 *
+	 * @see
+	 *  - Arena::FeatureStream
+	 *  - Arena::FeatureBatch
+	 */
+	class FeatureSnapshot
+	{
+	public:
+		/**
+		 * @fn FeatureSnapshot()
+		 *
+		 * A constructor, creating an empty snapshot.
+		 */
+		FeatureSnapshot()
+		{
+		}
+
+		/**
+		 * @fn FeatureSnapshot(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to capture
+		 *
+		 * A constructor, capturing a node map (Arena::FeatureSnapshot::Capture).
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		explicit FeatureSnapshot(GenApi::INodeMap* pNodeMap)
+		{
+			Capture(pNodeMap);
+		}
+
+		/**
+		 * @fn void Capture(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to capture
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Capture </B> replaces the contents of the snapshot with the
+		 * current values of all streamable features of a node map.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Capture(GenApi::INodeMap* pNodeMap)
+		{
+			m_entries.clear();
+
+			GenApi::AutoLock lock(pNodeMap->GetLock());
+
+			GenApi::CFeatureBag bag;
+			bag.StoreToBag(pNodeMap);
+
+			std::stringstream stream;
+			stream << bag;
+
+			std::string line;
+			while (std::getline(stream, line))
+			{
+				if (line.empty() || line[0] == '#')
+					continue;
+
+				size_t tab = line.find('\t');
+				if (tab == std::string::npos)
+					continue;
+
+				Entry entry;
+				entry.name = line.substr(0, tab).c_str();
+				entry.value = line.substr(tab + 1).c_str();
+
+				GenApi::CSelectorPtr pSelector = pNodeMap->GetNode(entry.name);
+				entry.selector = pSelector && pSelector->IsSelector();
+				m_entries.push_back(entry);
+			}
+		}
+
+		/**
+		 * @fn size_t GetSize()
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of writes in the snapshot
+		 */
+		size_t GetSize() const
+		{
+			return m_entries.size();
+		}
+
+		/**
+		 * @fn bool GetValue(const GenICam::gcstring& name, GenICam::gcstring& value)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @param value
+		 *  - Type: GenICam::gcstring&
+		 *  - Receives the value, as a string
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the snapshot holds the feature
+		 *  - Otherwise, false
+		 *
+		 * <B> GetValue </B> gets the last value written to a feature by the
+		 * snapshot. For selectors, this is the value they are left at.
+		 */
+		bool GetValue(const GenICam::gcstring& name, GenICam::gcstring& value) const
+		{
+			for (size_t i = m_entries.size(); i > 0; i--)
+			{
+				if (m_entries[i - 1].name == name)
+				{
+					value = m_entries[i - 1].value;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * @fn FeatureSnapshot Diff(const FeatureSnapshot& target)
+		 *
+		 * @param target
+		 *  - Type: const Arena::FeatureSnapshot&
+		 *  - Snapshot to change to
+		 *
+		 * @return
+		 *  - Type: Arena::FeatureSnapshot
+		 *  - Writes that change this snapshot into the target
+		 *
+		 * <B> Diff </B> compares this snapshot with a target and returns
+		 * the writes of the target whose values differ, in the order of the
+		 * target.
+		 *
+		 * Features under a selector are matched by the number of times they
+		 * appear, so that each selected value is compared with the same
+		 * selected value. Before each changed feature, the diff sets the
+		 * selectors it depends on; at the end, it leaves each selector at the
+		 * value of the target.
+		 */
+		FeatureSnapshot Diff(const FeatureSnapshot& target) const
+		{
+			std::map<std::pair<GenICam::gcstring, size_t>, GenICam::gcstring> base;
+			std::map<GenICam::gcstring, GenICam::gcstring> baseSelectors;
+			std::map<GenICam::gcstring, size_t> occurrences;
+			for (size_t i = 0; i < m_entries.size(); i++)
+			{
+				const Entry& entry = m_entries[i];
+				if (entry.selector)
+					baseSelectors[entry.name] = entry.value;
+				else
+					base[std::make_pair(entry.name, occurrences[entry.name]++)] = entry.value;
+			}
+
+			FeatureSnapshot diff;
+			std::map<GenICam::gcstring, GenICam::gcstring> targetSelectors;
+			std::map<GenICam::gcstring, GenICam::gcstring> writtenSelectors;
+			std::vector<GenICam::gcstring> selectorOrder;
+			occurrences.clear();
+			for (size_t i = 0; i < target.m_entries.size(); i++)
+			{
+				const Entry& entry = target.m_entries[i];
+				if (entry.selector)
+				{
+					if (targetSelectors.find(entry.name) == targetSelectors.end())
+						selectorOrder.push_back(entry.name);
+					targetSelectors[entry.name] = entry.value;
+					continue;
+				}
+
+				std::map<std::pair<GenICam::gcstring, size_t>, GenICam::gcstring>::const_iterator it = base.find(std::make_pair(entry.name, occurrences[entry.name]++));
+				if (it != base.end() && it->second == entry.value)
+					continue;
+
+				// selectors are written lazily, only ahead of changed features
+				for (size_t j = 0; j < selectorOrder.size(); j++)
+				{
+					const GenICam::gcstring& selector = selectorOrder[j];
+					std::map<GenICam::gcstring, GenICam::gcstring>::const_iterator written = writtenSelectors.find(selector);
+					if (written == writtenSelectors.end() || written->second != targetSelectors[selector])
+					{
+						diff.m_entries.push_back(Entry(selector, targetSelectors[selector], true));
+						writtenSelectors[selector] = targetSelectors[selector];
+					}
+				}
+				diff.m_entries.push_back(entry);
+			}
+
+			for (size_t j = 0; j < selectorOrder.size(); j++)
+			{
+				const GenICam::gcstring& selector = selectorOrder[j];
+				std::map<GenICam::gcstring, GenICam::gcstring>::const_iterator written = writtenSelectors.find(selector);
+				std::map<GenICam::gcstring, GenICam::gcstring>::const_iterator previous = baseSelectors.find(selector);
+				bool changed = previous == baseSelectors.end() || previous->second != targetSelectors[selector];
+				if (written != writtenSelectors.end() ? written->second != targetSelectors[selector] : changed)
+					diff.m_entries.push_back(Entry(selector, targetSelectors[selector], true));
+			}
+			return diff;
+		}
+
+		/**
+		 * @fn bool Apply(GenApi::INodeMap* pNodeMap, std::vector<FeatureBatchResult>* pResults = NULL)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to write to
+		 *
+		 * @param pResults
+		 *  - Type: std::vector<Arena::FeatureBatchResult>*
+		 *  - Default: NULL
+		 *  - Receives the result of each write, if not NULL
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if all writes succeeded
+		 *  - Otherwise, false
+		 *
+		 * <B> Apply </B> writes the snapshot to a node map as a feature batch
+		 * (Arena::FeatureBatch::Write). Applying a diff writes only the
+		 * features that changed; applying a captured snapshot restores all
+		 * of its features. Writes that fail are retried after the writes of
+		 * their selectors that come before them, so that selected features
+		 * keep their selector values.
+		 *
+		 * @see
+		 *  - Arena::FeatureBatch
+		 */
+		bool Apply(GenApi::INodeMap* pNodeMap, std::vector<FeatureBatchResult>* pResults = NULL) const
+		{
+			FeatureBatch batch(pNodeMap);
+			for (size_t i = 0; i < m_entries.size(); i++)
+				batch.Add(m_entries[i].name, m_entries[i].value);
+
+			bool written = batch.Write();
+			if (pResults)
+				*pResults = batch.GetResults();
+			return written;
+		}
+
+		/**
+		 * @fn void Save(std::ostream& os)
+		 *
+		 * @param os
+		 *  - Type: std::ostream&
+		 *  - Binary stream to save to
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Save </B> writes the snapshot in a compact binary form. Feature
+		 * names are stored once and referred to by index, and lengths are
+		 * stored as variable-length integers.
+		 *
+		 * @see
+		 *  - Arena::FeatureSnapshot::Load
+		 */
+		void Save(std::ostream& os) const
+		{
+			std::vector<GenICam::gcstring> names;
+			std::map<GenICam::gcstring, uint64_t> indices;
+			for (size_t i = 0; i < m_entries.size(); i++)
+			{
+				if (indices.find(m_entries[i].name) == indices.end())
+				{
+					indices[m_entries[i].name] = names.size();
+					names.push_back(m_entries[i].name);
+				}
+			}
+
+			os.write(SnapshotMagic(), 4);
+			WriteVarint(os, SnapshotVersion);
+			WriteVarint(os, names.size());
+			for (size_t i = 0; i < names.size(); i++)
+				WriteString(os, names[i]);
+
+			WriteVarint(os, m_entries.size());
+			for (size_t i = 0; i < m_entries.size(); i++)
+			{
+				// the lowest bit marks selectors
+				WriteVarint(os, (indices[m_entries[i].name] << 1) | (m_entries[i].selector ? 1 : 0));
+				WriteString(os, m_entries[i].value);
+			}
+		}
+
+		/**
+		 * @fn void Load(std::istream& is)
+		 *
+		 * @param is
+		 *  - Type: std::istream&
+		 *  - Binary stream to load from
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Load </B> replaces the contents of the snapshot with one saved
+		 * in binary form (Arena::FeatureSnapshot::Save).
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Load(std::istream& is)
+		{
+			char magic[4] = {0};
+			is.read(magic, 4);
+			if (!is || std::string(magic, 4) != std::string(SnapshotMagic(), 4))
+				throw GenICam::GenericException("Stream is not a feature snapshot", __FILE__, __LINE__);
+			if (ReadVarint(is) != SnapshotVersion)
+				throw GenICam::GenericException("Unsupported feature snapshot version", __FILE__, __LINE__);
+
+			// counts come from the stream, so the vectors grow as items are
+			// read rather than being sized up front
+			uint64_t nameCount = ReadVarint(is);
+			std::vector<GenICam::gcstring> names;
+			names.reserve(static_cast<size_t>(std::min<uint64_t>(nameCount, 1024)));
+			for (uint64_t i = 0; i < nameCount; i++)
+				names.push_back(ReadString(is));
+
+			uint64_t entryCount = ReadVarint(is);
+			std::vector<Entry> entries;
+			entries.reserve(static_cast<size_t>(std::min<uint64_t>(entryCount, 1024)));
+			for (uint64_t i = 0; i < entryCount; i++)
+			{
+				uint64_t key = ReadVarint(is);
+				if ((key >> 1) >= names.size())
+					throw GenICam::GenericException("Feature snapshot is corrupt", __FILE__, __LINE__);
+
+				GenICam::gcstring value = ReadString(is);
+				entries.push_back(Entry(names[static_cast<size_t>(key >> 1)], value, (key & 1) != 0));
+			}
+			m_entries.swap(entries);
+		}
+
+	private:
+		struct Entry
+		{
+			GenICam::gcstring name;
+			GenICam::gcstring value;
+			bool selector;
+
+			Entry() :
+				selector(false)
+			{
+			}
+
+			Entry(const GenICam::gcstring& entryName, const GenICam::gcstring& entryValue, bool entrySelector) :
+				name(entryName),
+				value(entryValue),
+				selector(entrySelector)
+			{
+			}
+		};
+
+		static const uint64_t SnapshotVersion = 1;
+
+		static const char* SnapshotMagic()
+		{
+			return "AFSS";
+		}
+
+		static void WriteVarint(std::ostream& os, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				os.put(static_cast<char>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+			os.put(static_cast<char>(value));
+		}
+
+		static uint64_t ReadVarint(std::istream& is)
+		{
+			uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				int byte = is.get();
+				if (byte == std::char_traits<char>::eof())
+					throw GenICam::GenericException("Feature snapshot is truncated", __FILE__, __LINE__);
+
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return value;
+			}
+			throw GenICam::GenericException("Feature snapshot is corrupt", __FILE__, __LINE__);
+		}
+
+		static void WriteString(std::ostream& os, const GenICam::gcstring& value)
+		{
+			WriteVarint(os, value.size());
+			os.write(value.c_str(), static_cast<std::streamsize>(value.size()));
+		}
+
+		static GenICam::gcstring ReadString(std::istream& is)
+		{
+			uint64_t size = ReadVarint(is);
+			std::string value;
+			while (value.size() < size)
+			{
+				char buffer[256];
+				size_t count = static_cast<size_t>(std::min<uint64_t>(sizeof(buffer), size - value.size()));
+				if (!is.read(buffer, static_cast<std::streamsize>(count)))
+					throw GenICam::GenericException("Feature snapshot is truncated", __FILE__, __LINE__);
+				value.append(buffer, count);
+			}
+			return value.c_str();
+		}
+
+		std::vector<Entry> m_entries;
+	};
+} // namespace Arena
@@ -0,0 +1,241 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file LUT.h
+ * This file defines bulk access to the lookup table.
+ */
+
+#pragma once
+
+#include "FeatureBatch.h"
+
+#include <vector>
+
+namespace Arena
+{
+	namespace Internal
+	{
+		// size and byte order of the entries of 'LUTValueAll', if the device
+		// provides it for the given number of entries
+		inline bool GetLUTValueAll(GenApi::INodeMap* pNodeMap, int64_t numEntries, GenApi::IRegister*& pValueAll, int64_t& entrySize, bool& bigEndian)
+		{
+			GenApi::INode* pNode = pNodeMap->GetNode("LUTValueAll");
+			pValueAll = dynamic_cast<GenApi::IRegister*>(pNode);
+			if (!pValueAll || !GenApi::IsAvailable(pNode) || numEntries <= 0)
+				return false;
+
+			int64_t length = pValueAll->GetLength();
+			if (length % numEntries != 0)
+				return false;
+
+			entrySize = length / numEntries;
+			if (entrySize != 2 && entrySize != 4)
+				return false;
+
+			GenICam::gcstring endianess;
+			GenICam::gcstring attribute;
+			bigEndian = pNode->GetProperty("Endianess", endianess, attribute) && endianess == "BigEndian";
+			return true;
+		}
+	} // namespace Internal
+
+	/**
+	 * @fn inline void SetLUT(GenApi::INodeMap* pNodeMap, const uint16_t* pTable, size_t numEntries)
+	 *
+	 * @param pNodeMap
+	 *  - Type: GenApi::INodeMap*
+	 *  - Node map of the device
+	 *
+	 * @param pTable
+	 *  - Type: const uint16_t*
+	 *  - Values to substitute, starting at index 0
+	 *
+	 * @param numEntries
+	 *  - Type: size_t
+	 *  - Number of values
+	 *  - At most the number of entries of the lookup table ('LUTIndex'
+	 *    maximum + 1)
+	 *
+	 * @return
+	 *  - none
+	 *
+	 * <B> SetLUT </B> uploads the lookup table currently selected
+	 * ('LUTSelector') in bulk, instead of selecting each index ('LUTIndex')
+	 * and setting its value ('LUTValue') one register at a time.
+	 *
+	 * If the device provides the whole table as a register ('LUTValueAll'),
+	 * the table is written as a single block of memory. Otherwise, the
+	 * index and value writes are sent as stacked writes
+	 * (Arena::FeatureBatch), so that each packet carries many entries, and
+	 * 'LUTIndex' is set back to where it was.
+	 *
+	 * \code{.cpp}
+	 * 	// inverting a 12-bit lookup table
+	 * 	{
+	 * 		std::vector<uint16_t> table(4096);
+	 * 		for (size_t i = 0; i < table.size(); i++)
+	 * 			table[i] = static_cast<uint16_t>(4095 - i);
+	 * 		Arena::SetLUT(pNodeMap, &table[0], table.size());
+	 * 	}
+	 * \endcode
+	 *
+	 * @warning
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *
+	 * @see
+	 *  - Arena::GetLUT
+	 *  - Arena::FeatureBatch
+	 */
+	inline void SetLUT(GenApi::INodeMap* pNodeMap, const uint16_t* pTable, size_t numEntries)
+	{
+		GenApi::CIntegerPtr pLUTIndex = pNodeMap->GetNode("LUTIndex");
+		if (!pLUTIndex || !pNodeMap->GetNode("LUTValue"))
+			throw GenICam::GenericException("Requisite node(s) LUTIndex and/or LUTValue do(es) not exist", __FILE__, __LINE__);
+
+		int64_t tableSize = pLUTIndex->GetMax() + 1;
+		if (static_cast<int64_t>(numEntries) > tableSize)
+			throw GenICam::GenericException("Number of entries exceeds the size of the lookup table", __FILE__, __LINE__);
+
+		GenApi::IRegister* pValueAll = NULL;
+		int64_t entrySize = 0;
+		bool bigEndian = false;
+		if (Internal::GetLUTValueAll(pNodeMap, tableSize, pValueAll, entrySize, bigEndian))
+		{
+			std::vector<uint8_t> buffer(static_cast<size_t>(tableSize * entrySize));
+
+			// a partial table keeps the remaining entries
+			if (static_cast<int64_t>(numEntries) < tableSize)
+				pValueAll->Get(&buffer[0], static_cast<int64_t>(buffer.size()));
+
+			for (size_t i = 0; i < numEntries; i++)
+			{
+				uint8_t* pEntry = &buffer[i * static_cast<size_t>(entrySize)];
+				for (int64_t b = 0; b < entrySize; b++)
+					pEntry[bigEndian ? entrySize - 1 - b : b] = static_cast<uint8_t>(b < 2 ? pTable[i] >> (8 * b) : 0);
+			}
+			pValueAll->Set(&buffer[0], static_cast<int64_t>(buffer.size()));
+			return;
+		}
+
+		GenApi::AutoLock lock(pNodeMap->GetLock());
+		FeatureBatch batch(pNodeMap);
+		for (size_t i = 0; i < numEntries; i++)
+		{
+			batch.Add("LUTIndex", static_cast<int64_t>(i));
+			batch.Add("LUTValue", static_cast<int64_t>(pTable[i]));
+		}
+		batch.Add("LUTIndex", pLUTIndex->GetValue());
+
+		// written in order without retries if the stacked write fails, so
+		// that values never land under another index and the index is
+		// restored last
+		if (!batch.Write(false))
+		{
+			const std::vector<FeatureBatchResult>& results = batch.GetResults();
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				if (!results[i].written)
+					throw GenICam::GenericException(("Unable to set " + results[i].name + " to " + results[i].value + ": " + results[i].error).c_str(), __FILE__, __LINE__);
+			}
+		}
+	}
+
+	/**
+	 * @fn inline void GetLUT(GenApi::INodeMap* pNodeMap, uint16_t* pTable, size_t numEntries)
+	 *
+	 * @param pNodeMap
+	 *  - Type: GenApi::INodeMap*
+	 *  - Node map of the device
+	 *
+	 * @param pTable
+	 *  - Type: uint16_t*
+	 *  - Buffer to receive the values, starting at index 0
+	 *
+	 * @param numEntries
+	 *  - Type: size_t
+	 *  - Number of values to read
+	 *  - At most the number of entries of the lookup table ('LUTIndex'
+	 *    maximum + 1)
+	 *
+	 * @return
+	 *  - none
+	 *
+	 * <B> GetLUT </B> downloads the lookup table currently selected
+	 * ('LUTSelector'). If the device provides the whole table as a register
+	 * ('LUTValueAll'), it is read as a single block of memory, from the node
+	 * map's cache while it is valid; otherwise each entry is selected and
+	 * read in turn, and 'LUTIndex' is set back to where it was.
+	 *
+	 * @warning
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *  - Without 'LUTValueAll', reading takes a register access per entry
+	 *
+	 * @see
+	 *  - Arena::SetLUT
+	 */
+	inline void GetLUT(GenApi::INodeMap* pNodeMap, uint16_t* pTable, size_t numEntries)
+	{
+		GenApi::CIntegerPtr pLUTIndex = pNodeMap->GetNode("LUTIndex");
+		GenApi::CIntegerPtr pLUTValue = pNodeMap->GetNode("LUTValue");
+		if (!pLUTIndex || !pLUTValue)
+			throw GenICam::GenericException("Requisite node(s) LUTIndex and/or LUTValue do(es) not exist", __FILE__, __LINE__);
+
+		int64_t tableSize = pLUTIndex->GetMax() + 1;
+		if (static_cast<int64_t>(numEntries) > tableSize)
+			throw GenICam::GenericException("Number of entries exceeds the size of the lookup table", __FILE__, __LINE__);
+
+		GenApi::IRegister* pValueAll = NULL;
+		int64_t entrySize = 0;
+		bool bigEndian = false;
+		if (Internal::GetLUTValueAll(pNodeMap, tableSize, pValueAll, entrySize, bigEndian))
+		{
+			std::vector<uint8_t> buffer(static_cast<size_t>(tableSize * entrySize));
+			pValueAll->Get(&buffer[0], static_cast<int64_t>(buffer.size()));
+
+			for (size_t i = 0; i < numEntries; i++)
+			{
+				const uint8_t* pEntry = &buffer[i * static_cast<size_t>(entrySize)];
+				uint16_t value = 0;
+				for (int64_t b = 0; b < 2; b++)
+					value |= static_cast<uint16_t>(pEntry[bigEndian ? entrySize - 1 - b : b] << (8 * b));
+				pTable[i] = value;
+			}
+			return;
+		}
+
+		GenApi::AutoLock lock(pNodeMap->GetLock());
+		int64_t indexInitial = pLUTIndex->GetValue();
+		try
+		{
+			for (size_t i = 0; i < numEntries; i++)
+			{
+				pLUTIndex->SetValue(static_cast<int64_t>(i));
+				pTable[i] = static_cast<uint16_t>(pLUTValue->GetValue());
+			}
+		}
+		catch (...)
+		{
+			try
+			{
+				pLUTIndex->SetValue(indexInitial);
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+			throw;
+		}
+		pLUTIndex->SetValue(indexInitial);
+	}
+} // namespace Arena
@@ -0,0 +1,178 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file NodeMapCache.h
+ * This file defines the persistent cache of preprocessed node map XMLs.
+ */
+
+#pragma once
+
+#include <GenICam.h>
+#include <Base/GCUtilities.h>
+
+#include <string>
+#include <cstdlib>
+#include <cerrno>
+
+#if defined _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace Arena
+{
+	namespace Internal
+	{
+		// creates a folder and its parents, succeeding if it already exists
+		inline bool MakeFolders(const std::string& path)
+		{
+			for (size_t pos = 1; pos <= path.size(); pos++)
+			{
+				if (pos != path.size() && path[pos] != '/' && path[pos] != '\\')
+					continue;
+
+				std::string folder = path.substr(0, pos);
+#if defined _WIN32
+				int result = _mkdir(folder.c_str());
+#else
+				int result = mkdir(folder.c_str(), 0755);
+#endif
+				if (result != 0 && errno != EEXIST)
+					return false;
+			}
+			return true;
+		}
+	} // namespace Internal
+
+	/**
+	 * @fn inline GenICam::gcstring GetDefaultNodeMapCacheFolder()
+	 *
+	 * @return
+	 *  - Type: GenICam::gcstring
+	 *  - Default folder of the node map cache
+	 *
+	 * <B> GetDefaultNodeMapCacheFolder </B> retrieves the per-user folder
+	 * used by Arena::EnableNodeMapCache when no folder is given:
+	 *  - Linux: $XDG_CACHE_HOME/ArenaSDK/GenICam_v<major>_<minor>, or
+	 *    $HOME/.cache/ArenaSDK/GenICam_v<major>_<minor>
+	 *  - Windows: %LOCALAPPDATA%\\ArenaSDK\\GenICam_v<major>_<minor>
+	 *
+	 * The GenICam version is part of the folder, so that node maps
+	 * preprocessed by another version of GenApi are never loaded.
+	 *
+	 * @see
+	 *  - Arena::EnableNodeMapCache
+	 */
+	inline GenICam::gcstring GetDefaultNodeMapCacheFolder()
+	{
+		std::string folder;
+#if defined _WIN32
+		const char* pLocalAppData = getenv("LOCALAPPDATA");
+		folder = std::string(pLocalAppData ? pLocalAppData : ".") + "\\ArenaSDK\\";
+#else
+		const char* pCacheHome = getenv("XDG_CACHE_HOME");
+		const char* pHome = getenv("HOME");
+		if (pCacheHome && pCacheHome[0] == '/')
+			folder = std::string(pCacheHome) + "/ArenaSDK/";
+		else if (pHome && pHome[0])
+			folder = std::string(pHome) + "/.cache/ArenaSDK/";
+		else
+			folder = "/tmp/ArenaSDK/";
+#endif
+		folder += "GenICam_v" GENICAM_VERSION_MAJOR_STR "_" GENICAM_VERSION_MINOR_STR;
+		return GenICam::gcstring(folder.c_str());
+	}
+
+	/**
+	 * @fn inline void EnableNodeMapCache(const char* pFolder = NULL)
+	 *
+	 * @param pFolder
+	 *  - Type: const char*
+	 *  - Default: NULL
+	 *  - Folder to keep the cache in
+	 *  - NULL uses the default folder (Arena::GetDefaultNodeMapCacheFolder)
+	 *
+	 * @return
+	 *  - none
+	 *
+	 * <B> EnableNodeMapCache </B> enables the GenICam cache of preprocessed
+	 * XMLs in a persistent folder, creating the folder if needed.
+	 *
+	 * Building a node map parses and preprocesses the device's XML, which
+	 * takes most of the time spent creating a device
+	 * (Arena::ISystem::CreateDevice). With the cache enabled, the first
+	 * device of each model and firmware stores its preprocessed node graph,
+	 * keyed by the hash of its XML; every following device with an identical
+	 * XML, in this or any later process, loads the node graph from the cache
+	 * instead. The XML itself is still read from the device, as it is the only
+	 * way to know that it has not changed.
+	 *
+	 * \code{.cpp}
+	 * 	// enabling the cache before opening the system
+	 * 	{
+	 * 		Arena::EnableNodeMapCache();
+	 * 		Arena::ISystem* pSystem = Arena::OpenSystem();
+	 * 		// ...
+	 * 	}
+	 * \endcode
+	 *
+	 * @warning
+	 *  - Call before opening the system (Arena::OpenSystem)
+	 *  - Sets the cache folder of the process (GenICam::SetGenICamCacheFolder)
+	 *  - May throw GenICam::GenericException or other derived exception
+	 *
+	 * @see
+	 *  - Arena::GetDefaultNodeMapCacheFolder
+	 *  - Arena::IsNodeMapCacheEnabled
+	 */
+	inline void EnableNodeMapCache(const char* pFolder = NULL)
+	{
+		GenICam::gcstring folder = pFolder ? GenICam::gcstring(pFolder) : GetDefaultNodeMapCacheFolder();
+		if (!Internal::MakeFolders(folder.c_str()))
+			throw GenICam::GenericException(("Unable to create node map cache folder " + folder).c_str(), __FILE__, __LINE__);
+
+		GenICam::SetGenICamCacheFolder(folder);
+	}
+
+	/**
+	 * @fn inline bool IsNodeMapCacheEnabled()
+	 *
+	 * @return
+	 *  - Type: bool
+	 *  - True if a cache folder is set
+	 *  - Otherwise, false
+	 *
+	 * <B> IsNodeMapCacheEnabled </B> checks whether the GenICam cache is
+	 * enabled, either by Arena::EnableNodeMapCache or by the GENICAM_CACHE
+	 * environment variable of the GenICam version.
+	 *
+	 * @see
+	 *  - Arena::EnableNodeMapCache
+	 */
+	inline bool IsNodeMapCacheEnabled()
+	{
+		try
+		{
+			return GenICam::GetGenICamCacheFolder().length() > 0;
+		}
+		catch (GenICam::GenericException&)
+		{
+			// thrown when neither set nor in the environment
+			return false;
+		}
+	}
+} // namespace Arena
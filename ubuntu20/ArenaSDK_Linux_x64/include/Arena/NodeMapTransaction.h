@@ -0,0 +1,701 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file NodeMapTransaction.h
+ * This file defines transactional writes of features.
+ */
+
+#pragma once
+
+#include <GenICam.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace Arena
+{
+	/**
+	 * @class NodeMapTransaction
+	 *
+	 * A <B> NodeMapTransaction </B> applies a set of feature writes to a node
+	 * map (GenApi::INodeMap) as a whole: either all of them are written, or
+	 * the features are restored to the values they had before.
+	 *
+	 * \code{.cpp}
+	 * 	// changing recipe
+	 * 	{
+	 * 		Arena::NodeMapTransaction transaction(pNodeMap);
+	 * 		transaction.Begin();
+	 * 		transaction.Set("OffsetX", 0);
+	 * 		transaction.Set("Width", 1024);
+	 * 		transaction.Set("PixelFormat", "Mono12");
+	 * 		transaction.Set("TriggerSelector", "FrameStart");
+	 * 		transaction.Set("TriggerMode", "On");
+	 * 		transaction.Commit();
+	 * 	}
+	 * \endcode
+	 *
+	 * Beginning a transaction (Arena::NodeMapTransaction::Begin) locks the
+	 * node map, so that other threads cannot change it until the
+	 * transaction is committed or rolled back. Writes are staged
+	 * (Arena::NodeMapTransaction::Set) and only sent to the device on
+	 * commit (Arena::NodeMapTransaction::Commit), which:
+	 *  - orders the writes so that selectors and other features come before
+	 *    the features that depend on them, keeping the order they were
+	 *    staged in otherwise
+	 *  - validates all writes that do not depend on other staged writes
+	 *    (access mode, minimum, maximum, increment and enumeration entries)
+	 *    before writing anything
+	 *  - reads the value of each feature before writing it, together with
+	 *    the values of its selectors, and writes these values back in
+	 *    reverse order, each under its selector values, if any write fails
+	 *
+	 * A selector may be staged several times, once for each value whose
+	 * selected features are written; each selected feature stays with the
+	 * selector value staged before it.
+	 *
+	 * @warning
+	 *  - Commands cannot be part of a transaction
+	 *  - Features that cannot be read cannot be restored
+	 *  - The node map stays locked while the transaction is active
+	 *
+	 * @see
+	 *  - Arena::FeatureBatch
+	 */
+	class NodeMapTransaction
+	{
+	public:
+		/**
+		 * @fn NodeMapTransaction(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map to write to
+		 *
+		 * A constructor.
+		 */
+		NodeMapTransaction(GenApi::INodeMap* pNodeMap) :
+			m_pNodeMap(pNodeMap),
+			m_active(false)
+		{
+		}
+
+		/**
+		 * @fn ~NodeMapTransaction()
+		 *
+		 * A destructor, rolling back an active transaction.
+		 */
+		~NodeMapTransaction()
+		{
+			if (m_active)
+				Rollback();
+		}
+
+		/**
+		 * @fn void Begin()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Begin </B> locks the node map and starts staging writes.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Begin()
+		{
+			if (m_active)
+				throw GenICam::GenericException("Transaction already active", __FILE__, __LINE__);
+
+			m_pNodeMap->GetLock().Lock();
+			m_items.clear();
+			m_active = true;
+		}
+
+		/**
+		 * @fn void Set(const GenICam::gcstring& name, const GenICam::gcstring& value)
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature
+		 *
+		 * @param value
+		 *  - Type: const GenICam::gcstring&
+		 *  - Value to write, as a string
+		 *  - Enumeration nodes use the name of the entry
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> stages a write. Overloads take integer, float and
+		 * boolean values.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Set(const GenICam::gcstring& name, const GenICam::gcstring& value)
+		{
+			if (!m_active)
+				throw GenICam::GenericException("Transaction not active", __FILE__, __LINE__);
+
+			Item item;
+			item.name = name;
+			item.value = value;
+			m_items.push_back(item);
+		}
+
+		void Set(const GenICam::gcstring& name, const char* value)
+		{
+			Set(name, GenICam::gcstring(value));
+		}
+
+		void Set(const GenICam::gcstring& name, int64_t value)
+		{
+			std::ostringstream stream;
+			stream << value;
+			Set(name, GenICam::gcstring(stream.str().c_str()));
+		}
+
+		void Set(const GenICam::gcstring& name, int value)
+		{
+			Set(name, static_cast<int64_t>(value));
+		}
+
+		void Set(const GenICam::gcstring& name, double value)
+		{
+			std::ostringstream stream;
+			stream.precision(17);
+			stream << value;
+			Set(name, GenICam::gcstring(stream.str().c_str()));
+		}
+
+		void Set(const GenICam::gcstring& name, bool value)
+		{
+			Set(name, GenICam::gcstring(value ? "1" : "0"));
+		}
+
+		/**
+		 * @fn void Commit()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Commit </B> validates and writes the staged writes, then
+		 * unlocks the node map. If validation fails, nothing is written. If
+		 * a write fails, the features already written are restored. In both
+		 * cases, the transaction ends and an exception describes the
+		 * failure.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void Commit()
+		{
+			if (!m_active)
+				throw GenICam::GenericException("Transaction not active", __FILE__, __LINE__);
+
+			GenICam::gcstring error;
+			try
+			{
+				std::vector<size_t> order = Order();
+				error = Validate();
+				if (error.empty())
+					error = WriteAll(order);
+			}
+			catch (GenICam::GenericException& ge)
+			{
+				error = ge.GetDescription();
+			}
+
+			End();
+			if (!error.empty())
+				throw GenICam::GenericException(error.c_str(), __FILE__, __LINE__);
+		}
+
+		/**
+		 * @fn void Rollback()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Rollback </B> discards the staged writes and unlocks the node
+		 * map. Nothing is written to the device.
+		 */
+		void Rollback()
+		{
+			if (m_active)
+				End();
+		}
+
+		/**
+		 * @fn bool IsActive()
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the transaction has begun and is not yet committed or
+		 *    rolled back
+		 *  - Otherwise, false
+		 */
+		bool IsActive() const
+		{
+			return m_active;
+		}
+
+	private:
+		struct Item
+		{
+			GenICam::gcstring name;
+			GenICam::gcstring value;
+		};
+
+		struct Undo
+		{
+			GenICam::gcstring name;
+			GenICam::gcstring value;
+
+			// selector values the value was read under, outermost first
+			std::vector<Item> selectors;
+		};
+
+		GenApi::INodeMap* m_pNodeMap;
+		bool m_active;
+		std::vector<Item> m_items;
+
+		void End()
+		{
+			m_items.clear();
+			m_active = false;
+			m_pNodeMap->GetLock().Unlock();
+		}
+
+		// names of all nodes invalidated by a node, directly or indirectly
+		std::set<GenICam::gcstring> GetDependents(const GenICam::gcstring& name) const
+		{
+			std::set<GenICam::gcstring> dependents;
+			GenApi::INode* pNode = m_pNodeMap->GetNode(name);
+			if (pNode)
+			{
+				GenApi::NodeList_t nodes;
+				pNode->GetChildren(nodes, GenApi::ctDependingNodes);
+				for (GenApi::NodeList_t::iterator it = nodes.begin(); it != nodes.end(); it++)
+				{
+					if ((*it)->GetName() != name)
+						dependents.insert((*it)->GetName());
+				}
+			}
+			return dependents;
+		}
+
+		// indices of the items in the order to write them
+		std::vector<size_t> Order() const
+		{
+			size_t count = m_items.size();
+			std::vector<std::set<GenICam::gcstring> > dependents(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				bool known = false;
+				for (size_t j = 0; j < i && !known; j++)
+				{
+					if (m_items[j].name == m_items[i].name)
+					{
+						dependents[i] = dependents[j];
+						known = true;
+					}
+				}
+				if (!known)
+					dependents[i] = GetDependents(m_items[i].name);
+			}
+
+			// edges from each item to the items that must follow it
+			std::vector<std::set<size_t> > after(count);
+			for (size_t j = 0; j < count; j++)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					if (i == j)
+						continue;
+
+					if (m_items[i].name == m_items[j].name)
+					{
+						if (i < j)
+							after[i].insert(j);
+						continue;
+					}
+					if (!dependents[i].count(m_items[j].name))
+						continue;
+
+					// mutual dependencies keep the staged order
+					if (dependents[j].count(m_items[i].name) && j < i)
+						continue;
+
+					// an item follows the last write of a feature it depends on
+					// staged before it, or the first one staged after it
+					size_t source = count;
+					for (size_t k = 0; k < j; k++)
+					{
+						if (m_items[k].name == m_items[i].name)
+							source = k;
+					}
+					if (source == count)
+					{
+						for (size_t k = j + 1; k < count && source == count; k++)
+						{
+							if (m_items[k].name == m_items[i].name)
+								source = k;
+						}
+					}
+					if (source != i)
+						continue;
+
+					after[i].insert(j);
+
+					// and precedes the next write of that feature
+					for (size_t k = i + 1; k < count; k++)
+					{
+						if (m_items[k].name == m_items[i].name)
+						{
+							after[j].insert(k);
+							break;
+						}
+					}
+				}
+			}
+
+			std::vector<size_t> incoming(count, 0);
+			for (size_t i = 0; i < count; i++)
+			{
+				for (std::set<size_t>::const_iterator it = after[i].begin(); it != after[i].end(); it++)
+					incoming[*it]++;
+			}
+
+			// stable topological sort, breaking cycles in staged order
+			std::vector<size_t> order;
+			std::vector<bool> done(count, false);
+			while (order.size() < count)
+			{
+				size_t next = count;
+				for (size_t i = 0; i < count && next == count; i++)
+				{
+					if (!done[i] && incoming[i] == 0)
+						next = i;
+				}
+				for (size_t i = 0; i < count && next == count; i++)
+				{
+					if (!done[i])
+						next = i;
+				}
+
+				done[next] = true;
+				order.push_back(next);
+				for (std::set<size_t>::const_iterator it = after[next].begin(); it != after[next].end(); it++)
+				{
+					if (incoming[*it] > 0)
+						incoming[*it]--;
+				}
+			}
+			return order;
+		}
+
+		// validates the items whose limits do not depend on other items
+		GenICam::gcstring Validate() const
+		{
+			std::set<GenICam::gcstring> staged;
+			std::set<GenICam::gcstring> dependent;
+			for (size_t i = 0; i < m_items.size(); i++)
+				staged.insert(m_items[i].name);
+			for (std::set<GenICam::gcstring>::const_iterator it = staged.begin(); it != staged.end(); it++)
+			{
+				std::set<GenICam::gcstring> dependents = GetDependents(*it);
+				for (std::set<GenICam::gcstring>::const_iterator dep = dependents.begin(); dep != dependents.end(); dep++)
+					dependent.insert(*dep);
+			}
+
+			GenICam::gcstring errors;
+			for (size_t i = 0; i < m_items.size(); i++)
+			{
+				const Item& item = m_items[i];
+				GenICam::gcstring error = ValidateItem(item, dependent.count(item.name) != 0);
+				if (!error.empty())
+					errors += (errors.empty() ? "" : "; ") + item.name + ": " + error;
+			}
+			return errors;
+		}
+
+		GenICam::gcstring ValidateItem(const Item& item, bool dependent) const
+		{
+			GenApi::INode* pNode = m_pNodeMap->GetNode(item.name);
+			if (!pNode)
+				return "node not found";
+
+			GenApi::CCommandPtr pCommand = pNode;
+			GenApi::CValuePtr pValue = pNode;
+			if (pCommand || !pValue)
+				return "node cannot be part of a transaction";
+
+			if (dependent)
+				return "";
+
+			if (!GenApi::IsWritable(pNode))
+				return "node not writable";
+
+			GenApi::CIntegerPtr pInteger = pNode;
+			GenApi::CFloatPtr pFloat = pNode;
+			GenApi::CEnumerationPtr pEnumeration = pNode;
+			if (pInteger)
+			{
+				// values read from the node map are decimal, so a leading
+				// zero is not octal; hex needs an explicit 0x
+				const char* pText = item.value.c_str();
+				bool hex = pText[0] == '0' && (pText[1] == 'x' || pText[1] == 'X');
+				char* pEnd = NULL;
+				int64_t value = strtoll(pText, &pEnd, hex ? 16 : 10);
+				if (pEnd == pText || *pEnd != '\0')
+					return "value is not an integer";
+				if (value < pInteger->GetMin() || value > pInteger->GetMax())
+					return "value out of range";
+				if (pInteger->GetIncMode() == GenApi::fixedIncrement && pInteger->GetInc() > 0 && (value - pInteger->GetMin()) % pInteger->GetInc() != 0)
+					return "value does not match increment";
+			}
+			else if (pFloat)
+			{
+				char* pEnd = NULL;
+				double value = strtod(item.value.c_str(), &pEnd);
+				if (pEnd == item.value.c_str() || *pEnd != '\0')
+					return "value is not a float";
+				if (value < pFloat->GetMin() || value > pFloat->GetMax())
+					return "value out of range";
+			}
+			else if (pEnumeration)
+			{
+				GenApi::IEnumEntry* pEntry = pEnumeration->GetEntryByName(item.value);
+				if (!pEntry || !GenApi::IsAvailable(pEntry))
+					return "enumeration entry not available";
+			}
+			return "";
+		}
+
+		// names of the selectors of a feature, outermost first
+		void GetSelectors(const GenICam::gcstring& name, std::vector<GenICam::gcstring>& selectors) const
+		{
+			GenApi::CSelectorPtr pSelected = m_pNodeMap->GetNode(name);
+			if (!pSelected)
+				return;
+
+			GenApi::FeatureList_t features;
+			pSelected->GetSelectingFeatures(features);
+			for (size_t i = 0; i < features.size(); i++)
+			{
+				GenICam::gcstring selector = features[i]->GetNode()->GetName();
+				if (std::find(selectors.begin(), selectors.end(), selector) != selectors.end())
+					continue;
+
+				GetSelectors(selector, selectors);
+				if (std::find(selectors.begin(), selectors.end(), selector) == selectors.end())
+					selectors.push_back(selector);
+			}
+		}
+
+		// writes an item, keeping its previous value and the selector values
+		// it was read under
+		void WriteItem(const Item& item, std::vector<Undo>& undos)
+		{
+			GenApi::CValuePtr pValue = m_pNodeMap->GetNode(item.name);
+			Undo undo;
+			undo.name = item.name;
+			bool readable = GenApi::IsReadable(pValue);
+			if (readable)
+			{
+				undo.value = pValue->ToString();
+
+				std::vector<GenICam::gcstring> selectors;
+				GetSelectors(item.name, selectors);
+				for (size_t i = 0; i < selectors.size(); i++)
+				{
+					GenApi::CValuePtr pSelector = m_pNodeMap->GetNode(selectors[i]);
+					if (!GenApi::IsReadable(pSelector))
+						continue;
+
+					Item selector;
+					selector.name = selectors[i];
+					selector.value = pSelector->ToString();
+					undo.selectors.push_back(selector);
+				}
+			}
+
+			pValue->FromString(item.value, true);
+			if (readable)
+				undos.push_back(undo);
+		}
+
+		void WriteValue(const GenICam::gcstring& name, const GenICam::gcstring& value)
+		{
+			GenApi::CValuePtr pValue = m_pNodeMap->GetNode(name);
+			pValue->FromString(value, true);
+		}
+
+		GenICam::gcstring WriteAll(const std::vector<size_t>& order)
+		{
+			std::vector<Undo> undos;
+			std::vector<bool> written(order.size(), false);
+			std::vector<size_t> failed;
+			GenICam::gcstring error;
+
+			for (size_t i = 0; i < order.size(); i++)
+			{
+				const Item& item = m_items[order[i]];
+				try
+				{
+					WriteItem(item, undos);
+					written[i] = true;
+				}
+				catch (GenICam::GenericException& ge)
+				{
+					error = item.name + ": " + ge.GetDescription();
+					failed.push_back(i);
+				}
+			}
+
+			// failed writes are retried while others succeed, resolving
+			// limits that depend on each other; each is preceded by the
+			// writes of its selectors ordered before it, so that it lands
+			// under the selector values it was staged with
+			std::vector<GenICam::gcstring> reselected;
+			bool progress = !failed.empty();
+			while (progress && !failed.empty())
+			{
+				progress = false;
+				std::vector<size_t> stillFailed;
+				for (size_t i = 0; i < failed.size(); i++)
+				{
+					const Item& item = m_items[order[failed[i]]];
+					std::vector<GenICam::gcstring> selectors;
+					GetSelectors(item.name, selectors);
+					try
+					{
+						for (size_t j = 0; j < selectors.size(); j++)
+						{
+							for (size_t k = failed[i]; k-- > 0;)
+							{
+								if (written[k] && m_items[order[k]].name == selectors[j])
+								{
+									WriteValue(selectors[j], m_items[order[k]].value);
+									if (std::find(reselected.begin(), reselected.end(), selectors[j]) == reselected.end())
+										reselected.push_back(selectors[j]);
+									break;
+								}
+							}
+						}
+						WriteItem(item, undos);
+						written[failed[i]] = true;
+						progress = true;
+					}
+					catch (GenICam::GenericException& ge)
+					{
+						error = item.name + ": " + ge.GetDescription();
+						stillFailed.push_back(failed[i]);
+					}
+				}
+				failed.swap(stillFailed);
+			}
+
+			// selectors written again by retries are set back to their last
+			// staged values
+			for (size_t i = 0; i < reselected.size() && failed.empty(); i++)
+			{
+				for (size_t k = order.size(); k-- > 0;)
+				{
+					if (m_items[order[k]].name == reselected[i])
+					{
+						try
+						{
+							WriteValue(reselected[i], m_items[order[k]].value);
+						}
+						catch (GenICam::GenericException& ge)
+						{
+							error = reselected[i] + ": " + ge.GetDescription();
+							failed.push_back(k);
+						}
+						break;
+					}
+				}
+			}
+			if (failed.empty())
+				return "";
+
+			GenICam::gcstring restoreErrors = Restore(undos);
+			return "Transaction rolled back; " + error + (restoreErrors.empty() ? "" : "; unable to restore " + restoreErrors);
+		}
+
+		// writes the previous values back in reverse order, each under the
+		// selector values it was read under, then sets the selectors back to
+		// their values from before the transaction
+		GenICam::gcstring Restore(const std::vector<Undo>& undos)
+		{
+			GenICam::gcstring errors;
+			std::vector<Item> selectors;
+			for (size_t i = undos.size(); i-- > 0;)
+			{
+				try
+				{
+					for (size_t j = 0; j < undos[i].selectors.size(); j++)
+					{
+						WriteValue(undos[i].selectors[j].name, undos[i].selectors[j].value);
+
+						bool known = false;
+						for (size_t k = 0; k < selectors.size() && !known; k++)
+							known = selectors[k].name == undos[i].selectors[j].name;
+						if (!known)
+							selectors.push_back(undos[i].selectors[j]);
+					}
+					WriteValue(undos[i].name, undos[i].value);
+				}
+				catch (GenICam::GenericException&)
+				{
+					errors += (errors.empty() ? "" : ", ") + undos[i].name;
+				}
+			}
+
+			// the first value kept of a selector is from before the
+			// transaction; selectors that were not written kept their value
+			for (size_t i = 0; i < selectors.size(); i++)
+			{
+				GenICam::gcstring value = selectors[i].value;
+				for (size_t j = 0; j < undos.size(); j++)
+				{
+					if (undos[j].name == selectors[i].name)
+					{
+						value = undos[j].value;
+						break;
+					}
+				}
+				try
+				{
+					WriteValue(selectors[i].name, value);
+				}
+				catch (GenICam::GenericException&)
+				{
+					errors += (errors.empty() ? "" : ", ") + selectors[i].name;
+				}
+			}
+			return errors;
+		}
+
+		NodeMapTransaction(const NodeMapTransaction&);
+		NodeMapTransaction& operator=(const NodeMapTransaction&);
+	};
+} // namespace Arena
@@ -0,0 +1,767 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file ReconnectManager.h
+ * This file defines the automatic reconnection of a device.
+ */
+
+#pragma once
+
+#include "ISystem.h"
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+
+namespace Arena
+{
+	/**
+	 * @struct ReconnectStatistics
+	 *
+	 * Statistics of the disconnections handled by a reconnect manager
+	 * (Arena::ReconnectManager).
+	 *
+	 * @see
+	 *  - Arena::ReconnectManager::GetStatistics
+	 */
+	struct ReconnectStatistics
+	{
+		/** number of disconnections */
+		uint64_t disconnections;
+		/** number of successful reconnections */
+		uint64_t reconnections;
+		/** time from the last disconnection until the device was restored, in milliseconds */
+		uint64_t lastDowntime;
+		/** time disconnected over all disconnections, in milliseconds */
+		uint64_t totalDowntime;
+		/** frames estimated to be lost over the last disconnection */
+		uint64_t lastLostFrames;
+		/** frames estimated to be lost over all disconnections */
+		uint64_t totalLostFrames;
+	};
+
+	/**
+	 * @class IReconnectCallback
+	 *
+	 * An interface to be notified when a device managed by a reconnect manager
+	 * (Arena::ReconnectManager) is lost and restored.
+	 *
+	 * @warning
+	 *  - Called from the reconnect manager's thread
+	 *  - Exceptions thrown by the callback are ignored
+	 *
+	 * @see
+	 *  - Arena::ReconnectManager
+	 */
+	class IReconnectCallback
+	{
+	public:
+		virtual ~IReconnectCallback(){};
+
+		virtual void OnDisconnected() = 0;
+
+		virtual void OnReconnected(IDevice* pDevice, const ReconnectStatistics& statistics) = 0;
+
+	protected:
+		IReconnectCallback(){};
+	};
+
+	/**
+	 * @class ReconnectManager
+	 *
+	 * A <B> ReconnectManager </B> keeps a device (Arena::IDevice) running
+	 * through disconnections, such as a cable pull or power cycle. When the
+	 * device disconnects (Arena::IDisconnectCallback), the reconnect manager:
+	 *  - destroys the lost device,
+	 *  - rediscovers the device by serial number,
+	 *  - recreates it,
+	 *  - reapplies the feature state of its node map and stream node map,
+	 *  - reregisters image callbacks,
+	 *  - and restarts the stream with the same number of buffers if it was
+	 *    streaming.
+	 *
+	 * \code{.cpp}
+	 * 	// acquiring through disconnections
+	 * 	{
+	 * 		Arena::ReconnectManager manager(pSystem, pDevice);
+	 * 		manager.RegisterImageCallback(pCallback);
+	 * 		manager.StartStream(10);
+	 * 		// ...
+	 * 		manager.StopStream();
+	 * 		manager.DeregisterImageCallback(pCallback);
+	 * 	}
+	 * \endcode
+	 *
+	 * Image callbacks registered through the reconnect manager
+	 * (Arena::ReconnectManager::RegisterImageCallback) keep receiving images
+	 * after a reconnection. Applications retrieving images
+	 * (Arena::IDevice::GetImage) instead must get the current device
+	 * (Arena::ReconnectManager::GetDevice) after a reconnection, waiting for
+	 * it (Arena::ReconnectManager::WaitForConnection) or being notified of it
+	 * (Arena::IReconnectCallback).
+	 *
+	 * The feature state is saved when the manager is created and whenever the
+	 * stream is started through it, and may be saved explicitly
+	 * (Arena::ReconnectManager::SaveState) after changing features.
+	 *
+	 * @warning
+	 *  - Takes ownership of the device; the device is destroyed with the
+	 *    reconnect manager
+	 *  - The device pointer changes on reconnection
+	 *  - Start and stop the stream through the reconnect manager
+	 *  - Devices that come back on another subnet cannot be recreated until
+	 *    their IP address is fixed (Cpp_ForceIp)
+	 *
+	 * @see
+	 *  - Arena::IDisconnectCallback
+	 *  - Arena::IReconnectCallback
+	 *  - Arena::ReconnectStatistics
+	 */
+	class ReconnectManager : public IDisconnectCallback
+	{
+	public:
+		/**
+		 * @fn ReconnectManager(ISystem* pSystem, IDevice* pDevice, uint64_t timeout = 100, uint64_t retryInterval = 500)
+		 *
+		 * @param pSystem
+		 *  - Type: Arena::ISystem*
+		 *  - The system object
+		 *
+		 * @param pDevice
+		 *  - Type: Arena::IDevice*
+		 *  - Device to manage
+		 *
+		 * @param timeout
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Default: 100
+		 *  - Time to wait for devices to respond to discovery
+		 *
+		 * @param retryInterval
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Default: 500
+		 *  - Time between attempts to find the device
+		 *
+		 * A constructor, saving the feature state of the device and
+		 * registering for its disconnection.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		ReconnectManager(ISystem* pSystem, IDevice* pDevice, uint64_t timeout = 100, uint64_t retryInterval = 500) :
+			m_pSystem(pSystem),
+			m_pDevice(pDevice),
+			m_timeout(timeout),
+			m_retryInterval(retryInterval),
+			m_running(true),
+			m_disconnected(false),
+			m_streaming(false),
+			m_numBuffers(0),
+			m_frameRate(0.0),
+			m_forwarder(this),
+			m_forwarding(false),
+			m_frameReceived(false),
+			m_pRecreating(NULL),
+			m_recreatingLost(false)
+		{
+			memset(&m_statistics, 0, sizeof(m_statistics));
+
+			m_serialNumber = GenApi::CStringPtr(pDevice->GetTLDeviceNodeMap()->GetNode("DeviceSerialNumber"))->GetValue();
+			SaveState();
+
+			m_pSystem->RegisterDeviceDisconnectCallback(m_pDevice, this);
+			m_thread = std::thread(&ReconnectManager::Run, this);
+		}
+
+		/**
+		 * @fn virtual ~ReconnectManager()
+		 *
+		 * A destructor, stopping the stream and destroying the device.
+		 */
+		virtual ~ReconnectManager()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+			}
+			m_changed.notify_all();
+			m_thread.join();
+
+			try
+			{
+				m_pSystem->DeregisterDeviceDisconnectCallback(this);
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+			if (m_pDevice)
+				Release(m_pDevice);
+		}
+
+		/**
+		 * @fn IDevice* GetDevice()
+		 *
+		 * @return
+		 *  - Type: Arena::IDevice*
+		 *  - The current device
+		 *  - NULL while disconnected
+		 *
+		 * <B> GetDevice </B> retrieves the current device. The device changes
+		 * on each reconnection.
+		 */
+		IDevice* GetDevice()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_disconnected ? NULL : m_pDevice;
+		}
+
+		/**
+		 * @fn bool WaitForConnection(uint64_t timeout)
+		 *
+		 * @param timeout
+		 *  - Type: uint64_t
+		 *  - Unit: milliseconds
+		 *  - Maximum time to wait for the device
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the device is connected
+		 *  - Otherwise, false
+		 *
+		 * <B> WaitForConnection </B> waits until the device is connected,
+		 * returning immediately if it already is.
+		 */
+		bool WaitForConnection(uint64_t timeout)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			return m_changed.wait_for(lock, std::chrono::milliseconds(timeout), [this]() { return !m_disconnected || !m_running; }) && !m_disconnected;
+		}
+
+		/**
+		 * @fn void SaveState()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SaveState </B> saves the streamable features of the node map and
+		 * stream node map, to be reapplied on reconnection.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void SaveState()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_disconnected)
+				return;
+
+			m_deviceState.StoreToBag(m_pDevice->GetNodeMap());
+			m_streamState.StoreToBag(m_pDevice->GetTLStreamNodeMap());
+		}
+
+		/**
+		 * @fn void StartStream(size_t numBuffers = 10)
+		 *
+		 * @param numBuffers
+		 *  - Type: size_t
+		 *  - Default: 10
+		 *  - Number of buffers to allocate for the stream
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> StartStream </B> saves the feature state and starts the stream
+		 * (Arena::IDevice::StartStream). The stream is restarted with the same
+		 * number of buffers on reconnection.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void StartStream(size_t numBuffers = 10)
+		{
+			SaveState();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numBuffers = numBuffers;
+			m_streaming = true;
+			m_frameRate = GetFrameRate(m_pDevice);
+			if (!m_disconnected)
+				m_pDevice->StartStream(numBuffers);
+		}
+
+		/**
+		 * @fn void StopStream()
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> StopStream </B> stops the stream (Arena::IDevice::StopStream).
+		 * The stream is no longer restarted on reconnection.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void StopStream()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_streaming = false;
+			if (!m_disconnected)
+				m_pDevice->StopStream();
+		}
+
+		/**
+		 * @fn void RegisterImageCallback(IImageCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IImageCallback*
+		 *  - Callback to receive images
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> RegisterImageCallback </B> registers an image callback that
+		 * keeps receiving images from the device across reconnections.
+		 *
+		 * @warning
+		 *  - Arena::IDevice::GetImage should not be called while callbacks are
+		 *    registered
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		void RegisterImageCallback(IImageCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			{
+				std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+				if (std::find(m_imageCallbacks.begin(), m_imageCallbacks.end(), pCallback) == m_imageCallbacks.end())
+					m_imageCallbacks.push_back(pCallback);
+			}
+			if (!m_forwarding && !m_disconnected)
+				m_pDevice->RegisterImageCallback(&m_forwarder);
+			m_forwarding = true;
+		}
+
+		/**
+		 * @fn void DeregisterImageCallback(IImageCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IImageCallback*
+		 *  - Callback to deregister
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> DeregisterImageCallback </B> deregisters an image callback.
+		 *
+		 * @warning
+		 *  - An image already being delivered may still reach the callback
+		 *    after it is deregistered
+		 */
+		void DeregisterImageCallback(IImageCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			bool empty = false;
+			{
+				std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+				m_imageCallbacks.erase(std::remove(m_imageCallbacks.begin(), m_imageCallbacks.end(), pCallback), m_imageCallbacks.end());
+				empty = m_imageCallbacks.empty();
+			}
+			if (empty && m_forwarding)
+			{
+				if (!m_disconnected)
+					m_pDevice->DeregisterImageCallback(&m_forwarder);
+				m_forwarding = false;
+			}
+		}
+
+		/**
+		 * @fn void RegisterReconnectCallback(IReconnectCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IReconnectCallback*
+		 *  - Callback to notify of disconnections and reconnections
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> RegisterReconnectCallback </B> registers a callback to be
+		 * notified when the device is lost and when it is restored.
+		 */
+		void RegisterReconnectCallback(IReconnectCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_callbackMutex);
+			if (std::find(m_reconnectCallbacks.begin(), m_reconnectCallbacks.end(), pCallback) == m_reconnectCallbacks.end())
+				m_reconnectCallbacks.push_back(pCallback);
+		}
+
+		/**
+		 * @fn void DeregisterReconnectCallback(IReconnectCallback* pCallback)
+		 *
+		 * @param pCallback
+		 *  - Type: Arena::IReconnectCallback*
+		 *  - Callback to deregister
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> DeregisterReconnectCallback </B> deregisters a callback.
+		 */
+		void DeregisterReconnectCallback(IReconnectCallback* pCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_callbackMutex);
+			m_reconnectCallbacks.erase(std::remove(m_reconnectCallbacks.begin(), m_reconnectCallbacks.end(), pCallback), m_reconnectCallbacks.end());
+		}
+
+		/**
+		 * @fn ReconnectStatistics GetStatistics()
+		 *
+		 * @return
+		 *  - Type: Arena::ReconnectStatistics
+		 *  - Statistics of the disconnections so far
+		 *
+		 * <B> GetStatistics </B> retrieves the number of disconnections and
+		 * reconnections, the downtime and the number of lost frames.
+		 *
+		 * Lost frames are estimated from the frame rate
+		 * ('AcquisitionFrameRate') when the stream was started, over the time
+		 * between the last image received before the disconnection (or the
+		 * disconnection itself, without image callbacks) and the restart of
+		 * the stream.
+		 */
+		ReconnectStatistics GetStatistics()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_statistics;
+		}
+
+		/**
+		 * @fn virtual void OnDeviceDisconnected(IDevice* pDevice)
+		 *
+		 * <B> OnDeviceDisconnected </B> is called by the system when the device
+		 * disconnects, handing the reconnection to the manager's thread.
+		 */
+		virtual void OnDeviceDisconnected(IDevice* pDevice)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (pDevice != NULL && pDevice == m_pRecreating)
+				{
+					m_recreatingLost = true;
+					return;
+				}
+				if (pDevice != m_pDevice || m_disconnected)
+					return;
+
+				m_disconnected = true;
+				m_disconnectTime = std::chrono::steady_clock::now();
+				m_statistics.disconnections++;
+			}
+			m_changed.notify_all();
+		}
+
+	private:
+		typedef std::chrono::steady_clock clock;
+
+		// forwards images to the callbacks registered with the manager,
+		// recording when the last image arrived
+		class ImageForwarder : public IImageCallback
+		{
+		public:
+			ImageForwarder(ReconnectManager* pManager) :
+				m_pManager(pManager)
+			{
+			}
+
+			virtual void OnImage(IImage* pImage)
+			{
+				// callbacks are called outside the lock, so that they may
+				// call back into the manager
+				std::vector<IImageCallback*> callbacks;
+				{
+					std::lock_guard<std::mutex> lock(m_pManager->m_callbackMutex);
+					m_pManager->m_lastFrameTime = clock::now();
+					m_pManager->m_frameReceived = true;
+					callbacks = m_pManager->m_imageCallbacks;
+				}
+				for (size_t i = 0; i < callbacks.size(); i++)
+					callbacks[i]->OnImage(pImage);
+			}
+
+		private:
+			ReconnectManager* m_pManager;
+		};
+
+		static double GetFrameRate(IDevice* pDevice)
+		{
+			try
+			{
+				GenApi::CFloatPtr pFrameRate = pDevice->GetNodeMap()->GetNode("AcquisitionFrameRate");
+				if (GenApi::IsReadable(pFrameRate))
+					return pFrameRate->GetValue();
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+			return 0.0;
+		}
+
+		// destroys a device, ignoring errors from the lost connection
+		void Release(IDevice* pDevice)
+		{
+			if (m_forwarding)
+			{
+				try
+				{
+					pDevice->DeregisterImageCallback(&m_forwarder);
+				}
+				catch (GenICam::GenericException&)
+				{
+				}
+			}
+			try
+			{
+				pDevice->StopStream();
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+			try
+			{
+				m_pSystem->DestroyDevice(pDevice);
+			}
+			catch (GenICam::GenericException&)
+			{
+			}
+		}
+
+		// finds and recreates the device, restoring its state; returns NULL
+		// if not found yet
+		IDevice* Recreate()
+		{
+			m_pSystem->UpdateDevices(m_timeout);
+			std::vector<DeviceInfo> deviceInfos = m_pSystem->GetDevices();
+
+			DeviceInfo* pDeviceInfo = NULL;
+			for (size_t i = 0; i < deviceInfos.size(); i++)
+			{
+				if (deviceInfos[i].SerialNumber() == m_serialNumber)
+					pDeviceInfo = &deviceInfos[i];
+			}
+			if (!pDeviceInfo)
+				return NULL;
+
+			IDevice* pDevice = m_pSystem->CreateDevice(*pDeviceInfo);
+			try
+			{
+				// registered before the stream starts, so that no
+				// disconnection is missed
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_pRecreating = pDevice;
+					m_recreatingLost = false;
+				}
+				m_pSystem->RegisterDeviceDisconnectCallback(pDevice, this);
+
+				// features that cannot be applied (e.g. locked by the
+				// device's state) are skipped rather than failing the
+				// reconnection
+				std::unique_lock<std::mutex> lock(m_mutex);
+				GenICam::gcstring_vector errors;
+				m_deviceState.LoadFromBag(pDevice->GetNodeMap(), true, &errors);
+				m_streamState.LoadFromBag(pDevice->GetTLStreamNodeMap(), true, &errors);
+
+				if (m_forwarding)
+					pDevice->RegisterImageCallback(&m_forwarder);
+				if (m_streaming)
+					pDevice->StartStream(m_numBuffers);
+			}
+			catch (...)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_pRecreating = NULL;
+				}
+				try
+				{
+					m_pSystem->DeregisterDeviceDisconnectCallback(this);
+				}
+				catch (GenICam::GenericException&)
+				{
+				}
+				Release(pDevice);
+				throw;
+			}
+			return pDevice;
+		}
+
+		std::vector<IReconnectCallback*> GetReconnectCallbacks()
+		{
+			std::lock_guard<std::mutex> lock(m_callbackMutex);
+			return m_reconnectCallbacks;
+		}
+
+		void Run()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_running)
+			{
+				m_changed.wait(lock, [this]() { return m_disconnected || !m_running; });
+				if (!m_running)
+					break;
+
+				IDevice* pLost = m_pDevice;
+				lock.unlock();
+
+				std::vector<IReconnectCallback*> callbacks = GetReconnectCallbacks();
+				for (size_t i = 0; i < callbacks.size(); i++)
+				{
+					try
+					{
+						callbacks[i]->OnDisconnected();
+					}
+					catch (...)
+					{
+					}
+				}
+
+				try
+				{
+					m_pSystem->DeregisterDeviceDisconnectCallback(this);
+				}
+				catch (GenICam::GenericException&)
+				{
+				}
+				Release(pLost);
+
+				IDevice* pDevice = NULL;
+				lock.lock();
+				m_pDevice = NULL;
+				while (m_running && !pDevice)
+				{
+					lock.unlock();
+					try
+					{
+						pDevice = Recreate();
+					}
+					catch (GenICam::GenericException&)
+					{
+						// the device may still be booting; try again
+						pDevice = NULL;
+					}
+					catch (...)
+					{
+						// anything else (e.g. an allocation failure) counts
+						// as a failed attempt too, rather than ending the
+						// thread
+						pDevice = NULL;
+					}
+					lock.lock();
+
+					if (!pDevice)
+						m_changed.wait_for(lock, std::chrono::milliseconds(m_retryInterval), [this]() { return !m_running; });
+				}
+				if (!pDevice)
+					break;
+
+				clock::time_point now = clock::now();
+				clock::time_point gapStart = m_disconnectTime;
+				{
+					std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+					if (m_forwarding && m_frameReceived && m_lastFrameTime < gapStart)
+						gapStart = m_lastFrameTime;
+				}
+
+				uint64_t downtime = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_disconnectTime).count();
+				uint64_t lostFrames = 0;
+				if (m_streaming && m_frameRate > 0.0)
+					lostFrames = static_cast<uint64_t>(std::chrono::duration<double>(now - gapStart).count() * m_frameRate);
+
+				// a disconnection since the callback was registered is
+				// handled as soon as the reconnection is reported
+				m_pDevice = pDevice;
+				m_disconnected = m_recreatingLost;
+				if (m_recreatingLost)
+				{
+					m_disconnectTime = clock::now();
+					m_statistics.disconnections++;
+				}
+				m_pRecreating = NULL;
+				m_recreatingLost = false;
+				m_statistics.reconnections++;
+				m_statistics.lastDowntime = downtime;
+				m_statistics.totalDowntime += downtime;
+				m_statistics.lastLostFrames = lostFrames;
+				m_statistics.totalLostFrames += lostFrames;
+				ReconnectStatistics statistics = m_statistics;
+				lock.unlock();
+				m_changed.notify_all();
+
+				callbacks = GetReconnectCallbacks();
+				for (size_t i = 0; i < callbacks.size(); i++)
+				{
+					try
+					{
+						callbacks[i]->OnReconnected(pDevice, statistics);
+					}
+					catch (...)
+					{
+					}
+				}
+
+				lock.lock();
+			}
+		}
+
+		ISystem* m_pSystem;
+		IDevice* m_pDevice;
+		GenICam::gcstring m_serialNumber;
+		uint64_t m_timeout;
+		uint64_t m_retryInterval;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_changed;
+		bool m_running;
+		bool m_disconnected;
+		clock::time_point m_disconnectTime;
+
+		GenApi::CFeatureBag m_deviceState;
+		GenApi::CFeatureBag m_streamState;
+		bool m_streaming;
+		size_t m_numBuffers;
+		double m_frameRate;
+
+		std::mutex m_callbackMutex;
+		std::vector<IImageCallback*> m_imageCallbacks;
+		std::vector<IReconnectCallback*> m_reconnectCallbacks;
+		ImageForwarder m_forwarder;
+		bool m_forwarding;
+		bool m_frameReceived;
+		clock::time_point m_lastFrameTime;
+
+		// device being recreated, and whether it disconnected meanwhile
+		IDevice* m_pRecreating;
+		bool m_recreatingLost;
+
+		ReconnectStatistics m_statistics;
+
+		ReconnectManager(const ReconnectManager&);
+		ReconnectManager& operator=(const ReconnectManager&);
+	};
+} // namespace Arena
@@ -0,0 +1,592 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+/**
+ * @file SequencerProgram.h
+ * This file defines programs for the sequencer.
+ */
+
+#pragma once
+
+#include "FeatureBatch.h"
+#include "GenApiCustom.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+
+namespace Arena
+{
+	/**
+	 * @class SequencerProgram
+	 *
+	 * A <B> SequencerProgram </B> describes the sets of the sequencer in one
+	 * object: the feature values of each set, the paths from each set to the
+	 * next and the set to start from. The program is validated
+	 * (Arena::SequencerProgram::Validate) before it is uploaded to a device
+	 * (Arena::SequencerProgram::Upload) and can be read back to verify it
+	 * (Arena::SequencerProgram::Verify).
+	 *
+	 * \code{.cpp}
+	 * 	// cycling through 3 exposure times
+	 * 	{
+	 * 		Arena::SequencerProgram program;
+	 * 		program.SetFeature(0, "ExposureTime", 25000.0);
+	 * 		program.SetFeature(1, "ExposureTime", 50000.0);
+	 * 		program.SetFeature(2, "ExposureTime", 100000.0);
+	 * 		program.SetPath(0, 0, 1, "FrameStart");
+	 * 		program.SetPath(1, 0, 2, "FrameStart");
+	 * 		program.SetPath(2, 0, 0, "FrameStart");
+	 * 		program.SetStartSet(0);
+	 * 		program.Upload(pNodeMap);
+	 * 	}
+	 * \endcode
+	 *
+	 * Configuring a set one feature at a time sends a register write for
+	 * each selector and value. Uploading a program instead writes all
+	 * selectors, features and paths of a set as one feature batch
+	 * (Arena::FeatureBatch), followed by the command to save the set
+	 * ('SequencerSetSave').
+	 *
+	 * @warning
+	 *  - Uploading turns sequencer mode ('SequencerMode') off; it must be
+	 *    turned back on to run the program
+	 *  - Sets are stored in volatile memory on the device
+	 *
+	 * @see
+	 *  - Arena::FeatureBatch
+	 */
+	class SequencerProgram
+	{
+	public:
+		/**
+		 * @fn SequencerProgram()
+		 *
+		 * A constructor, creating an empty program starting from set 0.
+		 */
+		SequencerProgram() :
+			m_startSet(0)
+		{
+		}
+
+		/**
+		 * @fn void SetStartSet(int64_t set)
+		 *
+		 * @param set
+		 *  - Type: int64_t
+		 *  - Set to start from ('SequencerSetStart')
+		 *
+		 * @return
+		 *  - none
+		 */
+		void SetStartSet(int64_t set)
+		{
+			m_startSet = set;
+		}
+
+		/**
+		 * @fn void SetFeature(int64_t set, const GenICam::gcstring& name, const GenICam::gcstring& value)
+		 *
+		 * @param set
+		 *  - Type: int64_t
+		 *  - Set to configure ('SequencerSetSelector')
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Name of the feature ('SequencerFeatureSelector')
+		 *
+		 * @param value
+		 *  - Type: const GenICam::gcstring&
+		 *  - Value of the feature in the set, as a string
+		 *  - Enumeration nodes use the name of the entry
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetFeature </B> sets the value of a feature in a set. Setting
+		 * the same feature again replaces its value. Overloads take integer,
+		 * float and boolean values.
+		 */
+		void SetFeature(int64_t set, const GenICam::gcstring& name, const GenICam::gcstring& value)
+		{
+			std::vector<Value>& features = m_sets[set].features;
+			for (size_t i = 0; i < features.size(); i++)
+			{
+				if (features[i].name == name)
+				{
+					features[i].value = value;
+					return;
+				}
+			}
+
+			Value feature;
+			feature.name = name;
+			feature.value = value;
+			features.push_back(feature);
+		}
+
+		void SetFeature(int64_t set, const GenICam::gcstring& name, const char* value)
+		{
+			SetFeature(set, name, GenICam::gcstring(value));
+		}
+
+		void SetFeature(int64_t set, const GenICam::gcstring& name, int64_t value)
+		{
+			std::ostringstream stream;
+			stream << value;
+			SetFeature(set, name, GenICam::gcstring(stream.str().c_str()));
+		}
+
+		void SetFeature(int64_t set, const GenICam::gcstring& name, int value)
+		{
+			SetFeature(set, name, static_cast<int64_t>(value));
+		}
+
+		void SetFeature(int64_t set, const GenICam::gcstring& name, double value)
+		{
+			std::ostringstream stream;
+			stream.precision(17);
+			stream << value;
+			SetFeature(set, name, GenICam::gcstring(stream.str().c_str()));
+		}
+
+		void SetFeature(int64_t set, const GenICam::gcstring& name, bool value)
+		{
+			SetFeature(set, name, GenICam::gcstring(value ? "1" : "0"));
+		}
+
+		/**
+		 * @fn void SetPath(int64_t set, int64_t path, int64_t nextSet, const GenICam::gcstring& triggerSource, const GenICam::gcstring& triggerActivation = "")
+		 *
+		 * @param set
+		 *  - Type: int64_t
+		 *  - Set to configure ('SequencerSetSelector')
+		 *
+		 * @param path
+		 *  - Type: int64_t
+		 *  - Path of the set ('SequencerPathSelector')
+		 *
+		 * @param nextSet
+		 *  - Type: int64_t
+		 *  - Set to go to ('SequencerSetNext')
+		 *
+		 * @param triggerSource
+		 *  - Type: const GenICam::gcstring&
+		 *  - Source that triggers the path ('SequencerTriggerSource')
+		 *
+		 * @param triggerActivation
+		 *  - Type: const GenICam::gcstring&
+		 *  - Default: ""
+		 *  - Activation of the trigger ('SequencerTriggerActivation')
+		 *  - Left unchanged if empty
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> SetPath </B> sets a path from a set to the next.
+		 */
+		void SetPath(int64_t set, int64_t path, int64_t nextSet, const GenICam::gcstring& triggerSource, const GenICam::gcstring& triggerActivation = "")
+		{
+			Path& entry = m_sets[set].paths[path];
+			entry.nextSet = nextSet;
+			entry.triggerSource = triggerSource;
+			entry.triggerActivation = triggerActivation;
+		}
+
+		/**
+		 * @fn size_t GetNumSets()
+		 *
+		 * @return
+		 *  - Type: size_t
+		 *  - Number of sets in the program
+		 */
+		size_t GetNumSets() const
+		{
+			return m_sets.size();
+		}
+
+		/**
+		 * @fn std::vector<GenICam::gcstring> Validate(GenApi::INodeMap* pNodeMap = NULL)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Default: NULL
+		 *  - Node map to validate against, if not NULL
+		 *
+		 * @return
+		 *  - Type: std::vector<GenICam::gcstring>
+		 *  - Problems found; empty if the program is valid
+		 *
+		 * <B> Validate </B> checks the program without writing to a device.
+		 * Without a node map, it checks that the start set and every set
+		 * reached by a path are defined, and that every set has a path. With
+		 * a node map, it also checks set and path indices, feature names,
+		 * feature values and trigger sources against the device.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 */
+		std::vector<GenICam::gcstring> Validate(GenApi::INodeMap* pNodeMap = NULL) const
+		{
+			std::vector<GenICam::gcstring> errors;
+			if (m_sets.empty())
+			{
+				errors.push_back("Program has no sets");
+				return errors;
+			}
+			if (!m_sets.count(m_startSet))
+				errors.push_back("Start set " + ToString(m_startSet) + " is not defined");
+
+			for (std::map<int64_t, Set>::const_iterator set = m_sets.begin(); set != m_sets.end(); set++)
+			{
+				GenICam::gcstring prefix = "Set " + ToString(set->first) + ": ";
+				if (set->second.paths.empty())
+					errors.push_back(prefix + "no path");
+
+				for (std::map<int64_t, Path>::const_iterator path = set->second.paths.begin(); path != set->second.paths.end(); path++)
+				{
+					if (!m_sets.count(path->second.nextSet))
+						errors.push_back(prefix + "path " + ToString(path->first) + " goes to set " + ToString(path->second.nextSet) + ", which is not defined");
+				}
+			}
+
+			if (pNodeMap)
+				ValidateNodeMap(pNodeMap, errors);
+			return errors;
+		}
+
+		/**
+		 * @fn void Upload(GenApi::INodeMap* pNodeMap, bool verify = true)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map of the device
+		 *
+		 * @param verify
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, reads the program back after uploading it
+		 *    (Arena::SequencerProgram::Verify)
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Upload </B> validates the program against the device, turns
+		 * sequencer mode off, and writes and saves each set in configuration
+		 * mode. Each set is written as one feature batch followed by
+		 * 'SequencerSetSave'.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 *  - Throws before writing anything if the program is not valid
+		 */
+		void Upload(GenApi::INodeMap* pNodeMap, bool verify = true) const
+		{
+			std::vector<GenICam::gcstring> errors = Validate(pNodeMap);
+			if (!errors.empty())
+				throw GenICam::GenericException(("Invalid sequencer program: " + Join(errors)).c_str(), __FILE__, __LINE__);
+
+			GenApi::AutoLock lock(pNodeMap->GetLock());
+
+			if (GetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerMode") != "Off")
+				SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerMode", "Off");
+			SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "On");
+
+			try
+			{
+				for (std::map<int64_t, Set>::const_iterator set = m_sets.begin(); set != m_sets.end(); set++)
+				{
+					FeatureBatch batch(pNodeMap);
+					batch.Add("SequencerSetSelector", set->first);
+					for (size_t i = 0; i < set->second.features.size(); i++)
+					{
+						batch.Add("SequencerFeatureSelector", set->second.features[i].name);
+						batch.Add(set->second.features[i].name, set->second.features[i].value);
+					}
+					for (std::map<int64_t, Path>::const_iterator path = set->second.paths.begin(); path != set->second.paths.end(); path++)
+					{
+						batch.Add("SequencerPathSelector", path->first);
+						batch.Add("SequencerSetNext", path->second.nextSet);
+						batch.Add("SequencerTriggerSource", path->second.triggerSource);
+						if (!path->second.triggerActivation.empty())
+							batch.Add("SequencerTriggerActivation", path->second.triggerActivation);
+					}
+
+					// written in order without retries if the stacked write
+					// fails, so that values stay under their selectors
+					if (!batch.Write(false))
+					{
+						std::vector<GenICam::gcstring> failed;
+						for (size_t i = 0; i < batch.GetResults().size(); i++)
+						{
+							const FeatureBatchResult& result = batch.GetResults()[i];
+							if (!result.written)
+								failed.push_back(result.name + " = " + result.value + " (" + result.error + ")");
+						}
+						throw GenICam::GenericException(("Unable to write sequencer set " + ToString(set->first) + ": " + Join(failed)).c_str(), __FILE__, __LINE__);
+					}
+
+					ExecuteNode(pNodeMap, "SequencerSetSave");
+				}
+
+				SetNodeValue<int64_t>(pNodeMap, "SequencerSetStart", m_startSet);
+
+				if (verify)
+				{
+					errors = ReadBack(pNodeMap);
+					if (!errors.empty())
+						throw GenICam::GenericException(("Sequencer program does not match device: " + Join(errors)).c_str(), __FILE__, __LINE__);
+				}
+			}
+			catch (...)
+			{
+				SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "Off");
+				throw;
+			}
+
+			SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "Off");
+		}
+
+		/**
+		 * @fn std::vector<GenICam::gcstring> Verify(GenApi::INodeMap* pNodeMap)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - Node map of the device
+		 *
+		 * @return
+		 *  - Type: std::vector<GenICam::gcstring>
+		 *  - Differences found; empty if the device matches the program
+		 *
+		 * <B> Verify </B> reads the sets back from the device and compares
+		 * them with the program. Feature values are loaded with
+		 * 'SequencerSetLoad' and compared within the precision of the
+		 * device; they are skipped if the device cannot load sets. Paths and
+		 * the start set are read through their selectors.
+		 *
+		 * @warning
+		 *  - May throw GenICam::GenericException or other derived exception
+		 *  - Turns sequencer mode off
+		 *  - Loading sets changes the current values of their features
+		 */
+		std::vector<GenICam::gcstring> Verify(GenApi::INodeMap* pNodeMap) const
+		{
+			GenApi::AutoLock lock(pNodeMap->GetLock());
+
+			if (GetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerMode") != "Off")
+				SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerMode", "Off");
+			SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "On");
+
+			std::vector<GenICam::gcstring> errors;
+			try
+			{
+				errors = ReadBack(pNodeMap);
+			}
+			catch (...)
+			{
+				SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "Off");
+				throw;
+			}
+
+			SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerConfigurationMode", "Off");
+			return errors;
+		}
+
+	private:
+		struct Value
+		{
+			GenICam::gcstring name;
+			GenICam::gcstring value;
+		};
+
+		struct Path
+		{
+			int64_t nextSet;
+			GenICam::gcstring triggerSource;
+			GenICam::gcstring triggerActivation;
+		};
+
+		struct Set
+		{
+			std::vector<Value> features;
+			std::map<int64_t, Path> paths;
+		};
+
+		std::map<int64_t, Set> m_sets;
+		int64_t m_startSet;
+
+		static GenICam::gcstring ToString(int64_t value)
+		{
+			std::ostringstream stream;
+			stream << value;
+			return stream.str().c_str();
+		}
+
+		static GenICam::gcstring Join(const std::vector<GenICam::gcstring>& values)
+		{
+			GenICam::gcstring joined;
+			for (size_t i = 0; i < values.size(); i++)
+				joined += (i ? "; " : "") + values[i];
+			return joined;
+		}
+
+		static bool HasEntry(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name, const GenICam::gcstring& entry)
+		{
+			GenApi::CEnumerationPtr pEnumeration = pNodeMap->GetNode(name);
+			if (!pEnumeration)
+				return false;
+
+			GenApi::IEnumEntry* pEntry = pEnumeration->GetEntryByName(entry);
+			return pEntry && GenApi::IsAvailable(pEntry);
+		}
+
+		void ValidateNodeMap(GenApi::INodeMap* pNodeMap, std::vector<GenICam::gcstring>& errors) const
+		{
+			const char* required[] = { "SequencerMode", "SequencerConfigurationMode", "SequencerSetSelector", "SequencerFeatureSelector", "SequencerPathSelector", "SequencerSetNext", "SequencerTriggerSource", "SequencerSetSave", "SequencerSetStart" };
+			for (size_t i = 0; i < sizeof(required) / sizeof(required[0]); i++)
+			{
+				if (!pNodeMap->GetNode(required[i]))
+					errors.push_back(GenICam::gcstring("Node not found: ") + required[i]);
+			}
+			if (!errors.empty())
+				return;
+
+			GenApi::CIntegerPtr pSetSelector = pNodeMap->GetNode("SequencerSetSelector");
+			GenApi::CIntegerPtr pPathSelector = pNodeMap->GetNode("SequencerPathSelector");
+			for (std::map<int64_t, Set>::const_iterator set = m_sets.begin(); set != m_sets.end(); set++)
+			{
+				GenICam::gcstring prefix = "Set " + ToString(set->first) + ": ";
+				if (set->first < pSetSelector->GetMin() || set->first > pSetSelector->GetMax())
+					errors.push_back(prefix + "set out of range");
+
+				for (size_t i = 0; i < set->second.features.size(); i++)
+				{
+					const Value& feature = set->second.features[i];
+					if (!HasEntry(pNodeMap, "SequencerFeatureSelector", feature.name))
+					{
+						errors.push_back(prefix + feature.name + " is not a sequencer feature");
+						continue;
+					}
+
+					GenApi::CIntegerPtr pInteger = pNodeMap->GetNode(feature.name);
+					GenApi::CFloatPtr pFloat = pNodeMap->GetNode(feature.name);
+					GenApi::CEnumerationPtr pEnumeration = pNodeMap->GetNode(feature.name);
+					char* pEnd = NULL;
+					if (pInteger)
+					{
+						int64_t value = strtoll(feature.value.c_str(), &pEnd, 0);
+						if (pEnd == feature.value.c_str() || *pEnd != '\0' || value < pInteger->GetMin() || value > pInteger->GetMax())
+							errors.push_back(prefix + feature.name + " value " + feature.value + " out of range");
+					}
+					else if (pFloat)
+					{
+						double value = strtod(feature.value.c_str(), &pEnd);
+						if (pEnd == feature.value.c_str() || *pEnd != '\0' || value < pFloat->GetMin() || value > pFloat->GetMax())
+							errors.push_back(prefix + feature.name + " value " + feature.value + " out of range");
+					}
+					else if (pEnumeration && !HasEntry(pNodeMap, feature.name, feature.value))
+					{
+						errors.push_back(prefix + feature.name + " has no entry " + feature.value);
+					}
+				}
+
+				for (std::map<int64_t, Path>::const_iterator path = set->second.paths.begin(); path != set->second.paths.end(); path++)
+				{
+					if (path->first < pPathSelector->GetMin() || path->first > pPathSelector->GetMax())
+						errors.push_back(prefix + "path " + ToString(path->first) + " out of range");
+					if (!HasEntry(pNodeMap, "SequencerTriggerSource", path->second.triggerSource))
+						errors.push_back(prefix + "trigger source " + path->second.triggerSource + " not available");
+					if (!path->second.triggerActivation.empty() && !HasEntry(pNodeMap, "SequencerTriggerActivation", path->second.triggerActivation))
+						errors.push_back(prefix + "trigger activation " + path->second.triggerActivation + " not available");
+				}
+			}
+		}
+
+		// compares a value read from the device with the one programmed
+		static bool Matches(GenApi::INode* pNode, const GenICam::gcstring& expected, const GenICam::gcstring& actual)
+		{
+			GenApi::CFloatPtr pFloat = pNode;
+			GenApi::CIntegerPtr pInteger = pNode;
+			GenApi::CBooleanPtr pBoolean = pNode;
+			if (pFloat)
+			{
+				double a = strtod(expected.c_str(), NULL);
+				double b = strtod(actual.c_str(), NULL);
+				double tolerance = std::fabs(a) * 1e-3;
+				if (pFloat->HasInc() && pFloat->GetInc() > tolerance)
+					tolerance = pFloat->GetInc();
+				return std::fabs(a - b) <= tolerance;
+			}
+			if (pInteger)
+				return strtoll(expected.c_str(), NULL, 0) == strtoll(actual.c_str(), NULL, 0);
+			if (pBoolean)
+				return (expected == "1" || expected == "true") == (actual == "1" || actual == "true");
+			return expected == actual;
+		}
+
+		std::vector<GenICam::gcstring> ReadBack(GenApi::INodeMap* pNodeMap) const
+		{
+			std::vector<GenICam::gcstring> errors;
+			GenApi::CCommandPtr pSetLoad = pNodeMap->GetNode("SequencerSetLoad");
+			bool loadable = GenApi::IsWritable(pSetLoad);
+
+			for (std::map<int64_t, Set>::const_iterator set = m_sets.begin(); set != m_sets.end(); set++)
+			{
+				GenICam::gcstring prefix = "Set " + ToString(set->first) + ": ";
+				SetNodeValue<int64_t>(pNodeMap, "SequencerSetSelector", set->first);
+
+				if (loadable)
+				{
+					pSetLoad->Execute();
+					for (size_t i = 0; i < set->second.features.size(); i++)
+					{
+						const Value& feature = set->second.features[i];
+						SetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerFeatureSelector", feature.name);
+
+						GenApi::CValuePtr pValue = pNodeMap->GetNode(feature.name);
+						GenICam::gcstring actual = pValue->ToString(false, true);
+						if (!Matches(pNodeMap->GetNode(feature.name), feature.value, actual))
+							errors.push_back(prefix + feature.name + " is " + actual + ", expected " + feature.value);
+					}
+				}
+
+				for (std::map<int64_t, Path>::const_iterator path = set->second.paths.begin(); path != set->second.paths.end(); path++)
+				{
+					GenICam::gcstring pathPrefix = prefix + "path " + ToString(path->first) + " ";
+					SetNodeValue<int64_t>(pNodeMap, "SequencerPathSelector", path->first);
+
+					int64_t nextSet = GetNodeValue<int64_t>(pNodeMap, "SequencerSetNext");
+					if (nextSet != path->second.nextSet)
+						errors.push_back(pathPrefix + "goes to set " + ToString(nextSet) + ", expected " + ToString(path->second.nextSet));
+
+					GenICam::gcstring triggerSource = GetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerTriggerSource");
+					if (triggerSource != path->second.triggerSource)
+						errors.push_back(pathPrefix + "trigger source is " + triggerSource + ", expected " + path->second.triggerSource);
+
+					if (!path->second.triggerActivation.empty())
+					{
+						GenICam::gcstring triggerActivation = GetNodeValue<GenICam::gcstring>(pNodeMap, "SequencerTriggerActivation");
+						if (triggerActivation != path->second.triggerActivation)
+							errors.push_back(pathPrefix + "trigger activation is " + triggerActivation + ", expected " + path->second.triggerActivation);
+					}
+				}
+			}
+
+			int64_t startSet = GetNodeValue<int64_t>(pNodeMap, "SequencerSetStart");
+			if (startSet != m_startSet)
+				errors.push_back("Start set is " + ToString(startSet) + ", expected " + ToString(m_startSet));
+			return errors;
+		}
+	};
+} // namespace Arena
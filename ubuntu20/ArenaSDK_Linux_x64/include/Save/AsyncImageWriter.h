@@ -0,0 +1,673 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SaveDefs.h"
+#include "ImageParams.h"
+#include "ImageWriter.h"
+#include "Stripe.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <stdexcept>
+#include <exception>
+
+namespace Save
+{
+	/**
+	 * @class AsyncImageWriter
+	 *
+	 * The asynchronous image writer hands images off to a pool of encoder
+	 * threads so that the caller is not held up by compression or disk
+	 * writes. Image data is copied into (or moved into) pooled buffers and
+	 * placed in a bounded queue; a full queue blocks the caller rather than
+	 * growing without limit.
+	 *
+	 * File names are resolved on the calling thread at the time of the call,
+	 * so '<count>', '<timestamp>' and other tags number images in submission
+	 * order no matter which worker finishes first.
+	 *
+	 * A file name pattern may start with a brace list of directories, such
+	 * as "{/mnt/nvme0,/mnt/nvme1}/images/image<count>.raw". Each image is
+	 * then written below one of the directories, chosen round-robin or by
+	 * the least data still queued for it (see SetStripePolicy), so several
+	 * drives share the load. SetManifest records where each image landed.
+	 *
+	 * \code{.cpp}
+	 * 	// saving images from the acquisition thread without blocking on PNG
+	 * 	{
+	 * 		Save::AsyncImageWriter writer(params, "savedimages/image<count>.png", 4);
+	 * 		writer.SetPng(".png", 6);
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			Arena::IImage* pImage = pDevice->GetImage(2000);
+	 * 			writer.SaveAsync(pImage->GetData());
+	 * 			pDevice->RequeueBuffer(pImage);
+	 * 		}
+	 *
+	 * 		writer.Flush();
+	 * 	}
+	 * \endcode
+	 */
+	class AsyncImageWriter
+	{
+	public:
+		/**
+		 * @fn AsyncImageWriter(ImageParams imageParams, const char* pFileNamePattern = "savedimages/image<count>.jpg", size_t numWorkers = 0, size_t maxQueued = 0)
+		 *
+		 * @param imageParams
+		 *  - Type: Save::ImageParams
+		 *  - The parameters of the image(s) to save
+		 *
+		 * @param pFileNamePattern
+		 *  - Type: const char*
+		 *  - Default: "savedimages/image<count>.jpg"
+		 *  - File name pattern to use for file names
+		 *  - A leading {dir1,dir2,...} list stripes images across the
+		 *    directories
+		 *
+		 * @param numWorkers
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Number of encoder threads
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * @param maxQueued
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Number of images that may wait for a worker before SaveAsync
+		 *    blocks
+		 *  - 0 uses twice the number of workers
+		 *
+		 * A constructor. Starts the encoder threads.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if the pattern uses
+		 *    '<count:global>'
+		 */
+		AsyncImageWriter(ImageParams imageParams, const char* pFileNamePattern = "savedimages/image<count>.jpg", size_t numWorkers = 0, size_t maxQueued = 0)
+			: m_params(imageParams),
+			  m_writer(imageParams),
+			  m_policy(StripeRoundRobin),
+			  m_nextStripe(0),
+			  m_submitted(0),
+			  m_maxQueued(maxQueued),
+			  m_active(0),
+			  m_peakDepth(0),
+			  m_completed(0),
+			  m_failed(0),
+			  m_stop(false)
+		{
+			if (numWorkers == 0)
+				numWorkers = std::thread::hardware_concurrency();
+			if (numWorkers == 0)
+				numWorkers = 1;
+			if (m_maxQueued == 0)
+				m_maxQueued = numWorkers * 2;
+
+			SetPattern(pFileNamePattern);
+
+			for (size_t i = 0; i < numWorkers; i++)
+				m_workers.push_back(std::thread(&AsyncImageWriter::Run, this));
+		}
+
+		/**
+		 * @fn virtual ~AsyncImageWriter()
+		 *
+		 * A destructor. Waits for all queued images to be saved, then stops
+		 * the encoder threads.
+		 */
+		virtual ~AsyncImageWriter()
+		{
+			Flush();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_workCv.notify_all();
+			for (size_t i = 0; i < m_workers.size(); i++)
+				m_workers[i].join();
+		}
+
+		/**
+		 * @fn virtual void SetJpeg(const char* pSetExtension = ".jpg", size_t quality = 75, bool progressive = false, EJpegSubsampling subsampling = Subsampling420, bool optimize = false)
+		 *
+		 * <B> SetJpeg </B> sets the output file format to JPEG for images
+		 * submitted after the call. Parameters are the same as
+		 * Save::ImageWriter::SetJpeg.
+		 */
+		virtual void SetJpeg(const char* pSetExtension = ".jpg", size_t quality = 75, bool progressive = false, EJpegSubsampling subsampling = Subsampling420, bool optimize = false)
+		{
+			std::string ext(pSetExtension);
+			SetFormat([=](ImageWriter& writer) { writer.SetJpeg(ext.c_str(), quality, progressive, subsampling, optimize); });
+		}
+
+		/**
+		 * @fn virtual void SetBmp(const char* pSetExtension = ".bmp")
+		 *
+		 * <B> SetBmp </B> sets the output file format to BMP for images
+		 * submitted after the call.
+		 */
+		virtual void SetBmp(const char* pSetExtension = ".bmp")
+		{
+			std::string ext(pSetExtension);
+			SetFormat([=](ImageWriter& writer) { writer.SetBmp(ext.c_str()); });
+		}
+
+		/**
+		 * @fn virtual void SetRaw(const char* pSetExtension = ".raw")
+		 *
+		 * <B> SetRaw </B> sets the output file format to raw for images
+		 * submitted after the call.
+		 */
+		virtual void SetRaw(const char* pSetExtension = ".raw")
+		{
+			std::string ext(pSetExtension);
+			SetFormat([=](ImageWriter& writer) { writer.SetRaw(ext.c_str()); });
+		}
+
+		/**
+		 * @fn virtual void SetTiff(const char* pSetExtension = ".tiff", ETiffCompression compression = NoCompression, bool cmykTags = false)
+		 *
+		 * <B> SetTiff </B> sets the output file format to TIFF for images
+		 * submitted after the call. Parameters are the same as
+		 * Save::ImageWriter::SetTiff.
+		 */
+		virtual void SetTiff(const char* pSetExtension = ".tiff", ETiffCompression compression = NoCompression, bool cmykTags = false)
+		{
+			std::string ext(pSetExtension);
+			SetFormat([=](ImageWriter& writer) { writer.SetTiff(ext.c_str(), compression, cmykTags); });
+		}
+
+		/**
+		 * @fn virtual void SetPng(const char* pSetExtension = ".png", size_t compression = 0, bool interlaced = false)
+		 *
+		 * <B> SetPng </B> sets the output file format to PNG for images
+		 * submitted after the call. Parameters are the same as
+		 * Save::ImageWriter::SetPng.
+		 */
+		virtual void SetPng(const char* pSetExtension = ".png", size_t compression = 0, bool interlaced = false)
+		{
+			std::string ext(pSetExtension);
+			SetFormat([=](ImageWriter& writer) { writer.SetPng(ext.c_str(), compression, interlaced); });
+		}
+
+		/**
+		 * @fn virtual void SetParams(ImageParams params)
+		 *
+		 * @param params
+		 *  - Type: Save::ImageParams
+		 *  - Image parameters
+		 *
+		 * <B> SetParams </B> changes the image parameters for images submitted
+		 * after the call. Images already queued keep their own parameters.
+		 */
+		virtual void SetParams(ImageParams params)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			m_params = params;
+			m_writer.SetParams(params);
+		}
+
+		/**
+		 * @fn virtual void SetFileNamePattern(const char* pFileNamePattern)
+		 *
+		 * <B> SetFileNamePattern </B> changes the file name pattern, see
+		 * Save::ImageWriter::SetFileNamePattern. The pattern may start with
+		 * a {dir1,dir2,...} list to stripe images across directories.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if the pattern uses
+		 *    '<count:global>'
+		 */
+		virtual void SetFileNamePattern(const char* pFileNamePattern)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			SetPattern(pFileNamePattern);
+		}
+
+		/**
+		 * @fn virtual void SetStripePolicy(EStripePolicy policy)
+		 *
+		 * @param policy
+		 *  - Type: Save::EStripePolicy
+		 *  - How images are spread over striped directories
+		 *
+		 * <B> SetStripePolicy </B> chooses between cycling through the
+		 * directories and picking the one with the least image data still
+		 * queued. The second favours whichever drive is currently keeping up
+		 * best.
+		 */
+		virtual void SetStripePolicy(EStripePolicy policy)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			m_policy = policy;
+		}
+
+		/**
+		 * @fn virtual void SetManifest(const char* pFileName)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - Manifest file to create, or NULL to stop recording
+		 *
+		 * <B> SetManifest </B> starts a Save::StripeManifest that lists the
+		 * file name of every image submitted from now on, in submission
+		 * order. The manifest is closed with the writer.
+		 */
+		virtual void SetManifest(const char* pFileName)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			if (pFileName == NULL)
+				m_manifest.Close();
+			else
+				m_manifest.Open(pFileName);
+		}
+
+		/**
+		 * @fn virtual void UpdateTag(const char* pTag, const char* pValue)
+		 *
+		 * <B> UpdateTag </B> updates a custom tag, see
+		 * Save::ImageWriter::UpdateTag.
+		 */
+		virtual void UpdateTag(const char* pTag, const char* pValue)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			m_writer.UpdateTag(pTag, pValue);
+		}
+
+		/**
+		 * @fn virtual void SetCount(unsigned long long count, ECountScope scope = Local)
+		 *
+		 * <B> SetCount </B> sets the value of one of the available counters,
+		 * see Save::ImageWriter::SetCount.
+		 */
+		virtual void SetCount(unsigned long long count, ECountScope scope = Local)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			m_writer.SetCount(count, scope);
+		}
+
+		/**
+		 * @fn virtual void SetTimestamp(unsigned long long timestamp)
+		 *
+		 * <B> SetTimestamp </B> updates the timestamp used by the next
+		 * submitted image.
+		 */
+		virtual void SetTimestamp(unsigned long long timestamp)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			m_writer.SetTimestamp(timestamp);
+		}
+
+		/**
+		 * @fn virtual std::string PeekFileName(bool withPath = false, bool withExt = true)
+		 *
+		 * <B> PeekFileName </B> returns the file name the next submitted image
+		 * will be saved as. For striped patterns the directory is only chosen
+		 * on submission and is not included.
+		 */
+		virtual std::string PeekFileName(bool withPath = false, bool withExt = true)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			return m_writer.PeekFileName(withPath, withExt);
+		}
+
+		/**
+		 * @fn virtual std::future<std::string> SaveAsync(const uint8_t* pData, bool createDirectories = true)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Pointer to the image data to save
+		 *  - Copied before the call returns
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * @return 
+		 *  - Type: std::future<std::string>
+		 *  - Becomes ready with the file name (with path) once saved
+		 *  - Rethrows any exception thrown while encoding or writing
+		 *
+		 * <B> SaveAsync </B> copies the image into a pooled buffer, resolves
+		 * its file name and queues it for encoding. Blocks while the queue is
+		 * full.
+		 *
+		 * The caller may requeue or destroy its image as soon as the call
+		 * returns.
+		 */
+		virtual std::future<std::string> SaveAsync(const uint8_t* pData, bool createDirectories = true)
+		{
+			std::vector<uint8_t> buffer = AcquireBuffer();
+			std::memcpy(&buffer[0], pData, buffer.size());
+			return Submit(std::move(buffer), createDirectories);
+		}
+
+		/**
+		 * @fn virtual std::future<std::string> SaveAsync(std::vector<uint8_t>&& data, bool createDirectories = true)
+		 *
+		 * @param data
+		 *  - Type: std::vector<uint8_t>&&
+		 *  - Image data to save
+		 *  - Ownership is taken; no copy is made
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * @return 
+		 *  - Type: std::future<std::string>
+		 *  - Becomes ready with the file name (with path) once saved
+		 *
+		 * <B> SaveAsync </B> queues an image whose buffer the writer takes
+		 * over. After saving, the buffer joins the pool used by the copying
+		 * overload.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if the buffer is smaller than the
+		 *    image size of the current parameters
+		 */
+		virtual std::future<std::string> SaveAsync(std::vector<uint8_t>&& data, bool createDirectories = true)
+		{
+			return Submit(std::move(data), createDirectories);
+		}
+
+		/**
+		 * @fn virtual AsyncImageWriter& operator<<(const uint8_t* pData)
+		 *
+		 * <B> operator<< </B> queues an image, the same as SaveAsync with
+		 * its future discarded.
+		 */
+		virtual AsyncImageWriter& operator<<(const uint8_t* pData)
+		{
+			SaveAsync(pData);
+			return *this;
+		}
+
+		/**
+		 * @fn virtual AsyncImageWriter& operator<<(unsigned long long timestamp)
+		 *
+		 * <B> operator<< </B> updates the timestamp used by the next
+		 * submitted image.
+		 */
+		virtual AsyncImageWriter& operator<<(unsigned long long timestamp)
+		{
+			SetTimestamp(timestamp);
+			return *this;
+		}
+
+		/**
+		 * @fn virtual void Flush()
+		 *
+		 * <B> Flush </B> blocks until every image submitted so far has been
+		 * saved or has failed.
+		 */
+		virtual void Flush()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_idleCv.wait(lock, [this]() { return m_jobs.empty() && m_active == 0; });
+		}
+
+		/**
+		 * @fn virtual size_t GetQueueDepth()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Images waiting for or being processed by a worker
+		 *
+		 * <B> GetQueueDepth </B> retrieves the current number of outstanding
+		 * images.
+		 */
+		virtual size_t GetQueueDepth()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_jobs.size() + m_active;
+		}
+
+		/**
+		 * @fn virtual size_t GetPeakQueueDepth()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Highest queue depth seen
+		 *
+		 * <B> GetPeakQueueDepth </B> retrieves the highest number of
+		 * outstanding images seen since construction. A peak at the queue
+		 * limit means SaveAsync has blocked the caller.
+		 */
+		virtual size_t GetPeakQueueDepth()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_peakDepth;
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumCompleted()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Images saved successfully
+		 */
+		virtual uint64_t GetNumCompleted()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_completed;
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumFailed()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Images whose encode or write threw
+		 */
+		virtual uint64_t GetNumFailed()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_failed;
+		}
+
+	private:
+		struct Job
+		{
+			std::vector<uint8_t> data;
+			ImageParams params;
+			std::string fileName;
+			std::function<void(ImageWriter&)> format;
+			bool createDirectories;
+			size_t stripe;
+			std::promise<std::string> done;
+		};
+
+		void SetPattern(const char* pFileNamePattern)
+		{
+			// the global counter is advanced by each save, when a worker
+			// finishes, so queued images could not be named from it in order
+			if (std::string(pFileNamePattern).find("<count:global>") != std::string::npos)
+				throw std::invalid_argument("asynchronous image writers do not support <count:global>");
+
+			std::string rest;
+			std::vector<std::string> roots = Internal::SplitStripedPattern(pFileNamePattern, rest);
+			m_writer.SetFileNamePattern(rest.c_str());
+			m_roots.swap(roots);
+			m_nextStripe = 0;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_load.size() < m_roots.size())
+				m_load.resize(m_roots.size(), 0);
+		}
+
+		void SetFormat(std::function<void(ImageWriter&)> format)
+		{
+			std::lock_guard<std::mutex> lock(m_nameMutex);
+			format(m_writer);
+			m_format = format;
+		}
+
+		std::vector<uint8_t> AcquireBuffer()
+		{
+			size_t size;
+			{
+				std::lock_guard<std::mutex> lock(m_nameMutex);
+				size = m_params.GetSize();
+			}
+
+			std::vector<uint8_t> buffer;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_pool.empty())
+				{
+					buffer.swap(m_pool.back());
+					m_pool.pop_back();
+				}
+			}
+			buffer.resize(size);
+			return buffer;
+		}
+
+		std::future<std::string> Submit(std::vector<uint8_t>&& data, bool createDirectories)
+		{
+			// names are resolved and queued under one lock so that counters
+			// follow submission order
+			std::lock_guard<std::mutex> nameLock(m_nameMutex);
+
+			if (data.size() < m_params.GetSize())
+				throw std::invalid_argument("image buffer smaller than image parameters");
+
+			Job job;
+			job.data.swap(data);
+			job.params = m_params;
+			job.format = m_format;
+			job.createDirectories = createDirectories;
+			job.stripe = 0;
+			if (m_roots.size() > 1)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				std::vector<uint64_t> load(m_load.begin(), m_load.begin() + m_roots.size());
+				job.stripe = Internal::ChooseStripe(m_policy, load, m_nextStripe);
+			}
+			job.fileName = Internal::JoinStripePath(m_roots[job.stripe], m_writer.PeekFileName(true, true));
+			std::future<std::string> result = job.done.get_future();
+
+			m_manifest.Add(m_submitted++, job.fileName);
+
+			// the workers save under the resolved name, so advance the
+			// counters here as ImageWriter::Save would
+			m_writer.SetCount(m_writer.PeekCount(Local) + 1, Local);
+			m_writer.SetCount(m_writer.PeekCount(Path) + 1, Path);
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_spaceCv.wait(lock, [this]() { return m_jobs.size() < m_maxQueued; });
+			m_load[job.stripe] += job.data.size();
+			m_jobs.push_back(std::move(job));
+			if (m_jobs.size() + m_active > m_peakDepth)
+				m_peakDepth = m_jobs.size() + m_active;
+			lock.unlock();
+
+			m_workCv.notify_one();
+			return result;
+		}
+
+		void Run()
+		{
+			for (;;)
+			{
+				Job job;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_workCv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+					if (m_jobs.empty())
+						return;
+					job = std::move(m_jobs.front());
+					m_jobs.pop_front();
+					m_active++;
+				}
+				m_spaceCv.notify_one();
+
+				bool ok = true;
+				try
+				{
+					ImageWriter writer(job.params, job.fileName.c_str());
+					if (job.format)
+						job.format(writer);
+					writer.Save(&job.data[0], job.createDirectories);
+					job.done.set_value(job.fileName);
+				}
+				catch (...)
+				{
+					ok = false;
+					job.done.set_exception(std::current_exception());
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_load[job.stripe] -= job.data.size();
+					if (m_pool.size() < m_maxQueued + m_workers.size())
+					{
+						m_pool.push_back(std::vector<uint8_t>());
+						m_pool.back().swap(job.data);
+					}
+					m_active--;
+					if (ok)
+						m_completed++;
+					else
+						m_failed++;
+				}
+				m_idleCv.notify_all();
+			}
+		}
+
+		// guards the naming writer, the current parameters and format, and
+		// striping
+		std::mutex m_nameMutex;
+		ImageParams m_params;
+		ImageWriter m_writer;
+		std::function<void(ImageWriter&)> m_format;
+		std::vector<std::string> m_roots;
+		EStripePolicy m_policy;
+		size_t m_nextStripe;
+		StripeManifest m_manifest;
+		uint64_t m_submitted;
+
+		// guards the queue, buffer pool and statistics
+		std::mutex m_mutex;
+		std::condition_variable m_workCv;
+		std::condition_variable m_spaceCv;
+		std::condition_variable m_idleCv;
+		std::deque<Job> m_jobs;
+		std::vector<std::vector<uint8_t> > m_pool;
+		std::vector<uint64_t> m_load;
+		size_t m_maxQueued;
+		size_t m_active;
+		size_t m_peakDepth;
+		uint64_t m_completed;
+		uint64_t m_failed;
+		bool m_stop;
+		std::vector<std::thread> m_workers;
+
+		AsyncImageWriter(const AsyncImageWriter&);
+		AsyncImageWriter& operator=(const AsyncImageWriter&);
+	};
+}
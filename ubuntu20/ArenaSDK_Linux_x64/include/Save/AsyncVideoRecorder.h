@@ -0,0 +1,1473 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SaveDefs.h"
+#include "VideoParams.h"
+#include "VideoRecorder.h"
+#include "RawCodec.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <stdexcept>
+#include <exception>
+#include <sys/stat.h>
+
+namespace Save
+{
+	namespace Internal
+	{
+		enum EVideoInput
+		{
+			VideoInputNone,
+			VideoInputCopy,
+			VideoInputMono,
+			VideoInputYuyv,
+			VideoInputUyvy,
+			VideoInputBayer
+		};
+
+		inline uint8_t VideoClamp(int value)
+		{
+			return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+		}
+
+		// YUV 4:2:2 row to RGB or BGR with full range BT.601, as used by
+		// JFIF and the Arena image factory; the offsets locate Y0, Cb and Cr
+		// in each 4-byte pair of pixels, whose chroma terms are shared
+		inline void VideoYuv422Row(const uint8_t* pIn, size_t width, size_t yOffset, size_t cbOffset, size_t crOffset, size_t red, size_t blue, uint8_t* pOut)
+		{
+			for (size_t x = 0; x + 1 < width; x += 2, pIn += 4, pOut += 6)
+			{
+				int cb = pIn[cbOffset] - 128;
+				int cr = pIn[crOffset] - 128;
+				int redTerm = (91881 * cr + 32768) >> 16;
+				int greenTerm = (22554 * cb + 46802 * cr + 32768) >> 16;
+				int blueTerm = (116130 * cb + 32768) >> 16;
+				int y0 = pIn[yOffset];
+				int y1 = pIn[yOffset + 2];
+				pOut[red] = VideoClamp(y0 + redTerm);
+				pOut[1] = VideoClamp(y0 - greenTerm);
+				pOut[blue] = VideoClamp(y0 + blueTerm);
+				pOut[3 + red] = VideoClamp(y1 + redTerm);
+				pOut[4] = VideoClamp(y1 - greenTerm);
+				pOut[3 + blue] = VideoClamp(y1 + blueTerm);
+			}
+		}
+
+		// bilinear demosaic of one Bayer pixel from its 3x3 neighbourhood
+		inline void VideoBayerPixel(const uint8_t* pUp, const uint8_t* pRow, const uint8_t* pDown, size_t x, size_t left, size_t right, bool redColumn, bool redRow, size_t red, size_t blue, uint8_t* pOut)
+		{
+			int r, g, b;
+			if (redRow == redColumn)
+			{
+				int value = pRow[x];
+				int diagonal = (pUp[left] + pUp[right] + pDown[left] + pDown[right] + 2) >> 2;
+				g = (pRow[left] + pRow[right] + pUp[x] + pDown[x] + 2) >> 2;
+				r = redRow ? value : diagonal;
+				b = redRow ? diagonal : value;
+			}
+			else
+			{
+				int horizontal = (pRow[left] + pRow[right] + 1) >> 1;
+				int vertical = (pUp[x] + pDown[x] + 1) >> 1;
+				g = pRow[x];
+				r = redRow ? horizontal : vertical;
+				b = redRow ? vertical : horizontal;
+			}
+			pOut[red] = static_cast<uint8_t>(r);
+			pOut[1] = static_cast<uint8_t>(g);
+			pOut[blue] = static_cast<uint8_t>(b);
+		}
+
+		// demosaics one Bayer row; redX and redRow locate the red sites.
+		// Edges are reflected, which keeps the colour phase, and the
+		// interior is done in pairs so the colour of each site is fixed
+		inline void VideoBayerRow(const uint8_t* pUp, const uint8_t* pRow, const uint8_t* pDown, size_t width, size_t redX, bool redRow, size_t red, size_t blue, uint8_t* pOut)
+		{
+			VideoBayerPixel(pUp, pRow, pDown, 0, 1, 1, redX == 0, redRow, red, blue, pOut);
+			size_t x = 1;
+			for (; x + 2 < width; x += 2)
+			{
+				VideoBayerPixel(pUp, pRow, pDown, x, x - 1, x + 1, redX == 1, redRow, red, blue, pOut + 3 * x);
+				VideoBayerPixel(pUp, pRow, pDown, x + 1, x, x + 2, redX == 0, redRow, red, blue, pOut + 3 * x + 3);
+			}
+			for (; x < width; x++)
+			{
+				size_t right = x + 1 < width ? x + 1 : width - 2;
+				VideoBayerPixel(pUp, pRow, pDown, x, x - 1, right, (x & 1) == redX, redRow, red, blue, pOut + 3 * x);
+			}
+		}
+	}
+
+	/**
+	 * @class AsyncVideoRecorder
+	 *
+	 * The asynchronous video recorder moves conversion and encoding off the
+	 * acquisition thread. Frames are copied into a bounded pool of buffers
+	 * and pass through two stages, each on its own thread: conversion to
+	 * the recorder's pixel format, split in bands across a pool of helper
+	 * threads kept while the recorder is open, and encoding by a
+	 * Save::VideoRecorder. While one frame is encoded, the next is
+	 * converted and the caller is free to grab a third.
+	 *
+	 * Frames may be appended in Mono8, YUV 4:2:2 (YCbCr422_8, YUV422_8 and
+	 * their CbYCrY/UYVY variants) or 8-bit Bayer. They are converted in a
+	 * single pass into a BGR8 or RGB8 buffer of the pool, which the
+	 * Save::VideoRecorder then copies into its encoder, so callers no
+	 * longer convert each image to BGR8 first. Frames already in the
+	 * recorder's pixel format are passed through.
+	 *
+	 * When the encoder falls behind, AppendImage either waits for a free
+	 * buffer or drops the frame, and the drops are counted.
+	 *
+	 * Recordings can be cut into segments by duration or size
+	 * (SetSegmentDuration, SetSegmentSize). The next segment is always
+	 * opened ahead of time and finished segments are closed on a background
+	 * thread, so no frames are lost or delayed at the cut.
+	 *
+	 * For event capture, SetPreTrigger keeps the last few seconds of frames
+	 * in memory instead of recording them. Trigger writes those frames to a
+	 * new segment and keeps recording for a while after, so only the
+	 * moments around each event reach the disk.
+	 *
+	 * \code{.cpp}
+	 * 	// recording Bayer frames as they arrive, in 1 minute files
+	 * 	{
+	 * 		Save::AsyncVideoRecorder recorder(Save::VideoParams(width, height, 25.0), "savedvideos/video<count>.mp4");
+	 * 		recorder.SetH264Mp4BGR8();
+	 * 		recorder.SetSegmentDuration(60.0);
+	 * 		recorder.Open(BayerRG8);
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			Arena::IImage* pImage = pDevice->GetImage(2000);
+	 * 			recorder.AppendImage(pImage->GetData());
+	 * 			pDevice->RequeueBuffer(pImage);
+	 * 		}
+	 *
+	 * 		recorder.Close();
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::VideoRecorder
+	 */
+	class AsyncVideoRecorder
+	{
+	public:
+		/**
+		 * @fn AsyncVideoRecorder(VideoParams params, const char* pFileNamePattern = "savedvideos/video<count>.mp4", size_t maxQueued = 8, size_t numThreads = 0)
+		 *
+		 * @param params
+		 *  - Type: Save::VideoParams
+		 *  - Parameters of the video
+		 *
+		 * @param pFileNamePattern
+		 *  - Type: const char*
+		 *  - Default: "savedvideos/video<count>.mp4"
+		 *  - File name pattern of the videos
+		 *  - '<count>' numbers the segments
+		 *
+		 * @param maxQueued
+		 *  - Type: size_t
+		 *  - Default: 8
+		 *  - Number of frames that may be waiting for conversion or
+		 *    encoding
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Threads used to convert each frame
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * A constructor. The codec and container default to those of a
+		 * Save::VideoRecorder for the pattern's extension.
+		 */
+		AsyncVideoRecorder(VideoParams params, const char* pFileNamePattern = "savedvideos/video<count>.mp4", size_t maxQueued = 8, size_t numThreads = 0)
+			: m_params(params),
+			  m_pattern(pFileNamePattern),
+			  m_segmentFrames(0),
+			  m_segmentBytes(0),
+			  m_preFrames(0),
+			  m_postFrames(0),
+			  m_triggered(false),
+			  m_compressRing(true),
+			  m_input(Internal::VideoInputNone),
+			  m_inputFormat(0),
+			  m_redX(0),
+			  m_redY(0),
+			  m_red(2),
+			  m_blue(0),
+			  m_inputSize(0),
+			  m_outputSize(0),
+			  m_maxQueued(maxQueued == 0 ? 1 : maxQueued),
+			  m_numThreads(numThreads),
+			  m_open(false),
+			  m_stop(false),
+			  m_converted(false),
+			  m_peakDepth(0),
+			  m_encoded(0),
+			  m_dropped(0),
+			  m_ringCodec(numThreads),
+			  m_pNext(NULL),
+			  m_needNext(false),
+			  m_nextIndex(0),
+			  m_segmentStop(false),
+			  m_pBandSlot(NULL),
+			  m_bandRound(0),
+			  m_bandsBusy(0),
+			  m_bandStop(false),
+			  m_nextBand(0),
+			  m_numBands(0)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+		}
+
+		/**
+		 * @fn virtual ~AsyncVideoRecorder()
+		 *
+		 * A destructor. Encodes the queued frames and closes the video if
+		 * Close has not been called. Errors are swallowed; call Close to see
+		 * them.
+		 */
+		virtual ~AsyncVideoRecorder()
+		{
+			try
+			{
+				Close();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		/**
+		 * @fn virtual void SetRaw(uint64_t pixelFormat)
+		 *
+		 * <B> SetRaw </B> sets the codec to raw with the given pixel format.
+		 * Parameters are the same as Save::VideoRecorder::SetRaw. Like the
+		 * other codec settings, it applies to every segment.
+		 */
+		virtual void SetRaw(uint64_t pixelFormat)
+		{
+			SetFormat([=](VideoRecorder& recorder) { recorder.SetRaw(pixelFormat); });
+		}
+
+		/**
+		 * @fn virtual void SetRawAviBGR8()
+		 *
+		 * <B> SetRawAviBGR8 </B> sets the codec to raw, the container to AVI
+		 * and the pixel format to BGR8.
+		 */
+		virtual void SetRawAviBGR8()
+		{
+			SetFormat([](VideoRecorder& recorder) { recorder.SetRawAviBGR8(); });
+		}
+
+		/**
+		 * @fn virtual void SetRawMovRGB8()
+		 *
+		 * <B> SetRawMovRGB8 </B> sets the codec to raw, the container to MOV
+		 * and the pixel format to RGB8.
+		 */
+		virtual void SetRawMovRGB8()
+		{
+			SetFormat([](VideoRecorder& recorder) { recorder.SetRawMovRGB8(); });
+		}
+
+		/**
+		 * @fn virtual void SetH264MovRGB8(int64_t bitrate = 0)
+		 *
+		 * <B> SetH264MovRGB8 </B> sets the codec to H264, the container to
+		 * MOV and the pixel format to RGB8. Parameters are the same as
+		 * Save::VideoRecorder::SetH264MovRGB8.
+		 */
+		virtual void SetH264MovRGB8(int64_t bitrate = 0)
+		{
+			SetFormat([=](VideoRecorder& recorder) { recorder.SetH264MovRGB8(bitrate); });
+		}
+
+		/**
+		 * @fn virtual void SetH264MovBGR8(int64_t bitrate = 0)
+		 *
+		 * <B> SetH264MovBGR8 </B> sets the codec to H264, the container to
+		 * MOV and the pixel format to BGR8.
+		 */
+		virtual void SetH264MovBGR8(int64_t bitrate = 0)
+		{
+			SetFormat([=](VideoRecorder& recorder) { recorder.SetH264MovBGR8(bitrate); });
+		}
+
+		/**
+		 * @fn virtual void SetH264Mp4RGB8(int64_t bitrate = 0)
+		 *
+		 * <B> SetH264Mp4RGB8 </B> sets the codec to H264, the container to
+		 * MPEG-4 and the pixel format to RGB8.
+		 */
+		virtual void SetH264Mp4RGB8(int64_t bitrate = 0)
+		{
+			SetFormat([=](VideoRecorder& recorder) { recorder.SetH264Mp4RGB8(bitrate); });
+		}
+
+		/**
+		 * @fn virtual void SetH264Mp4BGR8(int64_t bitrate = 0)
+		 *
+		 * <B> SetH264Mp4BGR8 </B> sets the codec to H264, the container to
+		 * MPEG-4 and the pixel format to BGR8.
+		 */
+		virtual void SetH264Mp4BGR8(int64_t bitrate = 0)
+		{
+			SetFormat([=](VideoRecorder& recorder) { recorder.SetH264Mp4BGR8(bitrate); });
+		}
+
+		/**
+		 * @fn virtual void SetSegmentDuration(double seconds)
+		 *
+		 * @param seconds
+		 *  - Type: double
+		 *  - Unit: seconds
+		 *  - Length of each segment at the video's frame rate
+		 *  - 0 disables cutting by duration
+		 *
+		 * <B> SetSegmentDuration </B> starts a new file after the given
+		 * duration of video.
+		 *
+		 * @warning 
+		 *  - Cannot be called while the recorder is open
+		 */
+		virtual void SetSegmentDuration(double seconds)
+		{
+			CheckClosed();
+			m_segmentFrames = seconds > 0 ? ToFrames(seconds) : 0;
+		}
+
+		/**
+		 * @fn virtual void SetSegmentSize(uint64_t size)
+		 *
+		 * @param size
+		 *  - Type: uint64_t
+		 *  - Unit: bytes
+		 *  - Size at which a new segment is started
+		 *  - 0 disables cutting by size
+		 *
+		 * <B> SetSegmentSize </B> starts a new file once the current one
+		 * reaches the given size. The size is read from the file system, so
+		 * segments may run over by whatever the container still buffers.
+		 *
+		 * @warning 
+		 *  - Cannot be called while the recorder is open
+		 */
+		virtual void SetSegmentSize(uint64_t size)
+		{
+			CheckClosed();
+			m_segmentBytes = size;
+		}
+
+		/**
+		 * @fn virtual void SetPreTrigger(double preSeconds, double postSeconds, bool compress = true)
+		 *
+		 * @param preSeconds
+		 *  - Type: double
+		 *  - Unit: seconds
+		 *  - Video kept in memory before a trigger
+		 *
+		 * @param postSeconds
+		 *  - Type: double
+		 *  - Unit: seconds
+		 *  - Video recorded after a trigger
+		 *
+		 * @param compress
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, Mono8 and Bayer frames are kept compressed
+		 *    losslessly with the Save::RawCodec, about halving the memory
+		 *    used
+		 *
+		 * <B> SetPreTrigger </B> switches the recorder to event capture.
+		 * Appended frames go to a memory ring holding the last preSeconds of
+		 * video. Each call to Trigger writes the ring to a new segment and
+		 * records postSeconds more; a trigger during that time extends it.
+		 * SetPreTrigger(0, 0) returns to continuous recording.
+		 *
+		 * @warning 
+		 *  - Cannot be called while the recorder is open
+		 *  - Frames still in the ring at Close are discarded
+		 *  - While a trigger is written, up to preSeconds + postSeconds of
+		 *    frames may be held in memory
+		 */
+		virtual void SetPreTrigger(double preSeconds, double postSeconds, bool compress = true)
+		{
+			CheckClosed();
+			m_preFrames = preSeconds > 0 ? ToFrames(preSeconds) : 0;
+			m_postFrames = postSeconds > 0 ? ToFrames(postSeconds) : 0;
+			m_triggered = m_preFrames > 0 || m_postFrames > 0;
+			m_compressRing = compress;
+		}
+
+		/**
+		 * @fn static bool IsSupported(uint64_t pixelFormat)
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the frames to append
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if frames of the pixel format are converted internally
+		 */
+		static bool IsSupported(uint64_t pixelFormat)
+		{
+			size_t redX, redY;
+			return Classify(pixelFormat, redX, redY) != Internal::VideoInputNone;
+		}
+
+		/**
+		 * @fn virtual void Open(uint64_t pixelFormat)
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the frames that will be appended
+		 *
+		 * <B> Open </B> opens the first video file and starts the
+		 * conversion, encoding and segment threads, and the helpers
+		 * converting frames alongside the conversion thread.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if frames of the pixel format
+		 *    cannot be converted to the recorder's pixel format
+		 *  - Throws std::invalid_argument if segments or triggers are
+		 *    enabled and the file name pattern has no '<count>'
+		 */
+		virtual void Open(uint64_t pixelFormat)
+		{
+			if (m_open)
+				throw std::logic_error("video recorder is already open");
+			if ((m_segmentFrames > 0 || m_segmentBytes > 0 || m_triggered) && m_pattern.find("<count") == std::string::npos)
+				throw std::invalid_argument("segmented video recording needs <count> in the file name pattern");
+
+			size_t width = m_params.GetWidth();
+			size_t height = m_params.GetHeight();
+			m_nextIndex = 0;
+			Segment* pFirst = CreateSegment();
+			uint64_t outputFormat = pFirst->pRecorder->GetPixelFormat();
+
+			m_input = Classify(pixelFormat, m_redX, m_redY);
+			if (pixelFormat == outputFormat)
+				m_input = Internal::VideoInputCopy;
+			else if (outputFormat != BGR8 && outputFormat != RGB8)
+				m_input = Internal::VideoInputNone;
+			std::string error;
+			if (m_input == Internal::VideoInputNone)
+				error = "unsupported pixel format for video recording";
+			else if ((m_input == Internal::VideoInputYuyv || m_input == Internal::VideoInputUyvy) && width % 2 != 0)
+				error = "YUV 4:2:2 frames need an even width";
+			else if (m_input == Internal::VideoInputBayer && (width < 2 || height < 2))
+				error = "Bayer frames need at least 2x2 pixels";
+			if (!error.empty())
+			{
+				delete pFirst->pRecorder;
+				delete pFirst;
+				throw std::invalid_argument(error);
+			}
+
+			try
+			{
+				pFirst->pRecorder->Open();
+			}
+			catch (...)
+			{
+				delete pFirst->pRecorder;
+				delete pFirst;
+				throw;
+			}
+
+			m_inputFormat = pixelFormat;
+			m_red = outputFormat == RGB8 ? 0 : 2;
+			m_blue = 2 - m_red;
+			m_inputSize = width * height * (m_input == Internal::VideoInputMono || m_input == Internal::VideoInputBayer ? 1 : 2);
+			m_outputSize = width * height * 3;
+			if (m_input == Internal::VideoInputCopy)
+				m_inputSize = m_outputSize = width * height * ((pixelFormat >> 16) & 0xFF) / 8;
+
+			// the ring is flushed through slots of its own, as the queued
+			// slots may all be waiting behind the trigger
+			m_slots.resize(m_maxQueued + (m_triggered && m_preFrames > 0 ? 2 : 0));
+			m_free.clear();
+			m_ringFree.clear();
+			for (size_t i = 0; i < m_slots.size(); i++)
+			{
+				m_slots[i].input.resize(m_inputSize);
+				m_slots[i].output.resize(m_input == Internal::VideoInputCopy ? 0 : m_outputSize);
+				if (i < m_maxQueued)
+					m_free.push_back(i);
+				else
+					m_ringFree.push_back(i);
+			}
+			m_stop = false;
+			m_converted = false;
+			m_error = std::exception_ptr();
+			m_peakDepth = 0;
+			m_encoded = 0;
+			m_dropped = 0;
+			m_ring.clear();
+			m_release.clear();
+			m_spare.clear();
+			m_pNext = pFirst;
+			m_needNext = false;
+			m_segmentStop = false;
+			m_fileNames.clear();
+			m_open = true;
+
+			const size_t bandRows = 32;
+			m_numBands = (height + bandRows - 1) / bandRows;
+			m_bandRound = 0;
+			m_bandsBusy = 0;
+			m_bandStop = false;
+			size_t numHelpers = m_input == Internal::VideoInputCopy ? 0 : std::min(m_numThreads, m_numBands) - 1;
+			for (size_t i = 0; i < numHelpers; i++)
+				m_helpers.push_back(std::thread(&AsyncVideoRecorder::Help, this));
+
+			m_segmenter = std::thread(&AsyncVideoRecorder::ManageSegments, this);
+			m_converter = std::thread(&AsyncVideoRecorder::Convert, this);
+			m_encoder = std::thread(&AsyncVideoRecorder::Encode, this);
+		}
+
+		/**
+		 * @fn virtual bool AppendImage(const uint8_t* pData, bool wait = true)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Data of the next frame, in the pixel format given to Open
+		 *
+		 * @param wait
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, waits for a free buffer when the queue is full
+		 *  - Otherwise, drops the frame
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the frame was queued, false if it was dropped
+		 *
+		 * <B> AppendImage </B> copies a frame into the queue and returns.
+		 * Conversion and encoding happen on the recorder's threads.
+		 *
+		 * @warning 
+		 *  - Rethrows the first error raised while converting or encoding
+		 */
+		virtual bool AppendImage(const uint8_t* pData, bool wait = true)
+		{
+			size_t slot;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				if (!m_open)
+					throw std::logic_error("video recorder is not open");
+				if (m_error)
+					std::rethrow_exception(m_error);
+				if (m_free.empty() && !wait)
+				{
+					m_dropped++;
+					return false;
+				}
+				m_spaceCv.wait(lock, [this]() { return !m_free.empty() || m_error; });
+				if (m_error)
+					std::rethrow_exception(m_error);
+				slot = m_free.front();
+				m_free.pop_front();
+			}
+
+			std::memcpy(&m_slots[slot].input[0], pData, m_inputSize);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_toConvert.push_back(slot);
+				if (m_maxQueued - m_free.size() > m_peakDepth)
+					m_peakDepth = m_maxQueued - m_free.size();
+			}
+			m_workCv.notify_all();
+			return true;
+		}
+
+		/**
+		 * @fn virtual void Trigger()
+		 *
+		 * <B> Trigger </B> records an event. The frames held in memory are
+		 * written to a new segment, followed by the frames appended during
+		 * the post-trigger time. Triggers during that time extend it.
+		 *
+		 * The held frames are written one at a time, in between the frames
+		 * appended after the trigger. Until they are all written, those
+		 * frames are kept in memory behind them, the way the ring keeps
+		 * them, so AppendImage is not held up by the replay.
+		 *
+		 * @warning 
+		 *  - Only valid after SetPreTrigger
+		 */
+		virtual void Trigger()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_open)
+					throw std::logic_error("video recorder is not open");
+				if (!m_triggered)
+					throw std::logic_error("video recorder is not set up for triggers");
+
+				// queued with the frames as an index past the last slot, so
+				// it splits them where it was called
+				m_toConvert.push_back(m_slots.size());
+			}
+			m_workCv.notify_all();
+		}
+
+		/**
+		 * @fn virtual void Close()
+		 *
+		 * <B> Close </B> encodes the queued frames, stops the threads and
+		 * closes the video file.
+		 *
+		 * @warning 
+		 *  - Rethrows the first error raised while converting or encoding
+		 */
+		virtual void Close()
+		{
+			if (!m_open)
+				return;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_workCv.notify_all();
+			m_converter.join();
+			m_encoder.join();
+
+			{
+				std::lock_guard<std::mutex> lock(m_bandMutex);
+				m_bandStop = true;
+			}
+			m_bandCv.notify_all();
+			for (size_t i = 0; i < m_helpers.size(); i++)
+				m_helpers[i].join();
+			m_helpers.clear();
+
+			// frames held for a trigger that never came are discarded
+			m_ring.clear();
+			m_release.clear();
+			m_spare.clear();
+
+			// the segment thread finishes the closes handed to it first
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_segmentStop = true;
+			}
+			m_segmentCv.notify_all();
+			m_segmenter.join();
+			m_open = false;
+
+			if (m_error)
+				std::rethrow_exception(m_error);
+		}
+
+		/**
+		 * @fn virtual size_t GetQueueDepth()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of frames waiting for conversion or encoding
+		 */
+		virtual size_t GetQueueDepth()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_open ? m_maxQueued - m_free.size() : 0;
+		}
+
+		/**
+		 * @fn virtual size_t GetPeakQueueDepth()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Largest queue depth since Open
+		 *
+		 * <B> GetPeakQueueDepth </B> shows how close the encoder came to
+		 * falling behind.
+		 */
+		virtual size_t GetPeakQueueDepth()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_peakDepth;
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumEncoded()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Number of frames encoded since Open
+		 */
+		virtual uint64_t GetNumEncoded()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_encoded;
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumDropped()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Number of frames dropped because the queue was full
+		 */
+		virtual uint64_t GetNumDropped()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_dropped;
+		}
+
+		/**
+		 * @fn virtual size_t GetNumSegments()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of video files started since Open
+		 */
+		virtual size_t GetNumSegments()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_fileNames.size();
+		}
+
+		/**
+		 * @fn virtual std::string GetSegmentFileName(size_t segment)
+		 *
+		 * @param segment
+		 *  - Type: size_t
+		 *  - Position of the segment, in recording order
+		 *
+		 * @return 
+		 *  - Type: std::string
+		 *  - File name of the segment
+		 */
+		virtual std::string GetSegmentFileName(size_t segment)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (segment >= m_fileNames.size())
+				throw std::out_of_range("video segment index out of range");
+			return m_fileNames[segment];
+		}
+
+	private:
+		struct Slot
+		{
+			std::vector<uint8_t> input;
+			std::vector<uint8_t> output;
+		};
+
+		enum EJobFlags
+		{
+			JobStartSegment = 0x1,
+			JobEndSegment = 0x2
+		};
+
+		struct Job
+		{
+			size_t slot;
+			int flags;
+		};
+
+		struct Segment
+		{
+			VideoRecorder* pRecorder;
+			std::string fileName;
+			uint64_t frames;
+		};
+
+		struct RingFrame
+		{
+			std::vector<uint8_t> data;
+			bool compressed;
+			int flags;
+		};
+
+		static Internal::EVideoInput Classify(uint64_t pixelFormat, size_t& redX, size_t& redY)
+		{
+			redX = 0;
+			redY = 0;
+			switch (pixelFormat)
+			{
+			case Mono8: return Internal::VideoInputMono;
+			case YCbCr422_8:
+			case YUV422_8: return Internal::VideoInputYuyv;
+			case YCbCr422_8_CbYCrY:
+			case YUV422_8_UYVY: return Internal::VideoInputUyvy;
+			case BayerRG8: return Internal::VideoInputBayer;
+			case BayerGR8: redX = 1; return Internal::VideoInputBayer;
+			case BayerGB8: redY = 1; return Internal::VideoInputBayer;
+			case BayerBG8: redX = 1; redY = 1; return Internal::VideoInputBayer;
+			default: return Internal::VideoInputNone;
+			}
+		}
+
+		void CheckClosed() const
+		{
+			if (m_open)
+				throw std::logic_error("video recorder settings cannot change while open");
+		}
+
+		uint64_t ToFrames(double seconds) const
+		{
+			double frames = std::ceil(seconds * m_params.GetFPS());
+			return frames < 1 ? 1 : static_cast<uint64_t>(frames);
+		}
+
+		void SetFormat(std::function<void(VideoRecorder&)> format)
+		{
+			CheckClosed();
+			m_format = format;
+		}
+
+		// creates the recorder of the next segment, numbered through
+		// '<count>'; opening is left to the caller
+		Segment* CreateSegment()
+		{
+			Segment* pSegment = new Segment();
+			pSegment->pRecorder = NULL;
+			pSegment->frames = 0;
+			try
+			{
+				pSegment->pRecorder = new VideoRecorder(m_params, m_pattern.c_str());
+				if (m_format)
+					m_format(*pSegment->pRecorder);
+				pSegment->pRecorder->SetCount(m_nextIndex++, Local);
+				pSegment->fileName = pSegment->pRecorder->PeekFileName(true, true);
+			}
+			catch (...)
+			{
+				delete pSegment->pRecorder;
+				delete pSegment;
+				throw;
+			}
+			return pSegment;
+		}
+
+		static uint64_t GetFileSize(const std::string& fileName)
+		{
+			struct stat info;
+			return ::stat(fileName.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+		}
+
+		void ConvertRows(const uint8_t* pIn, uint8_t* pOut, size_t firstRow, size_t endRow) const
+		{
+			size_t width = m_params.GetWidth();
+			size_t height = m_params.GetHeight();
+			for (size_t y = firstRow; y < endRow; y++)
+			{
+				uint8_t* pRow = pOut + y * width * 3;
+				switch (m_input)
+				{
+				case Internal::VideoInputMono:
+				{
+					const uint8_t* pSrc = pIn + y * width;
+					for (size_t x = 0; x < width; x++, pRow += 3)
+						pRow[0] = pRow[1] = pRow[2] = pSrc[x];
+					break;
+				}
+				case Internal::VideoInputYuyv:
+					Internal::VideoYuv422Row(pIn + y * width * 2, width, 0, 1, 3, m_red, m_blue, pRow);
+					break;
+				case Internal::VideoInputUyvy:
+					Internal::VideoYuv422Row(pIn + y * width * 2, width, 1, 0, 2, m_red, m_blue, pRow);
+					break;
+				case Internal::VideoInputBayer:
+				{
+					size_t up = y > 0 ? y - 1 : 1;
+					size_t down = y + 1 < height ? y + 1 : height - 2;
+					Internal::VideoBayerRow(pIn + up * width, pIn + y * width, pIn + down * width, width, m_redX, (y & 1) == m_redY, m_red, m_blue, pRow);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+		}
+
+		// converts the bands of the current frame until none are left
+		void ConvertBands(Slot& slot)
+		{
+			size_t height = m_params.GetHeight();
+			size_t bandRows = (height + m_numBands - 1) / m_numBands;
+			for (size_t band = m_nextBand++; band < m_numBands; band = m_nextBand++)
+				ConvertRows(&slot.input[0], &slot.output[0], band * bandRows, std::min(height, (band + 1) * bandRows));
+		}
+
+		// converts a frame in bands of rows on the conversion thread and
+		// the helpers, returning once every band is done
+		void ConvertFrame(Slot& slot)
+		{
+			if (m_input == Internal::VideoInputCopy)
+				return;
+
+			m_nextBand = 0;
+			if (m_helpers.empty())
+			{
+				ConvertBands(slot);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_bandMutex);
+				m_pBandSlot = &slot;
+				m_bandsBusy = m_helpers.size();
+				m_bandRound++;
+			}
+			m_bandCv.notify_all();
+			ConvertBands(slot);
+
+			std::unique_lock<std::mutex> lock(m_bandMutex);
+			m_bandDoneCv.wait(lock, [this]() { return m_bandsBusy == 0; });
+		}
+
+		// helper thread, joining in each frame's conversion
+		void Help()
+		{
+			uint64_t round = 0;
+			for (;;)
+			{
+				Slot* pSlot;
+				{
+					std::unique_lock<std::mutex> lock(m_bandMutex);
+					m_bandCv.wait(lock, [&]() { return m_bandStop || m_bandRound != round; });
+					if (m_bandStop)
+						break;
+					round = m_bandRound;
+					pSlot = m_pBandSlot;
+				}
+
+				ConvertBands(*pSlot);
+
+				{
+					std::lock_guard<std::mutex> lock(m_bandMutex);
+					m_bandsBusy--;
+				}
+				m_bandDoneCv.notify_one();
+			}
+		}
+
+		void Fail()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_error)
+					m_error = std::current_exception();
+			}
+			m_spaceCv.notify_all();
+			m_segmentCv.notify_all();
+		}
+
+		void PushJob(size_t slot, int flags)
+		{
+			Job job;
+			job.slot = slot;
+			job.flags = flags;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_toEncode.push_back(job);
+			}
+			m_encodeCv.notify_one();
+		}
+
+		void ReleaseSlot(size_t slot)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_free.push_back(slot);
+			}
+			m_spaceCv.notify_all();
+		}
+
+		// copies a frame into memory, compressed if enabled, reusing the
+		// storage of a written frame when there is one
+		void Store(const Slot& slot, RingFrame& frame)
+		{
+			if (frame.data.empty() && !m_spare.empty())
+			{
+				frame.data.swap(m_spare.back());
+				m_spare.pop_back();
+			}
+			frame.compressed = m_compressRing && RawCodec::IsSupported(m_inputFormat);
+			frame.flags = 0;
+			if (frame.compressed)
+				m_ringCodec.Compress(&slot.input[0], m_params.GetWidth(), m_params.GetHeight(), m_inputFormat, frame.data);
+			else
+				frame.data.assign(slot.input.begin(), slot.input.end());
+		}
+
+		// keeps a frame in the pre-trigger ring, reusing the storage of the
+		// oldest frame once the ring is full
+		void Hold(const Slot& slot)
+		{
+			if (m_preFrames == 0)
+				return;
+
+			m_ring.push_back(RingFrame());
+			if (m_ring.size() > m_preFrames)
+			{
+				m_ring.back().data.swap(m_ring.front().data);
+				m_ring.pop_front();
+			}
+			Store(slot, m_ring.back());
+		}
+
+		// passes the oldest frame waiting to be written on to the encoder,
+		// through one of the ring's slots
+		void ReleaseOne(size_t slot)
+		{
+			RingFrame& frame = m_release.front();
+			try
+			{
+				if (frame.compressed)
+					m_ringCodec.Decompress(&frame.data[0], frame.data.size(), &m_slots[slot].input[0], m_inputSize);
+				else
+					std::memcpy(&m_slots[slot].input[0], &frame.data[0], m_inputSize);
+				ConvertFrame(m_slots[slot]);
+			}
+			catch (...)
+			{
+				Fail();
+			}
+			int flags = frame.flags;
+			if (m_spare.size() < m_preFrames)
+			{
+				m_spare.push_back(std::vector<uint8_t>());
+				m_spare.back().swap(frame.data);
+			}
+			m_release.pop_front();
+			PushJob(slot, flags);
+		}
+
+		// A trigger moves the ring to the frames waiting to be written.
+		// These are written one per pass, in between the frames appended
+		// meanwhile, which queue up behind them until they are all written,
+		// so the caller's slots are freed at the cost of a copy.
+		void Convert()
+		{
+			// trigger state, owned by this thread
+			bool recording = false;
+			bool startSegment = false;
+			uint64_t remaining = 0;
+
+			for (;;)
+			{
+				size_t slot = m_slots.size() + 1;
+				size_t ringSlot = m_slots.size();
+				bool failed;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_workCv.wait(lock, [this]() { return (m_stop && m_release.empty()) || !m_toConvert.empty() || (!m_release.empty() && (!m_ringFree.empty() || m_error)); });
+					failed = static_cast<bool>(m_error);
+					if (!m_toConvert.empty())
+					{
+						slot = m_toConvert.front();
+						m_toConvert.pop_front();
+					}
+					else if (m_release.empty())
+					{
+						m_converted = true;
+						break;
+					}
+					if (!failed && !m_release.empty() && !m_ringFree.empty())
+					{
+						ringSlot = m_ringFree.front();
+						m_ringFree.pop_front();
+					}
+				}
+
+				// after an error, frames waiting to be written are dropped
+				if (failed)
+					m_release.clear();
+
+				if (slot == m_slots.size())
+				{
+					if (!recording && !failed)
+					{
+						startSegment = m_ring.empty();
+						if (!m_ring.empty())
+						{
+							m_ring.front().flags |= JobStartSegment;
+							if (m_postFrames == 0)
+								m_ring.back().flags |= JobEndSegment;
+							for (size_t i = 0; i < m_ring.size(); i++)
+							{
+								m_release.push_back(RingFrame());
+								m_release.back().data.swap(m_ring[i].data);
+								m_release.back().compressed = m_ring[i].compressed;
+								m_release.back().flags = m_ring[i].flags;
+							}
+							m_ring.clear();
+						}
+						recording = m_postFrames > 0;
+						remaining = m_postFrames;
+					}
+					else if (remaining < m_postFrames)
+						remaining = m_postFrames;
+				}
+				else if (slot < m_slots.size())
+				{
+					// after an error, frames are passed on unconverted and
+					// released by the encoding thread
+					int flags = 0;
+					bool queued = false;
+					if (m_triggered && !failed)
+					{
+						if (!recording)
+						{
+							try
+							{
+								Hold(m_slots[slot]);
+							}
+							catch (...)
+							{
+								Fail();
+							}
+							queued = true;
+						}
+						else
+						{
+							if (startSegment)
+								flags |= JobStartSegment;
+							startSegment = false;
+							if (--remaining == 0)
+							{
+								flags |= JobEndSegment;
+								recording = false;
+							}
+						}
+
+						if (!queued && !m_release.empty())
+						{
+							try
+							{
+								m_release.push_back(RingFrame());
+								Store(m_slots[slot], m_release.back());
+								m_release.back().flags = flags;
+							}
+							catch (...)
+							{
+								Fail();
+							}
+							queued = true;
+						}
+					}
+
+					if (queued)
+						ReleaseSlot(slot);
+					else
+					{
+						if (!failed)
+						{
+							try
+							{
+								ConvertFrame(m_slots[slot]);
+							}
+							catch (...)
+							{
+								Fail();
+							}
+						}
+						PushJob(slot, flags);
+					}
+				}
+
+				if (ringSlot < m_slots.size())
+				{
+					if (m_release.empty())
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_ringFree.push_back(ringSlot);
+					}
+					else
+						ReleaseOne(ringSlot);
+				}
+			}
+			m_encodeCv.notify_one();
+		}
+
+		// takes the segment opened ahead of time and, when recordings are
+		// cut, asks for another
+		Segment* NextSegment()
+		{
+			Segment* pSegment;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_segmentCv.wait(lock, [this]() { return m_pNext != NULL || m_error; });
+				if (m_pNext == NULL)
+					std::rethrow_exception(m_error);
+				pSegment = m_pNext;
+				m_pNext = NULL;
+				m_needNext = m_segmentFrames > 0 || m_segmentBytes > 0 || m_triggered;
+				m_fileNames.push_back(pSegment->fileName);
+			}
+			m_segmentCv.notify_all();
+			return pSegment;
+		}
+
+		// hands a finished segment to the segment thread to close
+		void Retire(Segment* pSegment)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_closing.push_back(pSegment);
+			}
+			m_segmentCv.notify_all();
+		}
+
+		bool SegmentFull(const Segment& segment) const
+		{
+			if (m_segmentFrames > 0 && segment.frames >= m_segmentFrames)
+				return true;
+			return m_segmentBytes > 0 && GetFileSize(segment.fileName) >= m_segmentBytes;
+		}
+
+		void Encode()
+		{
+			Segment* pCurrent = NULL;
+			for (;;)
+			{
+				Job job;
+				bool failed;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_encodeCv.wait(lock, [this]() { return m_converted || !m_toEncode.empty(); });
+					if (m_toEncode.empty())
+						break;
+					job = m_toEncode.front();
+					m_toEncode.pop_front();
+					failed = static_cast<bool>(m_error);
+				}
+
+				if (!failed)
+				{
+					try
+					{
+						if (pCurrent != NULL && ((job.flags & JobStartSegment) != 0 || SegmentFull(*pCurrent)))
+						{
+							Retire(pCurrent);
+							pCurrent = NULL;
+						}
+						if (pCurrent == NULL)
+							pCurrent = NextSegment();
+
+						const Slot& frame = m_slots[job.slot];
+						pCurrent->pRecorder->AppendImage(m_input == Internal::VideoInputCopy ? &frame.input[0] : &frame.output[0]);
+						pCurrent->frames++;
+
+						if ((job.flags & JobEndSegment) != 0)
+						{
+							Retire(pCurrent);
+							pCurrent = NULL;
+						}
+					}
+					catch (...)
+					{
+						Fail();
+					}
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (job.slot < m_maxQueued)
+						m_free.push_back(job.slot);
+					else
+						m_ringFree.push_back(job.slot);
+					if (!m_error)
+						m_encoded++;
+				}
+				m_spaceCv.notify_all();
+				if (job.slot >= m_maxQueued)
+					m_workCv.notify_all();
+			}
+			if (pCurrent != NULL)
+				Retire(pCurrent);
+		}
+
+		// opens the next segment ahead of time and closes finished ones, so
+		// the encoding thread never waits on file creation or muxer
+		// flushes
+		void ManageSegments()
+		{
+			for (;;)
+			{
+				Segment* pSegment = NULL;
+				bool create = false;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_segmentCv.wait(lock, [this]() { return m_segmentStop || !m_closing.empty() || (m_needNext && !m_error); });
+					if (m_needNext && !m_error && !m_segmentStop)
+					{
+						create = true;
+						m_needNext = false;
+					}
+					else if (!m_closing.empty())
+					{
+						pSegment = m_closing.front();
+						m_closing.pop_front();
+					}
+					else
+						break;
+				}
+
+				if (create)
+				{
+					try
+					{
+						Segment* pNext = CreateSegment();
+						try
+						{
+							pNext->pRecorder->Open();
+						}
+						catch (...)
+						{
+							delete pNext->pRecorder;
+							delete pNext;
+							throw;
+						}
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_pNext = pNext;
+					}
+					catch (...)
+					{
+						Fail();
+					}
+					m_segmentCv.notify_all();
+					continue;
+				}
+
+				try
+				{
+					pSegment->pRecorder->Close();
+				}
+				catch (...)
+				{
+					Fail();
+				}
+				delete pSegment->pRecorder;
+				delete pSegment;
+			}
+
+			// the segment opened ahead of time was never used
+			if (m_pNext != NULL)
+			{
+				try
+				{
+					m_pNext->pRecorder->Close();
+				}
+				catch (...)
+				{
+				}
+				std::remove(m_pNext->fileName.c_str());
+				delete m_pNext->pRecorder;
+				delete m_pNext;
+				m_pNext = NULL;
+			}
+		}
+
+		VideoParams m_params;
+		std::string m_pattern;
+		std::function<void(VideoRecorder&)> m_format;
+		uint64_t m_segmentFrames;
+		uint64_t m_segmentBytes;
+		uint64_t m_preFrames;
+		uint64_t m_postFrames;
+		bool m_triggered;
+		bool m_compressRing;
+
+		Internal::EVideoInput m_input;
+		uint64_t m_inputFormat;
+		size_t m_redX;
+		size_t m_redY;
+		size_t m_red;
+		size_t m_blue;
+		size_t m_inputSize;
+		size_t m_outputSize;
+		size_t m_maxQueued;
+		size_t m_numThreads;
+		bool m_open;
+
+		// frames move from m_free to m_toConvert to m_toEncode and back
+		std::vector<Slot> m_slots;
+		std::mutex m_mutex;
+		std::condition_variable m_workCv;
+		std::condition_variable m_encodeCv;
+		std::condition_variable m_spaceCv;
+		std::deque<size_t> m_free;
+		std::deque<size_t> m_ringFree;
+		std::deque<size_t> m_toConvert;
+		std::deque<Job> m_toEncode;
+		bool m_stop;
+		bool m_converted;
+		std::exception_ptr m_error;
+		size_t m_peakDepth;
+		uint64_t m_encoded;
+		uint64_t m_dropped;
+
+		// pre-trigger ring, frames waiting to be written after a trigger
+		// and storage to reuse, used by the conversion thread only
+		std::deque<RingFrame> m_ring;
+		std::deque<RingFrame> m_release;
+		std::vector<std::vector<uint8_t> > m_spare;
+		RawCodec m_ringCodec;
+
+		// segments, guarded by m_mutex
+		std::condition_variable m_segmentCv;
+		Segment* m_pNext;
+		bool m_needNext;
+		uint64_t m_nextIndex;
+		std::deque<Segment*> m_closing;
+		std::vector<std::string> m_fileNames;
+		bool m_segmentStop;
+
+		// conversion helpers, started by Open and stopped by Close; each
+		// frame is a new round of bands
+		std::vector<std::thread> m_helpers;
+		std::mutex m_bandMutex;
+		std::condition_variable m_bandCv;
+		std::condition_variable m_bandDoneCv;
+		Slot* m_pBandSlot;
+		uint64_t m_bandRound;
+		size_t m_bandsBusy;
+		bool m_bandStop;
+		std::atomic<size_t> m_nextBand;
+		size_t m_numBands;
+
+		std::thread m_converter;
+		std::thread m_encoder;
+		std::thread m_segmenter;
+
+		AsyncVideoRecorder(const AsyncVideoRecorder&);
+		AsyncVideoRecorder& operator=(const AsyncVideoRecorder&);
+	};
+}
@@ -0,0 +1,783 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SaveDefs.h"
+#include "SequenceDefs.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <csetjmp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <jpeglib.h>
+
+namespace Save
+{
+	namespace Internal
+	{
+		// libjpeg reports fatal errors through error_exit, which must not
+		// return; the encoder jumps back out of the slice being compressed
+		struct JpegErrorManager
+		{
+			jpeg_error_mgr pub;
+			jmp_buf jump;
+			char message[JMSG_LENGTH_MAX];
+		};
+
+		inline void JpegErrorExit(j_common_ptr cinfo)
+		{
+			JpegErrorManager* pManager = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+			(*cinfo->err->format_message)(cinfo, pManager->message);
+			longjmp(pManager->jump, 1);
+		}
+
+		inline void JpegOutputMessage(j_common_ptr)
+		{
+		}
+
+		inline uint8_t JpegClamp(int value)
+		{
+			return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+		}
+
+		// full range BT.601 (JFIF) conversion in 16-bit fixed point; the
+		// offsets keep the sums positive before the shift
+		inline uint8_t JpegLuma(int r, int g, int b)
+		{
+			return static_cast<uint8_t>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+		}
+
+		inline uint8_t JpegCb(int r, int g, int b)
+		{
+			return JpegClamp((-11059 * r - 21709 * g + 32768 * b + (128 << 16) + 32768) >> 16);
+		}
+
+		inline uint8_t JpegCr(int r, int g, int b)
+		{
+			return JpegClamp((32768 * r - 27439 * g - 5329 * b + (128 << 16) + 32768) >> 16);
+		}
+
+		// reflects an out of range coordinate back into the image; unlike
+		// clamping, reflection keeps the Bayer colour phase
+		inline size_t JpegMirror(ptrdiff_t value, size_t size)
+		{
+			if (value < 0)
+				return static_cast<size_t>(-value);
+			if (static_cast<size_t>(value) >= size)
+				return 2 * size - 2 - static_cast<size_t>(value);
+			return static_cast<size_t>(value);
+		}
+
+		// luma of one Bayer row from a bilinear demosaic of its 3x3
+		// neighbourhood; redX and redY locate the red site in the 2x2 tile
+		inline void JpegBayerLumaRow(const uint8_t* pUp, const uint8_t* pRow, const uint8_t* pDown, size_t width, size_t redX, bool redRow, uint8_t* pOut)
+		{
+			for (size_t x = 0; x < width; x++)
+			{
+				size_t left = x > 0 ? x - 1 : 1;
+				size_t right = x + 1 < width ? x + 1 : width - 2;
+				bool redColumn = (x & 1) == redX;
+				int r, g, b;
+				if (redRow == redColumn)
+				{
+					int value = pRow[x];
+					int diagonal = (pUp[left] + pUp[right] + pDown[left] + pDown[right] + 2) >> 2;
+					g = (pRow[left] + pRow[right] + pUp[x] + pDown[x] + 2) >> 2;
+					r = redRow ? value : diagonal;
+					b = redRow ? diagonal : value;
+				}
+				else
+				{
+					int horizontal = (pRow[left] + pRow[right] + 1) >> 1;
+					int vertical = (pUp[x] + pDown[x] + 1) >> 1;
+					g = pRow[x];
+					r = redRow ? horizontal : vertical;
+					b = redRow ? vertical : horizontal;
+				}
+				pOut[x] = JpegLuma(r, g, b);
+			}
+		}
+
+		// returns the offset of the entropy-coded data of a baseline JPEG
+		// and the offset of its frame header
+		inline size_t JpegFindScan(const uint8_t* pData, size_t size, size_t& frameOffset)
+		{
+			size_t pos = 2;
+			frameOffset = 0;
+			while (pos + 4 <= size)
+			{
+				if (pData[pos] != 0xFF)
+					break;
+				uint8_t marker = pData[pos + 1];
+				if (marker == 0xFF)
+				{
+					pos++;
+					continue;
+				}
+				size_t length = (static_cast<size_t>(pData[pos + 2]) << 8) | pData[pos + 3];
+				if (marker >= 0xC0 && marker <= 0xC2)
+					frameOffset = pos;
+				if (marker == 0xDA)
+				{
+					if (frameOffset == 0 || pos + 2 + length > size)
+						break;
+					return pos + 2 + length;
+				}
+				pos += 2 + length;
+			}
+			throw std::runtime_error("malformed JPEG slice");
+		}
+	}
+
+	/**
+	 * @class JpegEncoder
+	 *
+	 * The JPEG encoder compresses one image on several threads with
+	 * libjpeg(-turbo), whose SIMD colour conversion, DCT and Huffman coding
+	 * are used where the library provides them. The image is cut into
+	 * slices of whole MCU rows. Each slice is compressed independently with
+	 * identical tables, and the slices are joined with restart markers into
+	 * one baseline JPEG that any decoder reads.
+	 *
+	 * Besides RGB8 and BGR8, the encoder takes camera formats directly and
+	 * converts them to YCbCr one MCU row at a time inside the encoder, so no
+	 * full-size intermediate image is made:
+	 *  - Mono8 is encoded as greyscale
+	 *  - YCbCr422_8/YUV422_8 (YUYV) and YCbCr422_8_CbYCrY/YUV422_8_UYVY
+	 *    (UYVY) are encoded as 4:2:2 without resampling
+	 *  - BayerRG8, BayerGR8, BayerGB8 and BayerBG8 are encoded as 4:2:0,
+	 *    with luma from a bilinear demosaic and chroma from each 2x2 tile
+	 *
+	 * The subsampling setting applies to RGB8 and BGR8; the other formats
+	 * keep their native chroma resolution.
+	 *
+	 * This header needs libjpeg or libjpeg-turbo; link with -ljpeg. It is
+	 * not included by SaveApi.h.
+	 *
+	 * \code{.cpp}
+	 * 	// saving a Bayer image without converting it first
+	 * 	{
+	 * 		Save::JpegEncoder encoder(90);
+	 * 		encoder.Save("savedimages/image.jpg", pImage->GetData(), pImage->GetWidth(), pImage->GetHeight(), pImage->GetPixelFormat());
+	 * 	}
+	 * \endcode
+	 */
+	class JpegEncoder
+	{
+	public:
+		/**
+		 * @fn JpegEncoder(size_t quality = 75, size_t numThreads = 0)
+		 *
+		 * @param quality
+		 *  - Type: size_t
+		 *  - Default: 75
+		 *  - Range: 1-100
+		 *  - Quality, as for Save::ImageWriter::SetJpeg
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Threads per image
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * A constructor.
+		 */
+		JpegEncoder(size_t quality = 75, size_t numThreads = 0)
+			: m_quality(ClampQuality(quality)),
+			  m_subsampling(Subsampling420),
+			  m_numThreads(numThreads),
+			  m_sliceRows(0)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+		}
+
+		/**
+		 * @fn virtual ~JpegEncoder()
+		 *
+		 * A destructor.
+		 */
+		virtual ~JpegEncoder()
+		{
+		}
+
+		/**
+		 * @fn virtual void SetQuality(size_t quality)
+		 *
+		 * @param quality
+		 *  - Type: size_t
+		 *  - Range: 1-100
+		 *  - Quality
+		 *
+		 * <B> SetQuality </B> sets the quality used to scale the quantization
+		 * tables.
+		 */
+		virtual void SetQuality(size_t quality)
+		{
+			m_quality = ClampQuality(quality);
+		}
+
+		/**
+		 * @fn virtual void SetSubsampling(EJpegSubsampling subsampling)
+		 *
+		 * @param subsampling
+		 *  - Type: Save::EJpegSubsampling
+		 *  - Chroma subsampling
+		 *
+		 * <B> SetSubsampling </B> sets the chroma subsampling of RGB8 and
+		 * BGR8 input. The default is 4:2:0.
+		 */
+		virtual void SetSubsampling(EJpegSubsampling subsampling)
+		{
+			m_subsampling = subsampling;
+		}
+
+		/**
+		 * @fn virtual void SetSliceRows(size_t sliceRows)
+		 *
+		 * @param sliceRows
+		 *  - Type: size_t
+		 *  - Unit: rows
+		 *  - Approximate rows per slice, rounded up to whole MCU rows
+		 *  - 0 picks about four slices per thread
+		 *
+		 * <B> SetSliceRows </B> sets how finely images are split between
+		 * threads. Each slice boundary costs a two byte restart marker and
+		 * resets the DC prediction, so very small slices grow the file
+		 * slightly.
+		 */
+		virtual void SetSliceRows(size_t sliceRows)
+		{
+			m_sliceRows = sliceRows;
+		}
+
+		/**
+		 * @fn static bool IsSupported(uint64_t pixelFormat)
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the encoder takes the pixel format directly
+		 *
+		 * <B> IsSupported </B> checks whether images of a pixel format can be
+		 * passed to the encoder without conversion.
+		 */
+		static bool IsSupported(uint64_t pixelFormat)
+		{
+			Input input;
+			size_t redX, redY;
+			return GetInput(pixelFormat, input, redX, redY);
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> Encode(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data, rows top to bottom without padding
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the data
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - JPEG file contents
+		 *
+		 * <B> Encode </B> encodes an image to JPEG in memory.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument for unsupported pixel formats, and
+		 *    for odd dimensions of YCbCr 4:2:2 and Bayer images
+		 *  - Throws std::runtime_error if libjpeg fails
+		 */
+		virtual std::vector<uint8_t> Encode(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat)
+		{
+			Frame frame;
+			if (!GetInput(pixelFormat, frame.input, frame.redX, frame.redY))
+				throw std::invalid_argument("unsupported pixel format for JPEG");
+			if (width == 0 || height == 0)
+				throw std::invalid_argument("empty image");
+			if (width > JPEG_MAX_DIMENSION || height > JPEG_MAX_DIMENSION)
+				throw std::invalid_argument("image too large for JPEG");
+			if ((frame.input == InputYuyv || frame.input == InputUyvy) && width % 2 != 0)
+				throw std::invalid_argument("YCbCr 4:2:2 images need an even width");
+			if (frame.input == InputBayer && (width < 2 || height < 2 || width % 2 != 0 || height % 2 != 0))
+				throw std::invalid_argument("Bayer images need an even width and height");
+
+			frame.pData = pData;
+			frame.width = width;
+			frame.height = height;
+			SetSampling(frame);
+
+			// slices of whole MCU rows; a restart interval cannot exceed
+			// 65535 MCUs
+			size_t mcuRows = (height + frame.mcuHeight - 1) / frame.mcuHeight;
+			size_t mcusPerRow = (width + frame.mcuWidth - 1) / frame.mcuWidth;
+			size_t sliceMcuRows = m_sliceRows > 0 ? (m_sliceRows + frame.mcuHeight - 1) / frame.mcuHeight : (m_numThreads > 1 ? (mcuRows + m_numThreads * 4 - 1) / (m_numThreads * 4) : mcuRows);
+			if (sliceMcuRows * mcusPerRow > 65535)
+				sliceMcuRows = 65535 / mcusPerRow;
+			if (sliceMcuRows == 0)
+				sliceMcuRows = 1;
+			size_t numSlices = (mcuRows + sliceMcuRows - 1) / sliceMcuRows;
+			frame.restartInterval = numSlices > 1 ? static_cast<unsigned int>(sliceMcuRows * mcusPerRow) : 0;
+
+			std::vector<Slice> slices(numSlices);
+			SliceGuard guard(slices);
+			for (size_t i = 0; i < numSlices; i++)
+			{
+				slices[i].firstRow = i * sliceMcuRows * frame.mcuHeight;
+				slices[i].numRows = (i + 1 == numSlices) ? height - slices[i].firstRow : sliceMcuRows * frame.mcuHeight;
+			}
+
+			std::atomic<size_t> next(0);
+			auto worker = [&]() {
+				for (size_t i = next++; i < slices.size(); i = next++)
+					EncodeSlice(frame, slices[i]);
+			};
+
+			size_t numThreads = m_numThreads < numSlices ? m_numThreads : numSlices;
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < numThreads; i++)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+
+			for (size_t i = 0; i < numSlices; i++)
+			{
+				if (slices[i].failed)
+					throw std::runtime_error(std::string("JPEG compression failed: ") + slices[i].message);
+			}
+
+			// the first slice supplies the headers, with the frame height
+			// patched to the full image; every slice's scan data follows,
+			// separated by restart markers numbered modulo 8
+			std::vector<size_t> scanOffsets(numSlices);
+			size_t total = 0;
+			for (size_t i = 0; i < numSlices; i++)
+			{
+				size_t frameOffset;
+				scanOffsets[i] = Internal::JpegFindScan(slices[i].pOut, slices[i].outSize, frameOffset);
+				if (i == 0)
+				{
+					slices[0].pOut[frameOffset + 5] = static_cast<uint8_t>(height >> 8);
+					slices[0].pOut[frameOffset + 6] = static_cast<uint8_t>(height);
+				}
+				total += slices[i].outSize - scanOffsets[i];
+			}
+
+			std::vector<uint8_t> out;
+			out.reserve(scanOffsets[0] + total + 2 * numSlices);
+			out.insert(out.end(), slices[0].pOut, slices[0].pOut + scanOffsets[0]);
+			for (size_t i = 0; i < numSlices; i++)
+			{
+				if (i > 0)
+				{
+					out.push_back(0xFF);
+					out.push_back(static_cast<uint8_t>(0xD0 + ((i - 1) & 7)));
+				}
+				// scan data without the end of image marker
+				out.insert(out.end(), slices[i].pOut + scanOffsets[i], slices[i].pOut + slices[i].outSize - 2);
+			}
+			out.push_back(0xFF);
+			out.push_back(0xD9);
+			return out;
+		}
+
+		/**
+		 * @fn virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, bool createDirectories = true)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File to write
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the data
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * <B> Save </B> encodes an image and writes it to a file.
+		 */
+		virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, bool createDirectories = true)
+		{
+			std::vector<uint8_t> jpeg = Encode(pData, width, height, pixelFormat);
+			if (createDirectories)
+				Internal::CreateDirectories(pFileName);
+			FILE* pFile = std::fopen(pFileName, "wb");
+			if (pFile == NULL)
+				throw Internal::SystemError("unable to create", pFileName);
+			size_t written = std::fwrite(&jpeg[0], 1, jpeg.size(), pFile);
+			if (std::fclose(pFile) != 0 || written != jpeg.size())
+				throw Internal::SystemError("unable to write", pFileName);
+		}
+
+	private:
+		enum Input
+		{
+			InputGray,
+			InputRgb,
+			InputBgr,
+			InputYuyv,
+			InputUyvy,
+			InputBayer
+		};
+
+		struct Frame
+		{
+			const uint8_t* pData;
+			size_t width;
+			size_t height;
+			Input input;
+			size_t redX;
+			size_t redY;
+			int lumaH;
+			int lumaV;
+			size_t mcuWidth;
+			size_t mcuHeight;
+			unsigned int restartInterval;
+		};
+
+		struct Slice
+		{
+			Slice() : firstRow(0), numRows(0), pOut(NULL), outSize(0), failed(false)
+			{
+				message[0] = '\0';
+			}
+
+			size_t firstRow;
+			size_t numRows;
+			unsigned char* pOut;
+			unsigned long outSize;
+			bool failed;
+			char message[JMSG_LENGTH_MAX];
+		};
+
+		// libjpeg allocates the output of each slice with malloc
+		struct SliceGuard
+		{
+			SliceGuard(std::vector<Slice>& slices) : m_slices(slices)
+			{
+			}
+
+			~SliceGuard()
+			{
+				for (size_t i = 0; i < m_slices.size(); i++)
+					std::free(m_slices[i].pOut);
+			}
+
+			std::vector<Slice>& m_slices;
+		};
+
+		static size_t ClampQuality(size_t quality)
+		{
+			return quality < 1 ? 1 : (quality > 100 ? 100 : quality);
+		}
+
+		static bool GetInput(uint64_t pixelFormat, Input& input, size_t& redX, size_t& redY)
+		{
+			redX = 0;
+			redY = 0;
+			switch (pixelFormat)
+			{
+			case Mono8: input = InputGray; return true;
+			case RGB8: input = InputRgb; return true;
+			case BGR8: input = InputBgr; return true;
+			case YCbCr422_8:
+			case YUV422_8: input = InputYuyv; return true;
+			case YCbCr422_8_CbYCrY:
+			case YUV422_8_UYVY: input = InputUyvy; return true;
+			case BayerRG8: input = InputBayer; return true;
+			case BayerGR8: input = InputBayer; redX = 1; return true;
+			case BayerGB8: input = InputBayer; redY = 1; return true;
+			case BayerBG8: input = InputBayer; redX = 1; redY = 1; return true;
+			default: return false;
+			}
+		}
+
+		void SetSampling(Frame& frame) const
+		{
+			frame.lumaH = 1;
+			frame.lumaV = 1;
+			if (frame.input == InputYuyv || frame.input == InputUyvy)
+				frame.lumaH = 2;
+			else if (frame.input == InputBayer)
+				frame.lumaH = frame.lumaV = 2;
+			else if (frame.input != InputGray)
+			{
+				switch (m_subsampling)
+				{
+				case Subsampling411: frame.lumaH = 4; break;
+				case Subsampling420: frame.lumaH = frame.lumaV = 2; break;
+				case Subsampling422: frame.lumaH = 2; break;
+				default: break;
+				}
+			}
+			frame.mcuWidth = DCTSIZE * frame.lumaH;
+			frame.mcuHeight = DCTSIZE * frame.lumaV;
+		}
+
+		void EncodeSlice(const Frame& frame, Slice& slice)
+		{
+			// planar YCbCr for one MCU row, padded to whole MCUs, for the
+			// formats converted here
+			bool raw = frame.input == InputYuyv || frame.input == InputUyvy || frame.input == InputBayer;
+			size_t lumaWidth = (frame.width + frame.mcuWidth - 1) / frame.mcuWidth * frame.mcuWidth;
+			size_t chromaWidth = lumaWidth / frame.lumaH;
+			std::vector<uint8_t> planes;
+			if (raw)
+				planes.resize(lumaWidth * frame.mcuHeight + 2 * chromaWidth * DCTSIZE);
+			Compress(frame, slice, raw ? &planes[0] : NULL, lumaWidth, chromaWidth);
+		}
+
+		// everything libjpeg can jump out of lives here, with no objects
+		// that need destruction
+		void Compress(const Frame& frame, Slice& slice, uint8_t* pPlanes, size_t lumaWidth, size_t chromaWidth)
+		{
+			jpeg_compress_struct cinfo;
+			Internal::JpegErrorManager error;
+			cinfo.err = jpeg_std_error(&error.pub);
+			error.pub.error_exit = Internal::JpegErrorExit;
+			error.pub.output_message = Internal::JpegOutputMessage;
+			unsigned char* pOut = NULL;
+			unsigned long outSize = 0;
+
+			if (setjmp(error.jump))
+			{
+				jpeg_destroy_compress(&cinfo);
+				std::free(pOut);
+				slice.failed = true;
+				std::memcpy(slice.message, error.message, sizeof(slice.message));
+				return;
+			}
+
+			jpeg_create_compress(&cinfo);
+			jpeg_mem_dest(&cinfo, &pOut, &outSize);
+			cinfo.image_width = static_cast<JDIMENSION>(frame.width);
+			cinfo.image_height = static_cast<JDIMENSION>(slice.numRows);
+			cinfo.input_components = frame.input == InputGray ? 1 : 3;
+			switch (frame.input)
+			{
+			case InputGray: cinfo.in_color_space = JCS_GRAYSCALE; break;
+			case InputRgb: cinfo.in_color_space = JCS_RGB; break;
+#ifdef JCS_EXTENSIONS
+			case InputBgr: cinfo.in_color_space = JCS_EXT_BGR; break;
+#endif
+			default: cinfo.in_color_space = JCS_YCbCr; break;
+			}
+#ifndef JCS_EXTENSIONS
+			if (frame.input == InputBgr)
+				ERREXIT(&cinfo, JERR_BAD_IN_COLORSPACE);
+#endif
+			jpeg_set_defaults(&cinfo);
+			jpeg_set_quality(&cinfo, static_cast<int>(m_quality), TRUE);
+			// every slice must share the standard Huffman tables
+			cinfo.optimize_coding = FALSE;
+			cinfo.restart_interval = frame.restartInterval;
+			if (cinfo.input_components == 3)
+			{
+				cinfo.comp_info[0].h_samp_factor = frame.lumaH;
+				cinfo.comp_info[0].v_samp_factor = frame.lumaV;
+				cinfo.comp_info[1].h_samp_factor = cinfo.comp_info[1].v_samp_factor = 1;
+				cinfo.comp_info[2].h_samp_factor = cinfo.comp_info[2].v_samp_factor = 1;
+			}
+
+			bool raw = pPlanes != NULL;
+			if (raw)
+			{
+				cinfo.raw_data_in = TRUE;
+#if JPEG_LIB_VERSION >= 70
+				cinfo.do_fancy_downsampling = FALSE;
+#endif
+			}
+
+			jpeg_start_compress(&cinfo, TRUE);
+
+			const uint8_t* pSlice = frame.pData + slice.firstRow * frame.width * BytesPerPixel(frame.input);
+			if (!raw)
+			{
+				size_t stride = frame.width * BytesPerPixel(frame.input);
+				while (cinfo.next_scanline < cinfo.image_height)
+				{
+					JSAMPROW rows[16];
+					JDIMENSION count = 0;
+					for (; count < 16 && cinfo.next_scanline + count < cinfo.image_height; count++)
+						rows[count] = const_cast<JSAMPROW>(pSlice + (cinfo.next_scanline + count) * stride);
+					jpeg_write_scanlines(&cinfo, rows, count);
+				}
+			}
+			else
+			{
+				JSAMPROW luma[16];
+				JSAMPROW cb[DCTSIZE];
+				JSAMPROW cr[DCTSIZE];
+				JSAMPARRAY components[3] = { luma, cb, cr };
+				uint8_t* pCb = pPlanes + lumaWidth * frame.mcuHeight;
+				uint8_t* pCr = pCb + chromaWidth * DCTSIZE;
+				for (size_t i = 0; i < frame.mcuHeight; i++)
+					luma[i] = pPlanes + i * lumaWidth;
+				for (size_t i = 0; i < DCTSIZE; i++)
+				{
+					cb[i] = pCb + i * chromaWidth;
+					cr[i] = pCr + i * chromaWidth;
+				}
+
+				for (size_t row = 0; row < slice.numRows; row += frame.mcuHeight)
+				{
+					if (frame.input == InputBayer)
+						ConvertBayer(frame, slice.firstRow + row, luma, cb, cr, lumaWidth);
+					else
+						ConvertYuv422(frame, slice.firstRow + row, luma, cb, cr, lumaWidth);
+					jpeg_write_raw_data(&cinfo, components, static_cast<JDIMENSION>(frame.mcuHeight));
+				}
+			}
+
+			jpeg_finish_compress(&cinfo);
+			jpeg_destroy_compress(&cinfo);
+			slice.pOut = pOut;
+			slice.outSize = outSize;
+		}
+
+		static size_t BytesPerPixel(Input input)
+		{
+			switch (input)
+			{
+			case InputGray: return 1;
+			case InputRgb:
+			case InputBgr: return 3;
+			default: return 2;
+			}
+		}
+
+		// splits one MCU row of packed 4:2:2 into planes; rows and columns
+		// past the image repeat its last row and pixel pair
+		static void ConvertYuv422(const Frame& frame, size_t firstRow, JSAMPROW* pLuma, JSAMPROW* pCb, JSAMPROW* pCr, size_t lumaWidth)
+		{
+			size_t lumaOffset = frame.input == InputYuyv ? 0 : 1;
+			size_t cbOffset = frame.input == InputYuyv ? 1 : 0;
+			size_t pairs = frame.width / 2;
+			for (size_t i = 0; i < frame.mcuHeight; i++)
+			{
+				size_t row = firstRow + i < frame.height ? firstRow + i : frame.height - 1;
+				const uint8_t* pIn = frame.pData + row * frame.width * 2;
+				uint8_t* pY = pLuma[i];
+				uint8_t* pU = pCb[i];
+				uint8_t* pV = pCr[i];
+				for (size_t x = 0; x < pairs; x++)
+				{
+					const uint8_t* pPair = pIn + 4 * x;
+					pY[2 * x] = pPair[lumaOffset];
+					pY[2 * x + 1] = pPair[lumaOffset + 2];
+					pU[x] = pPair[cbOffset];
+					pV[x] = pPair[cbOffset + 2];
+				}
+				for (size_t x = pairs; x < lumaWidth / 2; x++)
+				{
+					pY[2 * x] = pY[2 * x + 1] = pY[2 * pairs - 1];
+					pU[x] = pU[pairs - 1];
+					pV[x] = pV[pairs - 1];
+				}
+			}
+		}
+
+		// converts one MCU row of Bayer data to 4:2:0 planes: luma per
+		// pixel from the demosaic and chroma from each 2x2 tile
+		static void ConvertBayer(const Frame& frame, size_t firstRow, JSAMPROW* pLuma, JSAMPROW* pCb, JSAMPROW* pCr, size_t lumaWidth)
+		{
+			size_t width = frame.width;
+			size_t pairs = width / 2;
+			for (size_t i = 0; i < frame.mcuHeight; i += 2)
+			{
+				// the height is even, so a tile is either all inside the
+				// image or repeats the last one
+				size_t row = firstRow + i < frame.height ? firstRow + i : frame.height - 2;
+				for (size_t j = 0; j < 2; j++)
+				{
+					size_t y = row + j;
+					const uint8_t* pUp = frame.pData + Internal::JpegMirror(static_cast<ptrdiff_t>(y) - 1, frame.height) * width;
+					const uint8_t* pRow = frame.pData + y * width;
+					const uint8_t* pDown = frame.pData + Internal::JpegMirror(static_cast<ptrdiff_t>(y) + 1, frame.height) * width;
+					uint8_t* pY = pLuma[i + j];
+					Internal::JpegBayerLumaRow(pUp, pRow, pDown, width, frame.redX, (y & 1) == frame.redY, pY);
+					for (size_t x = width; x < lumaWidth; x++)
+						pY[x] = pY[width - 1];
+				}
+
+				const uint8_t* pTile[2] = { frame.pData + row * width, frame.pData + (row + 1) * width };
+				const uint8_t* pRed = pTile[frame.redY] + frame.redX;
+				const uint8_t* pBlue = pTile[1 - frame.redY] + (1 - frame.redX);
+				const uint8_t* pGreen1 = pTile[frame.redY] + (1 - frame.redX);
+				const uint8_t* pGreen2 = pTile[1 - frame.redY] + frame.redX;
+				uint8_t* pU = pCb[i / 2];
+				uint8_t* pV = pCr[i / 2];
+				for (size_t x = 0; x < pairs; x++)
+				{
+					int r = pRed[2 * x];
+					int g = (pGreen1[2 * x] + pGreen2[2 * x] + 1) >> 1;
+					int b = pBlue[2 * x];
+					pU[x] = Internal::JpegCb(r, g, b);
+					pV[x] = Internal::JpegCr(r, g, b);
+				}
+				for (size_t x = pairs; x < lumaWidth / 2; x++)
+				{
+					pU[x] = pU[pairs - 1];
+					pV[x] = pV[pairs - 1];
+				}
+			}
+		}
+
+		size_t m_quality;
+		EJpegSubsampling m_subsampling;
+		size_t m_numThreads;
+		size_t m_sliceRows;
+
+		JpegEncoder(const JpegEncoder&);
+		JpegEncoder& operator=(const JpegEncoder&);
+	};
+}
@@ -0,0 +1,620 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SequenceDefs.h"
+#include <zlib.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Save
+{
+	namespace Internal
+	{
+		const size_t PngFilterTypes = 5;
+
+		// PNG filter cost heuristic: sum of the filtered bytes taken as
+		// signed values
+		inline uint64_t PngFilterCost(const uint8_t* pRow, size_t size)
+		{
+			uint64_t cost = 0;
+			size_t i = 0;
+#if defined(__SSE2__)
+			const __m128i zero = _mm_setzero_si128();
+			__m128i sum = zero;
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i));
+				__m128i a = _mm_min_epu8(v, _mm_sub_epi8(zero, v));
+				sum = _mm_add_epi64(sum, _mm_sad_epu8(a, zero));
+			}
+			cost = static_cast<uint64_t>(_mm_cvtsi128_si32(sum)) + static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+#endif
+			for (; i < size; i++)
+				cost += pRow[i] < 128 ? pRow[i] : 256 - pRow[i];
+			return cost;
+		}
+
+		// writes the five filtered versions of a row; pPrev is NULL for the
+		// first row of the image
+		inline void PngFilterRow(const uint8_t* pRow, const uint8_t* pPrev, size_t size, size_t bpp, uint8_t* pOut[PngFilterTypes])
+		{
+			std::memcpy(pOut[0], pRow, size);
+
+			// sub
+			std::memcpy(pOut[1], pRow, bpp);
+			size_t i = bpp;
+#if defined(__SSE2__)
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i));
+				__m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i - bpp));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut[1] + i), _mm_sub_epi8(cur, left));
+			}
+#endif
+			for (; i < size; i++)
+				pOut[1][i] = static_cast<uint8_t>(pRow[i] - pRow[i - bpp]);
+
+			if (pPrev == NULL)
+			{
+				// no row above: up is none, average uses half the left pixel
+				// and paeth reduces to sub
+				std::memcpy(pOut[2], pRow, size);
+				std::memcpy(pOut[3], pRow, bpp);
+				for (i = bpp; i < size; i++)
+					pOut[3][i] = static_cast<uint8_t>(pRow[i] - (pRow[i - bpp] >> 1));
+				std::memcpy(pOut[4], pOut[1], size);
+				return;
+			}
+
+			// up
+			i = 0;
+#if defined(__SSE2__)
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i));
+				__m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrev + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut[2] + i), _mm_sub_epi8(cur, up));
+			}
+#endif
+			for (; i < size; i++)
+				pOut[2][i] = static_cast<uint8_t>(pRow[i] - pPrev[i]);
+
+			// average
+			for (i = 0; i < bpp; i++)
+				pOut[3][i] = static_cast<uint8_t>(pRow[i] - (pPrev[i] >> 1));
+#if defined(__SSE2__)
+			const __m128i one = _mm_set1_epi8(1);
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i));
+				__m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + i - bpp));
+				__m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrev + i));
+				// _mm_avg_epu8 rounds up; PNG needs the floor
+				__m128i avg = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut[3] + i), _mm_sub_epi8(cur, avg));
+			}
+#endif
+			for (; i < size; i++)
+				pOut[3][i] = static_cast<uint8_t>(pRow[i] - ((pRow[i - bpp] + pPrev[i]) >> 1));
+
+			// paeth
+			for (i = 0; i < bpp; i++)
+				pOut[4][i] = static_cast<uint8_t>(pRow[i] - pPrev[i]);
+			for (; i < size; i++)
+			{
+				int a = pRow[i - bpp];
+				int b = pPrev[i];
+				int c = pPrev[i - bpp];
+				int pa = std::abs(b - c);
+				int pb = std::abs(a - c);
+				int pc = std::abs(a + b - 2 * c);
+				int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+				pOut[4][i] = static_cast<uint8_t>(pRow[i] - predictor);
+			}
+		}
+
+		inline void PngPut32(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		inline void PngPutChunk(std::vector<uint8_t>& out, const char* pType, const uint8_t* pData, size_t size)
+		{
+			PngPut32(out, static_cast<uint32_t>(size));
+			size_t start = out.size();
+			out.insert(out.end(), pType, pType + 4);
+			if (size > 0)
+				out.insert(out.end(), pData, pData + size);
+			PngPut32(out, static_cast<uint32_t>(crc32(0, &out[start], static_cast<uInt>(size + 4))));
+		}
+	}
+
+	/**
+	 * @class PngEncoder
+	 *
+	 * The PNG encoder compresses one image on several threads. The image is
+	 * cut into bands of rows; each band is filtered and deflated on its own,
+	 * primed with the last 32 KB of the band before it so compression stays
+	 * close to a single stream. The bands are joined into one valid zlib
+	 * stream (the technique used by pigz), so the output is an ordinary PNG
+	 * that any decoder reads.
+	 *
+	 * Row filters are chosen per row with the minimum-sum-of-absolute-
+	 * differences heuristic, with SSE2 versions of the filters and the cost
+	 * function on x86. Fast mode skips the search, always uses the Up filter
+	 * and deflates at level 1 with run-length matching, trading file size for
+	 * several times the throughput.
+	 *
+	 * Supported inputs are 8 and 16 bit mono (8 and 16 bits per pixel) and 8
+	 * and 16 bit colour with or without alpha (24, 32, 48 and 64 bits per
+	 * pixel). 16-bit data is taken in host (little-endian) order. Colour
+	 * data is taken in BGR order by default, as produced for the image
+	 * writer.
+	 *
+	 * This header needs zlib; link with -lz. It is not included by
+	 * SaveApi.h.
+	 *
+	 * \code{.cpp}
+	 * 	// saving a 16-bit mono image on all cores
+	 * 	{
+	 * 		Save::PngEncoder encoder(6);
+	 * 		encoder.Save("savedimages/image.png", pImage->GetData(), pImage->GetWidth(), pImage->GetHeight(), 16);
+	 * 	}
+	 * \endcode
+	 */
+	class PngEncoder
+	{
+	public:
+		/**
+		 * @fn PngEncoder(size_t compression = 6, size_t numThreads = 0)
+		 *
+		 * @param compression
+		 *  - Type: size_t
+		 *  - Default: 6
+		 *  - Range: 0-9
+		 *  - Compression level, as for Save::ImageWriter::SetPng
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Threads per image
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * A constructor.
+		 */
+		PngEncoder(size_t compression = 6, size_t numThreads = 0)
+			: m_compression(compression > 9 ? 9 : compression),
+			  m_fast(false),
+			  m_bgr(true),
+			  m_numThreads(numThreads),
+			  m_bandSize(256 << 10)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+		}
+
+		/**
+		 * @fn virtual ~PngEncoder()
+		 *
+		 * A destructor.
+		 */
+		virtual ~PngEncoder()
+		{
+		}
+
+		/**
+		 * @fn virtual void SetCompression(size_t compression)
+		 *
+		 * @param compression
+		 *  - Type: size_t
+		 *  - Range: 0-9
+		 *  - Compression level
+		 *
+		 * <B> SetCompression </B> sets the deflate level used outside fast
+		 * mode.
+		 */
+		virtual void SetCompression(size_t compression)
+		{
+			m_compression = compression > 9 ? 9 : compression;
+		}
+
+		/**
+		 * @fn virtual void SetFast(bool fast)
+		 *
+		 * @param fast
+		 *  - Type: bool
+		 *  - If true, uses the Up filter and level 1 run-length deflate
+		 *  - Otherwise, uses adaptive filtering and the compression level
+		 *
+		 * <B> SetFast </B> turns fast mode on or off.
+		 */
+		virtual void SetFast(bool fast)
+		{
+			m_fast = fast;
+		}
+
+		/**
+		 * @fn virtual void SetBgr(bool bgr)
+		 *
+		 * @param bgr
+		 *  - Type: bool
+		 *  - If true, colour input is BGR(A)
+		 *  - Otherwise, colour input is RGB(A)
+		 *
+		 * <B> SetBgr </B> sets the channel order of colour input.
+		 */
+		virtual void SetBgr(bool bgr)
+		{
+			m_bgr = bgr;
+		}
+
+		/**
+		 * @fn virtual void SetBandSize(size_t bandSize)
+		 *
+		 * @param bandSize
+		 *  - Type: size_t
+		 *  - Unit: bytes
+		 *  - Approximate amount of image data per band
+		 *
+		 * <B> SetBandSize </B> sets how finely images are split between
+		 * threads. Smaller bands balance better across threads; larger bands
+		 * compress slightly better. The default is 256 KB.
+		 */
+		virtual void SetBandSize(size_t bandSize)
+		{
+			m_bandSize = bandSize > 0 ? bandSize : 1;
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> Encode(const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data, rows top to bottom without padding
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param bitsPerPixel
+		 *  - Type: size_t
+		 *  - Bits per pixel: 8, 16, 24, 32, 48 or 64
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - PNG file contents
+		 *
+		 * <B> Encode </B> encodes an image to PNG in memory.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument for unsupported bits per pixel
+		 */
+		virtual std::vector<uint8_t> Encode(const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel)
+		{
+			uint8_t depth;
+			uint8_t colorType;
+			size_t channels;
+			switch (bitsPerPixel)
+			{
+			case 8: depth = 8; colorType = 0; channels = 1; break;
+			case 16: depth = 16; colorType = 0; channels = 1; break;
+			case 24: depth = 8; colorType = 2; channels = 3; break;
+			case 32: depth = 8; colorType = 6; channels = 4; break;
+			case 48: depth = 16; colorType = 2; channels = 3; break;
+			case 64: depth = 16; colorType = 6; channels = 4; break;
+			default: throw std::invalid_argument("unsupported bits per pixel for PNG");
+			}
+			if (width == 0 || height == 0)
+				throw std::invalid_argument("empty image");
+
+			Frame frame;
+			frame.pData = pData;
+			frame.width = width;
+			frame.height = height;
+			frame.bpp = bitsPerPixel / 8;
+			frame.depth = depth;
+			frame.channels = channels;
+			frame.rowSize = width * frame.bpp;
+
+			// bands of whole rows
+			size_t bandRows = m_bandSize / (frame.rowSize + 1);
+			if (bandRows == 0)
+				bandRows = 1;
+			size_t numBands = (height + bandRows - 1) / bandRows;
+			std::vector<Band> bands(numBands);
+			for (size_t i = 0; i < numBands; i++)
+			{
+				bands[i].firstRow = i * bandRows;
+				bands[i].numRows = (i + 1 == numBands) ? height - bands[i].firstRow : bandRows;
+			}
+
+			// filtering first, then deflate, since each band's dictionary
+			// is the filtered tail of the band before it
+			RunParallel(frame, bands, &PngEncoder::FilterBand);
+			RunParallel(frame, bands, &PngEncoder::DeflateBand);
+
+			std::vector<uint8_t> out;
+			size_t compressed = 0;
+			for (size_t i = 0; i < numBands; i++)
+				compressed += bands[i].compressed.size();
+			out.reserve(compressed + 128);
+
+			static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			out.insert(out.end(), signature, signature + 8);
+
+			std::vector<uint8_t> ihdr;
+			Internal::PngPut32(ihdr, static_cast<uint32_t>(width));
+			Internal::PngPut32(ihdr, static_cast<uint32_t>(height));
+			ihdr.push_back(depth);
+			ihdr.push_back(colorType);
+			ihdr.push_back(0);
+			ihdr.push_back(0);
+			ihdr.push_back(0);
+			Internal::PngPutChunk(out, "IHDR", &ihdr[0], ihdr.size());
+
+			// zlib header, the joined raw deflate bands, then the combined
+			// adler32 of the filtered data
+			int level = m_fast ? 1 : static_cast<int>(m_compression);
+			uint8_t levelFlags = level <= 1 ? 0 : (level <= 5 ? 1 : (level == 6 ? 2 : 3));
+			uint16_t zlibHeader = static_cast<uint16_t>(0x7800 | (levelFlags << 6));
+			zlibHeader = static_cast<uint16_t>(zlibHeader + 31 - zlibHeader % 31);
+			uLong adler = adler32(0, NULL, 0);
+			for (size_t i = 0; i < numBands; i++)
+				adler = adler32_combine(adler, bands[i].adler, static_cast<z_off_t>(bands[i].filtered.size()));
+
+			std::vector<uint8_t> idat;
+			idat.reserve(compressed + 6);
+			idat.push_back(static_cast<uint8_t>(zlibHeader >> 8));
+			idat.push_back(static_cast<uint8_t>(zlibHeader));
+			for (size_t i = 0; i < numBands; i++)
+				idat.insert(idat.end(), bands[i].compressed.begin(), bands[i].compressed.end());
+			Internal::PngPut32(idat, static_cast<uint32_t>(adler));
+			Internal::PngPutChunk(out, "IDAT", &idat[0], idat.size());
+
+			Internal::PngPutChunk(out, "IEND", NULL, 0);
+			return out;
+		}
+
+		/**
+		 * @fn virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel, bool createDirectories = true)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File to write
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param bitsPerPixel
+		 *  - Type: size_t
+		 *  - Bits per pixel
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * <B> Save </B> encodes an image and writes it to a file.
+		 */
+		virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel, bool createDirectories = true)
+		{
+			std::vector<uint8_t> png = Encode(pData, width, height, bitsPerPixel);
+			if (createDirectories)
+				Internal::CreateDirectories(pFileName);
+			FILE* pFile = std::fopen(pFileName, "wb");
+			if (pFile == NULL)
+				throw Internal::SystemError("unable to create", pFileName);
+			size_t written = std::fwrite(&png[0], 1, png.size(), pFile);
+			if (std::fclose(pFile) != 0 || written != png.size())
+				throw Internal::SystemError("unable to write", pFileName);
+		}
+
+	private:
+		struct Frame
+		{
+			const uint8_t* pData;
+			size_t width;
+			size_t height;
+			size_t bpp;
+			size_t depth;
+			size_t channels;
+			size_t rowSize;
+		};
+
+		struct Band
+		{
+			size_t firstRow;
+			size_t numRows;
+			std::vector<uint8_t> filtered;
+			std::vector<uint8_t> compressed;
+			uLong adler;
+			int error;
+		};
+
+		typedef void (PngEncoder::*BandFunction)(const Frame&, std::vector<Band>&, size_t);
+
+		void RunParallel(const Frame& frame, std::vector<Band>& bands, BandFunction function)
+		{
+			std::atomic<size_t> next(0);
+			auto worker = [&]() {
+				for (size_t i = next++; i < bands.size(); i = next++)
+					(this->*function)(frame, bands, i);
+			};
+
+			size_t numThreads = m_numThreads < bands.size() ? m_numThreads : bands.size();
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < numThreads; i++)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+
+			for (size_t i = 0; i < bands.size(); i++)
+			{
+				if (bands[i].error != Z_OK)
+					throw std::runtime_error("PNG deflate failed");
+			}
+		}
+
+		// converts a row to PNG byte order: RGB channel order and big-endian
+		// samples
+		void ConvertRow(const Frame& frame, size_t row, uint8_t* pOut)
+		{
+			const uint8_t* pIn = frame.pData + row * frame.rowSize;
+			bool swapChannels = m_bgr && frame.channels >= 3;
+			if (frame.depth == 8 && !swapChannels)
+			{
+				std::memcpy(pOut, pIn, frame.rowSize);
+				return;
+			}
+
+			size_t sampleSize = frame.depth / 8;
+			for (size_t x = 0; x < frame.width; x++)
+			{
+				const uint8_t* pPixel = pIn + x * frame.bpp;
+				uint8_t* pDst = pOut + x * frame.bpp;
+				for (size_t c = 0; c < frame.channels; c++)
+				{
+					size_t src = (swapChannels && c < 3) ? 2 - c : c;
+					if (sampleSize == 1)
+						pDst[c] = pPixel[src];
+					else
+					{
+						pDst[2 * c] = pPixel[2 * src + 1];
+						pDst[2 * c + 1] = pPixel[2 * src];
+					}
+				}
+			}
+		}
+
+		void FilterBand(const Frame& frame, std::vector<Band>& bands, size_t index)
+		{
+			Band& band = bands[index];
+			band.error = Z_OK;
+			band.filtered.resize(band.numRows * (frame.rowSize + 1));
+
+			std::vector<uint8_t> scratch(frame.rowSize * (2 + Internal::PngFilterTypes));
+			uint8_t* pPrev = &scratch[0];
+			uint8_t* pCur = pPrev + frame.rowSize;
+			uint8_t* pOut[Internal::PngFilterTypes];
+			for (size_t i = 0; i < Internal::PngFilterTypes; i++)
+				pOut[i] = pCur + frame.rowSize * (i + 1);
+
+			if (band.firstRow > 0)
+				ConvertRow(frame, band.firstRow - 1, pPrev);
+
+			uint8_t* pDst = &band.filtered[0];
+			for (size_t r = 0; r < band.numRows; r++)
+			{
+				size_t row = band.firstRow + r;
+				ConvertRow(frame, row, pCur);
+				Internal::PngFilterRow(pCur, row > 0 ? pPrev : NULL, frame.rowSize, frame.bpp, pOut);
+
+				size_t best = 2;
+				if (!m_fast)
+				{
+					uint64_t bestCost = Internal::PngFilterCost(pOut[0], frame.rowSize);
+					best = 0;
+					for (size_t f = 1; f < Internal::PngFilterTypes; f++)
+					{
+						uint64_t cost = Internal::PngFilterCost(pOut[f], frame.rowSize);
+						if (cost < bestCost)
+						{
+							bestCost = cost;
+							best = f;
+						}
+					}
+				}
+
+				*pDst++ = static_cast<uint8_t>(best);
+				std::memcpy(pDst, pOut[best], frame.rowSize);
+				pDst += frame.rowSize;
+				std::swap(pPrev, pCur);
+			}
+
+			band.adler = adler32(adler32(0, NULL, 0), &band.filtered[0], static_cast<uInt>(band.filtered.size()));
+		}
+
+		void DeflateBand(const Frame&, std::vector<Band>& bands, size_t index)
+		{
+			Band& band = bands[index];
+			bool last = index + 1 == bands.size();
+
+			z_stream stream;
+			std::memset(&stream, 0, sizeof(stream));
+			int level = m_fast ? 1 : static_cast<int>(m_compression);
+			int strategy = m_fast ? Z_RLE : Z_FILTERED;
+			band.error = deflateInit2(&stream, level, Z_DEFLATED, -15, 8, strategy);
+			if (band.error != Z_OK)
+				return;
+
+			if (index > 0)
+			{
+				const std::vector<uint8_t>& previous = bands[index - 1].filtered;
+				size_t dictionary = previous.size() < 32768 ? previous.size() : 32768;
+				deflateSetDictionary(&stream, &previous[previous.size() - dictionary], static_cast<uInt>(dictionary));
+			}
+
+			band.compressed.resize(deflateBound(&stream, static_cast<uLong>(band.filtered.size())) + 16);
+			stream.next_in = &band.filtered[0];
+			stream.avail_in = static_cast<uInt>(band.filtered.size());
+			stream.next_out = &band.compressed[0];
+			stream.avail_out = static_cast<uInt>(band.compressed.size());
+
+			// a sync flush ends each band on a byte boundary so the raw
+			// streams can be joined; only the last band finishes the stream
+			int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+			band.error = (result == (last ? Z_STREAM_END : Z_OK) && stream.avail_in == 0) ? Z_OK : Z_BUF_ERROR;
+			band.compressed.resize(band.compressed.size() - stream.avail_out);
+			deflateEnd(&stream);
+		}
+
+		size_t m_compression;
+		bool m_fast;
+		bool m_bgr;
+		size_t m_numThreads;
+		size_t m_bandSize;
+
+		PngEncoder(const PngEncoder&);
+		PngEncoder& operator=(const PngEncoder&);
+	};
+}
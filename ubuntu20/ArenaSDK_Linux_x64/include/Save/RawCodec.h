@@ -0,0 +1,776 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SaveDefs.h"
+#include "SequenceDefs.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+namespace Save
+{
+	/**
+	 * @struct RawCodecHeader
+	 *
+	 * The <B> RawCodecHeader </B> opens every image compressed by the
+	 * Save::RawCodec. It is followed by the compressed size of each band (32
+	 * bits each), the raw tail bytes and the bands themselves.
+	 */
+	struct RawCodecHeader
+	{
+		char magic[4];          /*!< "ARLC" */
+		uint16_t version;       /*!< Format version */
+		uint8_t bitsPerSample;  /*!< 8, 10, 12 or 16 */
+		uint8_t distance;       /*!< Predictor distance: 1 for mono, 2 for Bayer */
+		uint32_t reserved;
+		uint32_t width;         /*!< Width, in pixels */
+		uint32_t height;        /*!< Height, in pixels */
+		uint32_t bandRows;      /*!< Rows per band */
+		uint32_t numBands;      /*!< Number of bands */
+		uint32_t tailSize;      /*!< Bytes stored raw after the band sizes */
+		uint64_t pixelFormat;   /*!< PFNC pixel format */
+		uint64_t dataSize;      /*!< Size of the original image data, in bytes */
+	};
+
+	static_assert(sizeof(RawCodecHeader) == 48, "unexpected RawCodecHeader size");
+
+	namespace Internal
+	{
+		const uint16_t RawCodecVersion = 1;
+		const size_t RawCodecBlock = 32;
+
+		// bits per sample as stored, 0 for unsupported formats; packed
+		// formats are 10 or 12, unpacked ones 8 or 16
+		inline size_t RawCodecBits(uint64_t pixelFormat, size_t& distance)
+		{
+			distance = 2;
+			switch (pixelFormat)
+			{
+			case Mono8: distance = 1; return 8;
+			case BayerRG8: case BayerGR8: case BayerGB8: case BayerBG8: return 8;
+			case Mono10p: distance = 1; return 10;
+			case BayerRG10p: case BayerGR10p: case BayerGB10p: case BayerBG10p: return 10;
+			case Mono12p: distance = 1; return 12;
+			case BayerRG12p: case BayerGR12p: case BayerGB12p: case BayerBG12p: return 12;
+			case Mono10: case Mono12: case Mono14: case Mono16: distance = 1; return 16;
+			case BayerRG10: case BayerGR10: case BayerGB10: case BayerBG10:
+			case BayerRG12: case BayerGR12: case BayerGB12: case BayerBG12:
+			case BayerRG16: case BayerGR16: case BayerGB16: case BayerBG16: return 16;
+			default: distance = 0; return 0;
+			}
+		}
+
+		// reads count samples starting at sample index first; packed
+		// samples are stored LSB first (PFNC "p" formats)
+		inline void RawCodecUnpack(const uint8_t* pData, size_t bits, size_t first, size_t count, uint16_t* pOut)
+		{
+			if (bits == 8)
+			{
+				for (size_t i = 0; i < count; i++)
+					pOut[i] = pData[first + i];
+				return;
+			}
+			if (bits == 16)
+			{
+				std::memcpy(pOut, pData + 2 * first, 2 * count);
+				return;
+			}
+			uint32_t mask = (1u << bits) - 1;
+			uint64_t bitPos = static_cast<uint64_t>(first) * bits;
+			for (size_t i = 0; i < count; i++, bitPos += bits)
+			{
+				const uint8_t* p = pData + (bitPos >> 3);
+				uint32_t shift = static_cast<uint32_t>(bitPos & 7);
+				uint32_t value = p[0] | (static_cast<uint32_t>(p[1]) << 8);
+				if (shift + bits > 16)
+					value |= static_cast<uint32_t>(p[2]) << 16;
+				pOut[i] = static_cast<uint16_t>((value >> shift) & mask);
+			}
+		}
+
+		// writes samples to a zeroed range that starts on a byte boundary
+		inline void RawCodecPack(const uint16_t* pIn, size_t bits, size_t first, size_t count, uint8_t* pData)
+		{
+			if (bits == 8)
+			{
+				for (size_t i = 0; i < count; i++)
+					pData[first + i] = static_cast<uint8_t>(pIn[i]);
+				return;
+			}
+			if (bits == 16)
+			{
+				std::memcpy(pData + 2 * first, pIn, 2 * count);
+				return;
+			}
+			uint64_t bitPos = static_cast<uint64_t>(first) * bits;
+			for (size_t i = 0; i < count; i++, bitPos += bits)
+			{
+				uint8_t* p = pData + (bitPos >> 3);
+				uint32_t shift = static_cast<uint32_t>(bitPos & 7);
+				uint32_t value = static_cast<uint32_t>(pIn[i]) << shift;
+				p[0] |= static_cast<uint8_t>(value);
+				p[1] |= static_cast<uint8_t>(value >> 8);
+				if (shift + bits > 16)
+					p[2] |= static_cast<uint8_t>(value >> 16);
+			}
+		}
+
+		// median edge detector of LOCO-I / JPEG-LS
+		inline int RawCodecPredict(int left, int up, int upLeft)
+		{
+			int lo = left < up ? left : up;
+			int hi = left < up ? up : left;
+			if (upLeft >= hi)
+				return lo;
+			if (upLeft <= lo)
+				return hi;
+			return left + up - upLeft;
+		}
+
+		inline size_t RawCodecWidth(uint32_t value)
+		{
+			size_t width = 0;
+			while (value != 0)
+			{
+				width++;
+				value >>= 1;
+			}
+			return width;
+		}
+	}
+
+	/**
+	 * @class RawCodec
+	 *
+	 * The raw codec compresses raw sensor images losslessly. Each pixel is
+	 * predicted from its already coded neighbours of the same colour (left,
+	 * above and above left, two pixels apart for Bayer data) with the median
+	 * predictor of JPEG-LS. The residuals are bit-packed in blocks of 32
+	 * with the smallest width that holds the block. Typical sensor noise
+	 * leaves 4 to 6 bits per pixel, about half the size of 10 or 12-bit
+	 * data.
+	 *
+	 * The image is cut into bands of rows that are coded independently on
+	 * several threads, so the codec keeps up with acquisition on multi-core
+	 * hosts. Decompression restores the original bytes exactly, including
+	 * the bit packing of 10 and 12-bit formats.
+	 *
+	 * Supported formats are Mono and Bayer 8-bit, 10 and 12-bit packed
+	 * (Mono10p, BayerRG12p, ...) and 10, 12, 14 and 16-bit unpacked.
+	 *
+	 * \code{.cpp}
+	 * 	// compressing a Mono12p image
+	 * 	{
+	 * 		Save::RawCodec codec;
+	 * 		std::vector<uint8_t> compressed = codec.Compress(pImage->GetData(), pImage->GetWidth(), pImage->GetHeight(), pImage->GetPixelFormat());
+	 * 		std::vector<uint8_t> original = codec.Decompress(&compressed[0], compressed.size());
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::SequenceWriter::SetCompression
+	 */
+	class RawCodec
+	{
+	public:
+		/**
+		 * @fn RawCodec(size_t numThreads = 0)
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Threads per image
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * A constructor.
+		 */
+		RawCodec(size_t numThreads = 0)
+			: m_numThreads(numThreads),
+			  m_bandRows(64)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+		}
+
+		/**
+		 * @fn virtual ~RawCodec()
+		 *
+		 * A destructor.
+		 */
+		virtual ~RawCodec()
+		{
+		}
+
+		/**
+		 * @fn virtual void SetBandRows(size_t bandRows)
+		 *
+		 * @param bandRows
+		 *  - Type: size_t
+		 *  - Rows per band, rounded up to a multiple of 8
+		 *
+		 * <B> SetBandRows </B> sets how finely images are split between
+		 * threads. The first rows of each band are predicted from the left
+		 * only, so very small bands compress slightly worse. The default is
+		 * 64.
+		 */
+		virtual void SetBandRows(size_t bandRows)
+		{
+			m_bandRows = bandRows == 0 ? 8 : (bandRows + 7) / 8 * 8;
+		}
+
+		/**
+		 * @fn static bool IsSupported(uint64_t pixelFormat)
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if images of the pixel format can be compressed
+		 */
+		static bool IsSupported(uint64_t pixelFormat)
+		{
+			size_t distance;
+			return Internal::RawCodecBits(pixelFormat, distance) != 0;
+		}
+
+		/**
+		 * @fn static size_t GetImageSize(size_t width, size_t height, uint64_t pixelFormat)
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Size of the image data, in bytes
+		 *  - 0 for unsupported formats
+		 */
+		static size_t GetImageSize(size_t width, size_t height, uint64_t pixelFormat)
+		{
+			size_t distance;
+			size_t bits = Internal::RawCodecBits(pixelFormat, distance);
+			return static_cast<size_t>((static_cast<uint64_t>(width) * height * bits + 7) / 8);
+		}
+
+		/**
+		 * @fn static bool GetHeader(const uint8_t* pData, size_t size, RawCodecHeader& header)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Compressed image
+		 *
+		 * @param size
+		 *  - Type: size_t
+		 *  - Size of the compressed image, in bytes
+		 *
+		 * @param header
+		 *  - Type: Save::RawCodecHeader&
+		 *  - Receives the header
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the data starts with a valid header
+		 */
+		static bool GetHeader(const uint8_t* pData, size_t size, RawCodecHeader& header)
+		{
+			if (pData == NULL || size < sizeof(RawCodecHeader))
+				return false;
+			std::memcpy(&header, pData, sizeof(header));
+			size_t distance;
+			return std::memcmp(header.magic, "ARLC", 4) == 0 &&
+				   header.version == Internal::RawCodecVersion &&
+				   Internal::RawCodecBits(header.pixelFormat, distance) == header.bitsPerSample &&
+				   header.dataSize == GetImageSize(header.width, header.height, header.pixelFormat);
+		}
+
+		/**
+		 * @fn virtual void Compress(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, std::vector<uint8_t>& out)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data, Save::RawCodec::GetImageSize bytes
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the data
+		 *
+		 * @param out
+		 *  - Type: std::vector<uint8_t>&
+		 *  - Receives the compressed image; its storage is reused
+		 *
+		 * <B> Compress </B> compresses an image.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument for unsupported pixel formats
+		 */
+		virtual void Compress(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, std::vector<uint8_t>& out)
+		{
+			RawCodecHeader header;
+			std::memset(&header, 0, sizeof(header));
+			size_t distance;
+			size_t bits = Internal::RawCodecBits(pixelFormat, distance);
+			if (bits == 0)
+				throw std::invalid_argument("unsupported pixel format for raw compression");
+			if (width == 0 || height == 0 || width > 0xFFFFFFFF || height > 0xFFFFFFFF)
+				throw std::invalid_argument("invalid image dimensions");
+
+			std::memcpy(header.magic, "ARLC", 4);
+			header.version = Internal::RawCodecVersion;
+			header.bitsPerSample = static_cast<uint8_t>(bits);
+			header.distance = static_cast<uint8_t>(distance);
+			header.width = static_cast<uint32_t>(width);
+			header.height = static_cast<uint32_t>(height);
+			header.bandRows = static_cast<uint32_t>(m_bandRows);
+			header.numBands = static_cast<uint32_t>((height + m_bandRows - 1) / m_bandRows);
+			header.pixelFormat = pixelFormat;
+			header.dataSize = GetImageSize(width, height, pixelFormat);
+			// padding bits of a final partial byte are kept as they were
+			header.tailSize = (static_cast<uint64_t>(width) * height * bits) % 8 != 0 ? 1 : 0;
+
+			std::vector<std::vector<uint8_t> > bands(header.numBands);
+			RunParallel(bands.size(), [&](size_t i) {
+				EncodeBand(header, pData, i, bands[i]);
+			});
+
+			size_t total = sizeof(header) + 4 * bands.size() + header.tailSize;
+			for (size_t i = 0; i < bands.size(); i++)
+				total += bands[i].size();
+			out.resize(total);
+			uint8_t* p = &out[0];
+			std::memcpy(p, &header, sizeof(header));
+			p += sizeof(header);
+			for (size_t i = 0; i < bands.size(); i++, p += 4)
+			{
+				uint32_t size = static_cast<uint32_t>(bands[i].size());
+				std::memcpy(p, &size, 4);
+			}
+			if (header.tailSize > 0)
+				*p++ = pData[header.dataSize - 1];
+			for (size_t i = 0; i < bands.size(); i++)
+			{
+				if (!bands[i].empty())
+					std::memcpy(p, &bands[i][0], bands[i].size());
+				p += bands[i].size();
+			}
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> Compress(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data, Save::RawCodec::GetImageSize bytes
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the data
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - Compressed image
+		 *
+		 * <B> Compress </B> compresses an image into a new buffer.
+		 */
+		virtual std::vector<uint8_t> Compress(const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat)
+		{
+			std::vector<uint8_t> out;
+			Compress(pData, width, height, pixelFormat, out);
+			return out;
+		}
+
+		/**
+		 * @fn virtual void Decompress(const uint8_t* pData, size_t size, uint8_t* pOut, size_t outSize)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Compressed image
+		 *
+		 * @param size
+		 *  - Type: size_t
+		 *  - Size of the compressed image, in bytes
+		 *
+		 * @param pOut
+		 *  - Type: uint8_t*
+		 *  - Receives the original image data
+		 *
+		 * @param outSize
+		 *  - Type: size_t
+		 *  - Size of the buffer, at least RawCodecHeader::dataSize bytes
+		 *
+		 * <B> Decompress </B> restores an image.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if the buffer is too small
+		 *  - Throws std::runtime_error for corrupt data
+		 */
+		virtual void Decompress(const uint8_t* pData, size_t size, uint8_t* pOut, size_t outSize)
+		{
+			RawCodecHeader header;
+			if (!GetHeader(pData, size, header) || header.bandRows == 0 || header.bandRows % 8 != 0 ||
+				header.numBands != (header.height + header.bandRows - 1) / header.bandRows || header.tailSize > 1)
+				throw std::runtime_error("corrupt raw codec header");
+			if (outSize < header.dataSize)
+				throw std::invalid_argument("buffer too small for raw image");
+
+			size_t offset = sizeof(header) + 4 * static_cast<size_t>(header.numBands) + header.tailSize;
+			if (offset > size)
+				throw std::runtime_error("truncated raw codec data");
+			std::vector<size_t> offsets(header.numBands);
+			std::vector<size_t> sizes(header.numBands);
+			for (size_t i = 0; i < header.numBands; i++)
+			{
+				uint32_t bandSize;
+				std::memcpy(&bandSize, pData + sizeof(header) + 4 * i, 4);
+				if (bandSize > size - offset)
+					throw std::runtime_error("truncated raw codec data");
+				offsets[i] = offset;
+				sizes[i] = bandSize;
+				offset += bandSize;
+			}
+
+			RunParallel(header.numBands, [&](size_t i) {
+				DecodeBand(header, pData + offsets[i], sizes[i], i, pOut);
+			});
+			if (header.tailSize > 0)
+				pOut[header.dataSize - 1] = pData[sizeof(header) + 4 * header.numBands];
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> Decompress(const uint8_t* pData, size_t size)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Compressed image
+		 *
+		 * @param size
+		 *  - Type: size_t
+		 *  - Size of the compressed image, in bytes
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - Original image data
+		 *
+		 * <B> Decompress </B> restores an image into a new buffer.
+		 */
+		virtual std::vector<uint8_t> Decompress(const uint8_t* pData, size_t size)
+		{
+			RawCodecHeader header;
+			if (!GetHeader(pData, size, header))
+				throw std::runtime_error("corrupt raw codec header");
+			std::vector<uint8_t> out(static_cast<size_t>(header.dataSize));
+			Decompress(pData, size, &out[0], out.size());
+			return out;
+		}
+
+		/**
+		 * @fn virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, bool createDirectories = true)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File to write
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the data
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * <B> Save </B> compresses an image and writes it to a file, the
+		 * compressed counterpart of a raw save.
+		 */
+		virtual void Save(const char* pFileName, const uint8_t* pData, size_t width, size_t height, uint64_t pixelFormat, bool createDirectories = true)
+		{
+			Compress(pData, width, height, pixelFormat, m_scratch);
+			if (createDirectories)
+				Internal::CreateDirectories(pFileName);
+			FILE* pFile = std::fopen(pFileName, "wb");
+			if (pFile == NULL)
+				throw Internal::SystemError("unable to create", pFileName);
+			size_t written = std::fwrite(&m_scratch[0], 1, m_scratch.size(), pFile);
+			if (std::fclose(pFile) != 0 || written != m_scratch.size())
+				throw Internal::SystemError("unable to write", pFileName);
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> Load(const char* pFileName, RawCodecHeader* pHeader = NULL)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File written by Save
+		 *
+		 * @param pHeader
+		 *  - Type: Save::RawCodecHeader*
+		 *  - Default: NULL
+		 *  - Receives the header, with the dimensions and pixel format
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - Original image data
+		 *
+		 * <B> Load </B> reads and decompresses an image file.
+		 */
+		virtual std::vector<uint8_t> Load(const char* pFileName, RawCodecHeader* pHeader = NULL)
+		{
+			FILE* pFile = std::fopen(pFileName, "rb");
+			if (pFile == NULL)
+				throw Internal::SystemError("unable to open", pFileName);
+			m_scratch.clear();
+			uint8_t block[1 << 16];
+			size_t read;
+			while ((read = std::fread(block, 1, sizeof(block), pFile)) > 0)
+				m_scratch.insert(m_scratch.end(), block, block + read);
+			bool failed = std::ferror(pFile) != 0;
+			std::fclose(pFile);
+			if (failed)
+				throw Internal::SystemError("unable to read", pFileName);
+
+			if (pHeader != NULL && !GetHeader(m_scratch.empty() ? NULL : &m_scratch[0], m_scratch.size(), *pHeader))
+				throw std::runtime_error(std::string("not a compressed raw image: ") + pFileName);
+			return Decompress(m_scratch.empty() ? NULL : &m_scratch[0], m_scratch.size());
+		}
+
+	private:
+		template <typename Function>
+		void RunParallel(size_t count, Function function)
+		{
+			std::atomic<size_t> next(0);
+			std::atomic<bool> failed(false);
+			std::string error;
+			auto worker = [&]() {
+				for (size_t i = next++; i < count; i = next++)
+				{
+					try
+					{
+						function(i);
+					}
+					catch (std::exception& ex)
+					{
+						if (!failed.exchange(true))
+							error = ex.what();
+					}
+				}
+			};
+
+			size_t numThreads = m_numThreads < count ? m_numThreads : count;
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < numThreads; i++)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+			if (failed)
+				throw std::runtime_error(error);
+		}
+
+		// residuals are zigzag mapped and packed LSB first in blocks of 32,
+		// each preceded by a byte holding its bit width
+		void EncodeBand(const RawCodecHeader& header, const uint8_t* pData, size_t band, std::vector<uint8_t>& out)
+		{
+			size_t width = header.width;
+			size_t distance = header.distance;
+			size_t firstRow = band * header.bandRows;
+			size_t numRows = std::min<size_t>(header.bandRows, header.height - firstRow);
+
+			// rows y - distance .. y, reused as a ring
+			std::vector<uint16_t> rows(width * (distance + 1));
+			uint32_t block[Internal::RawCodecBlock];
+			size_t blockSize = 0;
+			out.clear();
+			out.reserve(width * numRows * header.bitsPerSample / 16 + 64);
+
+			for (size_t r = 0; r < numRows; r++)
+			{
+				uint16_t* pCur = &rows[(r % (distance + 1)) * width];
+				const uint16_t* pUp = &rows[((r + 1) % (distance + 1)) * width];
+				Internal::RawCodecUnpack(pData, header.bitsPerSample, (firstRow + r) * width, width, pCur);
+
+				for (size_t x = 0; x < width; x++)
+				{
+					int predicted = Predict(pCur, pUp, x, r, distance);
+					int32_t residual = static_cast<int32_t>(pCur[x]) - predicted;
+					block[blockSize++] = (static_cast<uint32_t>(residual) << 1) ^ static_cast<uint32_t>(residual >> 31);
+					if (blockSize == Internal::RawCodecBlock)
+					{
+						PutBlock(block, blockSize, out);
+						blockSize = 0;
+					}
+				}
+			}
+			if (blockSize > 0)
+				PutBlock(block, blockSize, out);
+		}
+
+		void DecodeBand(const RawCodecHeader& header, const uint8_t* pIn, size_t size, size_t band, uint8_t* pOut)
+		{
+			size_t width = header.width;
+			size_t distance = header.distance;
+			size_t firstRow = band * header.bandRows;
+			size_t numRows = std::min<size_t>(header.bandRows, header.height - firstRow);
+
+			// bands start on byte boundaries since the band height is a
+			// multiple of 8
+			uint64_t firstBit = static_cast<uint64_t>(firstRow) * width * header.bitsPerSample;
+			uint64_t endBit = static_cast<uint64_t>(firstRow + numRows) * width * header.bitsPerSample;
+			std::memset(pOut + firstBit / 8, 0, static_cast<size_t>((endBit + 7) / 8 - firstBit / 8));
+
+			std::vector<uint16_t> rows(width * (distance + 1));
+			uint32_t block[Internal::RawCodecBlock];
+			size_t blockSize = 0;
+			size_t blockPos = 0;
+			size_t remaining = width * numRows;
+			const uint8_t* pEnd = pIn + size;
+
+			for (size_t r = 0; r < numRows; r++)
+			{
+				uint16_t* pCur = &rows[(r % (distance + 1)) * width];
+				const uint16_t* pUp = &rows[((r + 1) % (distance + 1)) * width];
+				for (size_t x = 0; x < width; x++)
+				{
+					if (blockPos == blockSize)
+					{
+						blockSize = std::min(remaining, Internal::RawCodecBlock);
+						pIn = GetBlock(pIn, pEnd, block, blockSize);
+						remaining -= blockSize;
+						blockPos = 0;
+					}
+					uint32_t mapped = block[blockPos++];
+					int32_t residual = static_cast<int32_t>(mapped >> 1) ^ -static_cast<int32_t>(mapped & 1);
+					pCur[x] = static_cast<uint16_t>(Predict(pCur, pUp, x, r, distance) + residual);
+				}
+				Internal::RawCodecPack(pCur, header.bitsPerSample, (firstRow + r) * width, width, pOut);
+			}
+		}
+
+		// the first rows of a band only look left, so bands decode
+		// independently
+		static int Predict(const uint16_t* pCur, const uint16_t* pUp, size_t x, size_t row, size_t distance)
+		{
+			if (row < distance)
+				return x >= distance ? pCur[x - distance] : 0;
+			if (x < distance)
+				return pUp[x];
+			return Internal::RawCodecPredict(pCur[x - distance], pUp[x], pUp[x - distance]);
+		}
+
+		static void PutBlock(const uint32_t* pBlock, size_t count, std::vector<uint8_t>& out)
+		{
+			uint32_t all = 0;
+			for (size_t i = 0; i < count; i++)
+				all |= pBlock[i];
+			size_t width = Internal::RawCodecWidth(all);
+			out.push_back(static_cast<uint8_t>(width));
+
+			uint64_t bits = 0;
+			size_t numBits = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				bits |= static_cast<uint64_t>(pBlock[i]) << numBits;
+				numBits += width;
+				while (numBits >= 8)
+				{
+					out.push_back(static_cast<uint8_t>(bits));
+					bits >>= 8;
+					numBits -= 8;
+				}
+			}
+			if (numBits > 0)
+				out.push_back(static_cast<uint8_t>(bits));
+		}
+
+		static const uint8_t* GetBlock(const uint8_t* pIn, const uint8_t* pEnd, uint32_t* pBlock, size_t count)
+		{
+			if (pIn >= pEnd)
+				throw std::runtime_error("truncated raw codec data");
+			size_t width = *pIn++;
+			if (width > 17)
+				throw std::runtime_error("corrupt raw codec data");
+			size_t bytes = (count * width + 7) / 8;
+			if (static_cast<size_t>(pEnd - pIn) < bytes)
+				throw std::runtime_error("truncated raw codec data");
+
+			uint32_t mask = static_cast<uint32_t>((1ULL << width) - 1);
+			uint64_t bits = 0;
+			size_t numBits = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				while (numBits < width)
+				{
+					bits |= static_cast<uint64_t>(*pIn++) << numBits;
+					numBits += 8;
+				}
+				pBlock[i] = static_cast<uint32_t>(bits) & mask;
+				bits >>= width;
+				numBits -= width;
+			}
+			return pIn;
+		}
+
+		size_t m_numThreads;
+		size_t m_bandRows;
+		std::vector<uint8_t> m_scratch;
+
+		RawCodec(const RawCodec&);
+		RawCodec& operator=(const RawCodec&);
+	};
+}
@@ -31,11 +31,18 @@
 #include <string>
 
 #include "ImageWriter.h"
+#include "AsyncImageWriter.h"
 #include "ImageReader.h"
 #include "ImageParams.h"
+#include "SequenceWriter.h"
+#include "SequenceReader.h"
+#include "RawCodec.h"
+#include "Stripe.h"
+#include "WriteQueue.h"
 
 #include "VideoRecorder.h"
 #include "VideoParams.h"
+#include "AsyncVideoRecorder.h"
 
 #include "SaveDefs.h"
 #include "Version.h"
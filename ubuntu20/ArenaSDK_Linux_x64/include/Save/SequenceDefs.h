@@ -0,0 +1,130 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace Save
+{
+	/**
+	 * @struct SequenceFileHeader
+	 *
+	 * The <B> SequenceFileHeader </B> opens every sequence segment file. It
+	 * is padded to the segment alignment so the first frame record starts on
+	 * an aligned offset. Frame count and index offset are filled in when the
+	 * segment is closed; an index offset of zero marks a segment that was
+	 * not closed cleanly, whose frames can still be recovered by walking the
+	 * frame headers.
+	 */
+	struct SequenceFileHeader
+	{
+		char magic[4];          /*!< "ASEQ" */
+		uint32_t version;       /*!< Format version */
+		uint32_t alignment;     /*!< Alignment of records and index, in bytes */
+		uint32_t segmentIndex;  /*!< Position of the segment in the sequence */
+		uint64_t frameCount;    /*!< Number of frames in the segment */
+		uint64_t indexOffset;   /*!< File offset of the trailing index, 0 if not closed */
+		uint64_t reserved[4];
+	};
+
+	/**
+	 * @enum ESequenceFrameFlags
+	 *
+	 * Flags of a Save::SequenceFrameHeader.
+	 */
+	typedef enum _ESequenceFrameFlags
+	{
+		SequenceFrameCompressed = 0x1 /*!< Image data is compressed with the Save::RawCodec */
+	} ESequenceFrameFlags;
+
+	/**
+	 * @struct SequenceFrameHeader
+	 *
+	 * The <B> SequenceFrameHeader </B> precedes the image data of every frame
+	 * record. The image data follows immediately, then the chunk data, and
+	 * the record is padded to the segment alignment.
+	 */
+	struct SequenceFrameHeader
+	{
+		char magic[4];          /*!< "AFRM" */
+		uint32_t headerSize;    /*!< Size of this header, in bytes */
+		uint64_t pixelFormat;   /*!< PFNC pixel format */
+		uint32_t width;         /*!< Width, in pixels */
+		uint32_t height;        /*!< Height, in pixels */
+		uint32_t bitsPerPixel;  /*!< Bits per pixel */
+		uint32_t flags;         /*!< Save::ESequenceFrameFlags */
+		uint64_t timestamp;     /*!< Device timestamp, in nanoseconds */
+		uint64_t frameId;       /*!< Frame ID */
+		uint64_t dataSize;      /*!< Size of the image data, in bytes */
+		uint64_t chunkSize;     /*!< Size of the chunk data, in bytes */
+	};
+
+	/**
+	 * @struct SequenceIndexEntry
+	 *
+	 * The <B> SequenceIndexEntry </B> is one entry of the index written at
+	 * the end of each segment.
+	 */
+	struct SequenceIndexEntry
+	{
+		uint64_t offset;        /*!< File offset of the frame header */
+		uint64_t recordSize;    /*!< Size of the padded record, in bytes */
+		uint64_t frameId;       /*!< Frame ID */
+		uint64_t timestamp;     /*!< Device timestamp, in nanoseconds */
+	};
+
+	static_assert(sizeof(SequenceFileHeader) == 64, "unexpected SequenceFileHeader size");
+	static_assert(sizeof(SequenceFrameHeader) == 64, "unexpected SequenceFrameHeader size");
+	static_assert(sizeof(SequenceIndexEntry) == 32, "unexpected SequenceIndexEntry size");
+
+	namespace Internal
+	{
+		const uint32_t SequenceVersion = 1;
+
+		inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		// segment files are named <base>_0000.aseq, <base>_0001.aseq, ...
+		inline std::string SegmentFileName(const std::string& base, uint32_t index)
+		{
+			char suffix[32];
+			std::snprintf(suffix, sizeof(suffix), "_%04u.aseq", index);
+			return base + suffix;
+		}
+
+		inline void CreateDirectories(const std::string& fileName)
+		{
+			for (size_t pos = fileName.find('/', 1); pos != std::string::npos; pos = fileName.find('/', pos + 1))
+			{
+				std::string dir = fileName.substr(0, pos);
+				if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+					throw std::runtime_error("unable to create directory " + dir + ": " + std::strerror(errno));
+			}
+		}
+
+		inline std::runtime_error SystemError(const std::string& what, const std::string& fileName)
+		{
+			return std::runtime_error(what + " " + fileName + ": " + std::strerror(errno));
+		}
+	}
+}
@@ -0,0 +1,437 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SequenceDefs.h"
+#include "Stripe.h"
+#include "RawCodec.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace Save
+{
+	/**
+	 * @struct SequenceFrame
+	 *
+	 * The <B> SequenceFrame </B> points into a memory-mapped segment. The
+	 * pointers stay valid for the lifetime of the Save::SequenceReader.
+	 */
+	struct SequenceFrame
+	{
+		const SequenceFrameHeader* pHeader; /*!< Frame header */
+		const uint8_t* pData;               /*!< Image data, pHeader->dataSize bytes, compressed if flagged SequenceFrameCompressed */
+		const uint8_t* pChunk;              /*!< Chunk data, pHeader->chunkSize bytes, NULL if none */
+	};
+
+	/**
+	 * @class SequenceReader
+	 *
+	 * The sequence reader maps the segment files written by a
+	 * Save::SequenceWriter into memory and gives random access to their
+	 * frames without copying. Frame lookup uses the index at the end of each
+	 * segment. Segments that were not closed (for example, after a crash)
+	 * have no index; their frames are recovered by walking the frame
+	 * headers.
+	 *
+	 * Striped recordings (a base path starting with a {dir1,dir2,...} list)
+	 * are read from every directory and put back into capture order using
+	 * the manifest; without a manifest, frames are ordered by timestamp.
+	 *
+	 * \code{.cpp}
+	 * 	// reading back a recording
+	 * 	{
+	 * 		Save::SequenceReader reader("recordings/run");
+	 *
+	 * 		for (uint64_t i = 0; i < reader.GetNumFrames(); i++)
+	 * 		{
+	 * 			Save::SequenceFrame frame = reader.GetFrame(i);
+	 * 			// frame.pHeader->width, frame.pData, ...
+	 * 		}
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::SequenceWriter
+	 */
+	class SequenceReader
+	{
+	public:
+		/**
+		 * @fn SequenceReader(const char* pBasePath)
+		 *
+		 * @param pBasePath
+		 *  - Type: const char*
+		 *  - Path and base name passed to the Save::SequenceWriter
+		 *
+		 * A constructor. Maps <base>_0000.aseq and every following segment
+		 * until one is missing, in each striped directory.
+		 *
+		 * @warning 
+		 *  - Throws std::runtime_error if no segment exists or a segment is
+		 *    not a sequence file
+		 */
+		SequenceReader(const char* pBasePath)
+		{
+			std::string rest;
+			std::vector<std::string> roots = Internal::SplitStripedPattern(pBasePath, rest);
+			try
+			{
+				for (size_t i = 0; i < roots.size(); i++)
+					MapSegments(Internal::JoinStripePath(roots[i], rest));
+				if (roots.size() > 1)
+					OrderStriped(Internal::JoinStripePath(roots[0], rest) + ".manifest");
+			}
+			catch (...)
+			{
+				Unmap();
+				throw;
+			}
+		}
+
+		/**
+		 * @fn virtual ~SequenceReader()
+		 *
+		 * A destructor. Unmaps all segments.
+		 */
+		virtual ~SequenceReader()
+		{
+			Unmap();
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumFrames()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Number of frames across all segments
+		 */
+		virtual uint64_t GetNumFrames()
+		{
+			return m_frames.size();
+		}
+
+		/**
+		 * @fn virtual size_t GetNumSegments()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of segments mapped
+		 */
+		virtual size_t GetNumSegments()
+		{
+			return m_segments.size();
+		}
+
+		/**
+		 * @fn virtual SequenceFrame GetFrame(uint64_t index)
+		 *
+		 * @param index
+		 *  - Type: uint64_t
+		 *  - Index of the frame within the sequence
+		 *
+		 * @return 
+		 *  - Type: Save::SequenceFrame
+		 *  - Pointers to the frame in the mapped segment
+		 *
+		 * <B> GetFrame </B> returns a frame by position in constant time.
+		 *
+		 * @warning 
+		 *  - Throws std::out_of_range for an index past the end
+		 */
+		virtual SequenceFrame GetFrame(uint64_t index)
+		{
+			if (index >= m_frames.size())
+				throw std::out_of_range("sequence frame index out of range");
+
+			const uint8_t* pRecord = m_segments[m_frames[index].segment].pBase + m_frames[index].offset;
+			SequenceFrame frame;
+			frame.pHeader = reinterpret_cast<const SequenceFrameHeader*>(pRecord);
+			frame.pData = pRecord + frame.pHeader->headerSize;
+			frame.pChunk = frame.pHeader->chunkSize > 0 ? frame.pData + frame.pHeader->dataSize : NULL;
+			return frame;
+		}
+
+		/**
+		 * @fn virtual void ReadImage(uint64_t index, std::vector<uint8_t>& image)
+		 *
+		 * @param index
+		 *  - Type: uint64_t
+		 *  - Index of the frame within the sequence
+		 *
+		 * @param image
+		 *  - Type: std::vector<uint8_t>&
+		 *  - Receives the image data; its storage is reused
+		 *
+		 * <B> ReadImage </B> copies the image data of a frame, decompressing
+		 * frames recorded with Save::SequenceWriter::SetCompression.
+		 *
+		 * @warning 
+		 *  - Throws std::out_of_range for an index past the end
+		 *  - Throws std::runtime_error for corrupt compressed data
+		 */
+		virtual void ReadImage(uint64_t index, std::vector<uint8_t>& image)
+		{
+			SequenceFrame frame = GetFrame(index);
+			size_t dataSize = static_cast<size_t>(frame.pHeader->dataSize);
+			if ((frame.pHeader->flags & SequenceFrameCompressed) == 0)
+			{
+				image.assign(frame.pData, frame.pData + dataSize);
+				return;
+			}
+
+			RawCodecHeader header;
+			if (!RawCodec::GetHeader(frame.pData, dataSize, header))
+				throw std::runtime_error("corrupt compressed sequence frame");
+			image.resize(static_cast<size_t>(header.dataSize));
+			m_codec.Decompress(frame.pData, dataSize, &image[0], image.size());
+		}
+
+		/**
+		 * @fn virtual bool FindFrame(uint64_t frameId, uint64_t& index)
+		 *
+		 * @param frameId
+		 *  - Type: uint64_t
+		 *  - Frame ID to look for
+		 *
+		 * @param index
+		 *  - Type: uint64_t&
+		 *  - Receives the index of the frame within the sequence
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the frame ID was found
+		 *
+		 * <B> FindFrame </B> looks up a frame by frame ID. Frame IDs are
+		 * usually increasing, so a binary search is tried first; a linear
+		 * scan covers recordings where the ID wrapped or was reset.
+		 */
+		virtual bool FindFrame(uint64_t frameId, uint64_t& index)
+		{
+			size_t lo = 0;
+			size_t hi = m_frames.size();
+			while (lo < hi)
+			{
+				size_t mid = lo + (hi - lo) / 2;
+				if (m_frames[mid].frameId < frameId)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			if (lo < m_frames.size() && m_frames[lo].frameId == frameId)
+			{
+				index = lo;
+				return true;
+			}
+
+			for (size_t i = 0; i < m_frames.size(); i++)
+			{
+				if (m_frames[i].frameId == frameId)
+				{
+					index = i;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * @fn virtual void Prefetch(uint64_t index, uint64_t count)
+		 *
+		 * @param index
+		 *  - Type: uint64_t
+		 *  - First frame to prefetch
+		 *
+		 * @param count
+		 *  - Type: uint64_t
+		 *  - Number of frames to prefetch
+		 *
+		 * <B> Prefetch </B> asks the kernel to start reading frames ahead of
+		 * use, which helps sequential playback from cold storage.
+		 */
+		virtual void Prefetch(uint64_t index, uint64_t count)
+		{
+			long pageSize = ::sysconf(_SC_PAGESIZE);
+			for (uint64_t i = index; i < index + count && i < m_frames.size(); i++)
+			{
+				const Segment& seg = m_segments[m_frames[i].segment];
+				uint64_t start = m_frames[i].offset / pageSize * pageSize;
+				uint64_t end = m_frames[i].offset + m_frames[i].recordSize;
+				if (end > seg.size)
+					end = seg.size;
+				::madvise(const_cast<uint8_t*>(seg.pBase) + start, static_cast<size_t>(end - start), MADV_WILLNEED);
+			}
+		}
+
+	private:
+		struct Segment
+		{
+			std::string fileName;
+			const uint8_t* pBase;
+			uint64_t size;
+		};
+
+		struct FrameLocation
+		{
+			size_t segment;
+			uint64_t offset;
+			uint64_t recordSize;
+			uint64_t frameId;
+		};
+
+		void MapSegments(const std::string& base)
+		{
+			for (uint32_t segment = 0;; segment++)
+			{
+				std::string fileName = Internal::SegmentFileName(base, segment);
+				int fd = ::open(fileName.c_str(), O_RDONLY);
+				if (fd < 0)
+				{
+					if (errno == ENOENT && segment > 0)
+						break;
+					throw Internal::SystemError("unable to open", fileName);
+				}
+
+				struct stat st;
+				void* pMap = MAP_FAILED;
+				if (::fstat(fd, &st) == 0 && st.st_size > 0)
+					pMap = ::mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+				::close(fd);
+				if (pMap == MAP_FAILED)
+					throw Internal::SystemError("unable to map", fileName);
+
+				Segment seg;
+				seg.fileName = fileName;
+				seg.pBase = static_cast<const uint8_t*>(pMap);
+				seg.size = static_cast<uint64_t>(st.st_size);
+				m_segments.push_back(seg);
+
+				IndexSegment(m_segments.size() - 1, fileName);
+			}
+		}
+
+		static bool EarlierTimestamp(const std::pair<uint64_t, size_t>& a, const std::pair<uint64_t, size_t>& b)
+		{
+			return a.first < b.first;
+		}
+
+		// restores capture order across striped directories: frames listed
+		// in the manifest come first in manifest order, then any the
+		// manifest missed (for example after a crash) by timestamp
+		void OrderStriped(const std::string& manifestFileName)
+		{
+			std::map<std::pair<std::string, uint64_t>, size_t> locations;
+			for (size_t i = 0; i < m_frames.size(); i++)
+				locations[std::make_pair(m_segments[m_frames[i].segment].fileName, m_frames[i].offset)] = i;
+
+			std::vector<StripeManifestEntry> entries = StripeManifest::Load(manifestFileName.c_str());
+			std::vector<bool> placed(m_frames.size(), false);
+			std::vector<FrameLocation> ordered;
+			ordered.reserve(m_frames.size());
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				std::map<std::pair<std::string, uint64_t>, size_t>::const_iterator it = locations.find(std::make_pair(entries[i].file, entries[i].offset));
+				if (it == locations.end() || placed[it->second])
+					continue;
+				placed[it->second] = true;
+				ordered.push_back(m_frames[it->second]);
+			}
+
+			std::vector<std::pair<uint64_t, size_t> > remaining;
+			for (size_t i = 0; i < m_frames.size(); i++)
+			{
+				if (!placed[i])
+					remaining.push_back(std::make_pair(GetHeader(m_frames[i])->timestamp, i));
+			}
+			std::stable_sort(remaining.begin(), remaining.end(), EarlierTimestamp);
+			for (size_t i = 0; i < remaining.size(); i++)
+				ordered.push_back(m_frames[remaining[i].second]);
+
+			m_frames.swap(ordered);
+		}
+
+		const SequenceFrameHeader* GetHeader(const FrameLocation& location)
+		{
+			return reinterpret_cast<const SequenceFrameHeader*>(m_segments[location.segment].pBase + location.offset);
+		}
+
+		void IndexSegment(size_t segment, const std::string& fileName)
+		{
+			const Segment& seg = m_segments[segment];
+			SequenceFileHeader header;
+			if (seg.size < sizeof(header))
+				throw std::runtime_error("sequence segment too small: " + fileName);
+			std::memcpy(&header, seg.pBase, sizeof(header));
+			if (std::memcmp(header.magic, "ASEQ", 4) != 0 || header.version > Internal::SequenceVersion || header.alignment < sizeof(header))
+				throw std::runtime_error("not a sequence segment: " + fileName);
+
+			if (header.indexOffset != 0 && header.indexOffset + header.frameCount * sizeof(SequenceIndexEntry) <= seg.size)
+			{
+				const SequenceIndexEntry* pIndex = reinterpret_cast<const SequenceIndexEntry*>(seg.pBase + header.indexOffset);
+				for (uint64_t i = 0; i < header.frameCount; i++)
+					AddFrame(segment, pIndex[i].offset, pIndex[i].recordSize);
+				return;
+			}
+
+			// not closed: walk the records until the preallocated zeros
+			uint64_t offset = header.alignment;
+			while (offset + sizeof(SequenceFrameHeader) <= seg.size)
+			{
+				const SequenceFrameHeader* pFrame = reinterpret_cast<const SequenceFrameHeader*>(seg.pBase + offset);
+				if (std::memcmp(pFrame->magic, "AFRM", 4) != 0 || pFrame->headerSize < sizeof(SequenceFrameHeader))
+					break;
+				uint64_t recordSize = Internal::AlignUp(pFrame->headerSize + pFrame->dataSize + pFrame->chunkSize, header.alignment);
+				if (offset + recordSize > seg.size)
+					break;
+				AddFrame(segment, offset, recordSize);
+				offset += recordSize;
+			}
+		}
+
+		void AddFrame(size_t segment, uint64_t offset, uint64_t recordSize)
+		{
+			const Segment& seg = m_segments[segment];
+			if (offset + sizeof(SequenceFrameHeader) > seg.size)
+				throw std::runtime_error("sequence index points past end of segment");
+			const SequenceFrameHeader* pFrame = reinterpret_cast<const SequenceFrameHeader*>(seg.pBase + offset);
+			if (offset + pFrame->headerSize + pFrame->dataSize + pFrame->chunkSize > seg.size)
+				throw std::runtime_error("sequence frame extends past end of segment");
+
+			FrameLocation location;
+			location.segment = segment;
+			location.offset = offset;
+			location.recordSize = recordSize;
+			location.frameId = pFrame->frameId;
+			m_frames.push_back(location);
+		}
+
+		void Unmap()
+		{
+			for (size_t i = 0; i < m_segments.size(); i++)
+				::munmap(const_cast<uint8_t*>(m_segments[i].pBase), static_cast<size_t>(m_segments[i].size));
+			m_segments.clear();
+			m_frames.clear();
+		}
+
+		std::vector<Segment> m_segments;
+		std::vector<FrameLocation> m_frames;
+		RawCodec m_codec;
+
+		SequenceReader(const SequenceReader&);
+		SequenceReader& operator=(const SequenceReader&);
+	};
+}
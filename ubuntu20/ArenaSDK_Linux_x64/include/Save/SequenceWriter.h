@@ -0,0 +1,744 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SequenceDefs.h"
+#include "WriteQueue.h"
+#include "Stripe.h"
+#include "RawCodec.h"
+#include <cstdlib>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Save
+{
+	/**
+	 * @class SequenceWriter
+	 *
+	 * The sequence writer records many frames into a few large segment files
+	 * instead of one file per frame. Each frame is stored as a
+	 * Save::SequenceFrameHeader followed by its image and chunk data, padded
+	 * to the alignment. When a segment reaches its size limit, the writer
+	 * appends an index of its frames and starts the next segment.
+	 *
+	 * Frames are gathered in aligned staging buffers and written in large
+	 * sequential blocks. Segments are preallocated so the file system does
+	 * not have to extend them on every write. With direct I/O enabled, the
+	 * page cache is bypassed (O_DIRECT), which keeps sustained recording
+	 * rates stable on NVMe drives.
+	 *
+	 * Full staging buffers are handed to a Save::WriteQueue (io_uring where
+	 * available) and the writer moves on to the next buffer, so several
+	 * writes are in flight while new frames are appended.
+	 *
+	 * With compression enabled, Mono and Bayer frames are stored compressed
+	 * with the Save::RawCodec, lossless and usually about half the size of
+	 * 10 and 12-bit data. Frames that would not shrink are stored as they
+	 * are.
+	 *
+	 * The base path may start with a brace list of directories, such as
+	 * "{/mnt/nvme0,/mnt/nvme1}/recordings/run". The writer then keeps one
+	 * segment stream open per directory and spreads frames over them, so
+	 * several drives share the load. A manifest (<base>.manifest, in the
+	 * first directory) records where each frame landed, and the
+	 * Save::SequenceReader uses it to restore capture order.
+	 *
+	 * \code{.cpp}
+	 * 	// recording frames into segments of 4 GB
+	 * 	{
+	 * 		Save::SequenceWriter writer("recordings/run", 4ULL << 30, true);
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			Arena::IImage* pImage = pDevice->GetImage(2000);
+	 * 			writer.Append(
+	 * 				pImage->GetData(),
+	 * 				pImage->GetWidth() * pImage->GetHeight() * pImage->GetBitsPerPixel() / 8,
+	 * 				pImage->GetPixelFormat(),
+	 * 				pImage->GetWidth(),
+	 * 				pImage->GetHeight(),
+	 * 				pImage->GetBitsPerPixel(),
+	 * 				pImage->GetTimestampNs(),
+	 * 				pImage->GetFrameId());
+	 * 			pDevice->RequeueBuffer(pImage);
+	 * 		}
+	 *
+	 * 		writer.Close();
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::SequenceReader
+	 */
+	class SequenceWriter
+	{
+	public:
+		/**
+		 * @fn SequenceWriter(const char* pBasePath, uint64_t segmentSize = 1ULL << 32, bool directIO = false, size_t bufferSize = 8 << 20, size_t alignment = 4096, size_t queueDepth = 4, EStripePolicy policy = StripeRoundRobin)
+		 *
+		 * @param pBasePath
+		 *  - Type: const char*
+		 *  - Path and base name of the segment files
+		 *  - Segments are named <base>_0000.aseq, <base>_0001.aseq, ...
+		 *  - A leading {dir1,dir2,...} list stripes frames across the
+		 *    directories
+		 *
+		 * @param segmentSize
+		 *  - Type: uint64_t
+		 *  - Default: 4 GB
+		 *  - Unit: bytes
+		 *  - Size at which a new segment is started, preallocated per
+		 *    segment
+		 *
+		 * @param directIO
+		 *  - Type: bool
+		 *  - Default: false
+		 *  - If true, opens segments with O_DIRECT where the file system
+		 *    supports it
+		 *  - Otherwise, writes through the page cache
+		 *
+		 * @param bufferSize
+		 *  - Type: size_t
+		 *  - Default: 8 MB
+		 *  - Unit: bytes
+		 *  - Size of each staging buffer, grown for larger frames
+		 *
+		 * @param alignment
+		 *  - Type: size_t
+		 *  - Default: 4096
+		 *  - Unit: bytes
+		 *  - Alignment of records, must be a power of two and at least the
+		 *    logical block size for direct I/O
+		 *
+		 * @param queueDepth
+		 *  - Type: size_t
+		 *  - Default: 4
+		 *  - Number of staging buffers, and so of writes kept in flight
+		 *  - 0 writes synchronously from a single buffer per directory
+		 *
+		 * @param policy
+		 *  - Type: Save::EStripePolicy
+		 *  - Default: StripeRoundRobin
+		 *  - How frames are spread over striped directories
+		 *
+		 * A constructor. Creates any missing directories and opens the first
+		 * segment.
+		 */
+		SequenceWriter(const char* pBasePath, uint64_t segmentSize = 1ULL << 32, bool directIO = false, size_t bufferSize = 8 << 20, size_t alignment = 4096, size_t queueDepth = 4, EStripePolicy policy = StripeRoundRobin)
+			: m_segmentSize(segmentSize),
+			  m_directIO(directIO),
+			  m_alignment(alignment),
+			  m_policy(policy),
+			  m_nextStream(0),
+			  m_pQueue(NULL),
+			  m_compress(false),
+			  m_numFrames(0),
+			  m_closed(false)
+		{
+			if (m_alignment < sizeof(SequenceFileHeader) || (m_alignment & (m_alignment - 1)) != 0)
+				throw std::invalid_argument("sequence alignment must be a power of two of at least 64 bytes");
+
+			std::string rest;
+			std::vector<std::string> roots = Internal::SplitStripedPattern(pBasePath, rest);
+			m_streams.resize(roots.size());
+			for (size_t i = 0; i < roots.size(); i++)
+				m_streams[i].base = Internal::JoinStripePath(roots[i], rest);
+
+			// each directory fills one buffer while queueDepth more are in
+			// flight
+			bufferSize = static_cast<size_t>(Internal::AlignUp(bufferSize, m_alignment));
+			m_buffers.resize(queueDepth + m_streams.size());
+			try
+			{
+				for (size_t i = 0; i < m_buffers.size(); i++)
+					Allocate(m_buffers[i], bufferSize, 0);
+
+				if (queueDepth > 0)
+				{
+					m_pQueue = new WriteQueue(queueDepth);
+
+					// pinning is best effort; it fails quietly under a low
+					// RLIMIT_MEMLOCK
+					std::vector<struct iovec> iovs(m_buffers.size());
+					for (size_t i = 0; i < m_buffers.size(); i++)
+					{
+						iovs[i].iov_base = m_buffers[i].pData;
+						iovs[i].iov_len = m_buffers[i].size;
+					}
+					bool registered = m_pQueue->RegisterBuffers(&iovs[0], iovs.size());
+					for (size_t i = 0; i < m_buffers.size(); i++)
+						m_buffers[i].registered = registered;
+				}
+
+				for (size_t i = 0; i < m_streams.size(); i++)
+				{
+					Internal::CreateDirectories(m_streams[i].base);
+					m_streams[i].buffer = i;
+					m_buffers[i].owner = i;
+					OpenSegment(i);
+				}
+
+				if (m_streams.size() > 1)
+					m_manifest.Open(GetManifestFileName().c_str());
+			}
+			catch (...)
+			{
+				for (size_t i = 0; i < m_streams.size(); i++)
+				{
+					if (m_streams[i].fd >= 0)
+						::close(m_streams[i].fd);
+				}
+				delete m_pQueue;
+				for (size_t i = 0; i < m_buffers.size(); i++)
+					std::free(m_buffers[i].pData);
+				throw;
+			}
+		}
+
+		/**
+		 * @fn virtual ~SequenceWriter()
+		 *
+		 * A destructor. Closes the current segments if Close has not been
+		 * called. Errors are swallowed; call Close to see them.
+		 */
+		virtual ~SequenceWriter()
+		{
+			try
+			{
+				Close();
+			}
+			catch (...)
+			{
+			}
+			for (size_t i = 0; i < m_streams.size(); i++)
+			{
+				if (m_streams[i].fd >= 0)
+					::close(m_streams[i].fd);
+			}
+			delete m_pQueue;
+			for (size_t i = 0; i < m_buffers.size(); i++)
+				std::free(m_buffers[i].pData);
+		}
+
+		/**
+		 * @fn virtual void SetCompression(bool compress)
+		 *
+		 * @param compress
+		 *  - Type: bool
+		 *  - If true, compresses frames of supported pixel formats
+		 *
+		 * <B> SetCompression </B> turns lossless compression of frames on or
+		 * off. Compression uses all hardware threads, which keeps up with
+		 * acquisition at typical frame rates. Compressed frames are flagged
+		 * with SequenceFrameCompressed; Save::SequenceReader::ReadImage
+		 * restores them.
+		 *
+		 * @see 
+		 *  - Save::RawCodec
+		 */
+		virtual void SetCompression(bool compress)
+		{
+			m_compress = compress;
+		}
+
+		/**
+		 * @fn virtual void Append(const uint8_t* pData, size_t dataSize, uint64_t pixelFormat, size_t width, size_t height, size_t bitsPerPixel, uint64_t timestamp, uint64_t frameId, const uint8_t* pChunk = NULL, size_t chunkSize = 0)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data
+		 *
+		 * @param dataSize
+		 *  - Type: size_t
+		 *  - Unit: bytes
+		 *  - Size of the image data
+		 *
+		 * @param pixelFormat
+		 *  - Type: uint64_t
+		 *  - PFNC pixel format of the image data
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param bitsPerPixel
+		 *  - Type: size_t
+		 *  - Bits per pixel
+		 *
+		 * @param timestamp
+		 *  - Type: uint64_t
+		 *  - Unit: nanoseconds
+		 *  - Device timestamp of the frame
+		 *
+		 * @param frameId
+		 *  - Type: uint64_t
+		 *  - Frame ID
+		 *
+		 * @param pChunk
+		 *  - Type: const uint8_t*
+		 *  - Default: NULL
+		 *  - Chunk data to store with the frame
+		 *
+		 * @param chunkSize
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Unit: bytes
+		 *  - Size of the chunk data
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Index of the frame within the sequence
+		 *
+		 * <B> Append </B> copies a frame into a staging buffer of the chosen
+		 * directory. Data reaches the disk when the buffer fills, a segment
+		 * is closed or Flush is called.
+		 */
+		virtual uint64_t Append(const uint8_t* pData, size_t dataSize, uint64_t pixelFormat, size_t width, size_t height, size_t bitsPerPixel, uint64_t timestamp, uint64_t frameId, const uint8_t* pChunk = NULL, size_t chunkSize = 0)
+		{
+			if (m_closed)
+				throw std::logic_error("sequence writer is closed");
+
+			size_t streamIndex = 0;
+			if (m_streams.size() > 1)
+			{
+				std::vector<uint64_t> load(m_streams.size());
+				for (size_t i = 0; i < m_streams.size(); i++)
+					load[i] = m_streams[i].pending + m_streams[i].used;
+				streamIndex = Internal::ChooseStripe(m_policy, load, m_nextStream);
+			}
+			Stream& stream = m_streams[streamIndex];
+
+			uint32_t flags = 0;
+			if (m_compress && RawCodec::IsSupported(pixelFormat) && dataSize == RawCodec::GetImageSize(width, height, pixelFormat))
+			{
+				m_codec.Compress(pData, width, height, pixelFormat, m_compressed);
+				if (m_compressed.size() < dataSize)
+				{
+					pData = &m_compressed[0];
+					dataSize = m_compressed.size();
+					flags = SequenceFrameCompressed;
+				}
+			}
+
+			uint64_t recordSize = Internal::AlignUp(sizeof(SequenceFrameHeader) + dataSize + chunkSize, m_alignment);
+
+			// keep each segment under its limit, but always take at least one
+			// frame so oversized frames still get written
+			if (!stream.index.empty() && stream.written + stream.used + recordSize > m_segmentSize)
+			{
+				CloseSegment(streamIndex);
+				stream.segment++;
+				OpenSegment(streamIndex);
+			}
+
+			if (stream.used + recordSize > m_buffers[stream.buffer].size)
+			{
+				FlushStream(streamIndex);
+				if (recordSize > m_buffers[stream.buffer].size)
+					Allocate(m_buffers[stream.buffer], static_cast<size_t>(recordSize), stream.used);
+			}
+
+			uint8_t* pRecord = m_buffers[stream.buffer].pData + stream.used;
+			SequenceFrameHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, "AFRM", 4);
+			header.headerSize = sizeof(SequenceFrameHeader);
+			header.pixelFormat = pixelFormat;
+			header.width = static_cast<uint32_t>(width);
+			header.height = static_cast<uint32_t>(height);
+			header.bitsPerPixel = static_cast<uint32_t>(bitsPerPixel);
+			header.flags = flags;
+			header.timestamp = timestamp;
+			header.frameId = frameId;
+			header.dataSize = dataSize;
+			header.chunkSize = chunkSize;
+			std::memcpy(pRecord, &header, sizeof(header));
+			std::memcpy(pRecord + sizeof(header), pData, dataSize);
+			if (chunkSize > 0)
+				std::memcpy(pRecord + sizeof(header) + dataSize, pChunk, chunkSize);
+			size_t end = sizeof(header) + dataSize + chunkSize;
+			std::memset(pRecord + end, 0, static_cast<size_t>(recordSize - end));
+
+			SequenceIndexEntry entry;
+			entry.offset = stream.written + stream.used;
+			entry.recordSize = recordSize;
+			entry.frameId = frameId;
+			entry.timestamp = timestamp;
+			stream.index.push_back(entry);
+
+			if (m_manifest.IsOpen())
+				m_manifest.Add(m_numFrames, GetSegmentFileName(stream.segment, streamIndex), entry.offset);
+
+			stream.used += static_cast<size_t>(recordSize);
+			return m_numFrames++;
+		}
+
+		/**
+		 * @fn virtual void Flush()
+		 *
+		 * <B> Flush </B> writes everything in the staging buffers to the
+		 * current segments and waits for the writes to finish. The segments
+		 * stay open; a reader only sees the frames once a segment is closed
+		 * or by recovery.
+		 */
+		virtual void Flush()
+		{
+			if (m_closed)
+				return;
+			for (size_t i = 0; i < m_streams.size(); i++)
+				FlushStream(i);
+			while (m_pQueue != NULL && m_pQueue->GetInFlight() > 0)
+				WaitWrite();
+			m_manifest.Flush();
+		}
+
+		/**
+		 * @fn virtual void Close()
+		 *
+		 * <B> Close </B> flushes the staging buffers, writes the index of
+		 * each current segment and closes them, along with the manifest.
+		 * Further appends throw.
+		 */
+		virtual void Close()
+		{
+			if (m_closed)
+				return;
+			m_closed = true;
+			for (size_t i = 0; i < m_streams.size(); i++)
+				CloseSegment(i);
+			m_manifest.Close();
+		}
+
+		/**
+		 * @fn virtual uint64_t GetNumFrames()
+		 *
+		 * @return 
+		 *  - Type: uint64_t
+		 *  - Number of frames appended
+		 */
+		virtual uint64_t GetNumFrames()
+		{
+			return m_numFrames;
+		}
+
+		/**
+		 * @fn virtual size_t GetNumStripes()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of directories frames are spread over
+		 */
+		virtual size_t GetNumStripes()
+		{
+			return m_streams.size();
+		}
+
+		/**
+		 * @fn virtual size_t GetNumSegments(size_t stripe = 0)
+		 *
+		 * @param stripe
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Directory, in the order listed in the base path
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of segment files started in the directory
+		 */
+		virtual size_t GetNumSegments(size_t stripe = 0)
+		{
+			return m_streams.at(stripe).segment + 1;
+		}
+
+		/**
+		 * @fn virtual std::string GetSegmentFileName(size_t segment, size_t stripe = 0)
+		 *
+		 * @param segment
+		 *  - Type: size_t
+		 *  - Segment index
+		 *
+		 * @param stripe
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Directory, in the order listed in the base path
+		 *
+		 * @return 
+		 *  - Type: std::string
+		 *  - File name of the segment
+		 */
+		virtual std::string GetSegmentFileName(size_t segment, size_t stripe = 0)
+		{
+			return Internal::SegmentFileName(m_streams.at(stripe).base, static_cast<uint32_t>(segment));
+		}
+
+		/**
+		 * @fn virtual std::string GetManifestFileName()
+		 *
+		 * @return 
+		 *  - Type: std::string
+		 *  - File name of the manifest, written only when striping
+		 */
+		virtual std::string GetManifestFileName()
+		{
+			return m_streams[0].base + ".manifest";
+		}
+
+	private:
+		struct Buffer
+		{
+			Buffer() : pData(NULL), size(0), busy(false), registered(false), owner(NoOwner), stream(0), inFlight(0) {}
+			uint8_t* pData;
+			size_t size;
+			bool busy;
+			bool registered;
+			size_t owner;    // stream filling the buffer, or NoOwner
+			size_t stream;   // stream of the write in flight
+			size_t inFlight; // bytes of the write in flight
+		};
+
+		struct Stream
+		{
+			Stream() : fd(-1), segment(0), written(0), used(0), buffer(0), pending(0) {}
+			std::string base;
+			int fd;
+			size_t segment;
+			uint64_t written;
+			size_t used;
+			size_t buffer;
+			uint64_t pending;
+			std::vector<SequenceIndexEntry> index;
+		};
+
+		static const size_t NoOwner = static_cast<size_t>(-1);
+
+		// (re)allocates a staging buffer keeping its first keep bytes; a
+		// reallocated buffer is no longer the registered one
+		void Allocate(Buffer& buffer, size_t size, size_t keep)
+		{
+			void* pBuffer = NULL;
+			if (posix_memalign(&pBuffer, m_alignment, size) != 0)
+				throw std::bad_alloc();
+			if (keep > 0)
+				std::memcpy(pBuffer, buffer.pData, keep);
+			if (buffer.pData != NULL)
+				buffer.registered = false;
+			std::free(buffer.pData);
+			buffer.pData = static_cast<uint8_t*>(pBuffer);
+			buffer.size = size;
+		}
+
+		void OpenSegment(size_t streamIndex)
+		{
+			Stream& stream = m_streams[streamIndex];
+			std::string fileName = GetSegmentFileName(stream.segment, streamIndex);
+			int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+			if (m_directIO)
+			{
+				stream.fd = ::open(fileName.c_str(), flags | O_DIRECT, 0644);
+				// tmpfs and some network file systems refuse O_DIRECT
+				if (stream.fd < 0 && errno == EINVAL)
+					stream.fd = ::open(fileName.c_str(), flags, 0644);
+			}
+			else
+#endif
+			{
+				stream.fd = ::open(fileName.c_str(), flags, 0644);
+			}
+			if (stream.fd < 0)
+				throw Internal::SystemError("unable to open", fileName);
+
+			// preallocation is a hint; file systems without it still work
+			posix_fallocate(stream.fd, 0, static_cast<off_t>(m_segmentSize));
+
+			stream.written = 0;
+			stream.used = 0;
+			stream.index.clear();
+			WriteFileHeader(streamIndex, 0, 0);
+		}
+
+		void WriteFileHeader(size_t streamIndex, uint64_t frameCount, uint64_t indexOffset)
+		{
+			Stream& stream = m_streams[streamIndex];
+			SequenceFileHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, "ASEQ", 4);
+			header.version = Internal::SequenceVersion;
+			header.alignment = static_cast<uint32_t>(m_alignment);
+			header.segmentIndex = static_cast<uint32_t>(stream.segment);
+			header.frameCount = frameCount;
+			header.indexOffset = indexOffset;
+
+			if (indexOffset == 0)
+			{
+				// start of a segment: the header block goes through the
+				// staging buffer ahead of the first frame
+				uint8_t* pBlock = m_buffers[stream.buffer].pData + stream.used;
+				std::memset(pBlock, 0, m_alignment);
+				std::memcpy(pBlock, &header, sizeof(header));
+				stream.used += m_alignment;
+				return;
+			}
+
+			// end of a segment: rewrite the first block in place
+			void* pBlock = NULL;
+			if (posix_memalign(&pBlock, m_alignment, m_alignment) != 0)
+				throw std::bad_alloc();
+			std::memset(pBlock, 0, m_alignment);
+			std::memcpy(pBlock, &header, sizeof(header));
+			bool ok = WriteAt(stream.fd, static_cast<const uint8_t*>(pBlock), m_alignment, 0);
+			std::free(pBlock);
+			if (!ok)
+				throw Internal::SystemError("unable to write", GetSegmentFileName(stream.segment, streamIndex));
+		}
+
+		static bool WriteAt(int fd, const uint8_t* pData, size_t size, uint64_t offset)
+		{
+			while (size > 0)
+			{
+				ssize_t written = ::pwrite(fd, pData, size, static_cast<off_t>(offset));
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+				pData += written;
+				size -= static_cast<size_t>(written);
+				offset += static_cast<uint64_t>(written);
+			}
+			return true;
+		}
+
+		void FlushStream(size_t streamIndex)
+		{
+			Stream& stream = m_streams[streamIndex];
+			if (stream.used == 0)
+				return;
+
+			if (m_pQueue == NULL)
+			{
+				if (!WriteAt(stream.fd, m_buffers[stream.buffer].pData, stream.used, stream.written))
+					throw Internal::SystemError("unable to write", GetSegmentFileName(stream.segment, streamIndex));
+				stream.written += stream.used;
+				stream.used = 0;
+				return;
+			}
+
+			Buffer& buffer = m_buffers[stream.buffer];
+			buffer.busy = true;
+			buffer.owner = NoOwner;
+			buffer.stream = streamIndex;
+			buffer.inFlight = stream.used;
+			stream.pending += stream.used;
+			m_pQueue->Write(stream.fd, buffer.pData, stream.used, stream.written, stream.buffer, buffer.registered ? static_cast<int>(stream.buffer) : -1);
+			stream.written += stream.used;
+			stream.used = 0;
+
+			// continue in a free buffer, waiting for a write to finish if
+			// every buffer is in flight
+			for (;;)
+			{
+				for (size_t i = 0; i < m_buffers.size(); i++)
+				{
+					if (!m_buffers[i].busy && m_buffers[i].owner == NoOwner)
+					{
+						m_buffers[i].owner = streamIndex;
+						stream.buffer = i;
+						return;
+					}
+				}
+				WaitWrite();
+			}
+		}
+
+		void WaitWrite()
+		{
+			WriteCompletion completion;
+			if (!m_pQueue->Wait(completion))
+				return;
+			Buffer& buffer = m_buffers[static_cast<size_t>(completion.tag)];
+			buffer.busy = false;
+			m_streams[buffer.stream].pending -= buffer.inFlight;
+			if (completion.result < 0)
+			{
+				errno = static_cast<int>(-completion.result);
+				throw Internal::SystemError("unable to write", GetSegmentFileName(m_streams[buffer.stream].segment, buffer.stream));
+			}
+		}
+
+		void CloseSegment(size_t streamIndex)
+		{
+			Stream& stream = m_streams[streamIndex];
+			if (stream.fd < 0)
+				return;
+
+			// the index follows the last record, padded to the alignment so it
+			// can go out through the same aligned path
+			uint64_t indexOffset = stream.written + stream.used;
+			size_t indexSize = stream.index.size() * sizeof(SequenceIndexEntry);
+			size_t paddedSize = static_cast<size_t>(Internal::AlignUp(indexSize, m_alignment));
+			if (stream.used + paddedSize > m_buffers[stream.buffer].size)
+			{
+				FlushStream(streamIndex);
+				if (paddedSize > m_buffers[stream.buffer].size)
+					Allocate(m_buffers[stream.buffer], paddedSize, 0);
+			}
+			uint8_t* pIndex = m_buffers[stream.buffer].pData + stream.used;
+			std::memset(pIndex, 0, paddedSize);
+			if (indexSize > 0)
+				std::memcpy(pIndex, &stream.index[0], indexSize);
+			stream.used += paddedSize;
+			FlushStream(streamIndex);
+			while (stream.pending > 0)
+				WaitWrite();
+
+			WriteFileHeader(streamIndex, stream.index.size(), indexOffset);
+
+			// drop the unused part of the preallocation
+			int result = ::ftruncate(stream.fd, static_cast<off_t>(stream.written));
+			::close(stream.fd);
+			stream.fd = -1;
+			if (result != 0)
+				throw Internal::SystemError("unable to truncate", GetSegmentFileName(stream.segment, streamIndex));
+		}
+
+		uint64_t m_segmentSize;
+		bool m_directIO;
+		size_t m_alignment;
+		EStripePolicy m_policy;
+		size_t m_nextStream;
+
+		// one segment stream per directory, sharing the staging buffers
+		std::vector<Stream> m_streams;
+		std::vector<Buffer> m_buffers;
+		WriteQueue* m_pQueue;
+		StripeManifest m_manifest;
+
+		bool m_compress;
+		RawCodec m_codec;
+		std::vector<uint8_t> m_compressed;
+
+		uint64_t m_numFrames;
+		bool m_closed;
+
+		SequenceWriter(const SequenceWriter&);
+		SequenceWriter& operator=(const SequenceWriter&);
+	};
+}
@@ -0,0 +1,267 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace Save
+{
+	/**
+	 * @typedef EStripePolicy
+	 *
+	 * The <B> EStripePolicy </B> enum represents the ways a striped writer
+	 * picks the root directory for the next frame or segment.
+	 */
+	typedef enum _EStripePolicy {
+		StripeRoundRobin, /*!< Cycle through the roots in order */
+		StripeLeastBusy, /*!< Pick the root with the least data still waiting to be written */
+	} EStripePolicy;
+
+	/**
+	 * @struct StripeManifestEntry
+	 *
+	 * The <B> StripeManifestEntry </B> records where one frame of a striped
+	 * recording was written.
+	 */
+	struct StripeManifestEntry
+	{
+		uint64_t frame;   /*!< Position of the frame in submission order */
+		std::string file; /*!< File the frame was written to */
+		uint64_t offset;  /*!< Offset of the frame within the file, 0 for one file per frame */
+	};
+
+	/**
+	 * @class StripeManifest
+	 *
+	 * The stripe manifest is a tab-separated text file listing, in
+	 * submission order, the file and offset each frame of a striped
+	 * recording landed in. Readers use it to put frames spread over several
+	 * drives back into order.
+	 *
+	 * \code{.cpp}
+	 * 	// listing the files of a striped image recording in capture order
+	 * 	{
+	 * 		std::vector<Save::StripeManifestEntry> entries = Save::StripeManifest::Load("images.manifest");
+	 *
+	 * 		for (size_t i = 0; i < entries.size(); i++)
+	 * 			std::cout << entries[i].frame << " " << entries[i].file << "\n";
+	 * 	}
+	 * \endcode
+	 */
+	class StripeManifest
+	{
+	public:
+		/**
+		 * @fn StripeManifest()
+		 *
+		 * An empty constructor. The manifest is closed.
+		 */
+		StripeManifest()
+			: m_pFile(NULL)
+		{
+		}
+
+		/**
+		 * @fn virtual ~StripeManifest()
+		 *
+		 * A destructor. Closes the manifest.
+		 */
+		virtual ~StripeManifest()
+		{
+			Close();
+		}
+
+		/**
+		 * @fn virtual void Open(const char* pFileName)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - Manifest file to create, replaced if it exists
+		 *
+		 * <B> Open </B> starts a new manifest.
+		 */
+		virtual void Open(const char* pFileName)
+		{
+			Close();
+			m_pFile = std::fopen(pFileName, "w");
+			if (m_pFile == NULL)
+				throw std::runtime_error(std::string("unable to create manifest ") + pFileName + ": " + std::strerror(errno));
+			std::fputs("# frame\tfile\toffset\n", m_pFile);
+		}
+
+		/**
+		 * @fn virtual bool IsOpen()
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the manifest is open
+		 */
+		virtual bool IsOpen()
+		{
+			return m_pFile != NULL;
+		}
+
+		/**
+		 * @fn virtual void Add(uint64_t frame, const std::string& file, uint64_t offset = 0)
+		 *
+		 * <B> Add </B> records where a frame was written. Entries are
+		 * buffered and reach the disk on Flush or Close.
+		 */
+		virtual void Add(uint64_t frame, const std::string& file, uint64_t offset = 0)
+		{
+			if (m_pFile != NULL)
+				std::fprintf(m_pFile, "%llu\t%s\t%llu\n", static_cast<unsigned long long>(frame), file.c_str(), static_cast<unsigned long long>(offset));
+		}
+
+		/**
+		 * @fn virtual void Flush()
+		 *
+		 * <B> Flush </B> writes buffered entries to the manifest file.
+		 */
+		virtual void Flush()
+		{
+			if (m_pFile != NULL)
+				std::fflush(m_pFile);
+		}
+
+		/**
+		 * @fn virtual void Close()
+		 *
+		 * <B> Close </B> flushes and closes the manifest.
+		 */
+		virtual void Close()
+		{
+			if (m_pFile != NULL)
+				std::fclose(m_pFile);
+			m_pFile = NULL;
+		}
+
+		/**
+		 * @fn static std::vector<StripeManifestEntry> Load(const char* pFileName)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - Manifest file to read
+		 *
+		 * @return 
+		 *  - Type: std::vector<Save::StripeManifestEntry>
+		 *  - Entries in the order they were recorded
+		 *
+		 * <B> Load </B> reads a manifest. A missing file gives an empty list.
+		 */
+		static std::vector<StripeManifestEntry> Load(const char* pFileName)
+		{
+			std::vector<StripeManifestEntry> entries;
+			FILE* pFile = std::fopen(pFileName, "r");
+			if (pFile == NULL)
+				return entries;
+
+			char line[4096];
+			while (std::fgets(line, sizeof(line), pFile) != NULL)
+			{
+				if (line[0] == '#')
+					continue;
+				char* pName = std::strchr(line, '\t');
+				char* pOffset = pName != NULL ? std::strrchr(line, '\t') : NULL;
+				if (pName == NULL || pOffset == pName)
+					continue;
+				StripeManifestEntry entry;
+				entry.frame = std::strtoull(line, NULL, 10);
+				entry.file.assign(pName + 1, pOffset);
+				entry.offset = std::strtoull(pOffset + 1, NULL, 10);
+				entries.push_back(entry);
+			}
+			std::fclose(pFile);
+			return entries;
+		}
+
+	private:
+		FILE* m_pFile;
+
+		StripeManifest(const StripeManifest&);
+		StripeManifest& operator=(const StripeManifest&);
+	};
+
+	namespace Internal
+	{
+		// splits a striped pattern such as "{/mnt/a,/mnt/b}/images/img<count>.raw"
+		// into its roots and the part below them; a pattern without a leading
+		// brace list has a single empty root
+		inline std::vector<std::string> SplitStripedPattern(const std::string& pattern, std::string& rest)
+		{
+			std::vector<std::string> roots;
+			size_t close = pattern.find('}');
+			if (pattern.empty() || pattern[0] != '{' || close == std::string::npos)
+			{
+				roots.push_back(std::string());
+				rest = pattern;
+				return roots;
+			}
+
+			std::string list = pattern.substr(1, close - 1);
+			for (size_t start = 0;;)
+			{
+				size_t comma = list.find(',', start);
+				std::string root = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+				while (root.size() > 1 && root[root.size() - 1] == '/')
+					root.erase(root.size() - 1);
+				if (!root.empty())
+					roots.push_back(root);
+				if (comma == std::string::npos)
+					break;
+				start = comma + 1;
+			}
+			if (roots.empty())
+				throw std::invalid_argument("striped pattern lists no directories: " + pattern);
+
+			rest = pattern.substr(close + 1);
+			while (!rest.empty() && rest[0] == '/')
+				rest.erase(0, 1);
+			return roots;
+		}
+
+		inline std::string JoinStripePath(const std::string& root, const std::string& rest)
+		{
+			if (root.empty())
+				return rest;
+			return root + "/" + rest;
+		}
+
+		// picks the root for the next frame; load holds the bytes still
+		// waiting to be written per root
+		inline size_t ChooseStripe(EStripePolicy policy, const std::vector<uint64_t>& load, size_t& next)
+		{
+			size_t choice = next % load.size();
+			if (policy == StripeLeastBusy)
+			{
+				// start at the round-robin position so ties still rotate
+				for (size_t i = 1; i < load.size(); i++)
+				{
+					size_t candidate = (next + i) % load.size();
+					if (load[candidate] < load[choice])
+						choice = candidate;
+				}
+			}
+			next = choice + 1;
+			return choice;
+		}
+	}
+}
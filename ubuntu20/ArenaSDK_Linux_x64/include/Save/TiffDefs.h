@@ -0,0 +1,449 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "SequenceDefs.h"
+#include <zlib.h>
+#if defined(SAVE_TIFF_ZSTD)
+#include <zstd.h>
+#endif
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+namespace Save
+{
+	/**
+	 * @typedef ETiffCodec
+	 *
+	 * The <B> ETiffCodec </B> enum represents the compression of strips or
+	 * tiles written by the Save::TiffWriter.
+	 */
+	typedef enum _ETiffCodec {
+		TiffCodecNone, /*!< Uncompressed */
+		TiffCodecLzw, /*!< LZW compression */
+		TiffCodecDeflate, /*!< Deflate (zlib) compression */
+		TiffCodecZstd /*!< Zstandard compression (needs SAVE_TIFF_ZSTD and libzstd) */
+	} ETiffCodec;
+
+	/**
+	 * @struct TiffPageInfo
+	 *
+	 * The <B> TiffPageInfo </B> describes one page (image file directory)
+	 * of a TIFF file, as read by the Save::TiffReader.
+	 */
+	struct TiffPageInfo
+	{
+		uint64_t offset;                     /*!< File offset of the image file directory */
+		size_t width;                        /*!< Width, in pixels */
+		size_t height;                       /*!< Height, in pixels */
+		size_t samplesPerPixel;              /*!< Samples per pixel */
+		size_t bitsPerSample;                /*!< Bits per sample */
+		ETiffCodec codec;                    /*!< Compression */
+		bool predictor;                      /*!< True if horizontal differencing is applied */
+		bool tiled;                          /*!< True for tiles, false for strips */
+		size_t blockWidth;                   /*!< Tile width, or the image width for strips */
+		size_t blockHeight;                  /*!< Tile height, or rows per strip */
+		std::vector<uint64_t> blockOffsets;  /*!< File offsets of the strips or tiles */
+		std::vector<uint64_t> blockSizes;    /*!< Sizes of the strips or tiles, in bytes */
+	};
+
+	namespace Internal
+	{
+		const uint16_t TiffTagNewSubfileType = 254;
+		const uint16_t TiffTagImageWidth = 256;
+		const uint16_t TiffTagImageLength = 257;
+		const uint16_t TiffTagBitsPerSample = 258;
+		const uint16_t TiffTagCompression = 259;
+		const uint16_t TiffTagPhotometric = 262;
+		const uint16_t TiffTagStripOffsets = 273;
+		const uint16_t TiffTagSamplesPerPixel = 277;
+		const uint16_t TiffTagRowsPerStrip = 278;
+		const uint16_t TiffTagStripByteCounts = 279;
+		const uint16_t TiffTagPlanarConfig = 284;
+		const uint16_t TiffTagPredictor = 317;
+		const uint16_t TiffTagTileWidth = 322;
+		const uint16_t TiffTagTileLength = 323;
+		const uint16_t TiffTagTileOffsets = 324;
+		const uint16_t TiffTagTileByteCounts = 325;
+		const uint16_t TiffTagExtraSamples = 338;
+		const uint16_t TiffTagSampleFormat = 339;
+
+		// the Save::TiffWriter follows the header with this magic and the
+		// 64-bit offset of the page index, which is 0 until the file is
+		// closed; no directory refers to the block, so other readers skip
+		// it. The index repeats the magic, then holds the page count and
+		// one 64-bit directory offset per page.
+		const char TiffPageIndexMagic[8] = { 'A', 'T', 'I', 'F', 'P', 'I', 'D', 'X' };
+
+		const uint16_t TiffTypeShort = 3;
+		const uint16_t TiffTypeLong = 4;
+		const uint16_t TiffTypeLong8 = 16;
+
+		const uint16_t TiffCompressionNone = 1;
+		const uint16_t TiffCompressionLzw = 5;
+		const uint16_t TiffCompressionAdobeDeflate = 8;
+		const uint16_t TiffCompressionDeflate = 32946;
+		const uint16_t TiffCompressionZstd = 50000;
+
+		inline uint16_t TiffCompressionTag(ETiffCodec codec)
+		{
+			switch (codec)
+			{
+			case TiffCodecLzw: return TiffCompressionLzw;
+			case TiffCodecDeflate: return TiffCompressionAdobeDeflate;
+			case TiffCodecZstd: return TiffCompressionZstd;
+			default: return TiffCompressionNone;
+			}
+		}
+
+		inline void TiffPut(uint8_t* p, uint64_t value, size_t size)
+		{
+			for (size_t i = 0; i < size; i++)
+				p[i] = static_cast<uint8_t>(value >> (8 * i));
+		}
+
+		inline uint64_t TiffGet(const uint8_t* p, size_t size)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < size; i++)
+				value |= static_cast<uint64_t>(p[i]) << (8 * i);
+			return value;
+		}
+
+		// runs fn(0) .. fn(count - 1) on up to numThreads threads and
+		// rethrows the first exception on the calling thread
+		inline void TiffRunParallel(size_t count, size_t numThreads, const std::function<void(size_t)>& fn)
+		{
+			std::atomic<size_t> next(0);
+			std::exception_ptr error;
+			std::mutex errorMutex;
+			auto worker = [&]() {
+				for (size_t i = next++; i < count; i = next++)
+				{
+					try
+					{
+						fn(i);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if (!error)
+							error = std::current_exception();
+						next = count;
+					}
+				}
+			};
+
+			if (numThreads > count)
+				numThreads = count;
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < numThreads; i++)
+				threads.push_back(std::thread(worker));
+			worker();
+			for (size_t i = 0; i < threads.size(); i++)
+				threads[i].join();
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		// horizontal differencing (TIFF predictor 2) over rows of 8 or 16-bit
+		// samples; 16-bit samples are in host order, which is the file order
+		// on little-endian machines
+		inline void TiffApplyPredictor(uint8_t* pData, size_t rowSize, size_t rows, size_t samplesPerPixel, size_t bitsPerSample)
+		{
+			for (size_t r = 0; r < rows; r++)
+			{
+				if (bitsPerSample == 16)
+				{
+					uint16_t* pRow = reinterpret_cast<uint16_t*>(pData + r * rowSize);
+					for (size_t i = rowSize / 2; i-- > samplesPerPixel;)
+						pRow[i] = static_cast<uint16_t>(pRow[i] - pRow[i - samplesPerPixel]);
+				}
+				else
+				{
+					uint8_t* pRow = pData + r * rowSize;
+					for (size_t i = rowSize; i-- > samplesPerPixel;)
+						pRow[i] = static_cast<uint8_t>(pRow[i] - pRow[i - samplesPerPixel]);
+				}
+			}
+		}
+
+		inline void TiffUndoPredictor(uint8_t* pData, size_t rowSize, size_t rows, size_t samplesPerPixel, size_t bitsPerSample)
+		{
+			for (size_t r = 0; r < rows; r++)
+			{
+				if (bitsPerSample == 16)
+				{
+					uint16_t* pRow = reinterpret_cast<uint16_t*>(pData + r * rowSize);
+					for (size_t i = samplesPerPixel; i < rowSize / 2; i++)
+						pRow[i] = static_cast<uint16_t>(pRow[i] + pRow[i - samplesPerPixel]);
+				}
+				else
+				{
+					uint8_t* pRow = pData + r * rowSize;
+					for (size_t i = samplesPerPixel; i < rowSize; i++)
+						pRow[i] = static_cast<uint8_t>(pRow[i] + pRow[i - samplesPerPixel]);
+				}
+			}
+		}
+
+		// TIFF LZW: MSB-first codes of 9 to 12 bits with the "early change"
+		// code width switch, as written by libtiff
+		inline void TiffLzwEncode(const uint8_t* pIn, size_t size, std::vector<uint8_t>& out)
+		{
+			const uint32_t clearCode = 256;
+			const uint32_t endCode = 257;
+			const uint32_t firstCode = 258;
+			const uint32_t tableFull = 4094;
+			const size_t hashSize = 1 << 14;
+
+			std::vector<uint32_t> keys(hashSize, 0);
+			std::vector<uint16_t> codes(hashSize);
+			out.clear();
+			out.reserve(size / 2 + 16);
+
+			uint64_t bits = 0;
+			size_t numBits = 0;
+			uint32_t codeBits = 9;
+			uint32_t maxCode = 511;
+			uint32_t nextCode = firstCode;
+			auto put = [&](uint32_t code) {
+				bits = (bits << codeBits) | code;
+				numBits += codeBits;
+				while (numBits >= 8)
+				{
+					numBits -= 8;
+					out.push_back(static_cast<uint8_t>(bits >> numBits));
+				}
+				bits &= (1ULL << numBits) - 1;
+			};
+
+			put(clearCode);
+			if (size > 0)
+			{
+				uint32_t prefix = pIn[0];
+				for (size_t i = 1; i < size; i++)
+				{
+					uint32_t key = ((prefix << 8) | pIn[i]) + 1;
+					size_t h = (key * 2654435761u) >> 18 & (hashSize - 1);
+					while (keys[h] != 0 && keys[h] != key)
+						h = (h + 1) & (hashSize - 1);
+					if (keys[h] == key)
+					{
+						prefix = codes[h];
+						continue;
+					}
+
+					put(prefix);
+					prefix = pIn[i];
+					keys[h] = key;
+					codes[h] = static_cast<uint16_t>(nextCode++);
+					if (nextCode == tableFull)
+					{
+						put(clearCode);
+						std::fill(keys.begin(), keys.end(), 0);
+						codeBits = 9;
+						maxCode = 511;
+						nextCode = firstCode;
+					}
+					else if (nextCode > maxCode)
+					{
+						codeBits++;
+						maxCode = (1u << codeBits) - 1;
+					}
+				}
+
+				// the decoder adds one more entry after the last code, which
+				// may widen the end code
+				put(prefix);
+				nextCode++;
+				if (nextCode == tableFull)
+				{
+					put(clearCode);
+					codeBits = 9;
+				}
+				else if (nextCode > maxCode)
+					codeBits++;
+			}
+			put(endCode);
+			if (numBits > 0)
+				out.push_back(static_cast<uint8_t>(bits << (8 - numBits)));
+		}
+
+		inline void TiffLzwDecode(const uint8_t* pIn, size_t size, uint8_t* pOut, size_t outSize)
+		{
+			const uint32_t clearCode = 256;
+			const uint32_t endCode = 257;
+			const uint32_t firstCode = 258;
+
+			uint16_t prefix[4096];
+			uint8_t suffix[4096];
+			uint16_t length[4096];
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				prefix[i] = 0;
+				suffix[i] = static_cast<uint8_t>(i);
+				length[i] = 1;
+			}
+
+			size_t pos = 0;
+			size_t bitPos = 0;
+			uint32_t codeBits = 9;
+			uint32_t nextCode = firstCode;
+			int64_t previous = -1;
+			auto get = [&]() -> uint32_t {
+				if (bitPos + codeBits > size * 8)
+					return endCode;
+				uint32_t code = 0;
+				for (uint32_t b = 0; b < codeBits; b++, bitPos++)
+					code = (code << 1) | ((pIn[bitPos >> 3] >> (7 - (bitPos & 7))) & 1);
+				return code;
+			};
+			auto emit = [&](uint32_t code) {
+				size_t n = length[code];
+				if (pos + n > outSize)
+					throw std::runtime_error("LZW data overflows the strip");
+				for (size_t i = n; i > 0; i--)
+				{
+					pOut[pos + i - 1] = suffix[code];
+					code = prefix[code];
+				}
+				pos += n;
+			};
+
+			for (;;)
+			{
+				uint32_t code = get();
+				if (code == endCode)
+					break;
+				if (code == clearCode)
+				{
+					codeBits = 9;
+					nextCode = firstCode;
+					previous = -1;
+					continue;
+				}
+				if (previous < 0)
+				{
+					if (code >= 256)
+						throw std::runtime_error("corrupt LZW data");
+					emit(code);
+					previous = code;
+					continue;
+				}
+				if (code > nextCode || nextCode >= 4096)
+					throw std::runtime_error("corrupt LZW data");
+
+				size_t start = pos;
+				if (code < nextCode)
+					emit(code);
+				else
+				{
+					emit(static_cast<uint32_t>(previous));
+					if (pos >= outSize)
+						throw std::runtime_error("LZW data overflows the strip");
+					pOut[pos++] = pOut[start];
+				}
+				prefix[nextCode] = static_cast<uint16_t>(previous);
+				suffix[nextCode] = pOut[start];
+				length[nextCode] = static_cast<uint16_t>(length[previous] + 1);
+				nextCode++;
+				if (nextCode >= (1u << codeBits) - 1 && codeBits < 12)
+					codeBits++;
+				previous = code;
+			}
+		}
+
+		inline void TiffCompress(ETiffCodec codec, int level, const uint8_t* pIn, size_t size, std::vector<uint8_t>& out)
+		{
+			switch (codec)
+			{
+			case TiffCodecNone:
+				out.assign(pIn, pIn + size);
+				return;
+			case TiffCodecLzw:
+				TiffLzwEncode(pIn, size, out);
+				return;
+			case TiffCodecDeflate:
+			{
+				uLongf outSize = compressBound(static_cast<uLong>(size));
+				out.resize(outSize);
+				if (compress2(&out[0], &outSize, pIn, static_cast<uLong>(size), level < 0 ? Z_DEFAULT_COMPRESSION : level) != Z_OK)
+					throw std::runtime_error("TIFF deflate failed");
+				out.resize(outSize);
+				return;
+			}
+#if defined(SAVE_TIFF_ZSTD)
+			case TiffCodecZstd:
+			{
+				out.resize(ZSTD_compressBound(size));
+				size_t outSize = ZSTD_compress(&out[0], out.size(), pIn, size, level < 0 ? ZSTD_CLEVEL_DEFAULT : level);
+				if (ZSTD_isError(outSize))
+					throw std::runtime_error(std::string("TIFF zstd compression failed: ") + ZSTD_getErrorName(outSize));
+				out.resize(outSize);
+				return;
+			}
+#endif
+			default:
+				throw std::invalid_argument("TIFF codec not available");
+			}
+		}
+
+		inline void TiffDecompress(uint16_t compression, const uint8_t* pIn, size_t size, uint8_t* pOut, size_t outSize)
+		{
+			switch (compression)
+			{
+			case TiffCompressionNone:
+				if (size < outSize)
+					throw std::runtime_error("TIFF strip is shorter than its rows");
+				std::memcpy(pOut, pIn, outSize);
+				return;
+			case TiffCompressionLzw:
+				TiffLzwDecode(pIn, size, pOut, outSize);
+				return;
+			case TiffCompressionAdobeDeflate:
+			case TiffCompressionDeflate:
+			{
+				uLongf length = static_cast<uLongf>(outSize);
+				int result = uncompress(pOut, &length, pIn, static_cast<uLong>(size));
+
+				// a full block may be followed by padding, but zlib reports
+				// truncated input the same way
+				if (result != Z_OK && !(result == Z_BUF_ERROR && length == outSize))
+					throw std::runtime_error("corrupt TIFF deflate data");
+				return;
+			}
+#if defined(SAVE_TIFF_ZSTD)
+			case TiffCompressionZstd:
+			{
+				size_t result = ZSTD_decompress(pOut, outSize, pIn, size);
+				if (ZSTD_isError(result))
+					throw std::runtime_error(std::string("corrupt TIFF zstd data: ") + ZSTD_getErrorName(result));
+				return;
+			}
+#endif
+			default:
+				throw std::runtime_error("unsupported TIFF compression");
+			}
+		}
+	}
+}
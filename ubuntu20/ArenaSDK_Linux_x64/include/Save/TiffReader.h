@@ -0,0 +1,488 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "TiffDefs.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace Save
+{
+	/**
+	 * @class TiffReader
+	 *
+	 * The TIFF reader maps a little-endian TIFF or BigTIFF file and decodes
+	 * its pages. Files closed by the Save::TiffWriter carry a page index, so
+	 * any page is found in constant time; for other files, and for files
+	 * whose writer did not close, the directory chain is walked once when
+	 * the file is opened.
+	 *
+	 * Pages can be decoded when they are chunky (interleaved), 8 or 16 bits
+	 * per sample, in strips or tiles, uncompressed or compressed with LZW,
+	 * Deflate or (with SAVE_TIFF_ZSTD) Zstandard, with or without the
+	 * horizontal predictor. Strips or tiles are decompressed in parallel.
+	 *
+	 * This header needs zlib; link with -lz. It is not included by
+	 * SaveApi.h.
+	 *
+	 * \code{.cpp}
+	 * 	// reading the last page of a stack
+	 * 	{
+	 * 		Save::TiffReader reader("savedimages/stack.tif");
+	 * 		std::vector<uint8_t> image = reader.ReadPage(reader.GetNumPages() - 1);
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::TiffWriter
+	 */
+	class TiffReader
+	{
+	public:
+		/**
+		 * @fn TiffReader(const char* pFileName, size_t numThreads = 0)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File to read
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Decompression threads
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * A constructor. Maps the file and locates its pages.
+		 *
+		 * @warning 
+		 *  - Throws std::runtime_error if the file cannot be mapped or is
+		 *    not a little-endian TIFF
+		 */
+		TiffReader(const char* pFileName, size_t numThreads = 0)
+			: m_fileName(pFileName),
+			  m_pBase(NULL),
+			  m_size(0),
+			  m_bigTiff(false),
+			  m_numThreads(numThreads),
+			  m_bgr(true),
+			  m_indexed(false)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+
+			int fd = ::open(pFileName, O_RDONLY);
+			if (fd < 0)
+				throw Internal::SystemError("unable to open", m_fileName);
+			struct stat st;
+			void* pMap = MAP_FAILED;
+			if (::fstat(fd, &st) == 0 && st.st_size > 0)
+				pMap = ::mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (pMap == MAP_FAILED)
+				throw Internal::SystemError("unable to map", m_fileName);
+			m_pBase = static_cast<const uint8_t*>(pMap);
+			m_size = static_cast<uint64_t>(st.st_size);
+
+			try
+			{
+				LocatePages();
+			}
+			catch (...)
+			{
+				::munmap(const_cast<uint8_t*>(m_pBase), static_cast<size_t>(m_size));
+				throw;
+			}
+		}
+
+		/**
+		 * @fn virtual ~TiffReader()
+		 *
+		 * A destructor. Unmaps the file.
+		 */
+		virtual ~TiffReader()
+		{
+			::munmap(const_cast<uint8_t*>(m_pBase), static_cast<size_t>(m_size));
+		}
+
+		/**
+		 * @fn virtual void SetBgr(bool bgr)
+		 *
+		 * @param bgr
+		 *  - Type: bool
+		 *  - If true, colour pages are returned in BGR(A) order
+		 *  - Otherwise, colour pages are returned in RGB(A) order
+		 *
+		 * <B> SetBgr </B> sets the channel order of decoded colour pages. The
+		 * default matches the Save::TiffWriter.
+		 */
+		virtual void SetBgr(bool bgr)
+		{
+			m_bgr = bgr;
+		}
+
+		/**
+		 * @fn virtual size_t GetNumPages()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of pages in the file
+		 */
+		virtual size_t GetNumPages()
+		{
+			return m_pages.size();
+		}
+
+		/**
+		 * @fn virtual bool IsIndexed()
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the pages were located through the page index
+		 *  - Otherwise, false (the directory chain was walked)
+		 */
+		virtual bool IsIndexed()
+		{
+			return m_indexed;
+		}
+
+		/**
+		 * @fn virtual TiffPageInfo GetPageInfo(size_t page)
+		 *
+		 * @param page
+		 *  - Type: size_t
+		 *  - Index of the page
+		 *
+		 * @return 
+		 *  - Type: Save::TiffPageInfo
+		 *  - Layout of the page
+		 *
+		 * <B> GetPageInfo </B> reads the directory of a page.
+		 *
+		 * @warning 
+		 *  - Throws std::out_of_range for a page past the end
+		 *  - Throws std::runtime_error for a malformed directory
+		 */
+		virtual TiffPageInfo GetPageInfo(size_t page)
+		{
+			if (page >= m_pages.size())
+				throw std::out_of_range("TIFF page index out of range");
+			uint16_t compression;
+			return ParseDirectory(m_pages[page], compression);
+		}
+
+		/**
+		 * @fn virtual void ReadPage(size_t page, uint8_t* pOut, size_t size)
+		 *
+		 * @param page
+		 *  - Type: size_t
+		 *  - Index of the page
+		 *
+		 * @param pOut
+		 *  - Type: uint8_t*
+		 *  - Receives the image, rows top to bottom without padding
+		 *
+		 * @param size
+		 *  - Type: size_t
+		 *  - Size of the buffer, in bytes
+		 *
+		 * <B> ReadPage </B> decodes a page into a buffer.
+		 *
+		 * @warning 
+		 *  - Throws std::out_of_range for a page past the end
+		 *  - Throws std::invalid_argument if the buffer is too small
+		 *  - Throws std::runtime_error for layouts the reader cannot decode
+		 *    or corrupt data
+		 */
+		virtual void ReadPage(size_t page, uint8_t* pOut, size_t size)
+		{
+			if (page >= m_pages.size())
+				throw std::out_of_range("TIFF page index out of range");
+			uint16_t compression;
+			TiffPageInfo info = ParseDirectory(m_pages[page], compression);
+			size_t pixelSize = info.samplesPerPixel * info.bitsPerSample / 8;
+			if (size < info.width * info.height * pixelSize)
+				throw std::invalid_argument("buffer too small for TIFF page");
+
+			size_t across = (info.width + info.blockWidth - 1) / info.blockWidth;
+			size_t sampleSize = info.bitsPerSample / 8;
+			bool swapChannels = m_bgr && info.samplesPerPixel >= 3;
+			Internal::TiffRunParallel(info.blockOffsets.size(), m_numThreads, [&](size_t i) {
+				size_t x0 = (i % across) * info.blockWidth;
+				size_t y0 = (i / across) * info.blockHeight;
+				if (x0 >= info.width || y0 >= info.height)
+					return;
+				size_t rows = info.tiled ? info.blockHeight : std::min(info.blockHeight, info.height - y0);
+				size_t blockRowSize = info.blockWidth * pixelSize;
+				std::vector<uint8_t> block(blockRowSize * rows, 0);
+				Internal::TiffDecompress(compression, m_pBase + info.blockOffsets[i], static_cast<size_t>(info.blockSizes[i]), &block[0], block.size());
+				if (info.predictor)
+					Internal::TiffUndoPredictor(&block[0], blockRowSize, rows, info.samplesPerPixel, info.bitsPerSample);
+
+				size_t columns = std::min(info.blockWidth, info.width - x0);
+				for (size_t r = 0; r < rows && y0 + r < info.height; r++)
+				{
+					const uint8_t* pSrc = &block[r * blockRowSize];
+					uint8_t* pDst = pOut + ((y0 + r) * info.width + x0) * pixelSize;
+					std::memcpy(pDst, pSrc, columns * pixelSize);
+					if (!swapChannels)
+						continue;
+					for (size_t x = 0; x < columns; x++)
+					{
+						std::memcpy(pDst + x * pixelSize, pSrc + x * pixelSize + 2 * sampleSize, sampleSize);
+						std::memcpy(pDst + x * pixelSize + 2 * sampleSize, pSrc + x * pixelSize, sampleSize);
+					}
+				}
+			});
+		}
+
+		/**
+		 * @fn virtual std::vector<uint8_t> ReadPage(size_t page)
+		 *
+		 * @param page
+		 *  - Type: size_t
+		 *  - Index of the page
+		 *
+		 * @return 
+		 *  - Type: std::vector<uint8_t>
+		 *  - Image, rows top to bottom without padding
+		 *
+		 * <B> ReadPage </B> decodes a page into a new buffer.
+		 */
+		virtual std::vector<uint8_t> ReadPage(size_t page)
+		{
+			TiffPageInfo info = GetPageInfo(page);
+			std::vector<uint8_t> image(info.width * info.height * info.samplesPerPixel * info.bitsPerSample / 8);
+			ReadPage(page, image.empty() ? NULL : &image[0], image.size());
+			return image;
+		}
+
+	private:
+		// reads the values of a directory entry as unsigned integers
+		std::vector<uint64_t> EntryValues(const uint8_t* pEntry)
+		{
+			uint16_t type = static_cast<uint16_t>(Internal::TiffGet(pEntry + 2, 2));
+			uint64_t count = Internal::TiffGet(pEntry + 4, m_bigTiff ? 8 : 4);
+			size_t fieldSize = m_bigTiff ? 8 : 4;
+			const uint8_t* pField = pEntry + 4 + fieldSize;
+
+			size_t typeSize;
+			switch (type)
+			{
+			case 1: typeSize = 1; break;
+			case 3: typeSize = 2; break;
+			case 4:
+			case 13: typeSize = 4; break;
+			case 16:
+			case 18: typeSize = 8; break;
+			default: return std::vector<uint64_t>();
+			}
+
+			const uint8_t* pValues = pField;
+			if (count * typeSize > fieldSize)
+			{
+				uint64_t offset = Internal::TiffGet(pField, fieldSize);
+				if (count > m_size / typeSize || offset > m_size - count * typeSize)
+					throw std::runtime_error("malformed TIFF directory in " + m_fileName);
+				pValues = m_pBase + offset;
+			}
+			std::vector<uint64_t> values(static_cast<size_t>(count));
+			for (size_t i = 0; i < values.size(); i++)
+				values[i] = Internal::TiffGet(pValues + i * typeSize, typeSize);
+			return values;
+		}
+
+		// checks that a directory fits in the file and returns its entry
+		// count
+		uint64_t DirectoryEntries(uint64_t offset)
+		{
+			size_t countSize = m_bigTiff ? 8 : 2;
+			size_t entrySize = m_bigTiff ? 20 : 12;
+			if (offset < 8 || offset > m_size - countSize)
+				throw std::runtime_error("TIFF directory offset out of range in " + m_fileName);
+			uint64_t count = Internal::TiffGet(m_pBase + offset, countSize);
+			if (count > (m_size - offset - countSize) / entrySize)
+				throw std::runtime_error("truncated TIFF directory in " + m_fileName);
+			return count;
+		}
+
+		TiffPageInfo ParseDirectory(uint64_t offset, uint16_t& compression)
+		{
+			size_t countSize = m_bigTiff ? 8 : 2;
+			size_t entrySize = m_bigTiff ? 20 : 12;
+			uint64_t count = DirectoryEntries(offset);
+
+			TiffPageInfo info;
+			info.offset = offset;
+			info.width = 0;
+			info.height = 0;
+			info.samplesPerPixel = 1;
+			info.bitsPerSample = 1;
+			info.codec = TiffCodecNone;
+			info.predictor = false;
+			info.tiled = false;
+			info.blockWidth = 0;
+			info.blockHeight = 0;
+			compression = Internal::TiffCompressionNone;
+			uint64_t planar = 1;
+
+			for (uint64_t i = 0; i < count; i++)
+			{
+				const uint8_t* pEntry = m_pBase + offset + countSize + i * entrySize;
+				uint16_t tag = static_cast<uint16_t>(Internal::TiffGet(pEntry, 2));
+				switch (tag)
+				{
+				case Internal::TiffTagImageWidth:
+				case Internal::TiffTagImageLength:
+				case Internal::TiffTagBitsPerSample:
+				case Internal::TiffTagCompression:
+				case Internal::TiffTagSamplesPerPixel:
+				case Internal::TiffTagRowsPerStrip:
+				case Internal::TiffTagPlanarConfig:
+				case Internal::TiffTagPredictor:
+				case Internal::TiffTagTileWidth:
+				case Internal::TiffTagTileLength:
+				case Internal::TiffTagStripOffsets:
+				case Internal::TiffTagStripByteCounts:
+				case Internal::TiffTagTileOffsets:
+				case Internal::TiffTagTileByteCounts:
+					break;
+				default:
+					continue;
+				}
+
+				std::vector<uint64_t> values = EntryValues(pEntry);
+				if (values.empty())
+					continue;
+				switch (tag)
+				{
+				case Internal::TiffTagImageWidth: info.width = static_cast<size_t>(values[0]); break;
+				case Internal::TiffTagImageLength: info.height = static_cast<size_t>(values[0]); break;
+				case Internal::TiffTagBitsPerSample: info.bitsPerSample = static_cast<size_t>(values[0]); break;
+				case Internal::TiffTagCompression: compression = static_cast<uint16_t>(values[0]); break;
+				case Internal::TiffTagSamplesPerPixel: info.samplesPerPixel = static_cast<size_t>(values[0]); break;
+				case Internal::TiffTagRowsPerStrip: info.blockHeight = static_cast<size_t>(values[0]); break;
+				case Internal::TiffTagPlanarConfig: planar = values[0]; break;
+				case Internal::TiffTagPredictor: info.predictor = values[0] == 2; break;
+				case Internal::TiffTagTileWidth: info.blockWidth = static_cast<size_t>(values[0]); info.tiled = true; break;
+				case Internal::TiffTagTileLength: info.blockHeight = static_cast<size_t>(values[0]); info.tiled = true; break;
+				case Internal::TiffTagStripOffsets:
+				case Internal::TiffTagTileOffsets: info.blockOffsets = values; break;
+				case Internal::TiffTagStripByteCounts:
+				case Internal::TiffTagTileByteCounts: info.blockSizes = values; break;
+				}
+			}
+
+			switch (compression)
+			{
+			case Internal::TiffCompressionLzw: info.codec = TiffCodecLzw; break;
+			case Internal::TiffCompressionAdobeDeflate:
+			case Internal::TiffCompressionDeflate: info.codec = TiffCodecDeflate; break;
+			case Internal::TiffCompressionZstd: info.codec = TiffCodecZstd; break;
+			default: break;
+			}
+			if (!info.tiled)
+			{
+				info.blockWidth = info.width;
+				if (info.blockHeight == 0 || info.blockHeight > info.height)
+					info.blockHeight = info.height;
+			}
+
+			// only layouts the decoder handles are accepted
+			if (info.width == 0 || info.height == 0 || info.blockWidth == 0 || info.blockHeight == 0)
+				throw std::runtime_error("TIFF page without dimensions in " + m_fileName);
+			if (planar != 1 || (info.bitsPerSample != 8 && info.bitsPerSample != 16) || info.samplesPerPixel == 0 || info.samplesPerPixel > 4)
+				throw std::runtime_error("unsupported TIFF sample layout in " + m_fileName);
+			size_t blocks = ((info.width + info.blockWidth - 1) / info.blockWidth) * ((info.height + info.blockHeight - 1) / info.blockHeight);
+			if (info.blockOffsets.size() != blocks || info.blockSizes.size() != blocks)
+				throw std::runtime_error("TIFF strip or tile count mismatch in " + m_fileName);
+			for (size_t i = 0; i < blocks; i++)
+			{
+				if (info.blockOffsets[i] > m_size || info.blockSizes[i] > m_size - info.blockOffsets[i])
+					throw std::runtime_error("truncated TIFF data in " + m_fileName);
+			}
+			return info;
+		}
+
+		void LocatePages()
+		{
+			if (m_size < 8 || m_pBase[0] != 'I' || m_pBase[1] != 'I')
+				throw std::runtime_error("not a little-endian TIFF file: " + m_fileName);
+			uint64_t version = Internal::TiffGet(m_pBase + 2, 2);
+			uint64_t first;
+			if (version == 42)
+				first = Internal::TiffGet(m_pBase + 4, 4);
+			else if (version == 43 && m_size >= 16 && Internal::TiffGet(m_pBase + 4, 2) == 8)
+			{
+				m_bigTiff = true;
+				first = Internal::TiffGet(m_pBase + 8, 8);
+			}
+			else
+				throw std::runtime_error("not a TIFF file: " + m_fileName);
+			if (first == 0)
+				return;
+
+			// the page index, if the Save::TiffWriter closed the file
+			size_t headerSize = m_bigTiff ? 16 : 8;
+			if (m_size >= headerSize + 16 && std::memcmp(m_pBase + headerSize, Internal::TiffPageIndexMagic, 8) == 0)
+			{
+				uint64_t index = Internal::TiffGet(m_pBase + headerSize + 8, 8);
+				if (index != 0 && index <= m_size - 16 && std::memcmp(m_pBase + index, Internal::TiffPageIndexMagic, 8) == 0)
+				{
+					uint64_t numPages = Internal::TiffGet(m_pBase + index + 8, 8);
+					if (numPages > 0 && numPages <= (m_size - index - 16) / 8 && Internal::TiffGet(m_pBase + index + 16, 8) == first)
+					{
+						for (uint64_t p = 0; p < numPages; p++)
+							m_pages.push_back(Internal::TiffGet(m_pBase + index + 16 + 8 * p, 8));
+						m_indexed = true;
+						return;
+					}
+				}
+			}
+
+			// otherwise the directory chain; a directory takes at least a
+			// few bytes, which bounds the walk on looping files
+			size_t countSize = m_bigTiff ? 8 : 2;
+			size_t entrySize = m_bigTiff ? 20 : 12;
+			uint64_t maxPages = m_size / (countSize + (m_bigTiff ? 8 : 4));
+			for (uint64_t offset = first; offset != 0; )
+			{
+				if (m_pages.size() >= maxPages)
+					throw std::runtime_error("TIFF directory chain loops in " + m_fileName);
+				uint64_t entries = DirectoryEntries(offset);
+				m_pages.push_back(offset);
+				uint64_t link = offset + countSize + entries * entrySize;
+				size_t fieldSize = m_bigTiff ? 8 : 4;
+				if (link > m_size - fieldSize)
+					break;
+				offset = Internal::TiffGet(m_pBase + link, fieldSize);
+			}
+		}
+
+		std::string m_fileName;
+		const uint8_t* m_pBase;
+		uint64_t m_size;
+		bool m_bigTiff;
+		size_t m_numThreads;
+		bool m_bgr;
+		bool m_indexed;
+		std::vector<uint64_t> m_pages;
+
+		TiffReader(const TiffReader&);
+		TiffReader& operator=(const TiffReader&);
+	};
+}
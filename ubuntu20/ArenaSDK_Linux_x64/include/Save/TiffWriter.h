@@ -0,0 +1,648 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "TiffDefs.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Save
+{
+	/**
+	 * @class TiffWriter
+	 *
+	 * The TIFF writer streams any number of pages into one TIFF file. Each
+	 * page is written as its strips or tiles followed by its image file
+	 * directory, and only the link from the previous directory is patched,
+	 * so appending never rewrites earlier data and the file is a valid TIFF
+	 * after every page. BigTIFF (the default) lifts the 4 GB limit of
+	 * classic TIFF.
+	 *
+	 * Strips or tiles are compressed in parallel with LZW, Deflate or
+	 * Zstandard, optionally after horizontal differencing, which suits
+	 * 16-bit scientific data. Zstandard needs SAVE_TIFF_ZSTD to be defined
+	 * before the include and libzstd to be linked; not every TIFF reader
+	 * supports it.
+	 *
+	 * On close, the writer stores a table of all directory offsets and
+	 * points a reserved block after the header at it. The
+	 * Save::TiffReader uses it to reach any page in constant time, and
+	 * falls back to walking the directory chain for files without it.
+	 *
+	 * Supported inputs are 8 and 16-bit mono (8 and 16 bits per pixel) and
+	 * 8 and 16-bit colour with or without alpha (24, 32, 48 and 64 bits per
+	 * pixel). 16-bit data is taken in host (little-endian) order. Colour
+	 * data is taken in BGR order by default, as produced for the image
+	 * writer.
+	 *
+	 * This header needs zlib; link with -lz. It is not included by
+	 * SaveApi.h.
+	 *
+	 * \code{.cpp}
+	 * 	// streaming 16-bit frames into one BigTIFF
+	 * 	{
+	 * 		Save::TiffWriter writer("savedimages/stack.tif");
+	 * 		writer.SetCompression(Save::TiffCodecDeflate);
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			Arena::IImage* pImage = pDevice->GetImage(2000);
+	 * 			writer.AppendPage(pImage->GetData(), pImage->GetWidth(), pImage->GetHeight(), pImage->GetBitsPerPixel());
+	 * 			pDevice->RequeueBuffer(pImage);
+	 * 		}
+	 *
+	 * 		writer.Close();
+	 * 	}
+	 * \endcode
+	 *
+	 * @see 
+	 *  - Save::TiffReader
+	 */
+	class TiffWriter
+	{
+	public:
+		/**
+		 * @fn TiffWriter(const char* pFileName, bool bigTiff = true, size_t numThreads = 0, bool createDirectories = true)
+		 *
+		 * @param pFileName
+		 *  - Type: const char*
+		 *  - File to create; an existing file is truncated
+		 *
+		 * @param bigTiff
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, writes BigTIFF with 64-bit offsets
+		 *  - Otherwise, writes classic TIFF, limited to 4 GB
+		 *
+		 * @param numThreads
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Compression threads
+		 *  - 0 uses one thread per hardware thread
+		 *
+		 * @param createDirectories
+		 *  - Type: bool
+		 *  - Default: true
+		 *  - If true, attempts to create any missing directories in the path
+		 *
+		 * A constructor. Creates the file and writes the TIFF header.
+		 *
+		 * @warning 
+		 *  - Throws std::runtime_error if the file cannot be created
+		 */
+		TiffWriter(const char* pFileName, bool bigTiff = true, size_t numThreads = 0, bool createDirectories = true)
+			: m_fileName(pFileName),
+			  m_fd(-1),
+			  m_bigTiff(bigTiff),
+			  m_numThreads(numThreads),
+			  m_codec(TiffCodecNone),
+			  m_level(-1),
+			  m_predictor(true),
+			  m_bgr(true),
+			  m_tiled(false),
+			  m_rowsPerStrip(0),
+			  m_tileWidth(256),
+			  m_tileHeight(256),
+			  m_end(0),
+			  m_linkOffset(0),
+			  m_nextFieldOffset(0),
+			  m_indexValueOffset(0),
+			  m_closed(false)
+		{
+			if (m_numThreads == 0)
+				m_numThreads = std::thread::hardware_concurrency();
+			if (m_numThreads == 0)
+				m_numThreads = 1;
+
+			if (createDirectories)
+				Internal::CreateDirectories(m_fileName);
+			m_fd = ::open(pFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (m_fd < 0)
+				throw Internal::SystemError("unable to create", m_fileName);
+
+			// header, then the page index block
+			uint8_t header[32] = { 'I', 'I' };
+			size_t headerSize = m_bigTiff ? 16 : 8;
+			if (m_bigTiff)
+			{
+				Internal::TiffPut(header + 2, 43, 2);
+				Internal::TiffPut(header + 4, 8, 2);
+				m_linkOffset = 8;
+			}
+			else
+			{
+				Internal::TiffPut(header + 2, 42, 2);
+				m_linkOffset = 4;
+			}
+			std::memcpy(header + headerSize, Internal::TiffPageIndexMagic, 8);
+			m_indexValueOffset = headerSize + 8;
+			m_end = headerSize + 16;
+
+			try
+			{
+				Write(header, static_cast<size_t>(m_end), 0);
+			}
+			catch (...)
+			{
+				::close(m_fd);
+				throw;
+			}
+		}
+
+		/**
+		 * @fn virtual ~TiffWriter()
+		 *
+		 * A destructor. Closes the file if Close has not been called. Errors
+		 * are swallowed; call Close to see them.
+		 */
+		virtual ~TiffWriter()
+		{
+			try
+			{
+				Close();
+			}
+			catch (...)
+			{
+			}
+			if (m_fd >= 0)
+				::close(m_fd);
+		}
+
+		/**
+		 * @fn virtual void SetCompression(ETiffCodec codec, int level = -1)
+		 *
+		 * @param codec
+		 *  - Type: Save::ETiffCodec
+		 *  - Compression of the following pages
+		 *
+		 * @param level
+		 *  - Type: int
+		 *  - Default: -1
+		 *  - Compression level for Deflate (1-9) and Zstandard (1-22)
+		 *  - -1 uses the codec's default
+		 *
+		 * <B> SetCompression </B> sets the compression of the pages that
+		 * follow. Pages are uncompressed by default.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument for Zstandard when SAVE_TIFF_ZSTD
+		 *    is not defined
+		 */
+		virtual void SetCompression(ETiffCodec codec, int level = -1)
+		{
+#if !defined(SAVE_TIFF_ZSTD)
+			if (codec == TiffCodecZstd)
+				throw std::invalid_argument("Zstandard TIFF compression needs SAVE_TIFF_ZSTD");
+#endif
+			m_codec = codec;
+			m_level = level;
+		}
+
+		/**
+		 * @fn virtual void SetPredictor(bool predictor)
+		 *
+		 * @param predictor
+		 *  - Type: bool
+		 *  - If true, applies horizontal differencing before compression
+		 *
+		 * <B> SetPredictor </B> turns the horizontal differencing predictor
+		 * on or off. It is on by default and has no effect on uncompressed
+		 * pages.
+		 */
+		virtual void SetPredictor(bool predictor)
+		{
+			m_predictor = predictor;
+		}
+
+		/**
+		 * @fn virtual void SetStrips(size_t rowsPerStrip = 0)
+		 *
+		 * @param rowsPerStrip
+		 *  - Type: size_t
+		 *  - Default: 0
+		 *  - Rows per strip
+		 *  - 0 picks strips of about 256 KB
+		 *
+		 * <B> SetStrips </B> lays the following pages out in strips, which
+		 * is the default.
+		 */
+		virtual void SetStrips(size_t rowsPerStrip = 0)
+		{
+			m_tiled = false;
+			m_rowsPerStrip = rowsPerStrip;
+		}
+
+		/**
+		 * @fn virtual void SetTiles(size_t tileWidth, size_t tileHeight)
+		 *
+		 * @param tileWidth
+		 *  - Type: size_t
+		 *  - Tile width, in pixels; a multiple of 16
+		 *
+		 * @param tileHeight
+		 *  - Type: size_t
+		 *  - Tile height, in pixels; a multiple of 16
+		 *
+		 * <B> SetTiles </B> lays the following pages out in tiles. Tiles
+		 * past the right and bottom edges are padded with zeros.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument if a dimension is not a positive
+		 *    multiple of 16
+		 */
+		virtual void SetTiles(size_t tileWidth, size_t tileHeight)
+		{
+			if (tileWidth == 0 || tileHeight == 0 || tileWidth % 16 != 0 || tileHeight % 16 != 0)
+				throw std::invalid_argument("TIFF tile dimensions must be multiples of 16");
+			m_tiled = true;
+			m_tileWidth = tileWidth;
+			m_tileHeight = tileHeight;
+		}
+
+		/**
+		 * @fn virtual void SetBgr(bool bgr)
+		 *
+		 * @param bgr
+		 *  - Type: bool
+		 *  - If true, colour input is BGR(A)
+		 *  - Otherwise, colour input is RGB(A)
+		 *
+		 * <B> SetBgr </B> sets the channel order of colour input.
+		 */
+		virtual void SetBgr(bool bgr)
+		{
+			m_bgr = bgr;
+		}
+
+		/**
+		 * @fn virtual size_t AppendPage(const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel)
+		 *
+		 * @param pData
+		 *  - Type: const uint8_t*
+		 *  - Image data, rows top to bottom without padding
+		 *
+		 * @param width
+		 *  - Type: size_t
+		 *  - Width, in pixels
+		 *
+		 * @param height
+		 *  - Type: size_t
+		 *  - Height, in pixels
+		 *
+		 * @param bitsPerPixel
+		 *  - Type: size_t
+		 *  - Bits per pixel: 8, 16, 24, 32, 48 or 64
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Index of the page
+		 *
+		 * <B> AppendPage </B> compresses an image and appends it as the next
+		 * page.
+		 *
+		 * @warning 
+		 *  - Throws std::invalid_argument for unsupported bits per pixel
+		 *  - Throws std::logic_error after Close
+		 *  - Throws std::runtime_error if a classic TIFF would pass 4 GB or
+		 *    the write fails
+		 */
+		virtual size_t AppendPage(const uint8_t* pData, size_t width, size_t height, size_t bitsPerPixel)
+		{
+			if (m_closed)
+				throw std::logic_error("TIFF file is closed");
+
+			Page page;
+			switch (bitsPerPixel)
+			{
+			case 8: page.samplesPerPixel = 1; page.bitsPerSample = 8; break;
+			case 16: page.samplesPerPixel = 1; page.bitsPerSample = 16; break;
+			case 24: page.samplesPerPixel = 3; page.bitsPerSample = 8; break;
+			case 32: page.samplesPerPixel = 4; page.bitsPerSample = 8; break;
+			case 48: page.samplesPerPixel = 3; page.bitsPerSample = 16; break;
+			case 64: page.samplesPerPixel = 4; page.bitsPerSample = 16; break;
+			default: throw std::invalid_argument("unsupported bits per pixel for TIFF");
+			}
+			if (width == 0 || height == 0 || width > 0xFFFFFFFF || height > 0xFFFFFFFF)
+				throw std::invalid_argument("invalid TIFF dimensions");
+
+			page.pData = pData;
+			page.width = width;
+			page.height = height;
+			page.pixelSize = bitsPerPixel / 8;
+			if (m_tiled)
+			{
+				page.blockWidth = m_tileWidth;
+				page.blockHeight = m_tileHeight;
+			}
+			else
+			{
+				page.blockWidth = width;
+				page.blockHeight = m_rowsPerStrip > 0 ? m_rowsPerStrip : (256 << 10) / (width * page.pixelSize);
+				page.blockHeight = std::max<size_t>(1, std::min(page.blockHeight, height));
+			}
+			page.across = (width + page.blockWidth - 1) / page.blockWidth;
+			page.down = (height + page.blockHeight - 1) / page.blockHeight;
+
+			// compress every strip or tile in parallel, then write them in
+			// order followed by the directory
+			std::vector<std::vector<uint8_t> > blocks(page.across * page.down);
+			Internal::TiffRunParallel(blocks.size(), m_numThreads, [&](size_t i) {
+				EncodeBlock(page, i, blocks[i]);
+			});
+
+			uint64_t dataOffset = Internal::AlignUp(m_end, 2);
+			std::vector<uint64_t> offsets(blocks.size());
+			std::vector<uint64_t> sizes(blocks.size());
+			uint64_t pos = dataOffset;
+			for (size_t i = 0; i < blocks.size(); i++)
+			{
+				offsets[i] = pos;
+				sizes[i] = blocks[i].size();
+				pos += sizes[i];
+			}
+
+			uint64_t ifdOffset = Internal::AlignUp(pos, m_bigTiff ? 8 : 2);
+			std::vector<uint8_t> ifd = BuildDirectory(page, offsets, sizes, ifdOffset);
+			if (!m_bigTiff && ifdOffset + ifd.size() + 8 * (m_pages.size() + 2) > 0xFFFFFFFFULL)
+				throw std::runtime_error("classic TIFF is limited to 4 GB; use BigTIFF for " + m_fileName);
+
+			for (size_t i = 0; i < blocks.size(); i++)
+			{
+				if (!blocks[i].empty())
+					Write(&blocks[i][0], blocks[i].size(), offsets[i]);
+			}
+			Write(&ifd[0], ifd.size(), ifdOffset);
+
+			// linking the directory last keeps the file valid if the
+			// process stops mid-page
+			uint8_t link[8];
+			Internal::TiffPut(link, ifdOffset, m_bigTiff ? 8 : 4);
+			Write(link, m_bigTiff ? 8 : 4, m_linkOffset);
+
+			m_linkOffset = ifdOffset + m_nextFieldOffset;
+			m_end = ifdOffset + ifd.size();
+			m_pages.push_back(ifdOffset);
+			return m_pages.size() - 1;
+		}
+
+		/**
+		 * @fn virtual void Flush()
+		 *
+		 * <B> Flush </B> waits until the pages written so far are on disk.
+		 */
+		virtual void Flush()
+		{
+			if (!m_closed && ::fdatasync(m_fd) != 0)
+				throw Internal::SystemError("unable to flush", m_fileName);
+		}
+
+		/**
+		 * @fn virtual void Close()
+		 *
+		 * <B> Close </B> writes the page index and closes the file. Further
+		 * appends throw.
+		 */
+		virtual void Close()
+		{
+			if (m_closed)
+				return;
+			m_closed = true;
+
+			if (!m_pages.empty())
+			{
+				uint64_t indexOffset = Internal::AlignUp(m_end, 8);
+				std::vector<uint8_t> index(16 + 8 * m_pages.size());
+				std::memcpy(&index[0], Internal::TiffPageIndexMagic, 8);
+				Internal::TiffPut(&index[8], m_pages.size(), 8);
+				for (size_t i = 0; i < m_pages.size(); i++)
+					Internal::TiffPut(&index[16 + 8 * i], m_pages[i], 8);
+				Write(&index[0], index.size(), indexOffset);
+
+				uint8_t value[8];
+				Internal::TiffPut(value, indexOffset, 8);
+				Write(value, 8, m_indexValueOffset);
+			}
+
+			int fd = m_fd;
+			m_fd = -1;
+			if (::close(fd) != 0)
+				throw Internal::SystemError("unable to close", m_fileName);
+		}
+
+		/**
+		 * @fn virtual size_t GetNumPages()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Number of pages appended
+		 */
+		virtual size_t GetNumPages()
+		{
+			return m_pages.size();
+		}
+
+		/**
+		 * @fn virtual std::string GetFileName()
+		 *
+		 * @return 
+		 *  - Type: std::string
+		 *  - Name of the file being written
+		 */
+		virtual std::string GetFileName()
+		{
+			return m_fileName;
+		}
+
+	private:
+		struct Page
+		{
+			const uint8_t* pData;
+			size_t width;
+			size_t height;
+			size_t samplesPerPixel;
+			size_t bitsPerSample;
+			size_t pixelSize;
+			size_t blockWidth;
+			size_t blockHeight;
+			size_t across;
+			size_t down;
+		};
+
+		struct Entry
+		{
+			uint16_t tag;
+			uint16_t type;
+			std::vector<uint64_t> values;
+		};
+
+		void EncodeBlock(const Page& page, size_t index, std::vector<uint8_t>& out)
+		{
+			size_t x0 = (index % page.across) * page.blockWidth;
+			size_t y0 = (index / page.across) * page.blockHeight;
+			size_t rows = m_tiled ? page.blockHeight : std::min(page.blockHeight, page.height - y0);
+			size_t blockRowSize = page.blockWidth * page.pixelSize;
+			size_t columns = std::min(page.blockWidth, page.width - x0);
+			size_t sampleSize = page.bitsPerSample / 8;
+			bool swapChannels = m_bgr && page.samplesPerPixel >= 3;
+
+			// tile padding stays zero
+			std::vector<uint8_t> raw(blockRowSize * rows, 0);
+			for (size_t r = 0; r < rows && y0 + r < page.height; r++)
+			{
+				const uint8_t* pSrc = page.pData + ((y0 + r) * page.width + x0) * page.pixelSize;
+				uint8_t* pDst = &raw[r * blockRowSize];
+				if (!swapChannels)
+				{
+					std::memcpy(pDst, pSrc, columns * page.pixelSize);
+					continue;
+				}
+				for (size_t x = 0; x < columns; x++)
+				{
+					const uint8_t* pPixel = pSrc + x * page.pixelSize;
+					uint8_t* pOut = pDst + x * page.pixelSize;
+					std::memcpy(pOut, pPixel, page.pixelSize);
+					std::memcpy(pOut, pPixel + 2 * sampleSize, sampleSize);
+					std::memcpy(pOut + 2 * sampleSize, pPixel, sampleSize);
+				}
+			}
+
+			if (m_codec == TiffCodecNone)
+			{
+				out.swap(raw);
+				return;
+			}
+			if (m_predictor)
+				Internal::TiffApplyPredictor(&raw[0], blockRowSize, rows, page.samplesPerPixel, page.bitsPerSample);
+			Internal::TiffCompress(m_codec, m_level, &raw[0], raw.size(), out);
+		}
+
+		std::vector<uint8_t> BuildDirectory(const Page& page, const std::vector<uint64_t>& offsets, const std::vector<uint64_t>& sizes, uint64_t ifdOffset)
+		{
+			uint16_t offsetType = m_bigTiff ? Internal::TiffTypeLong8 : Internal::TiffTypeLong;
+			std::vector<Entry> entries;
+			auto add = [&](uint16_t tag, uint16_t type, const std::vector<uint64_t>& values) {
+				Entry entry;
+				entry.tag = tag;
+				entry.type = type;
+				entry.values = values;
+				entries.push_back(entry);
+			};
+			auto one = [](uint64_t value) {
+				return std::vector<uint64_t>(1, value);
+			};
+
+			// entries must be in ascending tag order
+			add(Internal::TiffTagNewSubfileType, Internal::TiffTypeLong, one(2));
+			add(Internal::TiffTagImageWidth, Internal::TiffTypeLong, one(page.width));
+			add(Internal::TiffTagImageLength, Internal::TiffTypeLong, one(page.height));
+			add(Internal::TiffTagBitsPerSample, Internal::TiffTypeShort, std::vector<uint64_t>(page.samplesPerPixel, page.bitsPerSample));
+			add(Internal::TiffTagCompression, Internal::TiffTypeShort, one(Internal::TiffCompressionTag(m_codec)));
+			add(Internal::TiffTagPhotometric, Internal::TiffTypeShort, one(page.samplesPerPixel >= 3 ? 2 : 1));
+			if (!m_tiled)
+				add(Internal::TiffTagStripOffsets, offsetType, offsets);
+			add(Internal::TiffTagSamplesPerPixel, Internal::TiffTypeShort, one(page.samplesPerPixel));
+			if (!m_tiled)
+			{
+				add(Internal::TiffTagRowsPerStrip, Internal::TiffTypeLong, one(page.blockHeight));
+				add(Internal::TiffTagStripByteCounts, offsetType, sizes);
+			}
+			add(Internal::TiffTagPlanarConfig, Internal::TiffTypeShort, one(1));
+			if (m_codec != TiffCodecNone && m_predictor)
+				add(Internal::TiffTagPredictor, Internal::TiffTypeShort, one(2));
+			if (m_tiled)
+			{
+				add(Internal::TiffTagTileWidth, Internal::TiffTypeLong, one(page.blockWidth));
+				add(Internal::TiffTagTileLength, Internal::TiffTypeLong, one(page.blockHeight));
+				add(Internal::TiffTagTileOffsets, offsetType, offsets);
+				add(Internal::TiffTagTileByteCounts, offsetType, sizes);
+			}
+			if (page.samplesPerPixel == 4)
+				add(Internal::TiffTagExtraSamples, Internal::TiffTypeShort, one(2));
+			add(Internal::TiffTagSampleFormat, Internal::TiffTypeShort, std::vector<uint64_t>(page.samplesPerPixel, 1));
+
+			// count, entries and next link, then values too large to fit in
+			// their entries
+			size_t countSize = m_bigTiff ? 8 : 2;
+			size_t entrySize = m_bigTiff ? 20 : 12;
+			size_t fieldSize = m_bigTiff ? 8 : 4;
+			size_t directorySize = countSize + entries.size() * entrySize + fieldSize;
+			std::vector<uint8_t> out(directorySize, 0);
+			Internal::TiffPut(&out[0], entries.size(), countSize);
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				const Entry& entry = entries[i];
+				size_t typeSize = entry.type == Internal::TiffTypeShort ? 2 : (entry.type == Internal::TiffTypeLong ? 4 : 8);
+				size_t dataSize = typeSize * entry.values.size();
+				size_t pos = countSize + i * entrySize;
+				Internal::TiffPut(&out[pos], entry.tag, 2);
+				Internal::TiffPut(&out[pos + 2], entry.type, 2);
+				Internal::TiffPut(&out[pos + 4], entry.values.size(), m_bigTiff ? 8 : 4);
+				size_t valuePos = pos + 4 + (m_bigTiff ? 8 : 4);
+
+				uint8_t* pValues;
+				if (dataSize <= fieldSize)
+					pValues = &out[valuePos];
+				else
+				{
+					size_t extra = out.size();
+					Internal::TiffPut(&out[valuePos], ifdOffset + extra, fieldSize);
+					out.resize(extra + dataSize + (dataSize & 1), 0);
+					pValues = &out[extra];
+				}
+				for (size_t v = 0; v < entry.values.size(); v++)
+					Internal::TiffPut(pValues + v * typeSize, entry.values[v], typeSize);
+			}
+			m_nextFieldOffset = directorySize - fieldSize;
+			return out;
+		}
+
+		void Write(const uint8_t* pData, size_t size, uint64_t offset)
+		{
+			while (size > 0)
+			{
+				ssize_t written = ::pwrite(m_fd, pData, size, static_cast<off_t>(offset));
+				if (written < 0 && errno == EINTR)
+					continue;
+				if (written <= 0)
+					throw Internal::SystemError("unable to write", m_fileName);
+				pData += written;
+				size -= static_cast<size_t>(written);
+				offset += static_cast<uint64_t>(written);
+			}
+		}
+
+		std::string m_fileName;
+		int m_fd;
+		bool m_bigTiff;
+		size_t m_numThreads;
+		ETiffCodec m_codec;
+		int m_level;
+		bool m_predictor;
+		bool m_bgr;
+		bool m_tiled;
+		size_t m_rowsPerStrip;
+		size_t m_tileWidth;
+		size_t m_tileHeight;
+		uint64_t m_end;
+		uint64_t m_linkOffset;
+		uint64_t m_nextFieldOffset;
+		uint64_t m_indexValueOffset;
+		std::vector<uint64_t> m_pages;
+		bool m_closed;
+
+		TiffWriter(const TiffWriter&);
+		TiffWriter& operator=(const TiffWriter&);
+	};
+}
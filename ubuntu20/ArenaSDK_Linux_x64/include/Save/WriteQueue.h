@@ -0,0 +1,656 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2023, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define SAVE_HAVE_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace Save
+{
+	/**
+	 * @typedef EWriteBackend
+	 *
+	 * The <B> EWriteBackend </B> enum represents the ways a Save::WriteQueue
+	 * can issue writes.
+	 */
+	typedef enum _EWriteBackend {
+		WriteBackendAuto, /*!< io_uring if the kernel allows it, otherwise a thread pool */
+		WriteBackendIoUring, /*!< io_uring only, throws if unavailable */
+		WriteBackendThreadPool, /*!< Blocking pwrite calls on a pool of threads */
+	} EWriteBackend;
+
+	/**
+	 * @struct WriteCompletion
+	 *
+	 * The <B> WriteCompletion </B> reports the outcome of one write queued on
+	 * a Save::WriteQueue.
+	 */
+	struct WriteCompletion
+	{
+		uint64_t tag;   /*!< Tag passed to Write */
+		int64_t result; /*!< Bytes written, or a negated errno value */
+	};
+
+	/**
+	 * @class WriteQueue
+	 *
+	 * The write queue keeps several file writes in flight from a single
+	 * thread, so fast drives see a deep queue instead of one blocking write
+	 * at a time. On Linux it submits through io_uring, optionally from
+	 * registered (pinned) buffers. Where io_uring is not available (older
+	 * kernels, containers that filter the system call), the same interface
+	 * is served by a pool of threads calling pwrite.
+	 *
+	 * Completions are collected by the queue and handed back on the calling
+	 * thread through Poll, Wait or Drain, whichever backend is in use. Short
+	 * writes are resubmitted internally, so a completion either covers the
+	 * whole request or carries an error.
+	 *
+	 * A write queue is not thread-safe; use one per writing thread.
+	 */
+	class WriteQueue
+	{
+	public:
+		/**
+		 * @fn WriteQueue(size_t queueDepth = 32, EWriteBackend backend = WriteBackendAuto)
+		 *
+		 * @param queueDepth
+		 *  - Type: size_t
+		 *  - Default: 32
+		 *  - Maximum number of writes in flight
+		 *
+		 * @param backend
+		 *  - Type: Save::EWriteBackend
+		 *  - Default: WriteBackendAuto
+		 *  - Backend to use
+		 *
+		 * A constructor.
+		 *
+		 * @warning 
+		 *  - Throws std::runtime_error if WriteBackendIoUring is requested
+		 *    and io_uring cannot be set up
+		 */
+		WriteQueue(size_t queueDepth = 32, EWriteBackend backend = WriteBackendAuto)
+			: m_queueDepth(queueDepth > 0 ? queueDepth : 1),
+			  m_backend(WriteBackendThreadPool),
+			  m_inFlight(0),
+			  m_stop(false)
+#ifdef SAVE_HAVE_IO_URING
+			  ,
+			  m_ringFd(-1),
+			  m_pSqRing(MAP_FAILED),
+			  m_pCqRing(MAP_FAILED),
+			  m_pSqes(MAP_FAILED),
+			  m_sqRingSize(0),
+			  m_cqRingSize(0),
+			  m_sqesSize(0)
+#endif
+		{
+			m_slots.resize(m_queueDepth);
+			for (size_t i = 0; i < m_queueDepth; i++)
+				m_freeSlots.push_back(m_queueDepth - 1 - i);
+
+#ifdef SAVE_HAVE_IO_URING
+			if (backend != WriteBackendThreadPool && SetupRing())
+			{
+				m_backend = WriteBackendIoUring;
+				return;
+			}
+#endif
+			if (backend == WriteBackendIoUring)
+				throw std::runtime_error("io_uring is not available");
+
+			size_t numThreads = m_queueDepth < 16 ? m_queueDepth : 16;
+			for (size_t i = 0; i < numThreads; i++)
+				m_threads.push_back(std::thread(&WriteQueue::Run, this));
+		}
+
+		/**
+		 * @fn virtual ~WriteQueue()
+		 *
+		 * A destructor. Waits for writes in flight to finish.
+		 */
+		virtual ~WriteQueue()
+		{
+			try
+			{
+				Drain();
+			}
+			catch (...)
+			{
+			}
+
+			if (!m_threads.empty())
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_stop = true;
+				}
+				m_workCv.notify_all();
+				for (size_t i = 0; i < m_threads.size(); i++)
+					m_threads[i].join();
+			}
+#ifdef SAVE_HAVE_IO_URING
+			TeardownRing();
+#endif
+		}
+
+		/**
+		 * @fn virtual EWriteBackend GetBackend()
+		 *
+		 * @return 
+		 *  - Type: Save::EWriteBackend
+		 *  - Backend in use, never WriteBackendAuto
+		 */
+		virtual EWriteBackend GetBackend()
+		{
+			return m_backend;
+		}
+
+		/**
+		 * @fn virtual size_t GetQueueDepth()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Maximum number of writes in flight
+		 */
+		virtual size_t GetQueueDepth()
+		{
+			return m_queueDepth;
+		}
+
+		/**
+		 * @fn virtual size_t GetInFlight()
+		 *
+		 * @return 
+		 *  - Type: size_t
+		 *  - Writes submitted whose completion has not been collected
+		 */
+		virtual size_t GetInFlight()
+		{
+			return m_inFlight;
+		}
+
+		/**
+		 * @fn virtual bool RegisterBuffers(const struct iovec* pBuffers, size_t numBuffers)
+		 *
+		 * @param pBuffers
+		 *  - Type: const struct iovec*
+		 *  - Buffers to register
+		 *
+		 * @param numBuffers
+		 *  - Type: size_t
+		 *  - Number of buffers
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if the buffers were registered
+		 *  - False if the backend does not support it or the kernel refused
+		 *    (usually RLIMIT_MEMLOCK)
+		 *
+		 * <B> RegisterBuffers </B> pins buffers with the kernel so that writes
+		 * from them skip the per-request page mapping. Pass the position of a
+		 * registered buffer as the buffer index to Write. Registering again
+		 * replaces the previous set; all writes must have completed.
+		 */
+		virtual bool RegisterBuffers(const struct iovec* pBuffers, size_t numBuffers)
+		{
+#ifdef SAVE_HAVE_IO_URING
+			if (m_backend != WriteBackendIoUring)
+				return false;
+			if (m_inFlight > 0)
+				throw std::logic_error("cannot register buffers with writes in flight");
+			if (!m_registered.empty())
+			{
+				syscall(__NR_io_uring_register, m_ringFd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+				m_registered.clear();
+			}
+			if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS, pBuffers, static_cast<unsigned>(numBuffers)) != 0)
+				return false;
+			m_registered.assign(pBuffers, pBuffers + numBuffers);
+			return true;
+#else
+			(void)pBuffers;
+			(void)numBuffers;
+			return false;
+#endif
+		}
+
+		/**
+		 * @fn virtual void Write(int fd, const void* pData, size_t size, uint64_t offset, uint64_t tag = 0, int bufferIndex = -1)
+		 *
+		 * @param fd
+		 *  - Type: int
+		 *  - File descriptor to write to
+		 *
+		 * @param pData
+		 *  - Type: const void*
+		 *  - Data to write, must stay valid until the write completes
+		 *
+		 * @param size
+		 *  - Type: size_t
+		 *  - Unit: bytes
+		 *  - Number of bytes to write
+		 *
+		 * @param offset
+		 *  - Type: uint64_t
+		 *  - Unit: bytes
+		 *  - File offset to write at
+		 *
+		 * @param tag
+		 *  - Type: uint64_t
+		 *  - Default: 0
+		 *  - Value returned in the completion
+		 *
+		 * @param bufferIndex
+		 *  - Type: int
+		 *  - Default: -1
+		 *  - Registered buffer that contains the data, or -1
+		 *
+		 * <B> Write </B> queues a write. If the queue is full, it first waits
+		 * for a write to complete; that completion is kept for Poll, Wait or
+		 * Drain.
+		 */
+		virtual void Write(int fd, const void* pData, size_t size, uint64_t offset, uint64_t tag = 0, int bufferIndex = -1)
+		{
+			while (m_freeSlots.empty())
+				Reap(true);
+
+			size_t slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			Request& request = m_slots[slot];
+			request.fd = fd;
+			request.pData = static_cast<const uint8_t*>(pData);
+			request.remaining = size;
+			request.offset = offset;
+			request.written = 0;
+			request.tag = tag;
+			request.bufferIndex = bufferIndex;
+			m_inFlight++;
+
+			Submit(slot);
+		}
+
+		/**
+		 * @fn virtual bool Poll(WriteCompletion& completion)
+		 *
+		 * @param completion
+		 *  - Type: Save::WriteCompletion&
+		 *  - Receives a completion
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - True if a completion was returned
+		 *
+		 * <B> Poll </B> returns a finished write without blocking.
+		 */
+		virtual bool Poll(WriteCompletion& completion)
+		{
+			if (m_done.empty())
+				Reap(false);
+			if (m_done.empty())
+				return false;
+			completion = m_done.front();
+			m_done.pop_front();
+			return true;
+		}
+
+		/**
+		 * @fn virtual bool Wait(WriteCompletion& completion)
+		 *
+		 * @param completion
+		 *  - Type: Save::WriteCompletion&
+		 *  - Receives a completion
+		 *
+		 * @return 
+		 *  - Type: bool
+		 *  - False if nothing was in flight
+		 *
+		 * <B> Wait </B> blocks until a write finishes and returns it.
+		 */
+		virtual bool Wait(WriteCompletion& completion)
+		{
+			while (m_done.empty())
+			{
+				if (m_inFlight == 0)
+					return false;
+				Reap(true);
+			}
+			completion = m_done.front();
+			m_done.pop_front();
+			return true;
+		}
+
+		/**
+		 * @fn virtual void Drain()
+		 *
+		 * <B> Drain </B> waits for every write in flight and discards the
+		 * completions.
+		 *
+		 * @warning 
+		 *  - Throws std::runtime_error if any discarded completion carried an
+		 *    error
+		 */
+		virtual void Drain()
+		{
+			int64_t error = 0;
+			WriteCompletion completion;
+			while (Wait(completion))
+			{
+				if (completion.result < 0 && error == 0)
+					error = completion.result;
+			}
+			if (error != 0)
+				throw std::runtime_error(std::string("queued write failed: ") + std::strerror(static_cast<int>(-error)));
+		}
+
+	private:
+		struct Request
+		{
+			int fd;
+			const uint8_t* pData;
+			size_t remaining;
+			uint64_t offset;
+			uint64_t written;
+			uint64_t tag;
+			int bufferIndex;
+			struct iovec iov;
+			int64_t result;
+		};
+
+		void Submit(size_t slot)
+		{
+#ifdef SAVE_HAVE_IO_URING
+			if (m_backend == WriteBackendIoUring)
+			{
+				SubmitRing(slot);
+				return;
+			}
+#endif
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pending.push_back(slot);
+			}
+			m_workCv.notify_one();
+		}
+
+		// moves finished requests to the completion list, resubmitting any
+		// remainder of a short write
+		void Reap(bool block)
+		{
+#ifdef SAVE_HAVE_IO_URING
+			if (m_backend == WriteBackendIoUring)
+			{
+				ReapRing(block);
+				return;
+			}
+#endif
+			std::vector<size_t> finished;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				if (block)
+					m_doneCv.wait(lock, [this]() { return !m_finished.empty(); });
+				finished.swap(m_finished);
+			}
+			for (size_t i = 0; i < finished.size(); i++)
+				Complete(finished[i], m_slots[finished[i]].result);
+		}
+
+		void Complete(size_t slot, int64_t result)
+		{
+			Request& request = m_slots[slot];
+			if (result > 0 && static_cast<size_t>(result) < request.remaining)
+			{
+				request.pData += result;
+				request.remaining -= static_cast<size_t>(result);
+				request.offset += static_cast<uint64_t>(result);
+				request.written += static_cast<uint64_t>(result);
+				Submit(slot);
+				return;
+			}
+			if (result == 0 && request.remaining > 0)
+				result = -EIO;
+
+			WriteCompletion completion;
+			completion.tag = request.tag;
+			completion.result = result < 0 ? result : static_cast<int64_t>(request.written + static_cast<uint64_t>(result));
+			m_done.push_back(completion);
+			m_freeSlots.push_back(slot);
+			m_inFlight--;
+		}
+
+		void Run()
+		{
+			for (;;)
+			{
+				size_t slot;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_workCv.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+					if (m_pending.empty())
+						return;
+					slot = m_pending.front();
+					m_pending.pop_front();
+				}
+
+				Request& request = m_slots[slot];
+				ssize_t result;
+				do
+				{
+					result = ::pwrite(request.fd, request.pData, request.remaining, static_cast<off_t>(request.offset));
+				} while (result < 0 && errno == EINTR);
+				request.result = result < 0 ? -errno : result;
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_finished.push_back(slot);
+				}
+				m_doneCv.notify_one();
+			}
+		}
+
+#ifdef SAVE_HAVE_IO_URING
+		bool SetupRing()
+		{
+			struct io_uring_params params;
+			std::memset(&params, 0, sizeof(params));
+			int fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(m_queueDepth), &params));
+			if (fd < 0)
+				return false;
+			m_ringFd = fd;
+
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				if (m_cqRingSize > m_sqRingSize)
+					m_sqRingSize = m_cqRingSize;
+				m_cqRingSize = m_sqRingSize;
+			}
+			m_pSqRing = mmap(NULL, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (m_pSqRing == MAP_FAILED)
+				return TeardownRing();
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+				m_pCqRing = m_pSqRing;
+			else
+			{
+				m_pCqRing = mmap(NULL, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+				if (m_pCqRing == MAP_FAILED)
+					return TeardownRing();
+			}
+			m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+			m_pSqes = mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+			if (m_pSqes == MAP_FAILED)
+				return TeardownRing();
+
+			uint8_t* pSq = static_cast<uint8_t*>(m_pSqRing);
+			uint8_t* pCq = static_cast<uint8_t*>(m_pCqRing);
+			m_sqTail = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+			m_sqMask = *reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+			m_sqArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+			m_cqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+			m_cqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+			m_cqMask = *reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+			m_cqes = reinterpret_cast<struct io_uring_cqe*>(pCq + params.cq_off.cqes);
+			return true;
+		}
+
+		bool TeardownRing()
+		{
+			if (m_pSqes != MAP_FAILED)
+				munmap(m_pSqes, m_sqesSize);
+			if (m_pCqRing != MAP_FAILED && m_pCqRing != m_pSqRing)
+				munmap(m_pCqRing, m_cqRingSize);
+			if (m_pSqRing != MAP_FAILED)
+				munmap(m_pSqRing, m_sqRingSize);
+			if (m_ringFd >= 0)
+				::close(m_ringFd);
+			m_pSqes = m_pCqRing = m_pSqRing = MAP_FAILED;
+			m_ringFd = -1;
+			return false;
+		}
+
+		void SubmitRing(size_t slot)
+		{
+			Request& request = m_slots[slot];
+			unsigned tail = *m_sqTail;
+			unsigned index = tail & m_sqMask;
+			struct io_uring_sqe* pSqe = static_cast<struct io_uring_sqe*>(m_pSqes) + index;
+			std::memset(pSqe, 0, sizeof(*pSqe));
+			pSqe->fd = request.fd;
+			pSqe->off = request.offset;
+			pSqe->user_data = slot;
+			if (request.bufferIndex >= 0 && static_cast<size_t>(request.bufferIndex) < m_registered.size())
+			{
+				pSqe->opcode = IORING_OP_WRITE_FIXED;
+				pSqe->addr = reinterpret_cast<uint64_t>(request.pData);
+				pSqe->len = static_cast<uint32_t>(request.remaining);
+				pSqe->buf_index = static_cast<uint16_t>(request.bufferIndex);
+			}
+			else
+			{
+				// WRITEV predates IORING_OP_WRITE, so it works on every
+				// kernel with io_uring
+				request.iov.iov_base = const_cast<uint8_t*>(request.pData);
+				request.iov.iov_len = request.remaining;
+				pSqe->opcode = IORING_OP_WRITEV;
+				pSqe->addr = reinterpret_cast<uint64_t>(&request.iov);
+				pSqe->len = 1;
+			}
+			m_sqArray[index] = index;
+			__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+			for (;;)
+			{
+				long submitted = syscall(__NR_io_uring_enter, m_ringFd, 1, 0, 0, NULL, 0);
+				if (submitted >= 0)
+					break;
+				if (errno == EINTR)
+					continue;
+				// the ring is full of unreaped completions; collect and retry
+				if (errno == EBUSY || errno == EAGAIN)
+				{
+					ReapRing(true);
+					continue;
+				}
+				throw std::runtime_error(std::string("io_uring submit failed: ") + std::strerror(errno));
+			}
+		}
+
+		void ReapRing(bool block)
+		{
+			for (;;)
+			{
+				unsigned head = *m_cqHead;
+				unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+				if (head != tail)
+				{
+					std::vector<std::pair<size_t, int64_t> > finished;
+					for (; head != tail; head++)
+					{
+						const struct io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+						finished.push_back(std::make_pair(static_cast<size_t>(cqe.user_data), static_cast<int64_t>(cqe.res)));
+					}
+					__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+					for (size_t i = 0; i < finished.size(); i++)
+						Complete(finished[i].first, finished[i].second);
+					return;
+				}
+				if (!block)
+					return;
+				if (syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+					throw std::runtime_error(std::string("io_uring wait failed: ") + std::strerror(errno));
+			}
+		}
+#endif
+
+		size_t m_queueDepth;
+		EWriteBackend m_backend;
+		std::vector<Request> m_slots;
+		std::vector<size_t> m_freeSlots;
+		std::deque<WriteCompletion> m_done;
+		size_t m_inFlight;
+
+		// thread pool backend
+		std::mutex m_mutex;
+		std::condition_variable m_workCv;
+		std::condition_variable m_doneCv;
+		std::deque<size_t> m_pending;
+		std::vector<size_t> m_finished;
+		bool m_stop;
+		std::vector<std::thread> m_threads;
+
+#ifdef SAVE_HAVE_IO_URING
+		// io_uring backend
+		int m_ringFd;
+		void* m_pSqRing;
+		void* m_pCqRing;
+		void* m_pSqes;
+		size_t m_sqRingSize;
+		size_t m_cqRingSize;
+		size_t m_sqesSize;
+		unsigned* m_sqTail;
+		unsigned m_sqMask;
+		unsigned* m_sqArray;
+		unsigned* m_cqHead;
+		unsigned* m_cqTail;
+		unsigned m_cqMask;
+		struct io_uring_cqe* m_cqes;
+		std::vector<struct iovec> m_registered;
+#endif
+
+		WriteQueue(const WriteQueue&);
+		WriteQueue& operator=(const WriteQueue&);
+	};
+}